@@ -29,9 +29,10 @@ import torch
 from torch.nn import Parameter
 
 from MinkowskiSparseTensor import SparseTensor
-from MinkowskiEngineBackend._C import CoordinateMapKey, RegionType
+from MinkowskiEngineBackend._C import CoordinateMapKey, RegionType, ConvolutionMode
 from MinkowskiCommon import MinkowskiModuleBase
 from MinkowskiKernelGenerator import KernelGenerator
+from MinkowskiDepthwiseConvolution import MinkowskiDepthwiseConvolutionFunction
 
 
 class MinkowskiChannelwiseConvolution(MinkowskiModuleBase):
@@ -168,6 +169,20 @@ class MinkowskiChannelwiseConvolution(MinkowskiModuleBase):
         in_key = input.coordinate_map_key
 
         out_key = cm.stride(in_key, self.kernel_generator.kernel_stride)
+        if not input.F.is_cuda:
+            out_F = MinkowskiDepthwiseConvolutionFunction.apply(
+                input.F,
+                self.kernel,
+                self.kernel_generator,
+                ConvolutionMode.DEFAULT,
+                in_key,
+                out_key,
+                cm,
+            )
+            if self.bias is not None:
+                out_F = out_F + self.bias
+            return SparseTensor(out_F, coordinate_map_key=out_key, coordinate_manager=cm)
+
         N_out = cm.size(out_key)
         out_F = input._F.new(N_out, self.in_channels).zero_()
 
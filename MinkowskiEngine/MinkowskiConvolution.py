@@ -23,13 +23,19 @@
 # Networks", CVPR'19 (https://arxiv.org/abs/1904.08755) if you use any part
 # of the code.
 import math
-from typing import Union
+from typing import List, Union
 
 import torch
+import torch.nn.functional as F
 from torch.autograd import Function
 from torch.nn import Parameter
 
-from MinkowskiEngineBackend._C import CoordinateMapKey, RegionType, ConvolutionMode
+from MinkowskiEngineBackend._C import (
+    CoordinateMapKey,
+    RegionType,
+    ConvolutionMode,
+    ActivationType,
+)
 from MinkowskiSparseTensor import SparseTensor, _get_coordinate_map_key
 from MinkowskiCommon import (
     MinkowskiModuleBase,
@@ -121,6 +127,212 @@ class MinkowskiConvolutionFunction(Function):
         )
 
 
+class MinkowskiMultiTensorConvolutionFunction(Function):
+    r"""Convolution of several sparse tensors with the same kernel.
+
+    The tensors can be defined in different coordinate managers. On CPU, the
+    kernel slice of each kernel offset is multiplied with the features of all
+    tensors at once.
+    """
+
+    @staticmethod
+    def forward(
+        ctx,
+        kernel_weights: torch.Tensor,
+        kernel_generator: KernelGenerator,
+        convolution_mode: ConvolutionMode,
+        in_coordinate_map_keys: List[CoordinateMapKey],
+        out_coordinate_map_keys: List[CoordinateMapKey],
+        coordinate_managers: List[CoordinateManager],
+        *input_features: torch.Tensor,
+    ):
+        assert (
+            not kernel_weights.is_cuda
+        ), "The multi-tensor convolution is only supported on CPU."
+        input_features = [f.contiguous() for f in input_features]
+        ctx.input_features = input_features
+        ctx.kernel_weights = kernel_weights
+        ctx.misc = [
+            kernel_generator,
+            convolution_mode,
+            in_coordinate_map_keys,
+            out_coordinate_map_keys,
+            coordinate_managers,
+        ]
+
+        fw_fn = get_minkowski_function("MultiTensorConvolutionForward", kernel_weights)
+        return tuple(
+            fw_fn(
+                input_features,
+                kernel_weights,
+                kernel_generator.kernel_size,
+                kernel_generator.kernel_stride,
+                kernel_generator.kernel_dilation,
+                kernel_generator.region_type,
+                kernel_generator.region_offsets,
+                kernel_generator.expand_coordinates,
+                convolution_mode,
+                in_coordinate_map_keys,
+                out_coordinate_map_keys,
+                [manager._manager for manager in coordinate_managers],
+            )
+        )
+
+    @staticmethod
+    def backward(ctx, *grad_out_feats: torch.Tensor):
+        (
+            kernel_generator,
+            convolution_mode,
+            in_coordinate_map_keys,
+            out_coordinate_map_keys,
+            coordinate_managers,
+        ) = ctx.misc
+
+        bw_fn = get_minkowski_function("ConvolutionBackward", ctx.kernel_weights)
+        grad_in_feats, grad_kernel = [], None
+        for input_features, grad_out_feat, in_key, out_key, manager in zip(
+            ctx.input_features,
+            grad_out_feats,
+            in_coordinate_map_keys,
+            out_coordinate_map_keys,
+            coordinate_managers,
+        ):
+            grad_in_feat, grad_curr_kernel = bw_fn(
+                input_features,
+                grad_out_feat.contiguous(),
+                ctx.kernel_weights,
+                kernel_generator.kernel_size,
+                kernel_generator.kernel_stride,
+                kernel_generator.kernel_dilation,
+                kernel_generator.region_type,
+                kernel_generator.region_offsets,
+                convolution_mode,
+                in_key,
+                out_key,
+                manager._manager,
+            )
+            grad_in_feats.append(grad_in_feat)
+            grad_kernel = (
+                grad_curr_kernel if grad_kernel is None else grad_kernel + grad_curr_kernel
+            )
+        return (grad_kernel, None, None, None, None, None, *grad_in_feats)
+
+
+class MinkowskiConvolutionBiasActivationFunction(Function):
+    @staticmethod
+    def forward(
+        ctx,
+        input_features: torch.Tensor,
+        kernel_weights: torch.Tensor,
+        bias: torch.Tensor,
+        activation: ActivationType,
+        negative_slope: float,
+        kernel_generator: KernelGenerator,
+        convolution_mode: ConvolutionMode,
+        in_coordinate_map_key: CoordinateMapKey,
+        out_coordinate_map_key: CoordinateMapKey = None,
+        coordinate_manager: CoordinateManager = None,
+    ):
+        assert (
+            not input_features.is_cuda
+        ), "The fused convolution is only supported on CPU."
+        if out_coordinate_map_key is None:
+            out_coordinate_map_key = CoordinateMapKey(
+                in_coordinate_map_key.get_coordinate_size()
+            )
+
+        input_features = input_features.contiguous()
+        ctx.has_bias = bias is not None
+        if bias is None:
+            bias = torch.empty(0, dtype=input_features.dtype)
+
+        ctx.input_features = input_features
+        ctx.kernel_weights = kernel_weights
+        ctx.bias = bias
+        ctx.misc = [
+            activation,
+            negative_slope,
+            kernel_generator,
+            convolution_mode,
+            in_coordinate_map_key,
+            out_coordinate_map_key,
+            coordinate_manager,
+        ]
+
+        fw_fn = get_minkowski_function(
+            "ConvolutionBiasActivationForward", input_features
+        )
+        out_feat, pre_feat = fw_fn(
+            ctx.input_features,
+            kernel_weights,
+            bias,
+            activation,
+            negative_slope,
+            kernel_generator.kernel_size,
+            kernel_generator.kernel_stride,
+            kernel_generator.kernel_dilation,
+            kernel_generator.region_type,
+            kernel_generator.region_offsets,
+            kernel_generator.expand_coordinates,
+            convolution_mode,
+            in_coordinate_map_key,
+            out_coordinate_map_key,
+            coordinate_manager._manager,
+        )
+        ctx.pre_feat = pre_feat
+        ctx.save_for_backward(out_feat)
+        return out_feat
+
+    @staticmethod
+    def backward(ctx, grad_out_feat: torch.Tensor):
+        grad_out_feat = grad_out_feat.contiguous()
+        (out_feat,) = ctx.saved_tensors
+        (
+            activation,
+            negative_slope,
+            kernel_generator,
+            convolution_mode,
+            in_coordinate_map_key,
+            out_coordinate_map_key,
+            coordinate_manager,
+        ) = ctx.misc
+
+        bw_fn = get_minkowski_function(
+            "ConvolutionBiasActivationBackward", grad_out_feat
+        )
+        grad_in_feat, grad_kernel, grad_bias = bw_fn(
+            ctx.input_features,
+            grad_out_feat,
+            out_feat,
+            ctx.pre_feat,
+            ctx.kernel_weights,
+            ctx.bias,
+            activation,
+            negative_slope,
+            kernel_generator.kernel_size,
+            kernel_generator.kernel_stride,
+            kernel_generator.kernel_dilation,
+            kernel_generator.region_type,
+            kernel_generator.region_offsets,
+            convolution_mode,
+            in_coordinate_map_key,
+            out_coordinate_map_key,
+            coordinate_manager._manager,
+        )
+        return (
+            grad_in_feat,
+            grad_kernel,
+            grad_bias if ctx.has_bias else None,
+            None,
+            None,
+            None,
+            None,
+            None,
+            None,
+            None,
+        )
+
+
 class MinkowskiConvolutionTransposeFunction(Function):
     @staticmethod
     def forward(
@@ -473,6 +685,191 @@ class MinkowskiConvolution(MinkowskiConvolutionBase):
         )
         self.reset_parameters()
 
+    def _epilogue(self, outfeat):
+        if self.bias is not None:
+            outfeat = outfeat + self.bias
+        return outfeat
+
+    def forward_multi(self, inputs: List[SparseTensor]) -> List[SparseTensor]:
+        r"""Apply the convolution to several independent sparse tensors.
+
+        The tensors can have different coordinate managers. On CPU, the
+        convolution of all tensors is computed one kernel offset at a time so
+        that each kernel slice is reused for all tensors while it is in cache.
+        The outputs are identical to applying the layer to each tensor.
+
+        Args:
+            :attr:`inputs` (list of `MinkowskiEngine.SparseTensor`): the input
+            sparse tensors.
+
+        """
+        for input in inputs:
+            assert isinstance(input, SparseTensor)
+            assert input.D == self.dimension
+
+        if len(inputs) == 0:
+            return []
+        if self.use_mm:
+            out_coordinate_map_keys = [input.coordinate_map_key for input in inputs]
+            outfeats = [input.F.mm(self.kernel) for input in inputs]
+        elif self.kernel.is_cuda:
+            return [self(input) for input in inputs]
+        else:
+            out_coordinate_map_keys = [
+                _get_coordinate_map_key(
+                    input, None, self.kernel_generator.expand_coordinates
+                )
+                for input in inputs
+            ]
+            outfeats = MinkowskiMultiTensorConvolutionFunction.apply(
+                self.kernel,
+                self.kernel_generator,
+                self.convolution_mode,
+                [input.coordinate_map_key for input in inputs],
+                out_coordinate_map_keys,
+                [input._manager for input in inputs],
+                *[input.F for input in inputs],
+            )
+
+        return [
+            SparseTensor(
+                self._epilogue(outfeat),
+                coordinate_map_key=out_coordinate_map_key,
+                coordinate_manager=input._manager,
+            )
+            for input, outfeat, out_coordinate_map_key in zip(
+                inputs, outfeats, out_coordinate_map_keys
+            )
+        ]
+
+
+class MinkowskiFusedConvolution(MinkowskiConvolution):
+    r"""Convolution layer followed by the bias and a pointwise activation.
+
+    On CPU, the bias and the activation are applied in a single pass over the
+    convolution output and the backward computes the gradient of the
+    activation and the bias in a single pass before the convolution backward.
+    On GPU, the layers are applied one after another.
+
+    """
+
+    def __init__(
+        self,
+        in_channels,
+        out_channels,
+        kernel_size=-1,
+        stride=1,
+        dilation=1,
+        bias=True,
+        activation=ActivationType.RELU,
+        negative_slope=0.01,
+        kernel_generator=None,
+        expand_coordinates=False,
+        convolution_mode=ConvolutionMode.DEFAULT,
+        dimension=None,
+    ):
+        r"""convolution, bias, and activation on a sparse tensor
+
+        Args:
+            :attr:`activation` (:attr:`MinkowskiEngine.ActivationType`,
+            optional): one of `IDENTITY`, `RELU`, `LEAKY_RELU`, and `GELU`.
+            `RELU` by default.
+
+            :attr:`negative_slope` (float, optional): the non-negative slope
+            of `LEAKY_RELU`.
+
+            Please refer to :attr:`MinkowskiConvolution` for the rest of the
+            arguments.
+
+        """
+        assert isinstance(
+            activation, ActivationType
+        ), f"activation must be an instance of ActivationType. activation={activation}"
+        MinkowskiConvolution.__init__(
+            self,
+            in_channels,
+            out_channels,
+            kernel_size,
+            stride,
+            dilation,
+            bias,
+            kernel_generator,
+            expand_coordinates=expand_coordinates,
+            convolution_mode=convolution_mode,
+            dimension=dimension,
+        )
+        self.activation = activation
+        self.negative_slope = negative_slope
+
+    def _activation(self, x):
+        if self.activation == ActivationType.RELU:
+            return F.relu(x)
+        elif self.activation == ActivationType.LEAKY_RELU:
+            return F.leaky_relu(x, self.negative_slope)
+        elif self.activation == ActivationType.GELU:
+            return F.gelu(x)
+        return x
+
+    def _epilogue(self, outfeat):
+        return self._activation(MinkowskiConvolution._epilogue(self, outfeat))
+
+    def forward(
+        self,
+        input: SparseTensor,
+        coordinates: Union[torch.Tensor, CoordinateMapKey, SparseTensor] = None,
+    ):
+        assert isinstance(input, SparseTensor)
+        assert input.D == self.dimension
+
+        if self.use_mm:
+            out_coordinate_map_key = input.coordinate_map_key
+            outfeat = input.F.mm(self.kernel)
+            if self.bias is not None:
+                outfeat = outfeat + self.bias
+            outfeat = self._activation(outfeat)
+        else:
+            out_coordinate_map_key = _get_coordinate_map_key(
+                input, coordinates, self.kernel_generator.expand_coordinates
+            )
+            if input.F.is_cuda:
+                outfeat = self.conv.apply(
+                    input.F,
+                    self.kernel,
+                    self.kernel_generator,
+                    self.convolution_mode,
+                    input.coordinate_map_key,
+                    out_coordinate_map_key,
+                    input._manager,
+                )
+                if self.bias is not None:
+                    outfeat += self.bias
+                outfeat = self._activation(outfeat)
+            else:
+                outfeat = MinkowskiConvolutionBiasActivationFunction.apply(
+                    input.F,
+                    self.kernel,
+                    self.bias,
+                    self.activation,
+                    self.negative_slope,
+                    self.kernel_generator,
+                    self.convolution_mode,
+                    input.coordinate_map_key,
+                    out_coordinate_map_key,
+                    input._manager,
+                )
+
+        return SparseTensor(
+            outfeat,
+            coordinate_map_key=out_coordinate_map_key,
+            coordinate_manager=input._manager,
+        )
+
+    def __repr__(self):
+        return (
+            MinkowskiConvolution.__repr__(self)
+            + f"({str(self.activation)})"
+        )
+
 
 class MinkowskiConvolutionTranspose(MinkowskiConvolutionBase):
     r"""A generalized sparse transposed convolution or deconvolution layer."""
@@ -23,6 +23,7 @@
 # Networks", CVPR'19 (https://arxiv.org/abs/1904.08755) if you use any part
 # of the code.
 import os
+import time
 import numpy as np
 from collections import Sequence
 from typing import Union, List, Tuple
@@ -35,6 +36,7 @@ from MinkowskiEngineBackend._C import (
     CoordinateMapKey,
     GPUMemoryAllocatorType,
     CoordinateMapType,
+    CoordinateOrdering,
     MinkowskiAlgorithm,
     RegionType,
 )
@@ -48,6 +50,7 @@ _coordinate_map_type = (
     CoordinateMapType.CUDA if _C.is_cuda_available() else CoordinateMapType.CPU
 )
 _minkowski_algorithm = MinkowskiAlgorithm.DEFAULT
+_coordinate_ordering = CoordinateOrdering.INSERTION
 
 
 def set_coordinate_map_type(coordinate_map_type: CoordinateMapType):
@@ -60,6 +63,34 @@ def set_coordinate_map_type(coordinate_map_type: CoordinateMapType):
     _coordinate_map_type = coordinate_map_type
 
 
+def set_coordinate_ordering(ordering: CoordinateOrdering):
+    r"""Set the default row order of the CPU coordinate maps.
+
+    With :attr:`ME.CoordinateOrdering.MORTON` or
+    :attr:`ME.CoordinateOrdering.HILBERT`, the rows of the new and the strided
+    coordinate maps are sorted by the batch index and then along the Z-order
+    or the Hilbert curve. The neighbors of a coordinate then have nearby rows
+    and the CPU kernels gather the features of a kernel map with fewer cache
+    misses. :attr:`ME.CoordinateOrdering.INSERTION` keeps the order of the
+    input coordinates.
+
+    The `unique_map` of the coordinates follows the order of the rows. Use it
+    to reorder the labels of the input coordinates.
+
+    Example::
+
+       >>> ME.set_coordinate_ordering(ME.CoordinateOrdering.HILBERT)
+       >>> sinput = ME.SparseTensor(feats, coordinates)
+       >>> labels = labels[sinput.unique_index]
+
+    """
+    assert isinstance(
+        ordering, CoordinateOrdering
+    ), f"Input must be an instance of CoordinateOrdering not {ordering}"
+    global _coordinate_ordering
+    _coordinate_ordering = ordering
+
+
 def set_gpu_allocator(backend: GPUMemoryAllocatorType):
     r"""Set the GPU memory allocator
 
@@ -112,22 +143,39 @@ class CoordinateManager:
         coordinate_map_type: CoordinateMapType = None,
         allocator_type: GPUMemoryAllocatorType = None,
         minkowski_algorithm: MinkowskiAlgorithm = None,
+        coordinate_ordering: CoordinateOrdering = None,
     ):
         r"""
 
         :attr:`D`: The order, or dimension of the coordinates.
+
+        :attr:`num_threads`: The maximum number of threads of the CPU
+        operations on the coordinates and the features of this manager. The
+        threads are limited to `torch.get_num_threads()` so that the CPU
+        kernels do not oversubscribe the cores PyTorch uses. A negative value
+        or 0 uses `torch.get_num_threads()` threads.
+
+        :attr:`coordinate_ordering`: The row order of the new and the strided
+        CPU coordinate maps. See :attr:`set_coordinate_ordering`.
+
+        A manager can be shared by threads. The lookups of the coordinate
+        maps and the kernel maps run concurrently and a missing map is
+        generated once and shared by the threads that request it.
         """
         global _coordinate_map_type, _allocator_type, _minkowski_algorithm
+        global _coordinate_ordering
         if D < 1:
             raise ValueError(f"Invalid rank D > 0, D = {D}.")
         if num_threads < 0:
-            num_threads = min(CPU_COUNT, 20)
+            num_threads = 0
         if coordinate_map_type is None:
             coordinate_map_type = _coordinate_map_type
         if allocator_type is None:
             allocator_type = _allocator_type
         if minkowski_algorithm is None:
             minkowski_algorithm = _minkowski_algorithm
+        if coordinate_ordering is None:
+            coordinate_ordering = _coordinate_ordering
 
         postfix = ""
         if coordinate_map_type == CoordinateMapType.CPU:
@@ -143,8 +191,11 @@ class CoordinateManager:
 
         self.D = D
         self.minkowski_algorithm = minkowski_algorithm
+        self.coordinate_map_type = coordinate_map_type
         self._CoordinateManagerClass = getattr(_C, "CoordinateMapManager" + postfix)
-        self._manager = self._CoordinateManagerClass(minkowski_algorithm, num_threads)
+        self._manager = self._CoordinateManagerClass(
+            minkowski_algorithm, num_threads, coordinate_ordering
+        )
 
     # TODO: insert without remap, unique_map, inverse_mapa
     #
@@ -331,6 +382,16 @@ class CoordinateManager:
         key = self._get_coordinate_map_key(coords_key_or_tensor_strides)
         return self._manager.get_coordinate_field(key)
 
+    @property
+    def num_threads(self) -> int:
+        r"""The number of threads of the CPU operations of this manager."""
+        return self._manager.num_threads()
+
+    @property
+    def coordinate_ordering(self) -> CoordinateOrdering:
+        r"""The row order of the new and the strided CPU coordinate maps."""
+        return self._manager.coordinate_ordering()
+
     def number_of_unique_batch_indices(self) -> int:
         return self._manager.origin_map_size()
 
@@ -429,6 +490,98 @@ class CoordinateManager:
     def stride_map(self, in_key: CoordinateMapKey, stride_key: CoordinateMapKey):
         return self._manager.stride_map(in_key, stride_key)
 
+    def batch_row_indices(self, key: CoordinateMapKey) -> List[torch.Tensor]:
+        r"""Returns the row indices of each batch index in ascending order.
+
+        The rows come from the batch segment index of the coordinate map,
+        which is built with a single counting sort on the batch indices and
+        cached until the map changes. The returned tensors are views of a
+        single tensor. Only supported for `CoordinateMapType.CPU`.
+
+        Example::
+
+           >>> manager = CoordinateManager(D=3, coordinate_map_type=CoordinateMapType.CPU)
+           >>> key, (unique_map, inverse_map) = manager.insert_and_map(coordinates)
+           >>> batch_rows = manager.batch_row_indices(key)
+           >>> batch_coordinates = manager.get_coordinates(key)[batch_rows[0]]
+
+        """
+        row_ptr, rows = self._manager.batch_row_indices(key)
+        return list(torch.split(rows, (row_ptr[1:] - row_ptr[:-1]).tolist()))
+
+    def update(
+        self,
+        key: CoordinateMapKey,
+        insert_coordinates: torch.Tensor = None,
+        erase_coordinates: torch.Tensor = None,
+    ) -> Tuple[torch.LongTensor, torch.LongTensor]:
+        r"""Erase and insert coordinates of the coordinate map :attr:`key` in
+        place and returns (insert_rows, moved_rows).
+
+        The rows of the erased coordinates are filled with the last rows so
+        that the rows stay contiguous, and the inserted coordinates get the
+        rows after them. `moved_rows` is a `2 x M` tensor of the (old row, new
+        row) pairs of the moved rows and `insert_rows[i]` is the row of
+        `insert_coordinates[i]`. Use :attr:`update_features` to update the
+        features of the map accordingly.
+
+        The cached kernel maps of the map to itself with stride 1, e.g. the
+        kernel maps of the convolutions with stride 1, are updated with the
+        neighbors of the inserted coordinates only. An update that only
+        inserts coordinates costs O(inserted x kernel volume) hash lookups.
+        Erasing coordinates additionally takes a pass over the rows and the
+        pairs of the updated kernel maps, O(N + pairs), which is still a
+        fraction of a rebuild. With `SPEED_OPTIMIZED`, the pairs of the
+        updated kernel maps are sorted again. The other kernel maps and the
+        field to sparse maps of the map are erased and regenerated on
+        demand. The coordinate maps derived from the map, e.g. the strided,
+        pruned, and merged maps, and the origin map are stale. They are
+        erased with their kernel maps, and :attr:`stride` and the strided
+        layers regenerate them from the updated map under the same keys.
+
+        The map is modified in place and the kernel maps of the map are
+        modified or freed, so neither may be in use by other threads, e.g. a
+        forward pass running concurrently on the same manager. Call it between
+        iterations. Only supported for `CoordinateMapType.CPU`.
+
+        Example::
+
+           >>> insert_rows, moved_rows = manager.update(key, new_coordinates, old_coordinates)
+           >>> feats = manager.update_features(key, feats, new_feats, insert_rows, moved_rows)
+           >>> sinput = ME.SparseTensor(feats, coordinate_map_key=key, coordinate_manager=manager)
+
+        """
+        empty = torch.empty((0, self.D + 1), dtype=torch.int)
+        if insert_coordinates is None:
+            insert_coordinates = empty
+        if erase_coordinates is None:
+            erase_coordinates = empty
+        return self._manager.update(
+            key,
+            insert_coordinates.int().contiguous(),
+            erase_coordinates.int().contiguous(),
+        )
+
+    def update_features(
+        self,
+        key: CoordinateMapKey,
+        features: torch.Tensor,
+        insert_features: torch.Tensor,
+        insert_rows: torch.LongTensor,
+        moved_rows: torch.LongTensor,
+    ) -> torch.Tensor:
+        r"""Returns the features of the coordinate map :attr:`key` after
+        :attr:`update` from the features before the update.
+        """
+        num_rows = self.size(key)
+        updated = features.new_empty((num_rows, features.size(1)))
+        num_kept = min(num_rows, features.size(0))
+        updated[:num_kept] = features[:num_kept]
+        updated[moved_rows[1]] = features[moved_rows[0]]
+        if len(insert_rows) > 0:
+            updated[insert_rows] = insert_features.to(features)
+        return updated
+
     def union_map(self, in_keys: list, out_key):
         return self._manager.union_map(in_keys, out_key)
 
@@ -439,6 +592,138 @@ class CoordinateManager:
     ):
         return self._manager.interpolation_map_weight(samples, key)
 
+    def neighbors(
+        self,
+        key: CoordinateMapKey,
+        query: torch.Tensor,
+        k: int = 0,
+        radius: float = 0,
+        p: float = 2,
+    ) -> Tuple[torch.LongTensor, torch.LongTensor, torch.Tensor]:
+        r"""Returns the neighbors of the query points in the coordinate map
+        :attr:`key` as (row_ptr, rows, distances).
+
+        The neighbors of the query `i` are the rows of the coordinate map
+        `rows[row_ptr[i]:row_ptr[i + 1]]` in the ascending order of the
+        distances `distances[row_ptr[i]:row_ptr[i + 1]]`. The search uses the
+        hash table of the map and runs in parallel over the query points. Only
+        supported for `CoordinateMapType.CPU`.
+
+        Args:
+            :attr:`query` (`torch.FloatTensor`): the query points with the
+            batch index in the first column, e.g. the coordinates of a
+            `TensorField`.
+
+            :attr:`k` (int): if positive, the k nearest coordinates within
+            :attr:`radius`, or within the batch of the query if :attr:`radius`
+            is 0. A query gets fewer than k neighbors if its batch has fewer
+            than k coordinates within the radius.
+
+            :attr:`radius` (float): if :attr:`k` is 0, all coordinates within
+            the radius.
+
+            :attr:`p` (float): the norm of the distance, 2 or `float("inf")`.
+
+        Example::
+
+           >>> row_ptr, rows, distances = manager.neighbors(
+           >>>     sinput.coordinate_map_key, field.C, k=8)
+           >>> # Every query has 8 neighbors only if every batch has at
+           >>> # least 8 coordinates
+           >>> nearest_features = sinput.F[rows.view(-1, 8)]
+
+        """
+        assert p in (2, float("inf")), f"Unsupported norm p = {p}"
+        assert k > 0 or radius > 0, "Either k or radius must be positive"
+        return self._manager.neighbors(
+            query.contiguous(), key, float(radius), int(k), p == 2
+        )
+
+    def save(self, path: str):
+        r"""Save all coordinate maps, kernel maps, and field to sparse maps to
+        :attr:`path` in a versioned binary format.
+
+        Coordinates and kernel map indices are stored as aligned arrays, so a
+        static scene can be loaded with :attr:`load` without regenerating the
+        kernel maps. Only supported for `CoordinateMapType.CPU`.
+
+        Example::
+
+           >>> manager = CoordinateManager(D=3, coordinate_map_type=CoordinateMapType.CPU)
+           >>> key, (unique_map, inverse_map) = manager.insert_and_map(coordinates)
+           >>> kernel_map = manager.kernel_map(key, key, kernel_size=3)
+           >>> manager.save("scene.mkmap")
+
+        """
+        self._manager.save(str(path))
+
+    def load(self, path: str):
+        r"""Load the maps saved with :attr:`save` to an empty coordinate manager.
+
+        The hash tables are rebuilt from the saved coordinates in the original
+        row order, and the cached kernel maps are restored as is. The arrays
+        are read into the manager with a copy rather than memory-mapped,
+        since the hash tables are rebuilt anyway, so a load takes time linear
+        in the file size. The array lengths are checked against the file size,
+        and a truncated or corrupt file raises an error.
+
+        Example::
+
+           >>> manager = CoordinateManager(D=3, coordinate_map_type=CoordinateMapType.CPU)
+           >>> manager.load("scene.mkmap")
+           >>> coordinates = manager.get_coordinates([1, 1, 1])
+
+        """
+        self._manager.load(str(path))
+
+    def memory_stats(self):
+        r"""Returns the memory usage of the maps owned by the manager.
+
+        The returned dict has a list of entries for each of `coordinate_maps`,
+        `field_maps`, `kernel_maps`, `field_kernel_maps`,
+        `transient_kernel_maps`, and `field_to_sparse_maps`. Each entry has
+        the allocated `bytes`, the `size`, and the `created` and `last_used`
+        times in seconds since the epoch as `time.time()`. The coordinate map
+        entries additionally have the hash table `hash_capacity`,
+        `load_factor`, `coordinate_bytes`, and `hash_bytes`, and the kernel
+        map entries the number of pairs per kernel offset in `sizes`. The
+        total bytes of each collection are in `total_bytes`. Only supported
+        for `CoordinateMapType.CPU`.
+
+        Example::
+
+           >>> stats = sinput.coordinate_manager.memory_stats()
+           >>> stats["total_bytes"]["kernel_maps"]
+           >>> for entry in stats["kernel_maps"]:
+           >>>     print(entry["kernel_size"], entry["bytes"], entry["last_used"])
+
+        """
+        stats = self._manager.memory_stats()
+        stats["total_bytes"] = {
+            name: sum(entry["bytes"] for entry in entries)
+            for name, entries in stats.items()
+        }
+        return stats
+
+    def clear_kernel_maps(self, idle_seconds: float = 0.0):
+        r"""Erase the cached kernel maps not used for :attr:`idle_seconds`
+        and returns the number of erased kernel maps.
+
+        The coordinate maps and the field to sparse maps are kept since the
+        sparse tensors refer to them, while an erased kernel map is
+        regenerated on the next use. It is safe to call while operations of
+        the manager are running on other threads. The kernel maps in use are
+        freed when the operations finish. Only supported for
+        `CoordinateMapType.CPU`.
+
+        Example::
+
+           >>> # Free the kernel maps of the layers skipped for a minute
+           >>> manager.clear_kernel_maps(idle_seconds=60)
+
+        """
+        return self._manager.clear_kernel_maps(time.time() - idle_seconds)
+
     # def get_union_map(self, in_keys: List[CoordsKey], out_key: CoordsKey):
     #     r"""Generates a union of coordinate sets and returns the mapping from input sets to the new output coordinates.
 
@@ -15,7 +15,7 @@ from torch.nn import Parameter
 import MinkowskiEngineBackend._C as _C
 from MinkowskiEngineBackend._C import CoordinateMapKey, RegionType, ConvolutionMode
 from MinkowskiSparseTensor import SparseTensor, _get_coordinate_map_key
-from MinkowskiCommon import MinkowskiModuleBase
+from MinkowskiCommon import MinkowskiModuleBase, get_minkowski_function
 from MinkowskiCoordinateManager import CoordinateManager
 from MinkowskiKernelGenerator import KernelGenerator
 
@@ -31,8 +31,6 @@ class MinkowskiDepthwiseConvolutionFunction(Function):
         out_coordinate_map_key: CoordinateMapKey = None,
         coordinate_manager: CoordinateManager = None,
     ):
-        if not input_features.is_cuda:
-            raise NotImplementedError("Not implemented on the CPU")
         if out_coordinate_map_key is None:
             out_coordinate_map_key = CoordinateMapKey(
                 in_coordinate_map_key.get_coordinate_size()
@@ -49,7 +47,8 @@ class MinkowskiDepthwiseConvolutionFunction(Function):
             out_coordinate_map_key,
             coordinate_manager
         ]
-        return _C.DepthwiseConvolutionForwardGPU(
+        fw_fn = get_minkowski_function("DepthwiseConvolutionForward", input_features)
+        return fw_fn(
             ctx.input_features,
             kernel_weights,
             kernel_generator.kernel_size,
@@ -65,8 +64,6 @@ class MinkowskiDepthwiseConvolutionFunction(Function):
 
     @staticmethod
     def backward(ctx, grad_out_feat: torch.Tensor):
-        if not grad_out_feat.is_cuda:
-            raise NotImplementedError("Not implemented on the CPU")
         grad_out_feat = grad_out_feat.contiguous()
         (
             kernel_generator,
@@ -76,7 +73,8 @@ class MinkowskiDepthwiseConvolutionFunction(Function):
             coordinate_manager,
         ) = ctx.misc
 
-        grad_in_feat, grad_kernel =  _C.DepthwiseConvolutionBackwardGPU(
+        bw_fn = get_minkowski_function("DepthwiseConvolutionBackward", grad_out_feat)
+        grad_in_feat, grad_kernel = bw_fn(
             ctx.input_features,
             grad_out_feat,
             ctx.kernel_weights,
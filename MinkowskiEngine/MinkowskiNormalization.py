@@ -204,6 +204,25 @@ class MinkowskiInstanceNormFunction(Function):
         if glob_coords_key is None:
             glob_coords_key = CoordinateMapKey(in_coords_key.get_coordinate_size())
 
+        ctx.use_native = not in_feat.is_cuda
+        if ctx.use_native:
+            # Single pass mean and variance followed by the normalization
+            in_feat = in_feat.contiguous()
+            instance_norm_forward = get_minkowski_function(
+                "InstanceNormForward", in_feat
+            )
+            norm_feat, inv_std = instance_norm_forward(
+                in_feat, 1e-8, in_coords_key, coords_manager._manager
+            )
+            ctx.saved_vars = (
+                in_coords_key,
+                glob_coords_key,
+                coords_manager,
+                gpooling_mode,
+            )
+            ctx.save_for_backward(inv_std, norm_feat)
+            return norm_feat
+
         gpool_avg_forward = get_minkowski_function("GlobalPoolingForward", in_feat)
         broadcast_forward = get_minkowski_function("BroadcastForward", in_feat)
 
@@ -258,6 +277,15 @@ class MinkowskiInstanceNormFunction(Function):
         # To prevent the memory leakage, compute the norm again
         inv_std, norm_feat = ctx.saved_tensors
 
+        if ctx.use_native:
+            instance_norm_backward = get_minkowski_function(
+                "InstanceNormBackward", out_grad
+            )
+            norm_din = instance_norm_backward(
+                out_grad, norm_feat, inv_std, in_coords_key, coords_manager._manager
+            )
+            return norm_din, None, None, None, None
+
         gpool_avg_forward = get_minkowski_function("GlobalPoolingForward", out_grad)
         broadcast_forward = get_minkowski_function("BroadcastForward", out_grad)
 
@@ -308,12 +308,9 @@ def to_sparse(x: torch.Tensor, format: str = None, coordinates=None, device=None
     reduced_x = torch.abs(x).sum(ch_dim)
     bcoords = torch.where(reduced_x != 0)
     stacked_bcoords = torch.stack(bcoords, dim=1).int()
-    indexing = [f"bcoords[{i}]" for i in range(len(bcoords))]
-    indexing.insert(ch_dim, ":")
-    features = torch.zeros(
-        (len(stacked_bcoords), x.size(ch_dim)), dtype=x.dtype, device=x.device
-    )
-    exec("features[:] = x[" + ", ".join(indexing) + "]")
+    # Gather with the channel axis last: x[b, ..., :]
+    permute = [i for i in range(x.ndim) if i != ch_dim] + [ch_dim]
+    features = x.permute(*permute)[bcoords]
     return SparseTensor(features=features, coordinates=stacked_bcoords, device=device)
 
 
@@ -0,0 +1,298 @@
+# Copyright (c) 2020 NVIDIA CORPORATION.
+# Copyright (c) 2018-2020 Chris Choy (chrischoy@ai.stanford.edu).
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+# of the Software, and to permit persons to whom the Software is furnished to do
+# so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# Please cite "4D Spatio-Temporal ConvNets: Minkowski Convolutional Neural
+# Networks", CVPR'19 (https://arxiv.org/abs/1904.08755) if you use any part
+# of the code.
+from typing import Union
+
+import torch
+import torch.nn as nn
+
+from MinkowskiEngineBackend._C import CoordinateMapKey
+from MinkowskiSparseTensor import SparseTensor, _get_coordinate_map_key
+from MinkowskiCommon import MinkowskiModuleBase, get_minkowski_function
+from MinkowskiConvolution import MinkowskiConvolution
+
+INT8_MAX = 127
+
+
+def quantize_int8(x: torch.Tensor, scale):
+    r"""Symmetric int8 quantization `round(x / scale)` clamped to [-127, 127].
+
+    :attr:`scale` is a float or a tensor broadcastable to :attr:`x`.
+    """
+    return torch.clamp(torch.round(x / scale), -INT8_MAX, INT8_MAX).to(torch.int8)
+
+
+def dequantize_int8(x: torch.Tensor, scale):
+    return x.float() * scale
+
+
+def _int8_scale(abs_max):
+    r"""The scale that maps [-abs_max, abs_max] to [-127, 127]."""
+    if isinstance(abs_max, torch.Tensor):
+        return torch.clamp(abs_max.float(), min=1e-8) / INT8_MAX
+    return max(float(abs_max), 1e-8) / INT8_MAX
+
+
+class MinkowskiQuantize(MinkowskiModuleBase):
+    r"""Quantize the features of a sparse tensor to int8 with a fixed scale.
+
+    The output shares the coordinates of the input and can be fed to
+    :attr:`MinkowskiQuantizedConvolution` layers with the same input scale.
+    """
+
+    def __init__(self, scale: float):
+        super(MinkowskiQuantize, self).__init__()
+        self.scale = scale
+
+    def forward(self, input: SparseTensor):
+        return SparseTensor(
+            quantize_int8(input.F, self.scale),
+            coordinate_map_key=input.coordinate_map_key,
+            coordinate_manager=input._manager,
+        )
+
+    def __repr__(self):
+        return self.__class__.__name__ + f"(scale={self.scale})"
+
+
+class MinkowskiDequantize(MinkowskiModuleBase):
+    r"""Convert the int8 features of a sparse tensor back to float."""
+
+    def __init__(self, scale: float):
+        super(MinkowskiDequantize, self).__init__()
+        self.scale = scale
+
+    def forward(self, input: SparseTensor):
+        return SparseTensor(
+            dequantize_int8(input.F, self.scale),
+            coordinate_map_key=input.coordinate_map_key,
+            coordinate_manager=input._manager,
+        )
+
+    def __repr__(self):
+        return self.__class__.__name__ + f"(scale={self.scale})"
+
+
+class MinkowskiQuantizedConvolution(MinkowskiModuleBase):
+    r"""Inference-only int8 convolution on CPU.
+
+    The kernel is quantized symmetrically per output channel and the input
+    features with a single scale. The products are accumulated in int32 and
+    the output is dequantized to float with the bias added. Use
+    :attr:`from_float` to convert a trained :attr:`MinkowskiConvolution`.
+
+    """
+
+    def __init__(
+        self,
+        in_channels,
+        out_channels,
+        kernel_generator,
+        input_scale: float,
+        convolution_mode,
+        dimension,
+    ):
+        super(MinkowskiQuantizedConvolution, self).__init__()
+        self.in_channels = in_channels
+        self.out_channels = out_channels
+        self.kernel_generator = kernel_generator
+        self.input_scale = input_scale
+        self.convolution_mode = convolution_mode
+        self.dimension = dimension
+
+        self.register_buffer(
+            "kernel",
+            torch.zeros(
+                kernel_generator.kernel_volume,
+                in_channels,
+                out_channels,
+                dtype=torch.int8,
+            ),
+        )
+        # input_scale * per output channel kernel scale
+        self.register_buffer("scale", torch.ones(out_channels))
+        self.register_buffer("bias", torch.empty(0))
+
+    @classmethod
+    def from_float(cls, conv: MinkowskiConvolution, input_scale: float):
+        r"""Quantize the kernel of :attr:`conv`.
+
+        Args:
+            :attr:`conv` (`MinkowskiConvolution`): a convolution with a
+            `kernel_volume x in_channels x out_channels` kernel. Transposed
+            convolutions and convolutions that use a matrix multiplication are
+            not supported.
+
+            :attr:`input_scale` (float): the scale of the int8 input features.
+            Use :attr:`calibrate_convolutions` to compute it.
+
+        """
+        assert type(conv) is MinkowskiConvolution and not conv.is_transpose
+        assert not conv.use_mm, "Use a float MinkowskiLinear for 1x1 convolutions."
+        qconv = cls(
+            conv.in_channels,
+            conv.out_channels,
+            conv.kernel_generator,
+            input_scale,
+            conv.convolution_mode,
+            conv.dimension,
+        )
+        with torch.no_grad():
+            kernel = conv.kernel.detach().float().cpu()
+            kernel_scale = _int8_scale(
+                kernel.abs().view(-1, conv.out_channels).max(0)[0]
+            )
+            qconv.kernel.copy_(quantize_int8(kernel, kernel_scale))
+            qconv.scale.copy_(kernel_scale * input_scale)
+            if conv.bias is not None:
+                qconv.bias = conv.bias.detach().float().cpu().view(-1).clone()
+        return qconv
+
+    def forward(
+        self,
+        input: SparseTensor,
+        coordinates: Union[torch.Tensor, CoordinateMapKey, SparseTensor] = None,
+    ):
+        r"""
+        :attr:`input` (`MinkowskiEngine.SparseTensor`): a sparse tensor with
+        int8 features quantized with :attr:`input_scale` or float features
+        which are quantized on the fly.
+
+        """
+        assert isinstance(input, SparseTensor)
+        assert input.D == self.dimension
+        assert not input.F.is_cuda, "The quantized convolution is only supported on CPU."
+
+        in_feat = input.F
+        if in_feat.dtype != torch.int8:
+            in_feat = quantize_int8(in_feat, self.input_scale)
+
+        out_coordinate_map_key = _get_coordinate_map_key(
+            input, coordinates, self.kernel_generator.expand_coordinates
+        )
+        fw_fn = get_minkowski_function("QuantizedConvolutionForward", in_feat)
+        outfeat = fw_fn(
+            in_feat.contiguous(),
+            self.kernel,
+            self.scale,
+            self.bias,
+            self.kernel_generator.kernel_size,
+            self.kernel_generator.kernel_stride,
+            self.kernel_generator.kernel_dilation,
+            self.kernel_generator.region_type,
+            self.kernel_generator.region_offsets,
+            self.kernel_generator.expand_coordinates,
+            self.convolution_mode,
+            input.coordinate_map_key,
+            out_coordinate_map_key,
+            input._manager._manager,
+        )
+        return SparseTensor(
+            outfeat,
+            coordinate_map_key=out_coordinate_map_key,
+            coordinate_manager=input._manager,
+        )
+
+    def __repr__(self):
+        s = "(in={}, out={}, region_type={}, kernel_volume={}, input_scale={})".format(
+            self.in_channels,
+            self.out_channels,
+            self.kernel_generator.region_type,
+            self.kernel_generator.kernel_volume,
+            self.input_scale,
+        )
+        return self.__class__.__name__ + s
+
+
+def _is_quantizable(module):
+    return (
+        type(module) is MinkowskiConvolution
+        and not module.is_transpose
+        and not module.use_mm
+    )
+
+
+def calibrate_convolutions(model: nn.Module, inputs):
+    r"""Run :attr:`model` on the sample :attr:`inputs` and return the
+    maximum absolute input feature of each quantizable convolution.
+
+    Returns:
+        a dictionary from the module name to the maximum absolute value.
+
+    """
+    ranges = {}
+    handles = []
+
+    def hook(name):
+        def _hook(module, args):
+            feats = args[0].F
+            if feats.numel() > 0:
+                abs_max = feats.detach().abs().max().item()
+                ranges[name] = max(ranges.get(name, 0.0), abs_max)
+
+        return _hook
+
+    for name, module in model.named_modules():
+        if _is_quantizable(module):
+            handles.append(module.register_forward_pre_hook(hook(name)))
+
+    training = model.training
+    model.eval()
+    try:
+        with torch.no_grad():
+            for input in inputs:
+                model(input)
+    finally:
+        model.train(training)
+        for handle in handles:
+            handle.remove()
+    return ranges
+
+
+def quantize_convolutions(model: nn.Module, ranges) -> nn.Module:
+    r"""Replace the convolutions in :attr:`ranges` with
+    :attr:`MinkowskiQuantizedConvolution` in place.
+
+    Args:
+        :attr:`ranges` (dict): the maximum absolute input of each convolution
+        returned by :attr:`calibrate_convolutions`.
+
+    Example::
+
+       >>> ranges = ME.calibrate_convolutions(model, calibration_inputs)
+       >>> model = ME.quantize_convolutions(model, ranges)
+
+    """
+    for name, module in list(model.named_modules()):
+        if name not in ranges or not _is_quantizable(module):
+            continue
+        qconv = MinkowskiQuantizedConvolution.from_float(
+            module, _int8_scale(ranges[name])
+        )
+        parent_name, _, child_name = name.rpartition(".")
+        parent = model
+        for child in parent_name.split(".") if parent_name else []:
+            parent = getattr(parent, child)
+        setattr(parent, child_name, qconv)
+    return model
@@ -25,11 +25,13 @@
 import os
 import torch
 import warnings
+from torch.autograd import Function
 
-from MinkowskiCommon import convert_to_int_list, StrideType
+from MinkowskiCommon import convert_to_int_list, StrideType, get_minkowski_function
 from MinkowskiEngineBackend._C import (
     CoordinateMapKey,
     CoordinateMapType,
+    CoordinateOrdering,
     GPUMemoryAllocatorType,
     MinkowskiAlgorithm,
 )
@@ -45,6 +47,62 @@ from MinkowskiCoordinateManager import CoordinateManager
 from sparse_matrix_functions import MinkowskiSPMMFunction, MinkowskiSPMMAverageFunction
 
 
+class MinkowskiDenseFunction(Function):
+    r"""Scatters the features of a sparse tensor to a dense tensor. The
+    backward gathers the gradients from the dense gradient."""
+
+    @staticmethod
+    def forward(
+        ctx,
+        in_feat: torch.Tensor,
+        shape: list,
+        min_coordinate: list,
+        contract_stride: bool,
+        channels_last: bool,
+        in_coordinate_map_key: CoordinateMapKey,
+        coordinate_manager: CoordinateManager,
+    ):
+        fw_fn = get_minkowski_function("SparseToDense", in_feat)
+        dense, min_coordinate = fw_fn(
+            in_feat.contiguous(),
+            shape,
+            min_coordinate,
+            contract_stride,
+            channels_last,
+            in_coordinate_map_key,
+            coordinate_manager._manager,
+        )
+        ctx.inputs = (
+            min_coordinate.tolist(),
+            contract_stride,
+            channels_last,
+            in_coordinate_map_key,
+            coordinate_manager,
+        )
+        ctx.mark_non_differentiable(min_coordinate)
+        return dense, min_coordinate
+
+    @staticmethod
+    def backward(ctx, grad_dense: torch.Tensor, grad_min_coordinate=None):
+        (
+            min_coordinate,
+            contract_stride,
+            channels_last,
+            in_coordinate_map_key,
+            coordinate_manager,
+        ) = ctx.inputs
+        bw_fn = get_minkowski_function("DenseToSparse", grad_dense)
+        grad_in_feat = bw_fn(
+            grad_dense.contiguous(),
+            min_coordinate,
+            contract_stride,
+            channels_last,
+            in_coordinate_map_key,
+            coordinate_manager._manager,
+        )
+        return grad_in_feat, None, None, None, None, None, None
+
+
 class SparseTensor(Tensor):
     r"""A sparse tensor class. Can be accessed via
     :attr:`MinkowskiEngine.SparseTensor`.
@@ -179,7 +237,11 @@ class SparseTensor(Tensor):
             :attr:`MinkowskiAlgorithm.MEMORY_EFFICIENT` if you want to reduce
             the memory footprint. Or use
             :attr:`MinkowskiAlgorithm.SPEED_OPTIMIZED` if you want to make it
-            run fasterat the cost of more memory.
+            run fasterat the cost of more memory. On CPU, the memory
+            efficient mode compacts the hash tables and the kernel maps and
+            does not cache the pooling stride maps while the speed optimized
+            mode keeps the hash tables at 40% occupancy and sorts the kernel
+            maps by the input row.
 
             :attr:`requires_grad` (:attr:`bool`): Set the requires_grad flag.
 
@@ -285,6 +347,7 @@ class SparseTensor(Tensor):
         self._C = coordinates
         self.coordinate_map_key = coordinate_map_key
         self._batch_rows = None
+        self._sorted_batch_rows = None
 
     @property
     def coordinate_key(self):
@@ -338,6 +401,9 @@ class SparseTensor(Tensor):
             features = spmm_avg.apply(self.inverse_mapping, cols, size, features)
         elif self.quantization_mode == SparseTensorQuantizationMode.RANDOM_SUBSAMPLE:
             features = features[self.unique_index]
+        elif self._manager.coordinate_ordering != CoordinateOrdering.INSERTION:
+            # No quantization. The unique coordinates are reordered.
+            features = features[self.unique_index]
         else:
             # No quantization
             pass
@@ -457,7 +523,9 @@ class SparseTensor(Tensor):
         tensor_stride = torch.IntTensor(self.tensor_stride)
         return sparse_tensor, min_coords, tensor_stride
 
-    def dense(self, shape=None, min_coordinate=None, contract_stride=True):
+    def dense(
+        self, shape=None, min_coordinate=None, contract_stride=True, channels_last=False
+    ):
         r"""Convert the :attr:`MinkowskiEngine.SparseTensor` to a torch dense
         tensor.
 
@@ -472,6 +540,9 @@ class SparseTensor(Tensor):
             will be divided by the tensor stride to make features spatially
             contiguous. True by default.
 
+            :attr:`channels_last` (bool, optional): return a `[Batch Dim,
+            Spatial Dim..., Spatial Dim, Feature Dim]` tensor. False by default.
+
         Returns:
             :attr:`tensor` (torch.Tensor): the torch tensor with size `[Batch
             Dim, Feature Dim, Spatial Dim..., Spatial Dim]`. The coordinate of
@@ -503,6 +574,31 @@ class SparseTensor(Tensor):
                 self.tensor_stride,
             )
 
+        if not self.F.is_cuda and self.dtype in (torch.float32, torch.float64):
+            # Native scatter over the coordinate map
+            if min_coordinate is None:
+                min_coordinate_list = []
+            elif isinstance(min_coordinate, int) and min_coordinate == 0:
+                min_coordinate_list = [0] * self._D
+            else:
+                min_coordinate_list = min_coordinate.view(-1).tolist()
+            dense_F, native_min_coordinate = MinkowskiDenseFunction.apply(
+                self.F,
+                [] if shape is None else [shape[0], *shape[2:]],
+                min_coordinate_list,
+                contract_stride,
+                channels_last,
+                self.coordinate_map_key,
+                self.coordinate_manager,
+            )
+            if min_coordinate is None:
+                # The absolute coordinates are indexed. Return the minimum
+                # coordinate as the fallback below does.
+                min_coordinate = self.C[:, 1:].min(0, keepdim=True)[0]
+            elif not (isinstance(min_coordinate, int) and min_coordinate == 0):
+                min_coordinate = native_min_coordinate.unsqueeze(0)
+            return dense_F, min_coordinate, torch.IntTensor(self.tensor_stride)
+
         # Use int tensor for all operations
         tensor_stride = torch.IntTensor(self.tensor_stride).to(self.device)
 
@@ -552,6 +648,8 @@ class SparseTensor(Tensor):
             + ", ".join([f"tcoords[{i}]" for i in range(len(tcoords))])
             + "] = self.F"
         )
+        if channels_last:
+            dense_F = dense_F.permute(0, *range(2, self._D + 2), 1).contiguous()
 
         tensor_stride = torch.IntTensor(self.tensor_stride)
         return dense_F, min_coordinate, tensor_stride
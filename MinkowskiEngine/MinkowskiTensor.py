@@ -27,7 +27,7 @@ import torch
 import copy
 from enum import Enum
 
-from MinkowskiEngineBackend._C import CoordinateMapKey
+from MinkowskiEngineBackend._C import CoordinateMapKey, CoordinateMapType
 
 
 class SparseTensorOperationMode(Enum):
@@ -276,7 +276,16 @@ class Tensor:
     @property
     def _batchwise_row_indices(self):
         if self._batch_rows is None:
-            _, self._batch_rows = self._manager.origin_map(self.coordinate_map_key)
+            if self._manager.coordinate_map_type == CoordinateMapType.CPU:
+                # The batch segment index of the map has sorted rows
+                self._batch_rows = self._manager.batch_row_indices(
+                    self.coordinate_map_key
+                )
+                self._sorted_batch_rows = self._batch_rows
+            else:
+                _, self._batch_rows = self._manager.origin_map(
+                    self.coordinate_map_key
+                )
         return self._batch_rows
 
     @property
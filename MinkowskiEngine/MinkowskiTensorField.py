@@ -134,7 +134,11 @@ class TensorField(Tensor):
             :attr:`MinkowskiAlgorithm.MEMORY_EFFICIENT` if you want to reduce
             the memory footprint. Or use
             :attr:`MinkowskiAlgorithm.SPEED_OPTIMIZED` if you want to make it
-            run fasterat the cost of more memory.
+            run fasterat the cost of more memory. On CPU, the memory
+            efficient mode compacts the hash tables and the kernel maps and
+            does not cache the pooling stride maps while the speed optimized
+            mode keeps the hash tables at 40% occupancy and sorts the kernel
+            maps by the input row.
 
             :attr:`requires_grad` (:attr:`bool`): Set the requires_grad flag.
 
@@ -245,6 +249,7 @@ class TensorField(Tensor):
         self._C = coordinates
         self.coordinate_field_map_key = coordinate_field_map_key
         self._batch_rows = None
+        self._sorted_batch_rows = None
         self._inverse_mapping = {}
         self._splat = {}
 
@@ -55,9 +55,11 @@ from MinkowskiEngineBackend._C import (
     CoordinateMapKey,
     GPUMemoryAllocatorType,
     CoordinateMapType,
+    CoordinateOrdering,
     RegionType,
     PoolingMode,
     BroadcastMode,
+    ActivationType,
     is_cuda_available,
     cuda_version,
     cudart_version,
@@ -93,6 +95,7 @@ from MinkowskiCommon import (
 from MinkowskiCoordinateManager import (
     set_memory_manager_backend,
     set_gpu_allocator,
+    set_coordinate_ordering,
     CoordsManager,
     CoordinateManager,
 )
@@ -100,11 +103,22 @@ from MinkowskiCoordinateManager import (
 from MinkowskiConvolution import (
     MinkowskiConvolutionFunction,
     MinkowskiConvolution,
+    MinkowskiMultiTensorConvolutionFunction,
+    MinkowskiConvolutionBiasActivationFunction,
+    MinkowskiFusedConvolution,
     MinkowskiConvolutionTransposeFunction,
     MinkowskiConvolutionTranspose,
     MinkowskiGenerativeConvolutionTranspose,
 )
 
+from MinkowskiQuantizedConvolution import (
+    MinkowskiQuantize,
+    MinkowskiDequantize,
+    MinkowskiQuantizedConvolution,
+    calibrate_convolutions,
+    quantize_convolutions,
+)
+
 from MinkowskiDepthwiseConvolution import MinkowskiDepthwiseConvolution
 from MinkowskiChannelwiseConvolution import MinkowskiChannelwiseConvolution
 
@@ -23,6 +23,20 @@
 # of the code.
 from .quantization import sparse_quantize, ravel_hash_vec, fnv_hash_vec, unique_coordinate_map
 from .collation import SparseCollation, batched_coordinates, sparse_collate, batch_sparse_collate
+from .dataset import SparseDataset, SparseDatasetWriter
 # from .coords import get_coords_map
 from .init import kaiming_normal_
-from .summary import summary
\ No newline at end of file
+from .summary import summary
+from .inference import optimize_for_inference, verify_inference_model
+from .profiler import (
+    profile,
+    record,
+    enable_profiling,
+    disable_profiling,
+    is_profiling_enabled,
+    clear_profile,
+    profile_events,
+    profile_summary,
+    profile_table,
+    export_chrome_trace,
+)
\ No newline at end of file
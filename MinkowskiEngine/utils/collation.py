@@ -26,6 +26,47 @@ import torch
 import logging
 import collections.abc
 
+import MinkowskiEngineBackend._C as MEB
+
+_NATIVE_COORDINATE_TYPES = (torch.int32, torch.int64, torch.float32, torch.float64)
+
+
+def _to_cpu_tensors(arrays):
+    r"""Returns the arrays as CPU tensors without a copy, or `None` if any of
+    them cannot be collated by the native collation."""
+    tensors = []
+    for array in arrays:
+        if isinstance(array, np.ndarray):
+            array = torch.from_numpy(array)
+        if not isinstance(array, torch.Tensor) or array.is_cuda or array.ndim == 0:
+            return None
+        tensors.append(array)
+    return tensors
+
+
+def _native_collate(coords, feats, labels, quantize, ignore_label):
+    r"""Collates the samples with a single native pass. Returns `None` if the
+    inputs are not supported."""
+    coords = _to_cpu_tensors(coords)
+    if coords is None or not all(
+        c.ndim == 2 and c.dtype in _NATIVE_COORDINATE_TYPES for c in coords
+    ):
+        return None
+    feats = _to_cpu_tensors(feats)
+    if feats is None:
+        return None
+    labels = _to_cpu_tensors(labels)
+    if labels is None or not all(
+        len(label) == len(c) for label, c in zip(labels, coords)
+    ):
+        return None
+    if quantize and not all(
+        label.ndim == 1 and label.dtype in (torch.int32, torch.int64)
+        for label in labels
+    ):
+        return None
+    return MEB.sparse_collate_cpu(coords, feats, labels, quantize, ignore_label)
+
 
 def batched_coordinates(coords, dtype=torch.int32, device=None):
     r"""Create a `ME.SparseTensor` coordinates from a sequence of coordinates
@@ -66,6 +107,11 @@ def batched_coordinates(coords, dtype=torch.int32, device=None):
         torch.float32,
     ], "Only torch.int32, torch.float32 supported for coordinates."
 
+    if dtype == torch.int32:
+        outputs = _native_collate(coords, [], [], False, 0)
+        if outputs is not None:
+            return outputs[0].to(device)
+
     # Create a batched coordinates
     N = np.array([len(cs) for cs in coords]).sum()
     bcoords = torch.zeros((N, D + 1), dtype=dtype, device=device)  # uninitialized
@@ -93,7 +139,15 @@ def batched_coordinates(coords, dtype=torch.int32, device=None):
     return bcoords
 
 
-def sparse_collate(coords, feats, labels=None, dtype=torch.int32, device=None):
+def sparse_collate(
+    coords,
+    feats,
+    labels=None,
+    dtype=torch.int32,
+    device=None,
+    quantize=False,
+    ignore_label=-100,
+):
     r"""Create input arguments for a sparse tensor `the documentation
     <https://nvidia.github.io/MinkowskiEngine/sparse_tensor.html>`_.
 
@@ -108,6 +162,18 @@ def sparse_collate(coords, feats, labels=None, dtype=torch.int32, device=None):
         :attr:`labels` (set of `torch.Tensor` or `numpy.ndarray`): a set of labels
         associated to the inputs.
 
+        :attr:`quantize` (bool, optional): remove duplicate coordinates of each
+        sample. The label of a coordinate is set to :attr:`ignore_label` if
+        the duplicate points have different labels.
+
+        :attr:`ignore_label` (int, optional): the label of the quantized
+        coordinates with conflicting labels.
+
+    .. note::
+
+       Integer coordinates of CPU tensors or numpy arrays are batched with a
+       single native pass that writes directly to the batched tensors.
+
     """
     use_label = False if labels is None else True
     feats_batch, labels_batch = [], []
@@ -139,6 +205,37 @@ def sparse_collate(coords, feats, labels=None, dtype=torch.int32, device=None):
     Nf = np.array([len(fs) for fs in feats]).sum()
     assert N == Nf, f"Coordinate length {N} != Feature length {Nf}"
 
+    if dtype == torch.int32:
+        outputs = _native_collate(
+            coords, feats, labels if use_label else [], quantize, ignore_label
+        )
+        if outputs is not None:
+            # The labels are None without labels
+            bcoords, feats_batch, labels_batch = [
+                None if o is None else o.to(device) for o in outputs
+            ]
+            if use_label:
+                return bcoords, feats_batch, labels_batch
+            return bcoords, feats_batch
+
+    if quantize:
+        from .quantization import sparse_quantize
+
+        quantized = [
+            sparse_quantize(
+                coord,
+                feat,
+                labels[i] if use_label else None,
+                ignore_label=ignore_label,
+            )
+            for i, (coord, feat) in enumerate(zip(coords, feats))
+        ]
+        coords = [q[0] for q in quantized]
+        feats = [q[1] for q in quantized]
+        if use_label:
+            labels = [q[2] for q in quantized]
+        N = np.array([len(cs) for cs in coords]).sum()
+
     batch_id = 0
     s = 0  # start index
     bcoords = torch.zeros((N, D + 1), dtype=dtype, device=device)  # uninitialized
@@ -188,7 +285,9 @@ def sparse_collate(coords, feats, labels=None, dtype=torch.int32, device=None):
         return bcoords, feats_batch
 
 
-def batch_sparse_collate(data, dtype=torch.int32, device=None):
+def batch_sparse_collate(
+    data, dtype=torch.int32, device=None, quantize=False, ignore_label=-100
+):
     r"""The wrapper function that can be used in in conjunction with
     `torch.utils.data.DataLoader` to generate inputs for a sparse tensor.
 
@@ -200,7 +299,13 @@ def batch_sparse_collate(data, dtype=torch.int32, device=None):
         :attr:`data`: list of (coordinates, features, labels) tuples.
 
     """
-    return sparse_collate(*list(zip(*data)), dtype=dtype, device=device)
+    return sparse_collate(
+        *list(zip(*data)),
+        dtype=dtype,
+        device=device,
+        quantize=quantize,
+        ignore_label=ignore_label,
+    )
 
 
 class SparseCollation:
@@ -0,0 +1,281 @@
+# Copyright (c) 2020 NVIDIA CORPORATION.
+# Copyright (c) 2018-2020 Chris Choy (chrischoy@ai.stanford.edu).
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+# of the Software, and to permit persons to whom the Software is furnished to do
+# so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# Please cite "4D Spatio-Temporal ConvNets: Minkowski Convolutional Neural
+# Networks", CVPR'19 (https://arxiv.org/abs/1904.08755) if you use any part
+# of the code.
+import os
+import json
+
+import numpy as np
+import torch
+
+import MinkowskiEngineBackend._C as MEB
+from .quantization import sparse_quantize
+
+_FORMAT_VERSION = 1
+_META_FILE = "meta.json"
+
+
+def _to_numpy(array):
+    if array is None or isinstance(array, np.ndarray):
+        return array
+    assert isinstance(
+        array, torch.Tensor
+    ), "Input must be either np.ndarray or torch.Tensor."
+    return array.cpu().numpy()
+
+
+class SparseDatasetWriter:
+    r"""Writes pre-quantized sparse samples to a memory-mappable columnar
+    directory that can be read with :attr:`SparseDataset`.
+
+    Each column (coordinates, features, labels, and optionally the unique and
+    inverse maps) is appended to a separate raw binary file. Row offsets of
+    each sample and the dtype and shape of each column are stored in
+    `meta.json`.
+
+    Args:
+        :attr:`path` (str): the output directory.
+
+        :attr:`quantization_size` (float, list, or numpy.ndarray, optional):
+        the quantization size passed to :attr:`sparse_quantize`. If `None`,
+        the coordinates are floored.
+
+        :attr:`ignore_label` (int, optional): the ignore label passed to
+        :attr:`sparse_quantize`.
+
+        :attr:`save_maps` (bool, optional): save the unique map and the inverse
+        map of each sample to recover the original points.
+
+    Example::
+
+       >>> with SparseDatasetWriter("train_quantized", quantization_size=0.02) as writer:
+       >>>     for coordinates, features, labels in raw_dataset:
+       >>>         writer.append(coordinates, features, labels)
+
+    """
+
+    def __init__(
+        self, path, quantization_size=None, ignore_label=-100, save_maps=False
+    ):
+        os.makedirs(path, exist_ok=True)
+        self.path = path
+        self.quantization_size = quantization_size
+        self.ignore_label = ignore_label
+        self.save_maps = save_maps
+        self.offsets = [0]
+        self.inverse_offsets = [0]
+        self.columns = {}
+        self._files = {}
+        self.dimension = None
+
+    def _write(self, name, array):
+        array = np.ascontiguousarray(array)
+        if name not in self.columns:
+            self.columns[name] = {
+                "dtype": array.dtype.str,
+                "shape": [0] + list(array.shape[1:]),
+            }
+            self._files[name] = open(os.path.join(self.path, name + ".bin"), "wb")
+        column = self.columns[name]
+        assert (
+            array.dtype.str == column["dtype"]
+        ), f"{name} dtype mismatch: {array.dtype.str} != {column['dtype']}"
+        assert (
+            list(array.shape[1:]) == column["shape"][1:]
+        ), f"{name} shape mismatch: {array.shape[1:]} != {column['shape'][1:]}"
+        self._files[name].write(array.tobytes())
+        column["shape"][0] += len(array)
+
+    def append(self, coordinates, features, labels=None):
+        r"""Quantize and append a sample."""
+        coordinates, features, labels = (
+            _to_numpy(coordinates),
+            _to_numpy(features),
+            _to_numpy(labels),
+        )
+        if self.dimension is None:
+            self.dimension = coordinates.shape[1]
+        assert (
+            coordinates.shape[1] == self.dimension
+        ), f"Dimension mismatch: {coordinates.shape[1]} != {self.dimension}"
+        use_label = labels is not None
+        if use_label:
+            labels = labels.astype(np.int32)
+        if len(self.offsets) > 1:
+            assert use_label == (
+                "labels" in self.columns
+            ), "All samples must either have labels or not."
+
+        outputs = sparse_quantize(
+            coordinates,
+            features,
+            labels,
+            ignore_label=self.ignore_label,
+            return_index=True,
+            return_inverse=self.save_maps,
+            quantization_size=self.quantization_size,
+        )
+        outputs = [_to_numpy(o) for o in outputs]
+        self._write("coordinates", outputs[0].astype(np.int32))
+        self._write("features", outputs[1])
+        if use_label:
+            self._write("labels", outputs[2])
+        if self.save_maps:
+            self._write("unique_map", outputs[-2].astype(np.int64))
+            self._write("inverse_map", outputs[-1].astype(np.int64))
+            self.inverse_offsets.append(
+                self.inverse_offsets[-1] + len(outputs[-1])
+            )
+        self.offsets.append(self.offsets[-1] + len(outputs[0]))
+
+    def close(self):
+        for f in self._files.values():
+            f.close()
+        self._files = {}
+        meta = {
+            "version": _FORMAT_VERSION,
+            "dimension": self.dimension,
+            "num_samples": len(self.offsets) - 1,
+            "quantization_size": np.asarray(self.quantization_size).tolist()
+            if self.quantization_size is not None
+            else None,
+            "columns": self.columns,
+        }
+        np.asarray(self.offsets, dtype=np.int64).tofile(
+            os.path.join(self.path, "offsets.bin")
+        )
+        if self.save_maps:
+            np.asarray(self.inverse_offsets, dtype=np.int64).tofile(
+                os.path.join(self.path, "inverse_offsets.bin")
+            )
+        with open(os.path.join(self.path, _META_FILE), "w") as f:
+            json.dump(meta, f, indent=2)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+
+class SparseDataset(torch.utils.data.Dataset):
+    r"""A memory-mapped dataset of pre-quantized sparse samples written with
+    :attr:`SparseDatasetWriter`.
+
+    :attr:`__getitem__` returns zero-copy tensors backed by the memory-mapped
+    files. The files are mapped copy-on-write, so in-place updates on the
+    returned tensors never modify the dataset.
+
+    :attr:`collate` copies the memory-mapped samples directly into the batched
+    coordinate and feature tensors with a single native pass.
+
+    Example::
+
+       >>> dataset = SparseDataset("train_quantized")
+       >>> coordinates, features, labels = dataset[0]
+       >>> # Load batches by index to skip the per-sample collation
+       >>> data_loader = torch.utils.data.DataLoader(
+       >>>     range(len(dataset)), batch_size=16, shuffle=True,
+       >>>     collate_fn=dataset.collate)
+       >>> for bcoords, bfeats, blabels in data_loader:
+       >>>     sinput = ME.SparseTensor(bfeats, bcoords)
+
+    """
+
+    def __init__(self, path):
+        with open(os.path.join(path, _META_FILE), "r") as f:
+            meta = json.load(f)
+        assert (
+            meta["version"] == _FORMAT_VERSION
+        ), f"Unsupported dataset version {meta['version']}"
+        self.path = path
+        self.dimension = meta["dimension"]
+        self.quantization_size = meta["quantization_size"]
+        self._meta = meta
+        self._columns = {
+            name: self._memmap(name + ".bin", column["dtype"], column["shape"])
+            for name, column in meta["columns"].items()
+        }
+        num_samples = meta["num_samples"]
+        self._offsets = self._memmap("offsets.bin", "<i8", [num_samples + 1])
+        self._inverse_offsets = None
+        if "inverse_map" in self._columns:
+            self._inverse_offsets = self._memmap(
+                "inverse_offsets.bin", "<i8", [num_samples + 1]
+            )
+
+    def _memmap(self, filename, dtype, shape):
+        if shape[0] == 0:
+            return np.empty(shape, dtype=dtype)
+        return np.memmap(
+            os.path.join(self.path, filename), dtype=dtype, mode="c", shape=tuple(shape)
+        )
+
+    @property
+    def has_labels(self):
+        return "labels" in self._columns
+
+    @property
+    def has_maps(self):
+        return "inverse_map" in self._columns
+
+    def __len__(self):
+        return len(self._offsets) - 1
+
+    def __getitem__(self, index):
+        begin, end = self._offsets[index], self._offsets[index + 1]
+        outputs = [
+            torch.from_numpy(self._columns["coordinates"][begin:end]),
+            torch.from_numpy(self._columns["features"][begin:end]),
+        ]
+        if self.has_labels:
+            outputs.append(torch.from_numpy(self._columns["labels"][begin:end]))
+        return tuple(outputs)
+
+    def maps(self, index):
+        r"""Returns the (unique_map, inverse_map) of the sample. The maps index
+        the original points of the sample given to the writer."""
+        assert self.has_maps, "The dataset was written without save_maps=True."
+        begin, end = self._offsets[index], self._offsets[index + 1]
+        ibegin, iend = self._inverse_offsets[index], self._inverse_offsets[index + 1]
+        return (
+            torch.from_numpy(self._columns["unique_map"][begin:end]),
+            torch.from_numpy(self._columns["inverse_map"][ibegin:iend]),
+        )
+
+    def collate(self, indices):
+        r"""Returns batched coordinates, features, and optionally labels of the
+        samples in :attr:`indices`. The batch index is prepended to the
+        coordinates."""
+        indices = [int(i) for i in indices]
+        samples = [self[i] for i in indices]
+        bcoords, bfeats, blabels = MEB.sparse_collate_cpu(
+            [s[0] for s in samples],
+            [s[1] for s in samples],
+            [s[2] for s in samples] if self.has_labels else [],
+            False,
+            0,
+        )
+        if self.has_labels:
+            return bcoords, bfeats, blabels
+        return bcoords, bfeats
@@ -0,0 +1,306 @@
+# Copyright (c) 2020 NVIDIA CORPORATION.
+# Copyright (c) 2018-2020 Chris Choy (chrischoy@ai.stanford.edu).
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+# of the Software, and to permit persons to whom the Software is furnished to do
+# so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# Please cite "4D Spatio-Temporal ConvNets: Minkowski Convolutional Neural
+# Networks", CVPR'19 (https://arxiv.org/abs/1904.08755) if you use any part
+# of the code.
+import copy
+from collections import OrderedDict
+
+import torch
+import torch.nn as nn
+from torch.nn import Parameter
+
+from MinkowskiEngineBackend._C import ActivationType
+from MinkowskiConvolution import (
+    MinkowskiConvolutionBase,
+    MinkowskiConvolution,
+    MinkowskiFusedConvolution,
+)
+from MinkowskiNormalization import MinkowskiBatchNorm
+from MinkowskiNonlinearity import (
+    MinkowskiReLU,
+    MinkowskiLeakyReLU,
+    MinkowskiGELU,
+    MinkowskiDropout,
+    MinkowskiAlphaDropout,
+)
+from MinkowskiOps import MinkowskiLinear
+
+
+def _batch_norm_affine(bn):
+    r"""Returns the per-channel (scale, shift) of an inference-mode batch
+    norm."""
+    bn = bn.bn
+    with torch.no_grad():
+        scale = torch.rsqrt(bn.running_var + bn.eps)
+        shift = -bn.running_mean * scale
+        if bn.weight is not None:
+            scale = scale * bn.weight
+            shift = shift * bn.weight + bn.bias
+    return scale, shift
+
+
+def _is_foldable_batch_norm(module):
+    return (
+        isinstance(module, MinkowskiBatchNorm)
+        and module.bn.running_mean is not None
+        and module.bn.running_var is not None
+    )
+
+
+def _is_affine_layer(module):
+    if isinstance(module, MinkowskiFusedConvolution):
+        return module.activation == ActivationType.IDENTITY
+    return isinstance(module, (MinkowskiConvolutionBase, MinkowskiLinear))
+
+
+def _set_bias(module, bias):
+    module.bias = Parameter(bias.view(1, -1) if module.bias is None else bias)
+
+
+def _fold_output_affine(module, scale, shift):
+    r"""Fold `y * scale + shift` into the output of a convolution or a
+    linear layer."""
+    with torch.no_grad():
+        if isinstance(module, MinkowskiLinear):
+            linear = module.linear
+            linear.weight.mul_(scale.view(-1, 1))
+            bias = shift if linear.bias is None else linear.bias * scale + shift
+            linear.bias = Parameter(bias)
+        else:
+            # The last dimension of the kernel is the output channel
+            module.kernel.mul_(scale)
+            bias = shift if module.bias is None else module.bias * scale + shift
+            _set_bias(module, bias)
+
+
+def _fold_input_affine(linear, scale, shift):
+    r"""Fold `x * scale + shift` into the input of a linear layer."""
+    linear = linear.linear
+    with torch.no_grad():
+        bias = linear.weight.mv(shift)
+        if linear.bias is not None:
+            bias += linear.bias
+        linear.weight.mul_(scale.view(1, -1))
+        linear.bias = Parameter(bias)
+
+
+def _fold_linear(module, linear):
+    r"""Fold a linear layer into the output of a convolution or a linear
+    layer."""
+    weight, bias = linear.linear.weight, linear.linear.bias
+    with torch.no_grad():
+        if isinstance(module, MinkowskiLinear):
+            prev = module.linear
+            new_bias = None
+            if prev.bias is not None:
+                new_bias = weight.mv(prev.bias)
+            if bias is not None:
+                new_bias = bias.clone() if new_bias is None else new_bias + bias
+            prev.weight = Parameter(weight.mm(prev.weight))
+            prev.bias = None if new_bias is None else Parameter(new_bias)
+            prev.out_features = weight.shape[0]
+        else:
+            new_bias = None
+            if module.bias is not None:
+                new_bias = module.bias.matmul(weight.t())
+            if bias is not None:
+                new_bias = (
+                    bias.view(1, -1).clone() if new_bias is None else new_bias + bias
+                )
+            module.kernel = Parameter(module.kernel.matmul(weight.t()))
+            module.bias = None if new_bias is None else Parameter(new_bias)
+            module.out_channels = weight.shape[0]
+    return module
+
+
+def _fused_activation(module):
+    r"""Returns the (activation, negative_slope) of an activation that
+    :attr:`MinkowskiFusedConvolution` supports or `None`."""
+    if isinstance(module, MinkowskiReLU):
+        return ActivationType.RELU, 0.0
+    elif isinstance(module, MinkowskiLeakyReLU):
+        if module.module.negative_slope >= 0:
+            return ActivationType.LEAKY_RELU, module.module.negative_slope
+    elif isinstance(module, MinkowskiGELU):
+        if getattr(module.module, "approximate", "none") == "none":
+            return ActivationType.GELU, 0.0
+    return None
+
+
+def _fuse_activation(conv, activation, negative_slope):
+    fused = MinkowskiFusedConvolution(
+        conv.in_channels,
+        conv.out_channels,
+        bias=conv.bias is not None,
+        activation=activation,
+        negative_slope=negative_slope,
+        kernel_generator=conv.kernel_generator,
+        expand_coordinates=conv.kernel_generator.expand_coordinates,
+        convolution_mode=conv.convolution_mode,
+        dimension=conv.dimension,
+    )
+    fused.kernel = conv.kernel
+    fused.bias = conv.bias
+    return fused
+
+
+def _fuse_sequence(named_modules):
+    r"""Fuse the adjacent layers of a sequential container."""
+    fused = []
+    for name, module in named_modules:
+        # Identity in inference
+        if isinstance(module, (MinkowskiDropout, MinkowskiAlphaDropout)):
+            continue
+
+        prev = fused[-1][1] if len(fused) > 0 else None
+        if _is_foldable_batch_norm(module) and _is_affine_layer(prev):
+            _fold_output_affine(prev, *_batch_norm_affine(module))
+            continue
+        elif isinstance(module, MinkowskiLinear):
+            if _is_affine_layer(prev):
+                _fold_linear(prev, module)
+                continue
+            elif _is_foldable_batch_norm(prev):
+                _fold_input_affine(module, *_batch_norm_affine(prev))
+                fused[-1] = (name, module)
+                continue
+        elif type(prev) is MinkowskiConvolution and not prev.is_transpose:
+            activation = _fused_activation(module)
+            if activation is not None:
+                fused[-1] = (fused[-1][0], _fuse_activation(prev, *activation))
+                continue
+        fused.append((name, module))
+    return fused
+
+
+def _optimize(module):
+    for name, child in list(module.named_children()):
+        setattr(module, name, _optimize(child))
+    # Containers derived from nn.Sequential such as MinkowskiStackCat do not
+    # chain their children.
+    if type(module) is nn.Sequential:
+        return nn.Sequential(OrderedDict(_fuse_sequence(module.named_children())))
+    return module
+
+
+def _output_features(output):
+    if isinstance(output, (list, tuple)):
+        return [f for o in output for f in _output_features(o)]
+    elif isinstance(output, torch.Tensor):
+        return [(output, None)]
+    return [(output.F, output.C)]
+
+
+def verify_inference_model(
+    model: nn.Module, optimized: nn.Module, input, rtol=1e-4, atol=1e-5
+):
+    r"""Compare the inference outputs of :attr:`model` and :attr:`optimized`
+    on :attr:`input` and raise an `AssertionError` if they differ.
+
+    Both models run on the same input and thus share the kernel maps cached
+    in the coordinate manager of :attr:`input`.
+
+    Returns:
+        the maximum absolute difference of the output features.
+
+    """
+    training = model.training
+    model.eval()
+    try:
+        with torch.no_grad():
+            outputs = _output_features(model(input))
+            optimized_outputs = _output_features(optimized(input))
+    finally:
+        model.train(training)
+
+    assert len(outputs) == len(
+        optimized_outputs
+    ), f"Number of outputs mismatch: {len(outputs)} != {len(optimized_outputs)}"
+    max_diff = 0.0
+    for (feats, coords), (optimized_feats, optimized_coords) in zip(
+        outputs, optimized_outputs
+    ):
+        if coords is not None:
+            assert torch.equal(
+                coords, optimized_coords
+            ), "Output coordinates of the optimized model mismatch"
+        assert (
+            feats.shape == optimized_feats.shape
+        ), f"Output shape mismatch: {feats.shape} != {optimized_feats.shape}"
+        if feats.numel() > 0:
+            max_diff = max(max_diff, (feats - optimized_feats).abs().max().item())
+        assert torch.allclose(
+            feats, optimized_feats, rtol=rtol, atol=atol
+        ), f"Output features of the optimized model mismatch. max abs diff={max_diff}"
+    return max_diff
+
+
+def optimize_for_inference(
+    model: nn.Module, verify_input=None, rtol=1e-4, atol=1e-5
+) -> nn.Module:
+    r"""Returns an inference-mode copy of :attr:`model` with the adjacent
+    layers of each `nn.Sequential` fused.
+
+    - `MinkowskiBatchNorm` following a convolution or `MinkowskiLinear` is
+      folded into the kernel and the bias.
+    - `MinkowskiBatchNorm` preceding `MinkowskiLinear` is folded into the
+      linear layer.
+    - `MinkowskiLinear` following a convolution or `MinkowskiLinear` is folded
+      into the kernel and the bias.
+    - `MinkowskiReLU`, `MinkowskiLeakyReLU`, and `MinkowskiGELU` following
+      `MinkowskiConvolution` are fused into `MinkowskiFusedConvolution`.
+    - `MinkowskiDropout` and `MinkowskiAlphaDropout` are removed.
+
+    The layers of a module with a custom :attr:`forward` are optimized
+    recursively, but are not fused with each other since their order of
+    execution is unknown. The optimized convolutions keep their kernel
+    generators, so the optimized model generates the same coordinates and
+    reuses the kernel maps cached in the coordinate manager of its input.
+
+    Args:
+        :attr:`model` (`nn.Module`): the model to optimize. The model is not
+        modified.
+
+        :attr:`verify_input` (`SparseTensor`, optional): if provided, compare
+        the outputs of :attr:`model` and the optimized model on the input with
+        :attr:`verify_inference_model`.
+
+        :attr:`rtol`, :attr:`atol` (float, optional): the tolerances of the
+        verification.
+
+    Example::
+
+       >>> model = ME.utils.optimize_for_inference(model, verify_input=sinput)
+       >>> with torch.no_grad():
+       >>>     soutput = model(sinput)
+
+    """
+    optimized = copy.deepcopy(model)
+    optimized.eval()
+    optimized = _optimize(optimized)
+    for param in optimized.parameters():
+        param.requires_grad_(False)
+
+    if verify_input is not None:
+        verify_inference_model(model, optimized, verify_input, rtol, atol)
+    return optimized
@@ -0,0 +1,306 @@
+# Copyright (c) 2020 NVIDIA CORPORATION.
+# Copyright (c) 2018-2020 Chris Choy (chrischoy@ai.stanford.edu).
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+# of the Software, and to permit persons to whom the Software is furnished to do
+# so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# Please cite "4D Spatio-Temporal ConvNets: Minkowski Convolutional Neural
+# Networks", CVPR'19 (https://arxiv.org/abs/1904.08755) if you use any part
+# of the code.
+import json
+import os
+from collections import OrderedDict, defaultdict
+
+import torch.nn as nn
+
+import MinkowskiEngineBackend._C as MEB
+
+# Phases of an op in the order of execution
+_PHASE_ORDER = [
+    "kernel_map.lookup",
+    "kernel_map.build",
+    "insert_and_map",
+    "stride",
+    "stride_region",
+    "alloc",
+    "gather",
+    "gemm",
+    "scatter",
+]
+
+
+def enable_profiling(capacity: int = -1):
+    r"""Start recording the timed phases of the CPU ops.
+
+    Args:
+        :attr:`capacity` (int, optional): the maximum number of recorded
+        events. The events beyond the capacity are dropped. Unlimited if
+        negative.
+
+    """
+    MEB.profiler_enable(capacity)
+
+
+def disable_profiling():
+    r"""Stop recording. The recorded events are kept."""
+    MEB.profiler_disable()
+
+
+def is_profiling_enabled() -> bool:
+    return MEB.profiler_is_enabled()
+
+
+def clear_profile():
+    r"""Discard the recorded events."""
+    MEB.profiler_clear()
+
+
+def profile_events() -> list:
+    r"""Returns the recorded events as dicts with the name, category,
+    thread, start, and duration in microseconds."""
+    return [
+        dict(
+            name=name,
+            category=category,
+            thread=thread,
+            start_us=start_ns / 1000.0,
+            duration_us=duration_ns / 1000.0,
+        )
+        for name, category, thread, start_ns, duration_ns in MEB.profiler_events()
+    ]
+
+
+class record:
+    r"""Record the code in the scope as an event of :attr:`category` on the
+    clock of the CPU ops.
+
+    Example::
+
+       >>> with ME.utils.record("data loading"):
+       >>>     sinput = next(loader)
+
+    """
+
+    def __init__(self, name: str, category: str = "user"):
+        self.name = name
+        self.category = category
+
+    def __enter__(self):
+        self.start_ns = MEB.profiler_now() if MEB.profiler_is_enabled() else None
+        return self
+
+    def __exit__(self, *args):
+        if self.start_ns is not None:
+            MEB.profiler_record(
+                self.name, self.category, self.start_ns, MEB.profiler_now()
+            )
+
+
+def _nest(events):
+    r"""Returns the parent index of each event. The events of a thread nest
+    by their time intervals."""
+    parents = [None] * len(events)
+    by_thread = defaultdict(list)
+    for i, e in enumerate(events):
+        by_thread[e["thread"]].append(i)
+    for indices in by_thread.values():
+        indices.sort(key=lambda i: (events[i]["start_us"], -events[i]["duration_us"]))
+        stack = []
+        for i in indices:
+            start = events[i]["start_us"]
+            while stack and (
+                events[stack[-1]]["start_us"] + events[stack[-1]]["duration_us"]
+                <= start
+            ):
+                stack.pop()
+            parents[i] = stack[-1] if stack else None
+            stack.append(i)
+    return parents
+
+
+def profile_summary(events=None, categories=("layer", "op")) -> OrderedDict:
+    r"""Aggregate the events of :attr:`categories` by name.
+
+    Returns:
+        an `OrderedDict` from the name to the number of calls, the total and
+        the self time in milliseconds, and the time of each map or phase
+        event nested in the calls, sorted by the total time.
+
+    """
+    if events is None:
+        events = profile_events()
+    parents = _nest(events)
+    children_us = defaultdict(float)
+    for i, parent in enumerate(parents):
+        if parent is not None:
+            children_us[parent] += events[i]["duration_us"]
+
+    summary = {}
+    for i, e in enumerate(events):
+        if e["category"] not in categories:
+            continue
+        row = summary.setdefault(
+            e["name"],
+            dict(category=e["category"], calls=0, total_ms=0.0, self_ms=0.0,
+                 phases_ms=defaultdict(float)),
+        )
+        row["calls"] += 1
+        row["total_ms"] += e["duration_us"] / 1000
+        row["self_ms"] += (e["duration_us"] - children_us[i]) / 1000
+
+    # Attribute the outermost map and phase events to all enclosing rows
+    for i, e in enumerate(events):
+        if e["category"] not in ("map", "phase"):
+            continue
+        parent, ancestors = parents[i], []
+        while parent is not None:
+            if events[parent]["category"] in ("map", "phase"):
+                break
+            ancestors.append(parent)
+            parent = parents[parent]
+        if parent is not None:
+            continue
+        for a in ancestors:
+            if events[a]["category"] in categories:
+                summary[events[a]["name"]]["phases_ms"][e["name"]] += (
+                    e["duration_us"] / 1000
+                )
+
+    return OrderedDict(
+        sorted(summary.items(), key=lambda item: item[1]["total_ms"], reverse=True)
+    )
+
+
+def profile_table(events=None, categories=("layer", "op")) -> str:
+    r"""Returns :attr:`profile_summary` as a table of milliseconds."""
+    summary = profile_summary(events, categories)
+    phases = set()
+    for row in summary.values():
+        phases.update(row["phases_ms"].keys())
+    phases = [p for p in _PHASE_ORDER if p in phases] + sorted(
+        phases.difference(_PHASE_ORDER)
+    )
+    name_width = max([len("name")] + [len(name) for name in summary.keys()])
+    headers = ["calls", "total", "self"] + phases
+    widths = [max(len(h), 9) for h in headers]
+    lines = [
+        "  ".join(
+            ["name".ljust(name_width)] + [h.rjust(w) for h, w in zip(headers, widths)]
+        )
+    ]
+    for name, row in summary.items():
+        values = [str(row["calls"]), "%.3f" % row["total_ms"], "%.3f" % row["self_ms"]]
+        values += ["%.3f" % row["phases_ms"].get(p, 0.0) for p in phases]
+        lines.append(
+            "  ".join(
+                [name.ljust(name_width)] + [v.rjust(w) for v, w in zip(values, widths)]
+            )
+        )
+    return "\n".join(lines)
+
+
+def export_chrome_trace(path: str, events=None):
+    r"""Write the events in the Chrome trace format, which chrome://tracing
+    and Perfetto open."""
+    if events is None:
+        events = profile_events()
+    origin = min([e["start_us"] for e in events], default=0)
+    pid = os.getpid()
+    trace = [
+        dict(
+            name=e["name"],
+            cat=e["category"],
+            ph="X",
+            ts=e["start_us"] - origin,
+            dur=e["duration_us"],
+            pid=pid,
+            tid=e["thread"],
+        )
+        for e in events
+    ]
+    with open(path, "w") as f:
+        json.dump(dict(traceEvents=trace, displayTimeUnit="ms"), f)
+
+
+class profile:
+    r"""Record the CPU ops in the scope. If :attr:`model` is given, the
+    forward of each submodule is recorded as a "layer" event that encloses
+    the ops of the layer.
+
+    Example::
+
+       >>> with ME.utils.profile(model) as prof:
+       >>>     soutput = model(sinput)
+       >>>     soutput.F.sum().backward()
+       >>> print(prof.table())
+       >>> prof.export_chrome_trace("trace.json")
+
+    """
+
+    def __init__(self, model: nn.Module = None, capacity: int = -1):
+        self.model = model
+        self.capacity = capacity
+        self.events = []
+        self._handles = []
+
+    def _register_hooks(self):
+        starts = defaultdict(list)
+
+        def pre_hook(module, input):
+            starts[module].append(MEB.profiler_now())
+
+        def hook(module, input, output):
+            MEB.profiler_record(
+                names[module], "layer", starts[module].pop(), MEB.profiler_now()
+            )
+
+        names = {}
+        for name, module in self.model.named_modules():
+            if isinstance(module, (nn.Sequential, nn.ModuleList)):
+                continue
+            names[module] = "%s (%s)" % (
+                name if name else "model",
+                module.__class__.__name__,
+            )
+            self._handles.append(module.register_forward_pre_hook(pre_hook))
+            self._handles.append(module.register_forward_hook(hook))
+
+    def __enter__(self):
+        MEB.profiler_clear()
+        if self.model is not None:
+            self._register_hooks()
+        MEB.profiler_enable(self.capacity)
+        return self
+
+    def __exit__(self, *args):
+        MEB.profiler_disable()
+        for handle in self._handles:
+            handle.remove()
+        self._handles = []
+        self.events = profile_events()
+        self.dropped = MEB.profiler_dropped()
+        MEB.profiler_clear()
+
+    def summary(self, categories=("layer", "op")) -> OrderedDict:
+        return profile_summary(self.events, categories)
+
+    def table(self, categories=("layer", "op")) -> str:
+        return profile_table(self.events, categories)
+
+    def export_chrome_trace(self, path: str):
+        export_chrome_trace(path, self.events)
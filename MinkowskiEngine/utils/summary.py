@@ -31,6 +31,12 @@ def size2list(size: torch.Size) -> list:
 
 def get_hash_occupancy_ratio(minkowski_tensor):
     alg = minkowski_tensor.coordinate_manager.minkowski_algorithm
+    if not minkowski_tensor.F.is_cuda:
+        # CPU coordinate maps grow at 80% occupancy unless rehashed
+        if alg == ME.MinkowskiAlgorithm.SPEED_OPTIMIZED:
+            return 40;
+        else:
+            return 80;
     if alg == ME.MinkowskiAlgorithm.SPEED_OPTIMIZED:
         return 25;
     else:
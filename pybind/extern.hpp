@@ -29,6 +29,7 @@
 #include "coordinate_map_key.hpp"
 #include "coordinate_map_manager.hpp"
 #include "errors.hpp"
+#include "profiler.hpp"
 #include "types.hpp"
 #include "utils.hpp"
 
@@ -65,6 +66,21 @@ ConvolutionForwardCPU(at::Tensor const &in_feat,                         //
                       CoordinateMapKey *p_out_map_key,                   //
                       cpu_manager_type<coordinate_type> *p_map_manager);
 
+template <typename coordinate_type>
+std::vector<at::Tensor> MultiTensorConvolutionForwardCPU(
+    std::vector<at::Tensor> const &in_feats,                          //
+    at::Tensor const &kernel,                                         //
+    default_types::stride_type const &kernel_size,                    //
+    default_types::stride_type const &kernel_stride,                  //
+    default_types::stride_type const &kernel_dilation,                //
+    RegionType::Type const region_type,                               //
+    at::Tensor const &offset,                                         //
+    bool const expand_coordinates,                                    //
+    ConvolutionMode::Type const convolution_mode,                     //
+    std::vector<CoordinateMapKey *> const &p_in_map_keys,             //
+    std::vector<CoordinateMapKey *> const &p_out_map_keys,            //
+    std::vector<cpu_manager_type<coordinate_type> *> const &p_map_managers);
+
 template <typename coordinate_type>
 std::pair<at::Tensor, at::Tensor>
 ConvolutionBackwardCPU(at::Tensor const &in_feat,                         //
@@ -80,6 +96,91 @@ ConvolutionBackwardCPU(at::Tensor const &in_feat,                         //
                        CoordinateMapKey *p_out_map_key,                   //
                        cpu_manager_type<coordinate_type> *p_map_manager);
 
+template <typename coordinate_type>
+std::pair<at::Tensor, at::Tensor> ConvolutionBiasActivationForwardCPU(
+    at::Tensor const &in_feat,                         //
+    at::Tensor const &kernel,                          //
+    at::Tensor const &bias,                            //
+    ActivationType::Type const activation,             //
+    double const negative_slope,                       //
+    default_types::stride_type const &kernel_size,     //
+    default_types::stride_type const &kernel_stride,   //
+    default_types::stride_type const &kernel_dilation, //
+    RegionType::Type const region_type,                //
+    at::Tensor const &offset,                          //
+    bool const expand_coordinates,                     //
+    ConvolutionMode::Type const convolution_mode,      //
+    CoordinateMapKey *p_in_map_key,                    //
+    CoordinateMapKey *p_out_map_key,                   //
+    cpu_manager_type<coordinate_type> *p_map_manager);
+
+template <typename coordinate_type>
+std::tuple<at::Tensor, at::Tensor, at::Tensor>
+ConvolutionBiasActivationBackwardCPU(
+    at::Tensor const &in_feat,                         //
+    at::Tensor &grad_out_feat,                         //
+    at::Tensor const &out_feat,                        //
+    at::Tensor const &pre_feat,                        //
+    at::Tensor const &kernel,                          //
+    at::Tensor const &bias,                            //
+    ActivationType::Type const activation,             //
+    double const negative_slope,                       //
+    default_types::stride_type const &kernel_size,     //
+    default_types::stride_type const &kernel_stride,   //
+    default_types::stride_type const &kernel_dilation, //
+    RegionType::Type const region_type,                //
+    at::Tensor const &offsets,                         //
+    ConvolutionMode::Type const convolution_mode,      //
+    CoordinateMapKey *p_in_map_key,                    //
+    CoordinateMapKey *p_out_map_key,                   //
+    cpu_manager_type<coordinate_type> *p_map_manager);
+
+template <typename coordinate_type>
+at::Tensor DepthwiseConvolutionForwardCPU(
+    at::Tensor const &in_feat,                         //
+    at::Tensor const &kernel,                          //
+    default_types::stride_type const &kernel_size,     //
+    default_types::stride_type const &kernel_stride,   //
+    default_types::stride_type const &kernel_dilation, //
+    RegionType::Type const region_type,                //
+    at::Tensor const &offset,                          //
+    ConvolutionMode::Type const convolution_mode,      //
+    CoordinateMapKey *p_in_map_key,                    //
+    CoordinateMapKey *p_out_map_key,                   //
+    cpu_manager_type<coordinate_type> *p_map_manager);
+
+template <typename coordinate_type>
+std::pair<at::Tensor, at::Tensor> DepthwiseConvolutionBackwardCPU(
+    at::Tensor const &in_feat,                         //
+    at::Tensor &grad_out_feat,                         //
+    at::Tensor const &kernel,                          //
+    default_types::stride_type const &kernel_size,     //
+    default_types::stride_type const &kernel_stride,   //
+    default_types::stride_type const &kernel_dilation, //
+    RegionType::Type const region_type,                //
+    at::Tensor const &offset,                          //
+    ConvolutionMode::Type const convolution_mode,      //
+    CoordinateMapKey *p_in_map_key,                    //
+    CoordinateMapKey *p_out_map_key,                   //
+    cpu_manager_type<coordinate_type> *p_map_manager);
+
+template <typename coordinate_type>
+at::Tensor QuantizedConvolutionForwardCPU(
+    at::Tensor const &in_feat,                         //
+    at::Tensor const &kernel,                          //
+    at::Tensor const &scale,                           //
+    at::Tensor const &bias,                            //
+    default_types::stride_type const &kernel_size,     //
+    default_types::stride_type const &kernel_stride,   //
+    default_types::stride_type const &kernel_dilation, //
+    RegionType::Type const region_type,                //
+    at::Tensor const &offset,                          //
+    bool const expand_coordinates,                     //
+    ConvolutionMode::Type const convolution_mode,      //
+    CoordinateMapKey *p_in_map_key,                    //
+    CoordinateMapKey *p_out_map_key,                   //
+    cpu_manager_type<coordinate_type> *p_map_manager);
+
 #ifndef CPU_ONLY
 template <typename coordinate_type,
           template <typename C> class TemplatedAllocator>
@@ -422,6 +523,46 @@ std::pair<at::Tensor, at::Tensor> BroadcastBackwardGPU(
     gpu_manager_type<coordinate_type, TemplatedAllocator> *p_map_manager);
 #endif
 
+/*************************************
+ * Normalization
+ *************************************/
+template <typename coordinate_type>
+std::pair<at::Tensor, at::Tensor>
+InstanceNormForwardCPU(at::Tensor const &in_feat,      //
+                       double const eps,               //
+                       CoordinateMapKey *p_in_map_key, //
+                       cpu_manager_type<coordinate_type> *p_map_manager);
+
+template <typename coordinate_type>
+at::Tensor
+InstanceNormBackwardCPU(at::Tensor &grad_out_feat,      //
+                        at::Tensor const &out_feat,     //
+                        at::Tensor const &inv_std,      //
+                        CoordinateMapKey *p_in_map_key, //
+                        cpu_manager_type<coordinate_type> *p_map_manager);
+
+/*************************************
+ * Dense
+ *************************************/
+template <typename coordinate_type>
+std::pair<at::Tensor, at::Tensor>
+SparseToDenseCPU(at::Tensor const &in_feat,                   //
+                 std::vector<int64_t> shape,                  //
+                 std::vector<coordinate_type> min_coordinate, //
+                 bool const contract_stride,                  //
+                 bool const channels_last,                    //
+                 CoordinateMapKey *p_in_map_key,              //
+                 cpu_manager_type<coordinate_type> *p_map_manager);
+
+template <typename coordinate_type>
+at::Tensor
+DenseToSparseCPU(at::Tensor const &dense,                            //
+                 std::vector<coordinate_type> const &min_coordinate, //
+                 bool const contract_stride,                         //
+                 bool const channels_last,                           //
+                 CoordinateMapKey *p_in_map_key,                     //
+                 cpu_manager_type<coordinate_type> *p_map_manager);
+
 /*************************************
  * Pruning
  *************************************/
@@ -513,6 +654,12 @@ std::vector<py::array> quantize_label_np(
 std::vector<at::Tensor> quantize_label_th(at::Tensor coords, at::Tensor labels,
                                           int invalid_label);
 
+std::vector<at::Tensor>
+sparse_collate_cpu(std::vector<at::Tensor> const &coordinates,
+                   std::vector<at::Tensor> const &features,
+                   std::vector<at::Tensor> const &labels, bool const quantize,
+                   int64_t const ignore_label);
+
 std::pair<torch::Tensor, torch::Tensor>
 max_pool_fw(torch::Tensor const &in_map,  //
             torch::Tensor const &out_map, //
@@ -552,6 +699,28 @@ void instantiate_cpu_func(py::module &m, const std::string &dtypestr) {
   m.def((std::string("ConvolutionBackwardCPU") + dtypestr).c_str(),
         &minkowski::ConvolutionBackwardCPU<coordinate_type>,
         py::call_guard<py::gil_scoped_release>());
+  m.def((std::string("MultiTensorConvolutionForwardCPU") + dtypestr).c_str(),
+        &minkowski::MultiTensorConvolutionForwardCPU<coordinate_type>,
+        py::call_guard<py::gil_scoped_release>());
+
+  m.def((std::string("ConvolutionBiasActivationForwardCPU") + dtypestr).c_str(),
+        &minkowski::ConvolutionBiasActivationForwardCPU<coordinate_type>,
+        py::call_guard<py::gil_scoped_release>());
+  m.def(
+      (std::string("ConvolutionBiasActivationBackwardCPU") + dtypestr).c_str(),
+      &minkowski::ConvolutionBiasActivationBackwardCPU<coordinate_type>,
+      py::call_guard<py::gil_scoped_release>());
+
+  m.def((std::string("DepthwiseConvolutionForwardCPU") + dtypestr).c_str(),
+        &minkowski::DepthwiseConvolutionForwardCPU<coordinate_type>,
+        py::call_guard<py::gil_scoped_release>());
+  m.def((std::string("DepthwiseConvolutionBackwardCPU") + dtypestr).c_str(),
+        &minkowski::DepthwiseConvolutionBackwardCPU<coordinate_type>,
+        py::call_guard<py::gil_scoped_release>());
+
+  m.def((std::string("QuantizedConvolutionForwardCPU") + dtypestr).c_str(),
+        &minkowski::QuantizedConvolutionForwardCPU<coordinate_type>,
+        py::call_guard<py::gil_scoped_release>());
 
   m.def((std::string("ConvolutionTransposeForwardCPU") + dtypestr).c_str(),
         &minkowski::ConvolutionTransposeForwardCPU<coordinate_type>,
@@ -595,6 +764,20 @@ void instantiate_cpu_func(py::module &m, const std::string &dtypestr) {
         &minkowski::BroadcastBackwardCPU<coordinate_type>,
         py::call_guard<py::gil_scoped_release>());
 
+  m.def((std::string("InstanceNormForwardCPU") + dtypestr).c_str(),
+        &minkowski::InstanceNormForwardCPU<coordinate_type>,
+        py::call_guard<py::gil_scoped_release>());
+  m.def((std::string("InstanceNormBackwardCPU") + dtypestr).c_str(),
+        &minkowski::InstanceNormBackwardCPU<coordinate_type>,
+        py::call_guard<py::gil_scoped_release>());
+
+  m.def((std::string("SparseToDenseCPU") + dtypestr).c_str(),
+        &minkowski::SparseToDenseCPU<coordinate_type>,
+        py::call_guard<py::gil_scoped_release>());
+  m.def((std::string("DenseToSparseCPU") + dtypestr).c_str(),
+        &minkowski::DenseToSparseCPU<coordinate_type>,
+        py::call_guard<py::gil_scoped_release>());
+
   m.def((std::string("InterpolationForwardCPU") + dtypestr).c_str(),
         &minkowski::InterpolationForwardCPU<coordinate_type>,
         py::call_guard<py::gil_scoped_release>());
@@ -690,10 +873,40 @@ void non_templated_cpu_func(py::module &m) {
   m.def("quantize_th", &minkowski::quantize_th);
   m.def("quantize_label_np", &minkowski::quantize_label_np);
   m.def("quantize_label_th", &minkowski::quantize_label_th);
+  m.def("sparse_collate_cpu", &minkowski::sparse_collate_cpu,
+        py::call_guard<py::gil_scoped_release>());
   m.def("direct_max_pool_fw", &minkowski::max_pool_fw,
         py::call_guard<py::gil_scoped_release>());
   m.def("direct_max_pool_bw", &minkowski::max_pool_bw,
         py::call_guard<py::gil_scoped_release>());
+
+  // Profiler
+  m.def(
+      "profiler_enable",
+      [](int64_t capacity) { minkowski::profiler::instance().enable(capacity); },
+      py::arg("capacity") = -1);
+  m.def("profiler_disable",
+        []() { minkowski::profiler::instance().disable(); });
+  m.def("profiler_is_enabled", &minkowski::profiler::enabled);
+  m.def("profiler_clear", []() { minkowski::profiler::instance().clear(); });
+  m.def("profiler_now", &minkowski::profiler::now);
+  m.def("profiler_record",
+        [](std::string name, std::string category, int64_t start_ns,
+           int64_t end_ns) {
+          minkowski::profiler::instance().record(name, category, start_ns,
+                                                 end_ns);
+        });
+  m.def("profiler_dropped",
+        []() { return minkowski::profiler::instance().dropped(); });
+  // (name, category, thread, start_ns, duration_ns)
+  m.def("profiler_events", []() {
+    std::vector<std::tuple<std::string, std::string, int, int64_t, int64_t>>
+        events;
+    for (auto const &e : minkowski::profiler::instance().events())
+      events.emplace_back(e.name, e.category, e.thread, e.start_ns,
+                          e.duration_ns);
+    return events;
+  });
 }
 
 #ifndef CPU_ONLY
@@ -733,6 +946,12 @@ void initialize_non_templated_classes(py::module &m) {
       .value("CUDA", minkowski::CoordinateMapBackend::Type::CUDA)
       .export_values();
 
+  py::enum_<minkowski::CoordinateOrdering::Type>(m, "CoordinateOrdering")
+      .value("INSERTION", minkowski::CoordinateOrdering::Type::INSERTION)
+      .value("MORTON", minkowski::CoordinateOrdering::Type::MORTON)
+      .value("HILBERT", minkowski::CoordinateOrdering::Type::HILBERT)
+      .export_values();
+
   py::enum_<minkowski::RegionType::Type>(m, "RegionType")
       .value("HYPER_CUBE", minkowski::RegionType::Type::HYPER_CUBE)
       .value("HYPER_CROSS", minkowski::RegionType::Type::HYPER_CROSS)
@@ -779,6 +998,13 @@ void initialize_non_templated_classes(py::module &m) {
       .value("COPY_GEMM", minkowski::ConvolutionMode::Type::COPY_GEMM)
       .export_values();
 
+  py::enum_<minkowski::ActivationType::Type>(m, "ActivationType")
+      .value("IDENTITY", minkowski::ActivationType::Type::IDENTITY)
+      .value("RELU", minkowski::ActivationType::Type::RELU)
+      .value("LEAKY_RELU", minkowski::ActivationType::Type::LEAKY_RELU)
+      .value("GELU", minkowski::ActivationType::Type::GELU)
+      .export_values();
+
   // Classes
   py::class_<minkowski::CoordinateMapKey>(m, "CoordinateMapKey")
       .def(py::init<minkowski::default_types::size_type>())
@@ -810,6 +1036,9 @@ void instantiate_manager(py::module &m, const std::string &dtypestr) {
       .def(py::init<>())
       .def(py::init<minkowski::MinkowskiAlgorithm::Mode,
                     minkowski::default_types::size_type>())
+      .def(py::init<minkowski::MinkowskiAlgorithm::Mode,
+                    minkowski::default_types::size_type,
+                    minkowski::CoordinateOrdering::Type>())
       .def("__repr__",
            py::overload_cast<>(&manager_type::to_string, py::const_))
       .def("print_coordinate_map",
@@ -835,13 +1064,22 @@ void instantiate_manager(py::module &m, const std::string &dtypestr) {
       .def("size", py::overload_cast<minkowski::CoordinateMapKey const *>(
                        &manager_type::size, py::const_))
       .def("get_random_string_id", &manager_type::get_random_string_id)
+      .def("num_threads", &manager_type::num_threads)
+      .def("coordinate_ordering", &manager_type::coordinate_ordering)
       .def("origin_map_size", &manager_type::origin_map_size)
       .def("origin_map", &manager_type::origin_map_th)
       .def("origin_field_map", &manager_type::origin_field_map_th)
       .def("union_map", &manager_type::union_map_th)
       .def("stride_map", &manager_type::stride_map_th)
+      .def("batch_row_indices", &manager_type::batch_row_indices_th)
+      .def("update", &manager_type::update)
       .def("kernel_map", &manager_type::kernel_map_th)
-      .def("interpolation_map_weight", &manager_type::interpolation_map_weight);
+      .def("interpolation_map_weight", &manager_type::interpolation_map_weight)
+      .def("neighbors", &manager_type::neighbors)
+      .def("memory_stats", &manager_type::memory_stats)
+      .def("clear_kernel_maps", &manager_type::clear_kernel_maps)
+      .def("save", &manager_type::save)
+      .def("load", &manager_type::load);
 }
 
 bool is_cuda_available() {
@@ -224,6 +224,7 @@ SOURCE_SETS = {
             "math_functions_cpu.cpp",
             "coordinate_map_manager.cpp",
             "convolution_cpu.cpp",
+            "depthwise_convolution_cpu.cpp",
             "convolution_transpose_cpu.cpp",
             "local_pooling_cpu.cpp",
             "local_pooling_transpose_cpu.cpp",
@@ -231,8 +232,11 @@ SOURCE_SETS = {
             "broadcast_cpu.cpp",
             "pruning_cpu.cpp",
             "interpolation_cpu.cpp",
+            "normalization_cpu.cpp",
+            "dense_cpu.cpp",
             "quantization.cpp",
             "direct_max_pool.cpp",
+            "collation.cpp",
         ],
         ["pybind/minkowski.cpp"],
         ["-DCPU_ONLY"],
@@ -258,10 +262,13 @@ SOURCE_SETS = {
             "broadcast_gpu.cu",
             "pruning_gpu.cu",
             "interpolation_gpu.cu",
+            "normalization_gpu.cu",
+            "dense_gpu.cu",
             "spmm.cu",
             "gpu.cu",
             "quantization.cpp",
             "direct_max_pool.cpp",
+            "collation.cpp",
         ],
         ["pybind/minkowski.cu"],
         [],
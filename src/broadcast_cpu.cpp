@@ -46,6 +46,8 @@ BroadcastForwardCPU(at::Tensor const &in_feat, at::Tensor const &in_feat_glob,
                     CoordinateMapKey *p_in_map_key,   //
                     CoordinateMapKey *p_glob_map_key, //
                     cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("BroadcastForwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
 
   ASSERT(in_feat.is_contiguous(), "in_feat must be contiguous");
   ASSERT(!in_feat.is_cuda(), "in_feat must be on CPU");
@@ -75,13 +77,15 @@ BroadcastForwardCPU(at::Tensor const &in_feat, at::Tensor const &in_feat_glob,
          "Incompatible scalar_type. Use the same float type for both in_feat "
          "and in_feat_glob.")
 
-  cpu_kernel_map const &kernel_map = p_map_manager->origin_map(p_in_map_key);
+  auto const p_kernel_map = p_map_manager->origin_map(p_in_map_key);
+  cpu_kernel_map const &kernel_map = *p_kernel_map;
 
   auto out_feat =
       torch::empty({in_feat.size(0), in_feat.size(1)}, in_feat.options());
 
-  AT_DISPATCH_FLOATING_TYPES(
-      in_feat.scalar_type(), "broadcast_forward_cpu", [&] {
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      at::ScalarType::BFloat16, at::ScalarType::Half, in_feat.scalar_type(),
+      "broadcast_forward_cpu", [&] {
         BroadcastForwardKernelCPU<scalar_t, int>(
             in_feat.template data_ptr<scalar_t>(), in_feat.size(0),
             in_feat_glob.template data_ptr<scalar_t>(), in_feat_glob.size(0),
@@ -100,6 +104,8 @@ BroadcastBackwardCPU(at::Tensor const &in_feat, at::Tensor const &in_feat_glob,
                      CoordinateMapKey *p_in_map_key,   //
                      CoordinateMapKey *p_glob_map_key, //
                      cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("BroadcastBackwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
 
   ASSERT(in_feat.is_contiguous(), "in_feat must be contiguous");
   ASSERT(!in_feat.is_cuda(), "in_feat must be on CPU");
@@ -136,15 +142,17 @@ BroadcastBackwardCPU(at::Tensor const &in_feat, at::Tensor const &in_feat_glob,
          "Incompatible scalar_type. Use the same float type for both in_feat "
          "and grad_out_feat.")
 
-  cpu_kernel_map const &kernel_map = p_map_manager->origin_map(p_in_map_key);
+  auto const p_kernel_map = p_map_manager->origin_map(p_in_map_key);
+  cpu_kernel_map const &kernel_map = *p_kernel_map;
 
   auto grad_in_feat =
       torch::zeros({in_feat.size(0), in_feat.size(1)}, in_feat.options());
   auto grad_glob_feat = torch::zeros(
       {in_feat_glob.size(0), in_feat_glob.size(1)}, in_feat_glob.options());
 
-  AT_DISPATCH_FLOATING_TYPES(
-      in_feat.scalar_type(), "broadcast_backward_cpu", [&] {
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      at::ScalarType::BFloat16, at::ScalarType::Half, in_feat.scalar_type(),
+      "broadcast_backward_cpu", [&] {
         BroadcastBackwardKernelCPU<scalar_t, int>(
             in_feat.template data_ptr<scalar_t>(),
             grad_in_feat.template data_ptr<scalar_t>(), in_feat.size(0),
@@ -82,7 +82,8 @@ at::Tensor BroadcastForwardGPU(
          "Incompatible scalar_type. Use the same float type for both in_feat "
          "and in_feat_glob.")
 
-  const auto &in_outs = p_map_manager->origin_map(p_in_map_key);
+  auto const p_in_outs = p_map_manager->origin_map(p_in_map_key);
+  const auto &in_outs = *p_in_outs;
 
   auto out_feat =
       torch::empty({in_feat.size(0), in_feat.size(1)}, in_feat.options());
@@ -155,7 +156,8 @@ std::pair<at::Tensor, at::Tensor> BroadcastBackwardGPU(
   auto grad_glob_feat = torch::zeros(
       {in_feat_glob.size(0), in_feat_glob.size(1)}, in_feat_glob.options());
 
-  const auto &in_outs = p_map_manager->origin_map(p_in_map_key);
+  auto const p_in_outs = p_map_manager->origin_map(p_in_map_key);
+  const auto &in_outs = *p_in_outs;
 
   auto stream = at::cuda::getCurrentCUDAStream();
   cusparseHandle_t handle = getCurrentCUDASparseHandle();
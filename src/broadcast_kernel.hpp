@@ -29,6 +29,9 @@
 #include "types.hpp"
 #include "utils.hpp"
 
+#include <algorithm>
+#include <vector>
+
 namespace minkowski {
 
 template <typename Dtype, typename Itype>
@@ -102,7 +105,9 @@ void BroadcastBackwardKernelCPU(const Dtype *p_in_feat,                   //
                                 BroadcastMode::Type const op, //
                                 const cpu_in_maps &in_maps,
                                 const cpu_out_maps &glob_maps) {
-  Dtype *p_curr_grad_in_feat, *p_curr_grad_in_feat_global;
+  using Acc = typename accumulate_type<Dtype>::type;
+  Dtype *p_curr_grad_in_feat;
+  Acc *p_curr_grad_in_feat_global;
   const Dtype *p_curr_in_feat_global, *p_curr_in_feat, *p_curr_grad_out_feat;
 
   // Assume that the memory is cleared
@@ -116,6 +121,11 @@ void BroadcastBackwardKernelCPU(const Dtype *p_in_feat,                   //
   std::memcpy(p_grad_in_feat, p_grad_out_feat,
               sizeof(Dtype) * in_nrows * nchannel);
 
+  // Reduce the gradient of the global features in accumulate_type<Dtype>
+  std::vector<Acc> grad_in_feat_global(
+      p_grad_in_feat_global,
+      p_grad_in_feat_global + in_nrows_global * nchannel);
+
   // To speed up, put switch outside for loops
   switch (op) {
   case BroadcastMode::ELEMENTWISE_ADDITON: // +
@@ -124,9 +134,9 @@ void BroadcastBackwardKernelCPU(const Dtype *p_in_feat,                   //
       for (uint32_t row = 0; row < in_maps[k].size(); ++row) {
         p_curr_grad_out_feat = p_grad_out_feat + in_maps[k][row] * nchannel;
         p_curr_grad_in_feat_global =
-            p_grad_in_feat_global + glob_maps[k][row] * nchannel;
-        cpu_add<Dtype>(nchannel, p_curr_grad_out_feat,
-                       p_curr_grad_in_feat_global, p_curr_grad_in_feat_global);
+            &grad_in_feat_global[glob_maps[k][row] * nchannel];
+        for (uint32_t j = 0; j < nchannel; j++)
+          p_curr_grad_in_feat_global[j] += Acc(p_curr_grad_out_feat[j]);
       }
     }
     break;
@@ -137,7 +147,7 @@ void BroadcastBackwardKernelCPU(const Dtype *p_in_feat,                   //
         p_curr_in_feat = p_in_feat + in_maps[k][row] * nchannel;
         p_curr_grad_in_feat = p_grad_in_feat + in_maps[k][row] * nchannel;
         p_curr_grad_in_feat_global =
-            p_grad_in_feat_global + glob_maps[k][row] * nchannel;
+            &grad_in_feat_global[glob_maps[k][row] * nchannel];
         p_curr_grad_out_feat = p_grad_out_feat + in_maps[k][row] * nchannel;
         p_curr_in_feat_global = p_in_feat_global + glob_maps[k][row] * nchannel;
 
@@ -147,7 +157,7 @@ void BroadcastBackwardKernelCPU(const Dtype *p_in_feat,                   //
         // In feat glob
         for (uint32_t j = 0; j < nchannel; j++) {
           p_curr_grad_in_feat_global[j] +=
-              p_curr_grad_out_feat[j] * p_curr_in_feat[j];
+              Acc(p_curr_grad_out_feat[j]) * Acc(p_curr_in_feat[j]);
         }
       }
     }
@@ -156,6 +166,9 @@ void BroadcastBackwardKernelCPU(const Dtype *p_in_feat,                   //
     throw std::invalid_argument(Formatter() << "Operation not supported: "
                                             << std::to_string(op));
   }
+
+  std::copy(grad_in_feat_global.begin(), grad_in_feat_global.end(),
+            p_grad_in_feat_global);
 }
 
 } // namespace minkowski
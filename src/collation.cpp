@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2020 NVIDIA Corporation.
+ * Copyright (c) 2018-2020 Chris Choy (chrischoy@ai.stanford.edu).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Please cite "4D Spatio-Temporal ConvNets: Minkowski Convolutional Neural
+ * Networks", CVPR'19 (https://arxiv.org/abs/1904.08755) if you use any part
+ * of the code.
+ */
+#include "coordinate_map_cpu.hpp"
+#include "types.hpp"
+#include "utils.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <type_traits>
+#include <omp.h>
+#include <torch/extension.h>
+
+namespace minkowski {
+
+namespace detail {
+
+/*
+ * Copy the rows of a N x D coordinate matrix to a N x (D + 1) int matrix with
+ * the batch index at the first column. Floating point coordinates are
+ * floored. If p_rows is not null, copy rows p_rows[0], ..., p_rows[N - 1].
+ */
+template <typename src_type>
+void copy_batched_coordinates(src_type const *p_src, int64_t const *p_rows,
+                              int64_t const N, int64_t const D,
+                              int32_t const batch_index, int32_t *p_dst) {
+  for (int64_t i = 0; i < N; ++i) {
+    src_type const *p_src_row = p_src + D * (p_rows ? p_rows[i] : i);
+    int32_t *p_dst_row = p_dst + (D + 1) * i;
+    p_dst_row[0] = batch_index;
+    for (int64_t j = 0; j < D; ++j) {
+      p_dst_row[j + 1] = std::is_floating_point<src_type>::value
+                             ? std::floor(p_src_row[j])
+                             : p_src_row[j];
+    }
+  }
+}
+
+template <typename src_type>
+void copy_int_coordinates(src_type const *p_src, int64_t const N,
+                          int64_t const D, int32_t *p_dst) {
+  for (int64_t i = 0; i < N * D; ++i) {
+    p_dst[i] = std::is_floating_point<src_type>::value ? std::floor(p_src[i])
+                                                       : p_src[i];
+  }
+}
+
+#define COLLATION_DISPATCH_COORDINATE_TYPES(TYPE, ...)                         \
+  switch (TYPE) {                                                              \
+  case at::ScalarType::Int: {                                                  \
+    using scalar_t = int32_t;                                                  \
+    __VA_ARGS__();                                                             \
+    break;                                                                     \
+  }                                                                            \
+  case at::ScalarType::Long: {                                                 \
+    using scalar_t = int64_t;                                                  \
+    __VA_ARGS__();                                                             \
+    break;                                                                     \
+  }                                                                            \
+  case at::ScalarType::Float: {                                                \
+    using scalar_t = float;                                                    \
+    __VA_ARGS__();                                                             \
+    break;                                                                     \
+  }                                                                            \
+  case at::ScalarType::Double: {                                               \
+    using scalar_t = double;                                                   \
+    __VA_ARGS__();                                                             \
+    break;                                                                     \
+  }                                                                            \
+  default:                                                                     \
+    ASSERT(false, "Unsupported coordinate type");                              \
+  }
+
+/*
+ * Per sample unique row indices and label agreement. A quantized label is
+ * ignore_label if the points that fall into the same voxel have different
+ * labels.
+ */
+template <typename label_type>
+void quantize_labels(label_type const *p_labels,
+                     std::vector<int64_t> const &unique_map,
+                     std::vector<int64_t> const &inverse_map,
+                     label_type const ignore_label,
+                     std::vector<label_type> &colabels) {
+  colabels.resize(unique_map.size());
+  for (size_t i = 0; i < unique_map.size(); ++i)
+    colabels[i] = p_labels[unique_map[i]];
+  for (size_t row = 0; row < inverse_map.size(); ++row) {
+    auto &colabel = colabels[inverse_map[row]];
+    if (colabel != p_labels[row])
+      colabel = ignore_label;
+  }
+}
+
+inline void copy_rows(char const *p_src, int64_t const *p_rows, int64_t const N,
+                      size_t const row_bytes, char *p_dst) {
+  if (p_rows == nullptr) {
+    std::memcpy(p_dst, p_src, N * row_bytes);
+  } else {
+    for (int64_t i = 0; i < N; ++i)
+      std::memcpy(p_dst + i * row_bytes, p_src + p_rows[i] * row_bytes,
+                  row_bytes);
+  }
+}
+
+inline size_t row_bytes(at::Tensor const &tensor) {
+  size_t bytes = tensor.element_size();
+  for (int64_t d = 1; d < tensor.dim(); ++d)
+    bytes *= tensor.size(d);
+  return bytes;
+}
+
+} // namespace detail
+
+/*
+ * Batch a list of coordinates, features, and optionally labels in a single
+ * pass. The batch index is prepended to the coordinates.
+ *
+ * When quantize is true, the duplicate coordinates of each sample are removed
+ * using the first occurrence. Labels of the duplicate coordinates are merged
+ * and set to ignore_label if they differ.
+ *
+ * returns {batched coordinates, batched features, batched labels}. Features
+ * and labels are undefined if the inputs are empty.
+ */
+std::vector<at::Tensor>
+sparse_collate_cpu(std::vector<at::Tensor> const &coordinates,
+                   std::vector<at::Tensor> const &features,
+                   std::vector<at::Tensor> const &labels, bool const quantize,
+                   int64_t const ignore_label) {
+  int64_t const batch_size = coordinates.size();
+  bool const use_feat = features.size() > 0;
+  bool const use_label = labels.size() > 0;
+  ASSERT(batch_size > 0, "Empty coordinates.");
+  ASSERT(!use_feat || features.size() == batch_size,
+         "The number of coordinates and features mismatch.",
+         coordinates.size(), "!=", features.size());
+  ASSERT(!use_label || labels.size() == batch_size,
+         "The number of coordinates and labels mismatch.", coordinates.size(),
+         "!=", labels.size());
+
+  std::vector<at::Tensor> ccoordinates(batch_size), cfeatures(batch_size),
+      clabels(batch_size);
+  int64_t const D = coordinates[0].size(1);
+  for (int64_t b = 0; b < batch_size; ++b) {
+    ASSERT(!coordinates[b].is_cuda(), "Coordinates must be CPU tensors.");
+    ASSERT(coordinates[b].dim() == 2 && coordinates[b].size(1) == D,
+           "Invalid coordinate size at", b);
+    ccoordinates[b] = coordinates[b].contiguous();
+    int64_t const N = coordinates[b].size(0);
+    if (use_feat) {
+      ASSERT(!features[b].is_cuda(), "Features must be CPU tensors.");
+      ASSERT(features[b].dim() > 0 && features[b].size(0) == N,
+             "Coordinate length", N, "!= Feature length at", b);
+      ASSERT(features[b].scalar_type() == features[0].scalar_type() &&
+                 detail::row_bytes(features[b]) ==
+                     detail::row_bytes(features[0]),
+             "Feature type or size mismatch at", b);
+      cfeatures[b] = features[b].contiguous();
+    }
+    if (use_label) {
+      ASSERT(!labels[b].is_cuda(), "Labels must be CPU tensors.");
+      ASSERT(labels[b].dim() > 0 && labels[b].size(0) == N,
+             "Coordinate length", N, "!= Label length at", b);
+      ASSERT(labels[b].scalar_type() == labels[0].scalar_type() &&
+                 detail::row_bytes(labels[b]) == detail::row_bytes(labels[0]),
+             "Label type or size mismatch at", b);
+      if (quantize) {
+        ASSERT(labels[b].dim() == 1 &&
+                   (labels[b].scalar_type() == at::kInt ||
+                    labels[b].scalar_type() == at::kLong),
+               "Quantization requires int or long label vectors.");
+      }
+      clabels[b] = labels[b].contiguous();
+    }
+  }
+
+  // First pass: quantize each sample and find the output sizes.
+  std::vector<std::vector<int64_t>> unique_maps(quantize ? batch_size : 0);
+  std::vector<std::vector<int32_t>> int32_labels(
+      (quantize && use_label) ? batch_size : 0);
+  std::vector<std::vector<int64_t>> int64_labels(
+      (quantize && use_label) ? batch_size : 0);
+  std::vector<int64_t> offsets(batch_size + 1, 0);
+
+  if (quantize) {
+    // quantize requires int coordinates of each sample
+    default_types::stride_type tensor_stride(D - 1, 1);
+#pragma omp parallel for schedule(dynamic)
+    for (int64_t b = 0; b < batch_size; ++b) {
+      at::Tensor const &coordinate = ccoordinates[b];
+      int64_t const N = coordinate.size(0);
+      if (N == 0)
+        continue;
+      std::vector<int32_t> int_coordinates(N * D);
+      COLLATION_DISPATCH_COORDINATE_TYPES(coordinate.scalar_type(), [&] {
+        detail::copy_int_coordinates<scalar_t>(
+            coordinate.data_ptr<scalar_t>(), N, D, int_coordinates.data());
+      });
+      CoordinateMapCPU<int32_t> map(N, D, tensor_stride);
+      auto map_inverse_map = map.insert_and_map<true>(
+          int_coordinates.data(), int_coordinates.data() + N * D);
+      unique_maps[b] = std::move(map_inverse_map.first);
+
+      if (use_label) {
+        if (clabels[b].scalar_type() == at::kInt)
+          detail::quantize_labels<int32_t>(
+              clabels[b].data_ptr<int32_t>(), unique_maps[b],
+              map_inverse_map.second, ignore_label, int32_labels[b]);
+        else
+          detail::quantize_labels<int64_t>(
+              clabels[b].data_ptr<int64_t>(), unique_maps[b],
+              map_inverse_map.second, ignore_label, int64_labels[b]);
+      }
+      offsets[b + 1] = unique_maps[b].size();
+    }
+  } else {
+    for (int64_t b = 0; b < batch_size; ++b)
+      offsets[b + 1] = ccoordinates[b].size(0);
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  int64_t const N = offsets[batch_size];
+  LOG_DEBUG("Collating", batch_size, "samples with", N, "points");
+
+  at::Tensor bcoordinates = torch::empty(
+      {N, D + 1}, torch::TensorOptions().dtype(torch::kInt32).requires_grad(false));
+  at::Tensor bfeatures, blabels;
+  if (use_feat) {
+    auto sizes = cfeatures[0].sizes().vec();
+    sizes[0] = N;
+    bfeatures = torch::empty(sizes, cfeatures[0].options());
+  }
+  if (use_label) {
+    auto sizes = clabels[0].sizes().vec();
+    sizes[0] = N;
+    blabels = torch::empty(sizes, clabels[0].options());
+  }
+
+  // Second pass: write all samples directly to the batched tensors.
+  int32_t *p_bcoordinates = bcoordinates.data_ptr<int32_t>();
+  char *p_bfeatures =
+      use_feat ? static_cast<char *>(bfeatures.data_ptr()) : nullptr;
+  char *p_blabels = use_label ? static_cast<char *>(blabels.data_ptr()) : nullptr;
+  size_t const feat_row_bytes = use_feat ? detail::row_bytes(cfeatures[0]) : 0;
+  size_t const label_row_bytes = use_label ? detail::row_bytes(clabels[0]) : 0;
+
+#pragma omp parallel for schedule(dynamic)
+  for (int64_t b = 0; b < batch_size; ++b) {
+    int64_t const begin = offsets[b];
+    int64_t const curr_size = offsets[b + 1] - begin;
+    int64_t const *p_rows = quantize ? unique_maps[b].data() : nullptr;
+    at::Tensor const &coordinate = ccoordinates[b];
+
+    COLLATION_DISPATCH_COORDINATE_TYPES(coordinate.scalar_type(), [&] {
+      detail::copy_batched_coordinates<scalar_t>(
+          coordinate.data_ptr<scalar_t>(), p_rows, curr_size, D, b,
+          p_bcoordinates + begin * (D + 1));
+    });
+
+    if (use_feat)
+      detail::copy_rows(static_cast<char const *>(cfeatures[b].data_ptr()),
+                        p_rows, curr_size, feat_row_bytes,
+                        p_bfeatures + begin * feat_row_bytes);
+
+    if (use_label) {
+      char *p_dst = p_blabels + begin * label_row_bytes;
+      if (!quantize)
+        detail::copy_rows(static_cast<char const *>(clabels[b].data_ptr()),
+                          nullptr, curr_size, label_row_bytes, p_dst);
+      else if (clabels[b].scalar_type() == at::kInt)
+        std::memcpy(p_dst, int32_labels[b].data(), curr_size * label_row_bytes);
+      else
+        std::memcpy(p_dst, int64_labels[b].data(), curr_size * label_row_bytes);
+    }
+  }
+
+  return {bcoordinates, bfeatures, blabels};
+}
+
+} // end namespace minkowski
@@ -39,41 +39,31 @@
 
 namespace minkowski {
 
-template <typename coordinate_type>
-at::Tensor
-ConvolutionForwardCPU(at::Tensor const &in_feat,                         //
-                      at::Tensor const &kernel,                          //
-                      default_types::stride_type const &kernel_size,     //
-                      default_types::stride_type const &kernel_stride,   //
-                      default_types::stride_type const &kernel_dilation, //
-                      RegionType::Type const region_type,                //
-                      at::Tensor const &offset,                          //
-                      bool const expand_coordinates,                     //
-                      ConvolutionMode::Type const convolution_mode,      //
-                      CoordinateMapKey *p_in_map_key,                    //
-                      CoordinateMapKey *p_out_map_key,                   //
-                      cpu_manager_type<coordinate_type> *p_map_manager) {
-
-  ASSERT(in_feat.is_contiguous(), "in_feat must be contiguous");
-  ASSERT(kernel.is_contiguous(), "kernel must be contiguous");
-
-  ASSERT(!in_feat.is_cuda(), "in_feat must be CPU");
-  ASSERT(!kernel.is_cuda(), "kernel must be CPU");
-
-  ASSERT(in_feat.scalar_type() == kernel.scalar_type(), "type mismatch");
-
-  ASSERT(in_feat.dim() == 2, "in_feat.dim():", in_feat.dim());
-  ASSERT(kernel.dim() == 3, "kernel.dim():", kernel.dim());
-
-  ASSERT(in_feat.size(1) == kernel.size(1),
-         "Input feature size and kernel size mismatch");
+namespace detail {
 
+/*
+ * Returns the kernel map of a convolution and sets the output coordinate map
+ * key if it is not set.
+ */
+template <typename coordinate_type>
+cpu_kernel_map_pointer
+convolution_kernel_map(int64_t const in_nrows,                           //
+                       default_types::stride_type const &kernel_size,     //
+                       default_types::stride_type const &kernel_stride,   //
+                       default_types::stride_type const &kernel_dilation, //
+                       RegionType::Type const region_type,                //
+                       at::Tensor const &offset,                          //
+                       bool const expand_coordinates,                     //
+                       CoordinateMapKey *p_in_map_key,                    //
+                       CoordinateMapKey *p_out_map_key,                   //
+                       cpu_manager_type<coordinate_type> *p_map_manager) {
+  auto const omp_scope = p_map_manager->thread_scope();
   // create out coordinate map
   coordinate_map_key_type in_key = p_in_map_key->get_key();
   ASSERT(p_map_manager->exists(in_key), ERROR_MAP_NOT_FOUND);
 
-  ASSERT(in_feat.size(0) == p_map_manager->size(in_key), "Invalid in_feat size",
-         in_feat.size(0), "!=", p_map_manager->size(in_key));
+  ASSERT(in_nrows == p_map_manager->size(in_key), "Invalid in_feat size",
+         in_nrows, "!=", p_map_manager->size(in_key));
 
   if (!p_out_map_key->is_key_set()) {
     if (expand_coordinates) {
@@ -107,7 +97,7 @@ ConvolutionForwardCPU(at::Tensor const &in_feat,                         //
     }
   }
 
-  cpu_kernel_map const &in_out = p_map_manager->kernel_map(
+  return p_map_manager->kernel_map(
       p_in_map_key,    //
       p_out_map_key,   //
       kernel_size,     //
@@ -115,15 +105,57 @@ ConvolutionForwardCPU(at::Tensor const &in_feat,                         //
       kernel_dilation, //
       region_type,     //
       offset, false /* is_transpose */, false /* is_pool */);
+}
+
+} // namespace detail
+
+template <typename coordinate_type>
+at::Tensor
+ConvolutionForwardCPU(at::Tensor const &in_feat,                         //
+                      at::Tensor const &kernel,                          //
+                      default_types::stride_type const &kernel_size,     //
+                      default_types::stride_type const &kernel_stride,   //
+                      default_types::stride_type const &kernel_dilation, //
+                      RegionType::Type const region_type,                //
+                      at::Tensor const &offset,                          //
+                      bool const expand_coordinates,                     //
+                      ConvolutionMode::Type const convolution_mode,      //
+                      CoordinateMapKey *p_in_map_key,                    //
+                      CoordinateMapKey *p_out_map_key,                   //
+                      cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("ConvolutionForwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
+
+  ASSERT(in_feat.is_contiguous(), "in_feat must be contiguous");
+  ASSERT(kernel.is_contiguous(), "kernel must be contiguous");
+
+  ASSERT(!in_feat.is_cuda(), "in_feat must be CPU");
+  ASSERT(!kernel.is_cuda(), "kernel must be CPU");
+
+  ASSERT(in_feat.scalar_type() == kernel.scalar_type(), "type mismatch");
+
+  ASSERT(in_feat.dim() == 2, "in_feat.dim():", in_feat.dim());
+  ASSERT(kernel.dim() == 3, "kernel.dim():", kernel.dim());
+
+  ASSERT(in_feat.size(1) == kernel.size(1),
+         "Input feature size and kernel size mismatch");
+
+  auto const p_in_out = detail::convolution_kernel_map(
+      in_feat.size(0), kernel_size, kernel_stride, kernel_dilation, region_type,
+      offset, expand_coordinates, p_in_map_key, p_out_map_key, p_map_manager);
+  cpu_kernel_map const &in_out = *p_in_out;
 
   auto const out_nrows = p_map_manager->size(p_out_map_key->get_key());
+  profile_scope alloc_scope("alloc", "phase");
   at::Tensor out_feat =
       torch::zeros({out_nrows, kernel.size(2)}, in_feat.options());
+  alloc_scope.stop();
   LOG_DEBUG("Allocated", out_nrows, "x", kernel.size(2), "out_features.");
 
   if (out_nrows > 0)
-    AT_DISPATCH_FLOATING_TYPES(
-        in_feat.scalar_type(), "convolution_forward_cpu", [&] {
+    AT_DISPATCH_FLOATING_TYPES_AND2(
+        at::ScalarType::BFloat16, at::ScalarType::Half, in_feat.scalar_type(),
+        "convolution_forward_cpu", [&] {
           ConvolutionForwardKernelCPU<scalar_t, coordinate_type>(
               in_feat.template data_ptr<scalar_t>(), in_feat.size(1),
               out_feat.template data_ptr<scalar_t>(), out_feat.size(1),
@@ -134,6 +166,84 @@ ConvolutionForwardCPU(at::Tensor const &in_feat,                         //
   return out_feat;
 }
 
+/*
+ * Convolution of several tensors with the same kernel. The i-th tensor is
+ * defined in p_map_managers[i]. The kernel maps of all tensors are built
+ * first and the kernel is applied to all tensors one offset at a time.
+ */
+template <typename coordinate_type>
+std::vector<at::Tensor> MultiTensorConvolutionForwardCPU(
+    std::vector<at::Tensor> const &in_feats,                          //
+    at::Tensor const &kernel,                                         //
+    default_types::stride_type const &kernel_size,                    //
+    default_types::stride_type const &kernel_stride,                  //
+    default_types::stride_type const &kernel_dilation,                //
+    RegionType::Type const region_type,                               //
+    at::Tensor const &offset,                                         //
+    bool const expand_coordinates,                                    //
+    ConvolutionMode::Type const convolution_mode,                     //
+    std::vector<CoordinateMapKey *> const &p_in_map_keys,             //
+    std::vector<CoordinateMapKey *> const &p_out_map_keys,            //
+    std::vector<cpu_manager_type<coordinate_type> *> const &p_map_managers) {
+  profile_scope const scope("MultiTensorConvolutionForwardCPU", "op");
+
+  ASSERT(kernel.is_contiguous(), "kernel must be contiguous");
+  ASSERT(!kernel.is_cuda(), "kernel must be CPU");
+  ASSERT(kernel.dim() == 3, "kernel.dim():", kernel.dim());
+
+  auto const ntensors = in_feats.size();
+  ASSERT(p_in_map_keys.size() == ntensors && p_out_map_keys.size() == ntensors &&
+             p_map_managers.size() == ntensors,
+         "The number of features, map keys, and managers mismatch");
+  omp_thread_scope const omp_scope(
+      ntensors > 0 ? p_map_managers[0]->num_threads() : 0);
+
+  std::vector<at::Tensor> out_feats;
+  // Keeps the kernel maps of the in and out maps below alive.
+  std::vector<cpu_kernel_map_pointer> kernel_maps;
+  std::vector<cpu_in_maps const *> in_maps;
+  std::vector<cpu_out_maps const *> out_maps;
+  for (int t = 0; t < ntensors; ++t) {
+    at::Tensor const &in_feat = in_feats[t];
+    ASSERT(in_feat.is_contiguous(), "in_feat must be contiguous");
+    ASSERT(!in_feat.is_cuda(), "in_feat must be CPU");
+    ASSERT(in_feat.scalar_type() == kernel.scalar_type(), "type mismatch");
+    ASSERT(in_feat.dim() == 2, "in_feat.dim():", in_feat.dim());
+    ASSERT(in_feat.size(1) == kernel.size(1),
+           "Input feature size and kernel size mismatch");
+
+    auto const p_in_out = detail::convolution_kernel_map(
+        in_feat.size(0), kernel_size, kernel_stride, kernel_dilation,
+        region_type, offset, expand_coordinates, p_in_map_keys[t],
+        p_out_map_keys[t], p_map_managers[t]);
+    in_maps.push_back(&p_in_out->first);
+    out_maps.push_back(&p_in_out->second);
+    kernel_maps.push_back(p_in_out);
+
+    auto const out_nrows =
+        p_map_managers[t]->size(p_out_map_keys[t]->get_key());
+    out_feats.push_back(
+        torch::zeros({out_nrows, kernel.size(2)}, in_feat.options()));
+  }
+
+  if (ntensors > 0)
+    AT_DISPATCH_FLOATING_TYPES_AND2(
+        at::ScalarType::BFloat16, at::ScalarType::Half, kernel.scalar_type(),
+        "multi_tensor_convolution_forward_cpu", [&] {
+          std::vector<scalar_t const *> p_in_feats;
+          std::vector<scalar_t *> p_out_feats;
+          for (int t = 0; t < ntensors; ++t) {
+            p_in_feats.push_back(in_feats[t].template data_ptr<scalar_t>());
+            p_out_feats.push_back(out_feats[t].template data_ptr<scalar_t>());
+          }
+          MultiTensorConvolutionForwardKernelCPU<scalar_t, coordinate_type>(
+              p_in_feats, kernel.size(1), p_out_feats, kernel.size(2),
+              kernel.template data_ptr<scalar_t>(), in_maps, out_maps);
+        });
+
+  return out_feats;
+}
+
 template <typename coordinate_type>
 std::pair<at::Tensor, at::Tensor>
 ConvolutionBackwardCPU(at::Tensor const &in_feat,                         //
@@ -148,6 +258,8 @@ ConvolutionBackwardCPU(at::Tensor const &in_feat,                         //
                        CoordinateMapKey *p_in_map_key,                    //
                        CoordinateMapKey *p_out_map_key,                   //
                        cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("ConvolutionBackwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
 
   ASSERT(in_feat.is_contiguous(), "in_feat must be contiguous");
   // ASSERT(grad_out_feat.is_contiguous(), "grad_out_feata must be contiguous");
@@ -173,7 +285,7 @@ ConvolutionBackwardCPU(at::Tensor const &in_feat,                         //
   coordinate_map_key_type out_key = p_out_map_key->get_key();
   ASSERT(p_map_manager->exists(out_key), ERROR_MAP_NOT_FOUND);
 
-  cpu_kernel_map const &in_out = p_map_manager->kernel_map(
+  auto const p_in_out = p_map_manager->kernel_map(
       p_in_map_key,    //
       p_out_map_key,   //
       kernel_size,     //
@@ -181,15 +293,19 @@ ConvolutionBackwardCPU(at::Tensor const &in_feat,                         //
       kernel_dilation, //
       region_type,     //
       offset, false /* is_transpose */, false /* is_pool */);
+  cpu_kernel_map const &in_out = *p_in_out;
 
+  profile_scope alloc_scope("alloc", "phase");
   at::Tensor grad_in_feat =
       torch::zeros({in_feat.size(0), in_feat.size(1)}, in_feat.options());
   at::Tensor grad_kernel = torch::zeros(
       {kernel.size(0), kernel.size(1), kernel.size(2)}, kernel.options());
+  alloc_scope.stop();
 
   if (in_feat.size(0) > 0)
-    AT_DISPATCH_FLOATING_TYPES(
-        in_feat.scalar_type(), "convolution_backward_cpu", [&] {
+    AT_DISPATCH_FLOATING_TYPES_AND2(
+        at::ScalarType::BFloat16, at::ScalarType::Half, in_feat.scalar_type(),
+        "convolution_backward_cpu", [&] {
           ConvolutionBackwardKernelCPU<scalar_t, coordinate_type>(
               in_feat.template data_ptr<scalar_t>(),
               grad_in_feat.template data_ptr<scalar_t>(), in_feat.size(1),
@@ -202,6 +318,199 @@ ConvolutionBackwardCPU(at::Tensor const &in_feat,                         //
   return std::make_pair(grad_in_feat, grad_kernel);
 }
 
+/*
+ * Convolution followed by the bias and the activation applied in a single
+ * pass over the output. Returns the output and the pre-activation, which is
+ * only saved for GELU and empty otherwise.
+ */
+template <typename coordinate_type>
+std::pair<at::Tensor, at::Tensor> ConvolutionBiasActivationForwardCPU(
+    at::Tensor const &in_feat,                         //
+    at::Tensor const &kernel,                          //
+    at::Tensor const &bias,                            //
+    ActivationType::Type const activation,             //
+    double const negative_slope,                       //
+    default_types::stride_type const &kernel_size,     //
+    default_types::stride_type const &kernel_stride,   //
+    default_types::stride_type const &kernel_dilation, //
+    RegionType::Type const region_type,                //
+    at::Tensor const &offset,                          //
+    bool const expand_coordinates,                     //
+    ConvolutionMode::Type const convolution_mode,      //
+    CoordinateMapKey *p_in_map_key,                    //
+    CoordinateMapKey *p_out_map_key,                   //
+    cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("ConvolutionBiasActivationForwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
+
+  ASSERT(bias.numel() == 0 || bias.numel() == kernel.size(2),
+         "Invalid bias size", bias.numel(), "!=", kernel.size(2));
+  ASSERT(bias.numel() == 0 || bias.scalar_type() == in_feat.scalar_type(),
+         "type mismatch");
+  // The LeakyReLU gradient is computed from the sign of the output
+  ASSERT(activation != ActivationType::LEAKY_RELU || negative_slope >= 0,
+         "Invalid negative_slope:", negative_slope);
+
+  at::Tensor out_feat = ConvolutionForwardCPU<coordinate_type>(
+      in_feat, kernel, kernel_size, kernel_stride, kernel_dilation,
+      region_type, offset, expand_coordinates, convolution_mode, p_in_map_key,
+      p_out_map_key, p_map_manager);
+
+  at::Tensor pre_feat = activation == ActivationType::GELU
+                            ? torch::empty_like(out_feat)
+                            : torch::empty({0}, out_feat.options());
+  at::Tensor const contiguous_bias = bias.contiguous();
+
+  if (out_feat.size(0) > 0)
+    AT_DISPATCH_FLOATING_TYPES_AND2(
+        at::ScalarType::BFloat16, at::ScalarType::Half, in_feat.scalar_type(),
+        "convolution_bias_activation_forward_cpu", [&] {
+          BiasActivationForwardKernelCPU<scalar_t>(
+              out_feat.template data_ptr<scalar_t>(),
+              pre_feat.numel() > 0 ? pre_feat.template data_ptr<scalar_t>()
+                                   : nullptr,
+              contiguous_bias.numel() > 0
+                  ? contiguous_bias.template data_ptr<scalar_t>()
+                  : nullptr,
+              out_feat.size(0), out_feat.size(1), activation,
+              negative_slope);
+        });
+
+  return std::make_pair(out_feat, pre_feat);
+}
+
+/*
+ * Returns the gradients of the input, the kernel, and the bias. The gradient
+ * of the bias is empty if bias is empty.
+ */
+template <typename coordinate_type>
+std::tuple<at::Tensor, at::Tensor, at::Tensor>
+ConvolutionBiasActivationBackwardCPU(
+    at::Tensor const &in_feat,                         //
+    at::Tensor &grad_out_feat,                         //
+    at::Tensor const &out_feat,                        //
+    at::Tensor const &pre_feat,                        //
+    at::Tensor const &kernel,                          //
+    at::Tensor const &bias,                            //
+    ActivationType::Type const activation,             //
+    double const negative_slope,                       //
+    default_types::stride_type const &kernel_size,     //
+    default_types::stride_type const &kernel_stride,   //
+    default_types::stride_type const &kernel_dilation, //
+    RegionType::Type const region_type,                //
+    at::Tensor const &offsets,                         //
+    ConvolutionMode::Type const convolution_mode,      //
+    CoordinateMapKey *p_in_map_key,                    //
+    CoordinateMapKey *p_out_map_key,                   //
+    cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("ConvolutionBiasActivationBackwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
+
+  grad_out_feat = grad_out_feat.contiguous();
+  ASSERT(out_feat.is_contiguous(), "out_feat must be contiguous");
+  ASSERT(out_feat.sizes() == grad_out_feat.sizes(), "Invalid out_feat size");
+  ASSERT(activation != ActivationType::GELU ||
+             pre_feat.sizes() == grad_out_feat.sizes(),
+         "Invalid pre_feat size");
+
+  at::Tensor grad_pre_feat = torch::empty_like(grad_out_feat);
+  at::Tensor grad_bias = torch::empty_like(bias);
+
+  if (grad_out_feat.size(0) > 0)
+    AT_DISPATCH_FLOATING_TYPES_AND2(
+        at::ScalarType::BFloat16, at::ScalarType::Half, grad_out_feat.scalar_type(),
+        "convolution_bias_activation_backward_cpu", [&] {
+          BiasActivationBackwardKernelCPU<scalar_t>(
+              grad_out_feat.template data_ptr<scalar_t>(),
+              out_feat.template data_ptr<scalar_t>(),
+              pre_feat.numel() > 0 ? pre_feat.template data_ptr<scalar_t>()
+                                   : nullptr,
+              grad_pre_feat.template data_ptr<scalar_t>(),
+              grad_bias.numel() > 0 ? grad_bias.template data_ptr<scalar_t>()
+                                    : nullptr,
+              grad_out_feat.size(0), grad_out_feat.size(1), activation,
+              negative_slope);
+        });
+  else
+    grad_bias.zero_();
+
+  auto const grads = ConvolutionBackwardCPU<coordinate_type>(
+      in_feat, grad_pre_feat, kernel, kernel_size, kernel_stride,
+      kernel_dilation, region_type, offsets, convolution_mode, p_in_map_key,
+      p_out_map_key, p_map_manager);
+
+  return std::make_tuple(grads.first, grads.second, grad_bias);
+}
+
+/*
+ * int8 convolution. in_feat and kernel are symmetric int8 and scale is the
+ * product of the input scale and the per output channel kernel scales.
+ * Returns the float output features.
+ */
+template <typename coordinate_type>
+at::Tensor QuantizedConvolutionForwardCPU(
+    at::Tensor const &in_feat,                         //
+    at::Tensor const &kernel,                          //
+    at::Tensor const &scale,                           //
+    at::Tensor const &bias,                            //
+    default_types::stride_type const &kernel_size,     //
+    default_types::stride_type const &kernel_stride,   //
+    default_types::stride_type const &kernel_dilation, //
+    RegionType::Type const region_type,                //
+    at::Tensor const &offset,                          //
+    bool const expand_coordinates,                     //
+    ConvolutionMode::Type const convolution_mode,      //
+    CoordinateMapKey *p_in_map_key,                    //
+    CoordinateMapKey *p_out_map_key,                   //
+    cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("QuantizedConvolutionForwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
+
+  ASSERT(in_feat.is_contiguous(), "in_feat must be contiguous");
+  ASSERT(kernel.is_contiguous(), "kernel must be contiguous");
+
+  ASSERT(!in_feat.is_cuda(), "in_feat must be CPU");
+  ASSERT(!kernel.is_cuda(), "kernel must be CPU");
+
+  ASSERT(in_feat.scalar_type() == at::kChar, "in_feat must be int8");
+  ASSERT(kernel.scalar_type() == at::kChar, "kernel must be int8");
+  ASSERT(scale.scalar_type() == at::kFloat, "scale must be float");
+  ASSERT(bias.numel() == 0 || bias.scalar_type() == at::kFloat,
+         "bias must be float");
+
+  ASSERT(in_feat.dim() == 2, "in_feat.dim():", in_feat.dim());
+  ASSERT(kernel.dim() == 3, "kernel.dim():", kernel.dim());
+
+  ASSERT(in_feat.size(1) == kernel.size(1),
+         "Input feature size and kernel size mismatch");
+  ASSERT(scale.numel() == kernel.size(2), "Invalid scale size", scale.numel(),
+         "!=", kernel.size(2));
+  ASSERT(bias.numel() == 0 || bias.numel() == kernel.size(2),
+         "Invalid bias size", bias.numel(), "!=", kernel.size(2));
+
+  auto const p_in_out = detail::convolution_kernel_map(
+      in_feat.size(0), kernel_size, kernel_stride, kernel_dilation, region_type,
+      offset, expand_coordinates, p_in_map_key, p_out_map_key, p_map_manager);
+  cpu_kernel_map const &in_out = *p_in_out;
+
+  auto const out_nrows = p_map_manager->size(p_out_map_key->get_key());
+  at::Tensor out_feat = torch::empty({out_nrows, kernel.size(2)},
+                                     in_feat.options().dtype(at::kFloat));
+
+  at::Tensor const contiguous_scale = scale.contiguous();
+  at::Tensor const contiguous_bias = bias.contiguous();
+  if (out_nrows > 0)
+    QuantizedConvolutionForwardKernelCPU<coordinate_type>(
+        in_feat.data_ptr<int8_t>(), in_feat.size(1),
+        out_feat.data_ptr<float>(), out_feat.size(1), out_nrows,
+        kernel.data_ptr<int8_t>(), contiguous_scale.data_ptr<float>(),
+        contiguous_bias.numel() > 0 ? contiguous_bias.data_ptr<float>()
+                                    : nullptr,
+        in_out.first, in_out.second);
+
+  return out_feat;
+}
+
 template at::Tensor ConvolutionForwardCPU<default_types::dcoordinate_type>(
     at::Tensor const &in_feat,                         //
     at::Tensor const &kernel,                          //
@@ -216,6 +525,22 @@ template at::Tensor ConvolutionForwardCPU<default_types::dcoordinate_type>(
     CoordinateMapKey *p_out_map_key,                   //
     cpu_manager_type<default_types::dcoordinate_type> *p_map_manager);
 
+template std::vector<at::Tensor>
+MultiTensorConvolutionForwardCPU<default_types::dcoordinate_type>(
+    std::vector<at::Tensor> const &in_feats,                          //
+    at::Tensor const &kernel,                                         //
+    default_types::stride_type const &kernel_size,                    //
+    default_types::stride_type const &kernel_stride,                  //
+    default_types::stride_type const &kernel_dilation,                //
+    RegionType::Type const region_type,                               //
+    at::Tensor const &offset,                                         //
+    bool const expand_coordinates,                                    //
+    ConvolutionMode::Type const convolution_mode,                     //
+    std::vector<CoordinateMapKey *> const &p_in_map_keys,             //
+    std::vector<CoordinateMapKey *> const &p_out_map_keys,            //
+    std::vector<cpu_manager_type<default_types::dcoordinate_type> *> const
+        &p_map_managers);
+
 template std::pair<at::Tensor, at::Tensor>
 ConvolutionBackwardCPU<default_types::dcoordinate_type>(
     at::Tensor const &in_feat,                         //
@@ -231,4 +556,59 @@ ConvolutionBackwardCPU<default_types::dcoordinate_type>(
     CoordinateMapKey *p_out_map_key,                   //
     cpu_manager_type<default_types::dcoordinate_type> *p_map_manager);
 
+template std::pair<at::Tensor, at::Tensor>
+ConvolutionBiasActivationForwardCPU<default_types::dcoordinate_type>(
+    at::Tensor const &in_feat,                         //
+    at::Tensor const &kernel,                          //
+    at::Tensor const &bias,                            //
+    ActivationType::Type const activation,             //
+    double const negative_slope,                       //
+    default_types::stride_type const &kernel_size,     //
+    default_types::stride_type const &kernel_stride,   //
+    default_types::stride_type const &kernel_dilation, //
+    RegionType::Type const region_type,                //
+    at::Tensor const &offset,                          //
+    bool const expand_coordinates,                     //
+    ConvolutionMode::Type const convolution_mode,      //
+    CoordinateMapKey *p_in_map_key,                    //
+    CoordinateMapKey *p_out_map_key,                   //
+    cpu_manager_type<default_types::dcoordinate_type> *p_map_manager);
+
+template std::tuple<at::Tensor, at::Tensor, at::Tensor>
+ConvolutionBiasActivationBackwardCPU<default_types::dcoordinate_type>(
+    at::Tensor const &in_feat,                         //
+    at::Tensor &grad_out_feat,                         //
+    at::Tensor const &out_feat,                        //
+    at::Tensor const &pre_feat,                        //
+    at::Tensor const &kernel,                          //
+    at::Tensor const &bias,                            //
+    ActivationType::Type const activation,             //
+    double const negative_slope,                       //
+    default_types::stride_type const &kernel_size,     //
+    default_types::stride_type const &kernel_stride,   //
+    default_types::stride_type const &kernel_dilation, //
+    RegionType::Type const region_type,                //
+    at::Tensor const &offsets,                         //
+    ConvolutionMode::Type const convolution_mode,      //
+    CoordinateMapKey *p_in_map_key,                    //
+    CoordinateMapKey *p_out_map_key,                   //
+    cpu_manager_type<default_types::dcoordinate_type> *p_map_manager);
+
+template at::Tensor
+QuantizedConvolutionForwardCPU<default_types::dcoordinate_type>(
+    at::Tensor const &in_feat,                         //
+    at::Tensor const &kernel,                          //
+    at::Tensor const &scale,                           //
+    at::Tensor const &bias,                            //
+    default_types::stride_type const &kernel_size,     //
+    default_types::stride_type const &kernel_stride,   //
+    default_types::stride_type const &kernel_dilation, //
+    RegionType::Type const region_type,                //
+    at::Tensor const &offset,                          //
+    bool const expand_coordinates,                     //
+    ConvolutionMode::Type const convolution_mode,      //
+    CoordinateMapKey *p_in_map_key,                    //
+    CoordinateMapKey *p_out_map_key,                   //
+    cpu_manager_type<default_types::dcoordinate_type> *p_map_manager);
+
 } // end namespace minkowski
@@ -114,7 +114,7 @@ at::Tensor ConvolutionForwardGPU(
     }
   }
 
-  auto const &in_out = p_map_manager->kernel_map(
+  auto const p_in_out = p_map_manager->kernel_map(
       p_in_map_key,    //
       p_out_map_key,   //
       kernel_size,     //
@@ -122,6 +122,7 @@ at::Tensor ConvolutionForwardGPU(
       kernel_dilation, //
       region_type,     //
       offset, false /* is_transpose */, false /* is_pool */);
+  auto const &in_out = *p_in_out;
 
   auto const out_nrows = p_map_manager->size(p_out_map_key->get_key());
   at::Tensor out_feat =
@@ -200,13 +201,14 @@ std::pair<at::Tensor, at::Tensor> ConvolutionBackwardGPU(
   coordinate_map_key_type out_key = p_out_map_key->get_key();
   ASSERT(p_map_manager->exists(out_key), ERROR_MAP_NOT_FOUND);
 
-  auto const &in_out = p_map_manager->kernel_map(p_in_map_key,    //
-                                                 p_out_map_key,   //
-                                                 kernel_size,     //
-                                                 kernel_stride,   //
-                                                 kernel_dilation, //
-                                                 region_type,     //
-                                                 offset, false, false);
+  auto const p_in_out = p_map_manager->kernel_map(p_in_map_key,    //
+                                                  p_out_map_key,   //
+                                                  kernel_size,     //
+                                                  kernel_stride,   //
+                                                  kernel_dilation, //
+                                                  region_type,     //
+                                                  offset, false, false);
+  auto const &in_out = *p_in_out;
 
   at::Tensor grad_in_feat =
       torch::zeros({in_feat.size(0), in_feat.size(1)}, in_feat.options());
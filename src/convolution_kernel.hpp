@@ -25,13 +25,66 @@
 #ifndef CPU_CONVOLUTION
 #define CPU_CONVOLUTION
 
+#include "kernel_map.hpp"
 #include "math_functions.hpp"
+#include "profiler.hpp"
 #include "types.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <omp.h>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX512VNNI__) && defined(__AVX512BW__)
+#include <immintrin.h>
+#define MINKOWSKI_AVX512_VNNI
+#endif
+
 namespace minkowski {
 
+namespace detail {
+
+// Number of rows indexed by the maps.
+template <typename MapType> int64_t map_nrows(MapType const &maps) {
+  int64_t nrows = 0;
+  for (auto const &map : maps)
+    for (auto const row : map)
+      nrows = std::max<int64_t>(nrows, row + 1);
+  return nrows;
+}
+
+#ifdef MINKOWSKI_AVX512_VNNI
+// Dot product of uint8 a and int8 b with the AVX-512 VNNI instructions.
+inline int32_t dot_u8s8(uint8_t const *a, int8_t const *b, int const n) {
+  __m512i acc = _mm512_setzero_si512();
+  int i = 0;
+  for (; i + 64 <= n; i += 64)
+    acc = _mm512_dpbusd_epi32(acc, _mm512_loadu_si512(a + i),
+                              _mm512_loadu_si512(b + i));
+  if (i < n) {
+    __mmask64 const mask = _cvtu64_mask64(~uint64_t(0) >> (64 - (n - i)));
+    acc = _mm512_dpbusd_epi32(acc, _mm512_maskz_loadu_epi8(mask, a + i),
+                              _mm512_maskz_loadu_epi8(mask, b + i));
+  }
+  return _mm512_reduce_add_epi32(acc);
+}
+#else
+inline int32_t dot_s8s8(int8_t const *a, int8_t const *b, int const n) {
+  int32_t sum = 0;
+#pragma omp simd reduction(+ : sum)
+  for (int i = 0; i < n; ++i)
+    sum += int32_t(a[i]) * int32_t(b[i]);
+  return sum;
+}
+#endif
+
+} // namespace detail
+
 template <typename Dtype, typename Itype>
-void ConvolutionForwardKernelCPU(const Dtype *p_in_feat, int in_nchannel,
+typename std::enable_if<!is_reduced_precision<Dtype>::value>::type
+ConvolutionForwardKernelCPU(const Dtype *p_in_feat, int in_nchannel,
                                  Dtype *p_out_feat, int out_nchannel,
                                  const Dtype *p_kernel,
                                  const cpu_in_maps &in_maps,
@@ -53,33 +106,43 @@ void ConvolutionForwardKernelCPU(const Dtype *p_in_feat, int in_nchannel,
     output_buffer.resize(n_active_in_volume * out_nchannel);
 
     // Gather all features (im2col)
-    for (row = 0; row < n_active_in_volume; row++)
-      std::memcpy(&input_buffer[row * in_nchannel],
-                  p_in_feat + in_maps[k][row] * in_nchannel,
-                  sizeof(Dtype) * in_nchannel);
+    {
+      profile_scope const scope("gather", "phase");
+      for (row = 0; row < n_active_in_volume; row++)
+        std::memcpy(&input_buffer[row * in_nchannel],
+                    p_in_feat + in_maps[k][row] * in_nchannel,
+                    sizeof(Dtype) * in_nchannel);
+    }
 
     // C := alpha*op(A)*op(B) + beta*C
-    cpu_gemm<Dtype>(CblasColMajor, CblasNoTrans, CblasNoTrans,
-                    out_nchannel,                              // M
-                    n_active_in_volume,                        // N
-                    in_nchannel,                               // K
-                    1,                                         // alpha
-                    &p_kernel[k * in_nchannel * out_nchannel], // A
-                    &input_buffer[0],                          // B
-                    0,                                         // beta
-                    &output_buffer[0]);                        // C
+    {
+      profile_scope const scope("gemm", "phase");
+      cpu_gemm<Dtype>(CblasColMajor, CblasNoTrans, CblasNoTrans,
+                      out_nchannel,                              // M
+                      n_active_in_volume,                        // N
+                      in_nchannel,                               // K
+                      1,                                         // alpha
+                      &p_kernel[k * in_nchannel * out_nchannel], // A
+                      &input_buffer[0],                          // B
+                      0,                                         // beta
+                      &output_buffer[0]);                        // C
+    }
 
     // Put it back to the correct index
-    for (row = 0; row < n_active_in_volume; row++) {
-      Dtype *dst = &p_out_feat[out_maps[k][row] * out_nchannel];
-      Dtype *src = &output_buffer[row * out_nchannel];
-      cpu_add<Dtype>(out_nchannel, src, dst, dst);
+    {
+      profile_scope const scope("scatter", "phase");
+      for (row = 0; row < n_active_in_volume; row++) {
+        Dtype *dst = &p_out_feat[out_maps[k][row] * out_nchannel];
+        Dtype *src = &output_buffer[row * out_nchannel];
+        cpu_add<Dtype>(out_nchannel, src, dst, dst);
+      }
     }
   }
 }
 
 template <typename Dtype, typename Itype>
-void ConvolutionBackwardKernelCPU(const Dtype *p_in_feat, Dtype *p_grad_in_feat,
+typename std::enable_if<!is_reduced_precision<Dtype>::value>::type
+ConvolutionBackwardKernelCPU(const Dtype *p_in_feat, Dtype *p_grad_in_feat,
                                   int in_nchannel, const Dtype *p_grad_out_feat,
                                   int out_nchannel, const Dtype *p_kernel,
                                   Dtype *p_grad_kernel,
@@ -101,45 +164,543 @@ void ConvolutionBackwardKernelCPU(const Dtype *p_in_feat, Dtype *p_grad_in_feat,
     output_buffer.resize(n_active_in_volume * out_nchannel);
 
     // Gather all features for a matrix multiplication (im2col)
-    for (row = 0; row < n_active_in_volume; row++)
-      std::memcpy(&output_buffer[row * out_nchannel],
-                  &p_grad_out_feat[out_maps[k][row] * out_nchannel],
-                  sizeof(Dtype) * out_nchannel);
+    {
+      profile_scope const scope("gather", "phase");
+      for (row = 0; row < n_active_in_volume; row++)
+        std::memcpy(&output_buffer[row * out_nchannel],
+                    &p_grad_out_feat[out_maps[k][row] * out_nchannel],
+                    sizeof(Dtype) * out_nchannel);
+    }
 
-    cpu_gemm<Dtype>(CblasColMajor, CblasTrans, CblasNoTrans,
-                    in_nchannel,                               // M
-                    n_active_in_volume,                        // N
-                    out_nchannel,                              // K
-                    1,                                         // alpha
-                    &p_kernel[k * in_nchannel * out_nchannel], // A
-                    &output_buffer[0],                         // B
-                    0,                                         // beta
-                    &input_buffer[0]                           // C
-    );
+    {
+      profile_scope const scope("gemm", "phase");
+      cpu_gemm<Dtype>(CblasColMajor, CblasTrans, CblasNoTrans,
+                      in_nchannel,                               // M
+                      n_active_in_volume,                        // N
+                      out_nchannel,                              // K
+                      1,                                         // alpha
+                      &p_kernel[k * in_nchannel * out_nchannel], // A
+                      &output_buffer[0],                         // B
+                      0,                                         // beta
+                      &input_buffer[0]                           // C
+      );
+    }
 
     // Accumulate gradients back to the input grad feat
-    for (row = 0; row < n_active_in_volume; row++) {
-      Dtype *src = &input_buffer[row * in_nchannel];
-      Dtype *dst = &p_grad_in_feat[in_maps[k][row] * in_nchannel];
-      cpu_add<Dtype>(in_nchannel, src, dst, dst);
+    {
+      profile_scope const scope("scatter", "phase");
+      for (row = 0; row < n_active_in_volume; row++) {
+        Dtype *src = &input_buffer[row * in_nchannel];
+        Dtype *dst = &p_grad_in_feat[in_maps[k][row] * in_nchannel];
+        cpu_add<Dtype>(in_nchannel, src, dst, dst);
+      }
     }
 
     // Compute gradient for kernel
-    for (row = 0; row < n_active_in_volume; row++)
+    {
+      profile_scope const scope("gather", "phase");
+      for (row = 0; row < n_active_in_volume; row++)
+        std::memcpy(&input_buffer[row * in_nchannel],
+                    p_in_feat + in_maps[k][row] * in_nchannel,
+                    sizeof(Dtype) * in_nchannel);
+    }
+
+    {
+      profile_scope const scope("gemm", "phase");
+      cpu_gemm<Dtype>(CblasColMajor, CblasNoTrans, CblasTrans,
+                      out_nchannel,                                  // M
+                      in_nchannel,                                   // N
+                      n_active_in_volume,                            // K
+                      1,                                             // alpha
+                      &output_buffer[0],                             // A
+                      &input_buffer[0],                              // B
+                      1,                                             // beta
+                      &p_grad_kernel[k * in_nchannel * out_nchannel] // C
+      );
+    }
+  }
+}
+
+/**
+ * Weight stationary convolution of several tensors that share the kernel.
+ * For each kernel offset, the rows of all tensors are gathered into one
+ * buffer and multiplied with the kernel slice in a single gemm so that the
+ * slice is loaded once per offset for all tensors.
+ */
+template <typename Dtype, typename Itype>
+typename std::enable_if<!is_reduced_precision<Dtype>::value>::type
+MultiTensorConvolutionForwardKernelCPU(
+    std::vector<Dtype const *> const &p_in_feats, int in_nchannel,
+    std::vector<Dtype *> const &p_out_feats, int out_nchannel,
+    const Dtype *p_kernel,
+    std::vector<cpu_in_maps const *> const &in_maps,
+    std::vector<cpu_out_maps const *> const &out_maps) {
+  int const ntensors = p_in_feats.size();
+  if (ntensors == 0)
+    return;
+  int const kernel_volume = in_maps[0]->size();
+  std::vector<Dtype> input_buffer, output_buffer;
+
+  for (int k = 0; k < kernel_volume; k++) {
+    int64_t n_active_in_volume = 0;
+    for (int t = 0; t < ntensors; ++t)
+      n_active_in_volume += (*in_maps[t])[k].size();
+    if (n_active_in_volume == 0)
+      continue;
+
+    input_buffer.resize(n_active_in_volume * in_nchannel);
+    output_buffer.resize(n_active_in_volume * out_nchannel);
+
+    // Gather the features of all tensors (im2col)
+    int64_t offset = 0;
+    {
+      profile_scope const scope("gather", "phase");
+      for (int t = 0; t < ntensors; ++t) {
+        auto const &in_map = (*in_maps[t])[k];
+        for (int64_t row = 0; row < in_map.size(); row++)
+          std::memcpy(&input_buffer[(offset + row) * in_nchannel],
+                      p_in_feats[t] + in_map[row] * in_nchannel,
+                      sizeof(Dtype) * in_nchannel);
+        offset += in_map.size();
+      }
+    }
+
+    {
+      profile_scope const scope("gemm", "phase");
+      cpu_gemm<Dtype>(CblasColMajor, CblasNoTrans, CblasNoTrans,
+                      out_nchannel,                              // M
+                      n_active_in_volume,                        // N
+                      in_nchannel,                               // K
+                      1,                                         // alpha
+                      &p_kernel[k * in_nchannel * out_nchannel], // A
+                      &input_buffer[0],                          // B
+                      0,                                         // beta
+                      &output_buffer[0]);                        // C
+    }
+
+    // Put it back to the output of each tensor
+    {
+      profile_scope const scope("scatter", "phase");
+      offset = 0;
+      for (int t = 0; t < ntensors; ++t) {
+        auto const &out_map = (*out_maps[t])[k];
+        for (int64_t row = 0; row < out_map.size(); row++) {
+          Dtype *dst = &p_out_feats[t][out_map[row] * out_nchannel];
+          Dtype *src = &output_buffer[(offset + row) * out_nchannel];
+          cpu_add<Dtype>(out_nchannel, src, dst, dst);
+        }
+        offset += out_map.size();
+      }
+    }
+  }
+}
+
+/**
+ * Reduced precision convolution. The features and the kernel are multiplied
+ * with float accumulation. Each thread accumulates the products of all kernel
+ * offsets for a tile of output rows in float and rounds them to Dtype once.
+ */
+template <typename Dtype, typename Itype>
+typename std::enable_if<is_reduced_precision<Dtype>::value>::type
+ConvolutionForwardKernelCPU(const Dtype *p_in_feat, int in_nchannel,
+                            Dtype *p_out_feat, int out_nchannel,
+                            const Dtype *p_kernel, const cpu_in_maps &in_maps,
+                            const cpu_out_maps &out_maps) {
+  using Acc = typename accumulate_type<Dtype>::type;
+  int const kernel_volume = in_maps.size();
+  int64_t const out_nrows = detail::map_nrows(out_maps);
+  cpu_kernel_map_tiles const tiles(out_maps, out_nrows);
+
+#pragma omp parallel
+  {
+    std::vector<Dtype> input_buffer;
+    std::vector<Acc> output_buffer,
+        tile_acc(tiles.tile_nrows * out_nchannel);
+#pragma omp for schedule(dynamic)
+    for (int64_t t = 0; t < tiles.num_tiles; ++t) {
+      int64_t const row_begin = t * tiles.tile_nrows;
+      int64_t const nrows = std::min(tiles.tile_nrows, out_nrows - row_begin);
+      std::fill_n(tile_acc.begin(), nrows * out_nchannel, 0);
+
+      for (int k = 0; k < kernel_volume; k++) {
+        int64_t const pair_begin = tiles.begin(t, k);
+        int const n_active_in_volume = tiles.end(t, k) - pair_begin;
+        if (n_active_in_volume == 0)
+          continue;
+        auto const *p_pairs = &tiles.pairs[pair_begin];
+
+        input_buffer.resize(n_active_in_volume * in_nchannel);
+        output_buffer.resize(n_active_in_volume * out_nchannel);
+
+        for (int row = 0; row < n_active_in_volume; row++)
+          std::memcpy(&input_buffer[row * in_nchannel],
+                      p_in_feat + in_maps[k][p_pairs[row]] * in_nchannel,
+                      sizeof(Dtype) * in_nchannel);
+
+        cpu_gemm_acc<Dtype>(CblasColMajor, CblasNoTrans, CblasNoTrans,
+                            out_nchannel,                              // M
+                            n_active_in_volume,                        // N
+                            in_nchannel,                               // K
+                            1,                                         // alpha
+                            &p_kernel[k * in_nchannel * out_nchannel], // A
+                            &input_buffer[0],                          // B
+                            0,                                         // beta
+                            &output_buffer[0]);                        // C
+
+        for (int row = 0; row < n_active_in_volume; row++) {
+          Acc *dst =
+              &tile_acc[(out_maps[k][p_pairs[row]] - row_begin) * out_nchannel];
+          Acc const *src = &output_buffer[row * out_nchannel];
+#pragma omp simd
+          for (int c = 0; c < out_nchannel; ++c)
+            dst[c] += src[c];
+        }
+      }
+
+      Dtype *p_tile_out = p_out_feat + row_begin * out_nchannel;
+      for (int64_t i = 0; i < nrows * out_nchannel; ++i)
+        p_tile_out[i] = Acc(p_tile_out[i]) + tile_acc[i];
+    }
+  }
+}
+
+/**
+ * Reduced precision convolution gradients. The input gradients are
+ * accumulated for a tile of input rows in float by each thread and the kernel
+ * gradient of each kernel offset in float.
+ */
+template <typename Dtype, typename Itype>
+typename std::enable_if<is_reduced_precision<Dtype>::value>::type
+ConvolutionBackwardKernelCPU(const Dtype *p_in_feat, Dtype *p_grad_in_feat,
+                             int in_nchannel, const Dtype *p_grad_out_feat,
+                             int out_nchannel, const Dtype *p_kernel,
+                             Dtype *p_grad_kernel, const cpu_in_maps &in_maps,
+                             const cpu_out_maps &out_maps) {
+  using Acc = typename accumulate_type<Dtype>::type;
+  int const kernel_volume = in_maps.size();
+  int64_t const in_nrows = detail::map_nrows(in_maps);
+  cpu_kernel_map_tiles const tiles(in_maps, in_nrows);
+
+#pragma omp parallel
+  {
+    std::vector<Dtype> output_buffer;
+    std::vector<Acc> acc_buffer, tile_acc(tiles.tile_nrows * in_nchannel);
+#pragma omp for schedule(dynamic)
+    for (int64_t t = 0; t < tiles.num_tiles; ++t) {
+      int64_t const row_begin = t * tiles.tile_nrows;
+      int64_t const nrows = std::min(tiles.tile_nrows, in_nrows - row_begin);
+      std::fill_n(tile_acc.begin(), nrows * in_nchannel, 0);
+
+      for (int k = 0; k < kernel_volume; k++) {
+        int64_t const pair_begin = tiles.begin(t, k);
+        int const n_active_in_volume = tiles.end(t, k) - pair_begin;
+        if (n_active_in_volume == 0)
+          continue;
+        auto const *p_pairs = &tiles.pairs[pair_begin];
+
+        output_buffer.resize(n_active_in_volume * out_nchannel);
+        acc_buffer.resize(n_active_in_volume * in_nchannel);
+
+        for (int row = 0; row < n_active_in_volume; row++)
+          std::memcpy(&output_buffer[row * out_nchannel],
+                      &p_grad_out_feat[out_maps[k][p_pairs[row]] *
+                                       out_nchannel],
+                      sizeof(Dtype) * out_nchannel);
+
+        cpu_gemm_acc<Dtype>(CblasColMajor, CblasTrans, CblasNoTrans,
+                            in_nchannel,                               // M
+                            n_active_in_volume,                        // N
+                            out_nchannel,                              // K
+                            1,                                         // alpha
+                            &p_kernel[k * in_nchannel * out_nchannel], // A
+                            &output_buffer[0],                         // B
+                            0,                                         // beta
+                            &acc_buffer[0]                             // C
+        );
+
+        for (int row = 0; row < n_active_in_volume; row++) {
+          Acc const *src = &acc_buffer[row * in_nchannel];
+          Acc *dst =
+              &tile_acc[(in_maps[k][p_pairs[row]] - row_begin) * in_nchannel];
+#pragma omp simd
+          for (int c = 0; c < in_nchannel; ++c)
+            dst[c] += src[c];
+        }
+      }
+
+      Dtype *p_tile_grad_in = p_grad_in_feat + row_begin * in_nchannel;
+      for (int64_t i = 0; i < nrows * in_nchannel; ++i)
+        p_tile_grad_in[i] = Acc(p_tile_grad_in[i]) + tile_acc[i];
+    }
+  }
+
+  std::vector<Dtype> input_buffer, output_buffer;
+  std::vector<Acc> grad_kernel_acc(in_nchannel * out_nchannel);
+  for (int k = 0; k < kernel_volume; k++) {
+    int const n_active_in_volume = in_maps[k].size();
+    if (n_active_in_volume == 0)
+      continue;
+
+    input_buffer.resize(n_active_in_volume * in_nchannel);
+    output_buffer.resize(n_active_in_volume * out_nchannel);
+
+    for (int row = 0; row < n_active_in_volume; row++)
+      std::memcpy(&output_buffer[row * out_nchannel],
+                  &p_grad_out_feat[out_maps[k][row] * out_nchannel],
+                  sizeof(Dtype) * out_nchannel);
+
+    for (int row = 0; row < n_active_in_volume; row++)
       std::memcpy(&input_buffer[row * in_nchannel],
                   p_in_feat + in_maps[k][row] * in_nchannel,
                   sizeof(Dtype) * in_nchannel);
 
-    cpu_gemm<Dtype>(CblasColMajor, CblasNoTrans, CblasTrans,
-                    out_nchannel,                                  // M
-                    in_nchannel,                                   // N
-                    n_active_in_volume,                            // K
-                    1,                                             // alpha
-                    &output_buffer[0],                             // A
-                    &input_buffer[0],                              // B
-                    1,                                             // beta
-                    &p_grad_kernel[k * in_nchannel * out_nchannel] // C
+    Dtype *p_curr_grad_kernel = &p_grad_kernel[k * in_nchannel * out_nchannel];
+    std::copy_n(p_curr_grad_kernel, grad_kernel_acc.size(),
+                grad_kernel_acc.begin());
+    cpu_gemm_acc<Dtype>(CblasColMajor, CblasNoTrans, CblasTrans,
+                        out_nchannel,           // M
+                        in_nchannel,            // N
+                        n_active_in_volume,     // K
+                        1,                      // alpha
+                        &output_buffer[0],      // A
+                        &input_buffer[0],       // B
+                        1,                      // beta
+                        &grad_kernel_acc[0]     // C
     );
+    std::copy(grad_kernel_acc.begin(), grad_kernel_acc.end(),
+              p_curr_grad_kernel);
+  }
+}
+
+/**
+ * Reduced precision tensors are convolved one at a time with the float
+ * accumulation of ConvolutionForwardKernelCPU.
+ */
+template <typename Dtype, typename Itype>
+typename std::enable_if<is_reduced_precision<Dtype>::value>::type
+MultiTensorConvolutionForwardKernelCPU(
+    std::vector<Dtype const *> const &p_in_feats, int in_nchannel,
+    std::vector<Dtype *> const &p_out_feats, int out_nchannel,
+    const Dtype *p_kernel,
+    std::vector<cpu_in_maps const *> const &in_maps,
+    std::vector<cpu_out_maps const *> const &out_maps) {
+  for (int t = 0; t < p_in_feats.size(); ++t)
+    ConvolutionForwardKernelCPU<Dtype, Itype>(p_in_feats[t], in_nchannel,
+                                              p_out_feats[t], out_nchannel,
+                                              p_kernel, *in_maps[t],
+                                              *out_maps[t]);
+}
+
+/**
+ * int8 convolution with int32 accumulation. p_in_feat and p_kernel are
+ * symmetric int8 and p_out_feat = sum_k in * kernel * p_scale + p_bias where
+ * p_scale is the product of the input scale and the output channel scale of
+ * the kernel. p_bias can be null.
+ *
+ * The kernel is transposed so that each output is a contiguous dot product.
+ * With AVX-512 VNNI, the input is shifted to uint8 and the shift is removed
+ * with the sum of the kernel weights.
+ */
+template <typename Itype>
+void QuantizedConvolutionForwardKernelCPU(int8_t const *p_in_feat,
+                                          int const in_nchannel,
+                                          float *p_out_feat,
+                                          int const out_nchannel,
+                                          int64_t const out_nrows,
+                                          int8_t const *p_kernel,
+                                          float const *p_scale,
+                                          float const *p_bias,
+                                          cpu_in_maps const &in_maps,
+                                          cpu_out_maps const &out_maps) {
+  int const kernel_volume = in_maps.size();
+  int64_t const kernel_size = int64_t(in_nchannel) * out_nchannel;
+  std::vector<int8_t> kernel_t(kernel_volume * kernel_size);
+  for (int k = 0; k < kernel_volume; ++k)
+    for (int i = 0; i < in_nchannel; ++i)
+      for (int o = 0; o < out_nchannel; ++o)
+        kernel_t[k * kernel_size + o * in_nchannel + i] =
+            p_kernel[k * kernel_size + i * out_nchannel + o];
+
+#ifdef MINKOWSKI_AVX512_VNNI
+  std::vector<int32_t> kernel_shift(kernel_volume * out_nchannel, 0);
+  for (int k = 0; k < kernel_volume; ++k)
+    for (int o = 0; o < out_nchannel; ++o)
+      for (int i = 0; i < in_nchannel; ++i)
+        kernel_shift[k * out_nchannel + o] +=
+            128 * kernel_t[k * kernel_size + o * in_nchannel + i];
+#endif
+
+  std::vector<int32_t> acc(out_nrows * out_nchannel, 0);
+  for (int k = 0; k < kernel_volume; ++k) {
+    int64_t const n_active_in_volume = in_maps[k].size();
+    if (n_active_in_volume == 0)
+      continue;
+    int8_t const *p_curr_kernel = &kernel_t[k * kernel_size];
+
+    // Each output row appears at most once in the map of a kernel offset.
+#pragma omp parallel
+    {
+#ifdef MINKOWSKI_AVX512_VNNI
+      std::vector<uint8_t> in_u8(in_nchannel);
+      int32_t const *p_curr_shift = &kernel_shift[k * out_nchannel];
+#endif
+#pragma omp for
+      for (int64_t row = 0; row < n_active_in_volume; ++row) {
+        int8_t const *p_curr_in = p_in_feat + in_maps[k][row] * in_nchannel;
+        int32_t *p_curr_acc = &acc[out_maps[k][row] * out_nchannel];
+#ifdef MINKOWSKI_AVX512_VNNI
+        for (int i = 0; i < in_nchannel; ++i)
+          in_u8[i] = uint8_t(p_curr_in[i] + 128);
+        for (int o = 0; o < out_nchannel; ++o)
+          p_curr_acc[o] += detail::dot_u8s8(in_u8.data(),
+                                            p_curr_kernel + o * in_nchannel,
+                                            in_nchannel) -
+                           p_curr_shift[o];
+#else
+        for (int o = 0; o < out_nchannel; ++o)
+          p_curr_acc[o] += detail::dot_s8s8(
+              p_curr_in, p_curr_kernel + o * in_nchannel, in_nchannel);
+#endif
+      }
+    }
+  }
+
+#pragma omp parallel for
+  for (int64_t row = 0; row < out_nrows; ++row) {
+    for (int o = 0; o < out_nchannel; ++o)
+      p_out_feat[row * out_nchannel + o] =
+          acc[row * out_nchannel + o] * p_scale[o] +
+          (p_bias != nullptr ? p_bias[o] : 0.f);
+  }
+}
+
+/**
+ * Convolution epilogue. Adds the bias and applies the activation to the
+ * convolution output in place. p_bias can be null. For GELU, the
+ * pre-activation is written to p_pre_feat for the backward.
+ */
+template <typename Dtype>
+void BiasActivationForwardKernelCPU(Dtype *p_out_feat,              //
+                                    Dtype *p_pre_feat,              //
+                                    Dtype const *p_bias,            //
+                                    int64_t const nrows,            //
+                                    int const nchannel,             //
+                                    ActivationType::Type const activation,
+                                    Dtype const negative_slope) {
+  Dtype const inv_sqrt2 = Dtype(M_SQRT1_2);
+#pragma omp parallel for
+  for (int64_t row = 0; row < nrows; ++row) {
+    Dtype *p_curr_out = p_out_feat + row * nchannel;
+    if (p_bias != nullptr) {
+#pragma omp simd
+      for (int c = 0; c < nchannel; ++c)
+        p_curr_out[c] += p_bias[c];
+    }
+
+    switch (activation) {
+    case ActivationType::RELU:
+#pragma omp simd
+      for (int c = 0; c < nchannel; ++c)
+        p_curr_out[c] = p_curr_out[c] > 0 ? p_curr_out[c] : Dtype(0);
+      break;
+    case ActivationType::LEAKY_RELU:
+#pragma omp simd
+      for (int c = 0; c < nchannel; ++c)
+        p_curr_out[c] = p_curr_out[c] > 0
+                            ? p_curr_out[c]
+                            : Dtype(negative_slope * p_curr_out[c]);
+      break;
+    case ActivationType::GELU: {
+      Dtype *p_curr_pre = p_pre_feat + row * nchannel;
+      for (int c = 0; c < nchannel; ++c) {
+        Dtype const x = p_curr_out[c];
+        p_curr_pre[c] = x;
+        p_curr_out[c] = Dtype(0.5) * x * (1 + std::erf(x * inv_sqrt2));
+      }
+    } break;
+    default:
+      break;
+    }
+  }
+}
+
+/**
+ * Gradient of the convolution epilogue. Writes the gradient of the
+ * pre-activation to p_grad_pre_feat and, if p_grad_bias is not null, the
+ * column sum of it to p_grad_bias. ReLU and LeakyReLU use the output and GELU
+ * uses the pre-activation.
+ */
+template <typename Dtype>
+void BiasActivationBackwardKernelCPU(Dtype const *p_grad_out_feat, //
+                                     Dtype const *p_out_feat,      //
+                                     Dtype const *p_pre_feat,      //
+                                     Dtype *p_grad_pre_feat,       //
+                                     Dtype *p_grad_bias,           //
+                                     int64_t const nrows,          //
+                                     int const nchannel,           //
+                                     ActivationType::Type const activation,
+                                     Dtype const negative_slope) {
+  Dtype const inv_sqrt2 = Dtype(M_SQRT1_2);
+  Dtype const inv_sqrt2pi = Dtype(0.5 * M_2_SQRTPI * M_SQRT1_2);
+  int const num_threads = omp_get_max_threads();
+  using Acc = typename accumulate_type<Dtype>::type;
+  std::vector<Acc> thread_grad_bias(
+      p_grad_bias != nullptr ? num_threads * nchannel : 0, 0);
+
+#pragma omp parallel
+  {
+    Acc *p_curr_grad_bias =
+        p_grad_bias != nullptr
+            ? &thread_grad_bias[omp_get_thread_num() * nchannel]
+            : nullptr;
+#pragma omp for
+    for (int64_t row = 0; row < nrows; ++row) {
+      Dtype const *p_curr_grad_out = p_grad_out_feat + row * nchannel;
+      Dtype const *p_curr_out = p_out_feat + row * nchannel;
+      Dtype *p_curr_grad_pre = p_grad_pre_feat + row * nchannel;
+
+      switch (activation) {
+      case ActivationType::RELU:
+#pragma omp simd
+        for (int c = 0; c < nchannel; ++c)
+          p_curr_grad_pre[c] =
+              p_curr_out[c] > 0 ? p_curr_grad_out[c] : Dtype(0);
+        break;
+      case ActivationType::LEAKY_RELU:
+#pragma omp simd
+        for (int c = 0; c < nchannel; ++c)
+          p_curr_grad_pre[c] = p_curr_out[c] > 0
+                                   ? p_curr_grad_out[c]
+                                   : Dtype(negative_slope * p_curr_grad_out[c]);
+        break;
+      case ActivationType::GELU: {
+        Dtype const *p_curr_pre = p_pre_feat + row * nchannel;
+        for (int c = 0; c < nchannel; ++c) {
+          Dtype const x = p_curr_pre[c];
+          Dtype const cdf = Dtype(0.5) * (1 + std::erf(x * inv_sqrt2));
+          Dtype const pdf = inv_sqrt2pi * std::exp(Dtype(-0.5) * x * x);
+          p_curr_grad_pre[c] = p_curr_grad_out[c] * (cdf + x * pdf);
+        }
+      } break;
+      default:
+        std::copy_n(p_curr_grad_out, nchannel, p_curr_grad_pre);
+      }
+
+      if (p_curr_grad_bias != nullptr) {
+#pragma omp simd
+        for (int c = 0; c < nchannel; ++c)
+          p_curr_grad_bias[c] += p_curr_grad_pre[c];
+      }
+    }
+  }
+
+  if (p_grad_bias != nullptr) {
+    for (int c = 0; c < nchannel; ++c) {
+      Acc sum = 0;
+      for (int t = 0; t < num_threads; ++t)
+        sum += thread_grad_bias[t * nchannel + c];
+      p_grad_bias[c] = sum;
+    }
   }
 }
 
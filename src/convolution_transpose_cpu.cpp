@@ -52,6 +52,8 @@ at::Tensor ConvolutionTransposeForwardCPU(
     CoordinateMapKey *p_in_map_key,                    //
     CoordinateMapKey *p_out_map_key,                   //
     cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("ConvolutionTransposeForwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
   ASSERT(in_feat.is_contiguous(), "in_feat must be contiguous");
   ASSERT(kernel.is_contiguous(), "kernel must be contiguous");
 
@@ -96,7 +98,7 @@ at::Tensor ConvolutionTransposeForwardCPU(
     p_out_map_key->set_key(out_key);
   }
 
-  cpu_kernel_map const &in_out =
+  auto const p_in_out =
       p_map_manager->kernel_map(p_in_map_key,            //
                                 p_out_map_key,           //
                                 kernel_size,             //
@@ -106,6 +108,7 @@ at::Tensor ConvolutionTransposeForwardCPU(
                                 offset,                  //
                                 true /* is_transpose */, //
                                 false /* is_pool */);
+  cpu_kernel_map const &in_out = *p_in_out;
 
   auto const out_nrows = p_map_manager->size(p_out_map_key->get_key());
   at::Tensor out_feat =
@@ -113,8 +116,9 @@ at::Tensor ConvolutionTransposeForwardCPU(
   LOG_DEBUG("In feat:", in_feat.size(0), "x", in_feat.size(1), "-> out feat",
             out_feat.size(0), "x", out_feat.size(1));
 
-  AT_DISPATCH_FLOATING_TYPES(
-      in_feat.scalar_type(), "convolution_transpose_forward_cpu", [&] {
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      at::ScalarType::BFloat16, at::ScalarType::Half, in_feat.scalar_type(),
+      "convolution_transpose_forward_cpu", [&] {
         ConvolutionForwardKernelCPU<scalar_t, default_types::index_type>(
             in_feat.template data_ptr<scalar_t>(), in_feat.size(1),
             out_feat.template data_ptr<scalar_t>(), out_feat.size(1),
@@ -137,6 +141,8 @@ std::pair<at::Tensor, at::Tensor> ConvolutionTransposeBackwardCPU(
     CoordinateMapKey *p_in_map_key,                    //
     CoordinateMapKey *p_out_map_key,                   //
     cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("ConvolutionTransposeBackwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
 
   ASSERT(in_feat.is_contiguous(), "in_feat must be contiguous");
   ASSERT(grad_out_feat.is_contiguous(), "grad_out_feat must be contiguous");
@@ -161,7 +167,7 @@ std::pair<at::Tensor, at::Tensor> ConvolutionTransposeBackwardCPU(
   coordinate_map_key_type out_key = p_out_map_key->get_key();
   ASSERT(p_map_manager->exists(out_key), ERROR_MAP_NOT_FOUND);
 
-  cpu_kernel_map const &in_out = p_map_manager->kernel_map(
+  auto const p_in_out = p_map_manager->kernel_map(
       p_in_map_key,    //
       p_out_map_key,   //
       kernel_size,     //
@@ -169,14 +175,16 @@ std::pair<at::Tensor, at::Tensor> ConvolutionTransposeBackwardCPU(
       kernel_dilation, //
       region_type,     //
       offset, true /* is_transpose */, false /* is_pool */);
+  cpu_kernel_map const &in_out = *p_in_out;
 
   at::Tensor grad_in_feat =
       torch::zeros({in_feat.size(0), in_feat.size(1)}, in_feat.options());
   at::Tensor grad_kernel = torch::zeros(
       {kernel.size(0), kernel.size(1), kernel.size(2)}, kernel.options());
 
-  AT_DISPATCH_FLOATING_TYPES(
-      in_feat.scalar_type(), "convolution_transpose_backward_cpu", [&] {
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      at::ScalarType::BFloat16, at::ScalarType::Half, in_feat.scalar_type(),
+      "convolution_transpose_backward_cpu", [&] {
         ConvolutionBackwardKernelCPU<scalar_t, default_types::index_type>(
             in_feat.template data_ptr<scalar_t>(),                       //
             grad_in_feat.template data_ptr<scalar_t>(), in_feat.size(1), //
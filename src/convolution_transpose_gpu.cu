@@ -109,15 +109,16 @@ at::Tensor ConvolutionTransposeForwardGPU(
     p_out_map_key->set_key(out_key);
   }
 
-  auto const &in_out = p_map_manager->kernel_map(p_in_map_key,            //
-                                                 p_out_map_key,           //
-                                                 kernel_size,             //
-                                                 kernel_stride,           //
-                                                 kernel_dilation,         //
-                                                 region_type,             //
-                                                 offset,                  //
-                                                 true /* is_transpose */, //
-                                                 false /* is_pool */);
+  auto const p_in_out = p_map_manager->kernel_map(p_in_map_key,            //
+                                                  p_out_map_key,           //
+                                                  kernel_size,             //
+                                                  kernel_stride,           //
+                                                  kernel_dilation,         //
+                                                  region_type,             //
+                                                  offset,                  //
+                                                  true /* is_transpose */, //
+                                                  false /* is_pool */);
+  auto const &in_out = *p_in_out;
 
 #ifdef DEBUG
   LOG_DEBUG("Transposed kernel map in_maps:",
@@ -196,7 +197,7 @@ std::pair<at::Tensor, at::Tensor> ConvolutionTransposeBackwardGPU(
   coordinate_map_key_type out_key = p_out_map_key->get_key();
   ASSERT(p_map_manager->exists(out_key), ERROR_MAP_NOT_FOUND);
 
-  auto const &in_out = p_map_manager->kernel_map(
+  auto const p_in_out = p_map_manager->kernel_map(
       p_in_map_key,    //
       p_out_map_key,   //
       kernel_size,     //
@@ -204,6 +205,7 @@ std::pair<at::Tensor, at::Tensor> ConvolutionTransposeBackwardGPU(
       kernel_dilation, //
       region_type,     //
       offset, true /* is_transpose */, false /* is_pool */);
+  auto const &in_out = *p_in_out;
 
   at::Tensor grad_in_feat =
       torch::zeros({in_feat.size(0), in_feat.size(1)}, in_feat.options());
@@ -28,9 +28,13 @@
 #include "coordinate_map.hpp"
 #include "kernel_map.hpp"
 #include "kernel_region.hpp"
+#include <atomic>
+#include <limits>
+#include <mutex>
 #include <numeric>
 #include <omp.h>
 #include <torch/extension.h>
+#include <unordered_map>
 
 namespace minkowski {
 
@@ -47,6 +51,49 @@ bool is_coordinate_aligned(coordinate<coordinate_type> const &point,
   return true;
 }
 
+// Number of tensor field points quantized at once per thread.
+constexpr uint32_t TFIELD_BLOCK_SIZE = 256;
+
+/*
+ * Quantize a block of tensor field points to the tensor stride. The batch
+ * index is rounded and the spatial coordinates are floored to the multiple of
+ * the tensor stride.
+ *
+ * The coordinates are written in the row major order. If p_offset is not
+ * null, the normalized offset (x - floor) / tensor_stride of each spatial
+ * coordinate is written in the axis major order, p_offset[(j - 1) *
+ * TFIELD_BLOCK_SIZE + i].
+ */
+template <typename coordinate_type, typename Dtype>
+void floor_to_stride(Dtype const *const p_tfield,         //
+                     uint32_t const num_points,            //
+                     uint32_t const coordinate_size,       //
+                     default_types::stride_type const &tensor_stride, //
+                     coordinate_type *p_coordinate,        //
+                     Dtype *p_offset) {
+  for (uint32_t i = 0; i < num_points; ++i)
+    p_coordinate[i * coordinate_size] =
+        std::lround(p_tfield[i * coordinate_size]);
+
+  for (uint32_t j = 1; j < coordinate_size; ++j) {
+    Dtype const curr_tensor_stride = tensor_stride[j - 1];
+    Dtype const inv_tensor_stride = Dtype(1) / curr_tensor_stride;
+#pragma omp simd
+    for (uint32_t i = 0; i < num_points; ++i) {
+      Dtype const x = p_tfield[i * coordinate_size + j];
+      Dtype q = std::floor(x * inv_tensor_stride);
+      // correct the rounding error of the reciprocal
+      q += Dtype((q + 1) * curr_tensor_stride <= x);
+      q -= Dtype(q * curr_tensor_stride > x);
+      Dtype const lb = q * curr_tensor_stride;
+      p_coordinate[i * coordinate_size + j] = static_cast<coordinate_type>(lb);
+      if (p_offset != nullptr)
+        p_offset[(j - 1) * TFIELD_BLOCK_SIZE + i] =
+            (x - lb) * inv_tensor_stride;
+    }
+  }
+}
+
 template <typename coordinate_type, typename Dtype, typename MapType>
 std::pair<at::Tensor, at::Tensor>
 field_map_kernel(uint32_t const num_tfield,      //
@@ -54,20 +101,6 @@ field_map_kernel(uint32_t const num_tfield,      //
                  Dtype const *const p_tfield,    //
                  MapType const &in_map,          //
                  default_types::stride_type const &tensor_stride) {
-  constexpr bool is_float32 = std::is_same<Dtype, float>::value;
-  at::ScalarType const float_type =
-      is_float32 ? at::ScalarType::Float : at::ScalarType::Double;
-
-  cpu_in_maps in_maps = initialize_maps<cpu_in_map>(1, num_tfield);
-  cpu_out_maps out_maps = initialize_maps<cpu_out_map>(1, num_tfield);
-
-  uint32_t num_used{0};
-
-  // OMP
-  // size_t stride = max((size_t)100, numElements / (2 *
-  // omp_get_max_threads())); size_t N = (numElements + stride - 1) /
-  // stride;
-
   // compute the chunk size per thread.
   // There's a trade-off between the thread initialization overhead and
   // the job sizes. If some jobs finish earlier than others due to
@@ -76,65 +109,65 @@ field_map_kernel(uint32_t const num_tfield,      //
   const size_t stride = (num_tfield + N - 1) / N;
   LOG_DEBUG("kernel map with", N, "chunks and", stride, "stride.");
 
+  // First pass: each chunk collects its matches without synchronization.
+  cpu_in_maps in_maps(N);
+  cpu_out_maps out_maps(N);
+
 #pragma omp parallel for
   for (uint32_t n = 0; n < N; n++) {
     // temporary variables for each thread
-    std::vector<coordinate_type> curr_vec(coordinate_size);
-    coordinate<coordinate_type> curr_coordinate(curr_vec.data());
-    uint32_t curr_index_begin;
-
-    for (auto i = stride * n;
-         i < std::min<uint64_t>((n + 1) * stride, uint64_t(num_tfield)); ++i) {
-
-      // batch index
-      curr_vec[0] = std::lroundf(p_tfield[i * coordinate_size]);
-      for (uint32_t j = 1; j < coordinate_size; ++j) {
-        auto const curr_tensor_stride = tensor_stride[j - 1];
-        curr_vec[j] =
-            curr_tensor_stride *
-            std::floor(p_tfield[coordinate_size * i + j] / curr_tensor_stride);
-      }
-
-      const auto iter_in = in_map.find(curr_coordinate);
-      // LOG_DEBUG(kernel_ind, ":",
-      //           PtrToString(iter_out->first.data(),
-      //           coordinate_size),
-      //           "->", PtrToString(point.data(),
-      //           coordinate_size));
-      if (iter_in != in_map.end()) {
-#pragma omp atomic capture
-        {
-          curr_index_begin = num_used;
-          num_used += 1;
+    std::vector<coordinate_type> block(TFIELD_BLOCK_SIZE * coordinate_size);
+    auto &curr_in_map = in_maps[n];
+    auto &curr_out_map = out_maps[n];
+
+    uint64_t const end = std::min<uint64_t>((n + 1) * stride, num_tfield);
+    for (uint64_t begin = stride * n; begin < end;
+         begin += TFIELD_BLOCK_SIZE) {
+      uint32_t const block_size =
+          std::min<uint64_t>(TFIELD_BLOCK_SIZE, end - begin);
+      floor_to_stride<coordinate_type, Dtype>(
+          p_tfield + begin * coordinate_size, block_size, coordinate_size,
+          tensor_stride, block.data(), nullptr);
+
+      for (uint32_t k = 0; k < block_size; ++k) {
+        coordinate<coordinate_type> curr_coordinate(&block[k *
+                                                           coordinate_size]);
+        const auto iter_in = in_map.find(curr_coordinate);
+        if (iter_in != in_map.end()) {
+          curr_in_map.push_back(iter_in->second);
+          curr_out_map.push_back(begin + k);
         }
-        // Ensure that in_maps and out_maps are resized accordingly
-        in_maps[0][curr_index_begin] = iter_in->second;
-        out_maps[0][curr_index_begin] = i;
-        // LOG_DEBUG(kernel_ind, ":",
-        //           PtrToString(iter_in->first.data(),
-        //           coordinate_size),
-        //           "->",
-        //           PtrToString(iter_out->first.data(),
-        //           coordinate_size));
       }
     }
   }
 
+  // Second pass: copy the chunks to the exact size maps.
+  std::vector<int64_t> offsets(N + 1, 0);
+  for (uint32_t n = 0; n < N; ++n)
+    offsets[n + 1] = offsets[n] + in_maps[n].size();
+
   auto final_in_map = torch::empty(
-      {num_used},
+      {offsets[N]},
       torch::TensorOptions().dtype(torch::kInt32).requires_grad(false));
   auto final_out_map = torch::empty(
-      {num_used},
+      {offsets[N]},
       torch::TensorOptions().dtype(torch::kInt32).requires_grad(false));
+  int *p_in_map = final_in_map.template data_ptr<int>();
+  int *p_out_map = final_out_map.template data_ptr<int>();
 
-  std::copy_n(in_maps[0].data(), num_used,
-              final_in_map.template data_ptr<int>());
-  std::copy_n(out_maps[0].data(), num_used,
-              final_out_map.template data_ptr<int>());
+#pragma omp parallel for
+  for (uint32_t n = 0; n < N; n++) {
+    std::copy(in_maps[n].begin(), in_maps[n].end(), p_in_map + offsets[n]);
+    std::copy(out_maps[n].begin(), out_maps[n].end(), p_out_map + offsets[n]);
+  }
 
   return std::make_pair(final_in_map, final_out_map);
 }
 
+/*
+ * Returns the in map, out map, and weights of the multilinear interpolation.
+ * The maps are sorted by the tensor field index (out map).
+ */
 template <typename coordinate_type, typename Dtype, typename MapType>
 std::vector<at::Tensor> interpolation_map_weight_kernel(
     uint32_t const num_tfield,      //
@@ -148,22 +181,6 @@ std::vector<at::Tensor> interpolation_map_weight_kernel(
   uint32_t const neighbor_volume = std::pow(2, (coordinate_size - 1));
   LOG_DEBUG("neighbor_volume :", neighbor_volume, "num_tfield:", num_tfield);
 
-  cpu_in_maps in_maps =
-      initialize_maps<cpu_in_map>(neighbor_volume, num_tfield);
-  cpu_out_maps out_maps =
-      initialize_maps<cpu_out_map>(neighbor_volume, num_tfield);
-
-  std::vector<std::vector<Dtype>> weights =
-      initialize_maps<std::vector<Dtype>>(neighbor_volume, num_tfield);
-
-  std::vector<uint32_t> num_used(neighbor_volume);
-  std::for_each(num_used.begin(), num_used.end(), [](auto &i) { i = 0; });
-
-  // OMP
-  // size_t stride = max((size_t)100, numElements / (2 *
-  // omp_get_max_threads())); size_t N = (numElements + stride - 1) /
-  // stride;
-
   // compute the chunk size per thread.
   // There's a trade-off between the thread initialization overhead and
   // the job sizes. If some jobs finish earlier than others due to
@@ -172,106 +189,396 @@ std::vector<at::Tensor> interpolation_map_weight_kernel(
   const size_t stride = (num_tfield + N - 1) / N;
   LOG_DEBUG("kernel map with", N, "chunks and", stride, "stride.");
 
+  // First pass: each chunk collects its matches without synchronization.
+  cpu_in_maps in_maps(N);
+  cpu_out_maps out_maps(N);
+  std::vector<std::vector<Dtype>> weights(N);
+
 #pragma omp parallel for
   for (uint32_t n = 0; n < N; n++) {
     // temporary variables for each thread
-    std::vector<coordinate_type> curr_vec(coordinate_size), lb(coordinate_size),
-        ub(coordinate_size);
+    std::vector<coordinate_type> block(TFIELD_BLOCK_SIZE * coordinate_size),
+        curr_vec(coordinate_size);
+    std::vector<Dtype> offset(TFIELD_BLOCK_SIZE * (coordinate_size - 1)),
+        corner_weights(TFIELD_BLOCK_SIZE * neighbor_volume);
     coordinate<coordinate_type> curr_coordinate(curr_vec.data());
-    uint32_t curr_index_begin;
-
-    for (auto i = stride * n;
-         i < std::min<uint64_t>((n + 1) * stride, uint64_t(num_tfield)); ++i) {
-
-      // batch index
-      curr_vec[0] = std::lroundf(p_tfield[i * coordinate_size]);
-      for (uint32_t j = 1; j < coordinate_size; ++j) {
-        auto const curr_tensor_stride = tensor_stride[j - 1];
-        lb[j] =
-            curr_tensor_stride *
-            std::floor(p_tfield[coordinate_size * i + j] / curr_tensor_stride);
-        ub[j] = lb[j] + curr_tensor_stride;
-        curr_vec[j] = lb[j];
-      }
-
-      // For elements in the current region
+    auto &curr_in_map = in_maps[n];
+    auto &curr_out_map = out_maps[n];
+    auto &curr_weights = weights[n];
+
+    uint64_t const end = std::min<uint64_t>((n + 1) * stride, num_tfield);
+    for (uint64_t begin = stride * n; begin < end;
+         begin += TFIELD_BLOCK_SIZE) {
+      uint32_t const block_size =
+          std::min<uint64_t>(TFIELD_BLOCK_SIZE, end - begin);
+      floor_to_stride<coordinate_type, Dtype>(
+          p_tfield + begin * coordinate_size, block_size, coordinate_size,
+          tensor_stride, block.data(), offset.data());
+
+      // Weights of all corners. The lower corner has the weight 1 - offset
+      // and the upper corner has the weight offset along each axis.
       for (uint32_t neighbor_ind = 0; neighbor_ind < neighbor_volume;
            ++neighbor_ind) {
-
+        Dtype *p_weight = &corner_weights[neighbor_ind * TFIELD_BLOCK_SIZE];
+        std::fill_n(p_weight, block_size, Dtype(1));
         uint32_t mask = 1;
         for (uint32_t j = coordinate_size - 1; j > 0; --j) {
-          if ((neighbor_ind & mask) == 0)
-            curr_vec[j] = lb[j];
-          else
-            curr_vec[j] = ub[j];
+          Dtype const *p_offset = &offset[(j - 1) * TFIELD_BLOCK_SIZE];
+          if ((neighbor_ind & mask) == 0) {
+#pragma omp simd
+            for (uint32_t k = 0; k < block_size; ++k)
+              p_weight[k] *= 1 - p_offset[k];
+          } else {
+#pragma omp simd
+            for (uint32_t k = 0; k < block_size; ++k)
+              p_weight[k] *= p_offset[k];
+          }
           mask = mask << 1;
         }
+      }
 
-        const auto iter_in = in_map.find(curr_coordinate);
-        // LOG_DEBUG(kernel_ind, ":",
-        //           PtrToString(iter_out->first.data(),
-        //           coordinate_size),
-        //           "->", PtrToString(point.data(),
-        //           coordinate_size));
-        if (iter_in != in_map.end()) {
-#pragma omp atomic capture
-          {
-            curr_index_begin = num_used[neighbor_ind];
-            num_used[neighbor_ind] += 1;
-          }
-          // Compute weights
-          Dtype weight = 1.0;
-          for (uint32_t j = 1; j < coordinate_size; ++j) {
-            weight *=
-                1 - std::abs(p_tfield[coordinate_size * i + j] - curr_vec[j]) /
-                        tensor_stride[j - 1];
+      for (uint32_t k = 0; k < block_size; ++k) {
+        coordinate_type const *lb = &block[k * coordinate_size];
+        curr_vec[0] = lb[0];
+        // For elements in the current region
+        for (uint32_t neighbor_ind = 0; neighbor_ind < neighbor_volume;
+             ++neighbor_ind) {
+          uint32_t mask = 1;
+          for (uint32_t j = coordinate_size - 1; j > 0; --j) {
+            curr_vec[j] =
+                (neighbor_ind & mask) == 0 ? lb[j] : lb[j] + tensor_stride[j - 1];
+            mask = mask << 1;
           }
 
-          // Ensure that in_maps and out_maps are resized accordingly
-          in_maps[neighbor_ind][curr_index_begin] = iter_in->second;
-          out_maps[neighbor_ind][curr_index_begin] = i;
-          weights[neighbor_ind][curr_index_begin] = weight;
-          // LOG_DEBUG(kernel_ind, ":",
-          //           PtrToString(iter_in->first.data(),
-          //           coordinate_size),
-          //           "->",
-          //           PtrToString(iter_out->first.data(),
-          //           coordinate_size));
+          const auto iter_in = in_map.find(curr_coordinate);
+          if (iter_in != in_map.end()) {
+            curr_in_map.push_back(iter_in->second);
+            curr_out_map.push_back(begin + k);
+            curr_weights.push_back(
+                corner_weights[neighbor_ind * TFIELD_BLOCK_SIZE + k]);
+          }
         }
       }
     }
   }
 
-  auto const total_num_used =
-      std::accumulate(num_used.begin(), num_used.end(), 0);
+  // Second pass: copy the chunks to the exact size maps.
+  std::vector<int64_t> offsets(N + 1, 0);
+  for (uint32_t n = 0; n < N; ++n)
+    offsets[n + 1] = offsets[n] + in_maps[n].size();
+  LOG_DEBUG("interpolation map size:", offsets[N]);
 
   auto final_in_map = torch::empty(
-      {total_num_used},
+      {offsets[N]},
       torch::TensorOptions().dtype(torch::kInt32).requires_grad(false));
   auto final_out_map = torch::empty(
-      {total_num_used},
+      {offsets[N]},
       torch::TensorOptions().dtype(torch::kInt32).requires_grad(false));
   auto final_weights = torch::empty(
-      {total_num_used},
+      {offsets[N]},
       torch::TensorOptions().dtype(float_type).requires_grad(false));
+  int *p_in_map = final_in_map.template data_ptr<int>();
+  int *p_out_map = final_out_map.template data_ptr<int>();
+  Dtype *p_weights = final_weights.template data_ptr<Dtype>();
 
-  uint32_t final_begin = 0;
-  for (uint32_t i = 0; i < neighbor_volume; ++i) {
-    uint32_t const max_num = num_used[i];
-    LOG_DEBUG("kernel index", i, "size:", max_num);
+#pragma omp parallel for
+  for (uint32_t n = 0; n < N; n++) {
+    std::copy(in_maps[n].begin(), in_maps[n].end(), p_in_map + offsets[n]);
+    std::copy(out_maps[n].begin(), out_maps[n].end(), p_out_map + offsets[n]);
+    std::copy(weights[n].begin(), weights[n].end(), p_weights + offsets[n]);
+  }
+  return {final_in_map, final_out_map, final_weights};
+}
 
-    std::copy_n(in_maps[i].data(), max_num,
-                &final_in_map.template data_ptr<int>()[final_begin]);
-    std::copy_n(out_maps[i].data(), max_num,
-                &final_out_map.template data_ptr<int>()[final_begin]);
-    std::copy_n(weights[i].data(), max_num,
-                final_weights.template data_ptr<Dtype>() + final_begin);
+/*
+ * Returns (row_ptr, rows, distances) of the occupied coordinates near each
+ * query point. The neighbors of the query i are rows[row_ptr[i]:row_ptr[i +
+ * 1]] in the ascending distance.
+ *
+ * If k > 0, the neighbors are the k nearest coordinates within the radius, or
+ * within the batch if the radius is 0. Otherwise, the neighbors are all
+ * coordinates within the radius. The coordinates are visited in the shells of
+ * the grid of the tensor stride around the query, up to the shell that covers
+ * the bounding box of the batch of the query, and the k nearest search stops
+ * once no coordinate in the next shell can be closer. Only the faces of each
+ * shell are probed.
+ *
+ * batch_bounds maps a batch index to the D-dimensional min coordinate
+ * followed by the max coordinate of the batch.
+ */
+template <typename coordinate_type, typename Dtype, typename MapType>
+std::vector<at::Tensor>
+neighbor_search_kernel(uint32_t const num_query,                        //
+                       uint32_t const coordinate_size,                  //
+                       Dtype const *const p_query,                      //
+                       MapType const &in_map,                           //
+                       default_types::stride_type const &tensor_stride, //
+                       std::unordered_map<coordinate_type,
+                                          std::vector<coordinate_type>> const
+                           &batch_bounds,
+                       Dtype const radius, uint32_t const k,
+                       bool const is_l2) {
+  using neighbor_type = std::pair<Dtype, default_types::index_type>;
+  constexpr bool is_float32 = std::is_same<Dtype, float>::value;
+  at::ScalarType const float_type =
+      is_float32 ? at::ScalarType::Float : at::ScalarType::Double;
+  uint32_t const ndim = coordinate_size - 1;
+  coordinate_type const min_tensor_stride =
+      *std::min_element(tensor_stride.begin(), tensor_stride.end());
+
+  std::vector<std::vector<neighbor_type>> neighbors(num_query);
+#pragma omp parallel
+  {
+    std::vector<coordinate_type> base(coordinate_size), curr(coordinate_size);
+    std::vector<int64_t> offset(ndim), lower(ndim), upper(ndim);
+    coordinate<coordinate_type> curr_coordinate(curr.data());
+#pragma omp for schedule(dynamic, 64)
+    for (int64_t i = 0; i < num_query; ++i) {
+      Dtype const *p_curr_query = p_query + i * coordinate_size;
+      base[0] = curr[0] = std::lround(p_curr_query[0]);
+      auto const bounds_it = batch_bounds.find(base[0]);
+      if (bounds_it == batch_bounds.end())
+        continue;
+      auto const &bounds = bounds_it->second;
+
+      // The shells that may have a coordinate of the batch within the radius
+      int64_t max_shell = 0;
+      for (uint32_t j = 0; j < ndim; ++j) {
+        base[j + 1] = tensor_stride[j] *
+                      std::floor(p_curr_query[j + 1] / tensor_stride[j]);
+        int64_t shell = std::max<int64_t>(base[j + 1] - bounds[j],
+                                          bounds[ndim + j] - base[j + 1]) /
+                        tensor_stride[j];
+        if (radius > 0)
+          shell = std::min<int64_t>(shell, radius / tensor_stride[j] + 1);
+        max_shell = std::max(max_shell, shell);
+      }
 
-    final_begin += max_num;
+      // A max heap of the k nearest neighbors if k > 0
+      auto &curr_neighbors = neighbors[i];
+      auto const probe = [&]() {
+        for (uint32_t j = 0; j < ndim; ++j)
+          curr[j + 1] = base[j + 1] + offset[j] * tensor_stride[j];
+        auto const iter = in_map.find(curr_coordinate);
+        if (iter == in_map.end())
+          return;
+        Dtype distance = 0;
+        for (uint32_t j = 0; j < ndim; ++j) {
+          Dtype const diff = curr[j + 1] - p_curr_query[j + 1];
+          distance = is_l2 ? distance + diff * diff
+                           : std::max(distance, std::abs(diff));
+        }
+        if (is_l2)
+          distance = std::sqrt(distance);
+        if (radius > 0 && distance > radius)
+          return;
+        curr_neighbors.emplace_back(distance, iter->second);
+        if (k > 0) {
+          std::push_heap(curr_neighbors.begin(), curr_neighbors.end());
+          if (curr_neighbors.size() > k) {
+            std::pop_heap(curr_neighbors.begin(), curr_neighbors.end());
+            curr_neighbors.pop_back();
+          }
+        }
+      };
+
+      // The offsets with the max norm equal to shell. The face offsets have
+      // +-shell at the face dimension, the inner range at the dimensions
+      // before it and the full range after it, so each offset is probed once.
+      auto const visit = [&](int64_t const shell) {
+        if (shell == 0) {
+          std::fill(offset.begin(), offset.end(), 0);
+          probe();
+          return;
+        }
+        for (uint32_t face = 0; face < ndim; ++face) {
+          for (int64_t const side : {-shell, shell}) {
+            for (uint32_t j = 0; j < ndim; ++j) {
+              lower[j] = j < face ? 1 - shell : j == face ? side : -shell;
+              upper[j] = j < face ? shell - 1 : j == face ? side : shell;
+            }
+            offset = lower;
+            while (true) {
+              probe();
+              // next offset on the face
+              uint32_t j = 0;
+              for (; j < ndim && offset[j] == upper[j]; ++j)
+                offset[j] = lower[j];
+              if (j == ndim)
+                break;
+              ++offset[j];
+            }
+          }
+        }
+      };
+
+      for (int64_t shell = 0; shell <= max_shell; ++shell) {
+        visit(shell);
+        // The coordinates in the next shell are at least shell * stride away
+        if (k > 0 && curr_neighbors.size() == k &&
+            curr_neighbors.front().first <= shell * min_tensor_stride)
+          break;
+      }
+      std::sort(curr_neighbors.begin(), curr_neighbors.end());
+    }
   }
-  return {final_in_map, final_out_map, final_weights};
+
+  auto options =
+      torch::TensorOptions().dtype(torch::kInt64).requires_grad(false);
+  at::Tensor row_ptr = torch::empty({(int64_t)num_query + 1}, options);
+  int64_t *p_row_ptr = row_ptr.template data_ptr<int64_t>();
+  p_row_ptr[0] = 0;
+  for (uint32_t i = 0; i < num_query; ++i)
+    p_row_ptr[i + 1] = p_row_ptr[i] + neighbors[i].size();
+
+  at::Tensor rows = torch::empty({p_row_ptr[num_query]}, options);
+  at::Tensor distances = torch::empty(
+      {p_row_ptr[num_query]},
+      torch::TensorOptions().dtype(float_type).requires_grad(false));
+  int64_t *p_rows = rows.template data_ptr<int64_t>();
+  Dtype *p_distances = distances.template data_ptr<Dtype>();
+#pragma omp parallel for
+  for (int64_t i = 0; i < num_query; ++i) {
+    int64_t n = p_row_ptr[i];
+    for (auto const &neighbor : neighbors[i]) {
+      p_distances[n] = neighbor.first;
+      p_rows[n++] = neighbor.second;
+    }
+  }
+  return {row_ptr, rows, distances};
+}
+
+/*
+ * Origin row of each row from the batch index in the first column of
+ * p_coordinate. The origin rows are read from a table over the batch index
+ * range of the origin map, or from the origin hash map if the range is sparse.
+ */
+template <typename coordinate_type, typename src_coordinate_type,
+          typename OriginMapType>
+std::vector<default_types::index_type>
+origin_rows(src_coordinate_type const *const p_coordinate, //
+            int64_t const nrows,                           //
+            uint32_t const coordinate_size,                //
+            OriginMapType const &origin_map) {
+  using index_type = default_types::index_type;
+  index_type const invalid_row = std::numeric_limits<index_type>::max();
+  index_type const out_size = origin_map.size();
+  coordinate_type const *p_origin = origin_map.const_coordinate_data();
+
+  int64_t min_batch_index = std::numeric_limits<int64_t>::max(),
+          max_batch_index = std::numeric_limits<int64_t>::min();
+  for (index_type k = 0; k < out_size; ++k) {
+    min_batch_index = std::min<int64_t>(min_batch_index,
+                                        p_origin[k * coordinate_size]);
+    max_batch_index = std::max<int64_t>(max_batch_index,
+                                        p_origin[k * coordinate_size]);
+  }
+
+  bool const use_table =
+      out_size > 0 && max_batch_index - min_batch_index < nrows + out_size;
+  std::vector<index_type> table;
+  if (use_table) {
+    table.assign(max_batch_index - min_batch_index + 1, invalid_row);
+    for (index_type k = 0; k < out_size; ++k)
+      table[p_origin[k * coordinate_size] - min_batch_index] = k;
+  }
+
+  std::vector<index_type> out_rows(nrows);
+  int64_t num_invalid = 0;
+#pragma omp parallel
+  {
+    std::vector<coordinate_type> dst(coordinate_size, 0);
+#pragma omp for reduction(+ : num_invalid)
+    for (int64_t i = 0; i < nrows; ++i) {
+      coordinate_type const b = p_coordinate[i * coordinate_size];
+      index_type row = invalid_row;
+      if (use_table) {
+        if (b >= min_batch_index && b <= max_batch_index)
+          row = table[b - min_batch_index];
+      } else {
+        dst[0] = b;
+        auto const iter_origin =
+            origin_map.find(coordinate<coordinate_type>(dst.data()));
+        if (iter_origin != origin_map.cend())
+          row = iter_origin->second;
+      }
+      num_invalid += row == invalid_row;
+      out_rows[i] = row;
+    }
+  }
+  ASSERT(num_invalid == 0, "Invalid origin_coordinate_map");
+  return out_rows;
+}
+
+// Position of a point with ndim coordinates in [0, 2^bits) on the Z-order
+// curve.
+inline uint64_t morton_code(uint64_t const *x, uint32_t const ndim,
+                            uint32_t const bits) {
+  uint64_t code = 0;
+  for (int32_t b = bits - 1; b >= 0; --b)
+    for (uint32_t i = 0; i < ndim; ++i)
+      code = (code << 1) | ((x[i] >> b) & 1);
+  return code;
+}
+
+// Position of a point with ndim coordinates in [0, 2^bits) on the Hilbert
+// curve. x is overwritten. J. Skilling, "Programming the Hilbert curve", AIP
+// Conference Proceedings 707, 2004.
+inline uint64_t hilbert_code(uint64_t *x, uint32_t const ndim,
+                             uint32_t const bits) {
+  if (bits == 0)
+    return 0;
+  uint64_t const M = uint64_t(1) << (bits - 1);
+  // Inverse undo
+  for (uint64_t Q = M; Q > 1; Q >>= 1) {
+    uint64_t const P = Q - 1;
+    for (uint32_t i = 0; i < ndim; ++i) {
+      if (x[i] & Q) {
+        x[0] ^= P;
+      } else {
+        uint64_t const t = (x[0] ^ x[i]) & P;
+        x[0] ^= t;
+        x[i] ^= t;
+      }
+    }
+  }
+  // Gray encode
+  for (uint32_t i = 1; i < ndim; ++i)
+    x[i] ^= x[i - 1];
+  uint64_t t = 0;
+  for (uint64_t Q = M; Q > 1; Q >>= 1)
+    if (x[ndim - 1] & Q)
+      t ^= Q - 1;
+  for (uint32_t i = 0; i < ndim; ++i)
+    x[i] ^= t;
+  // The bits of the transposed index interleave as the Z-order
+  return morton_code(x, ndim, bits);
 }
 
+/*
+ * Lazily built batch row index of a coordinate map. The index is built once
+ * under the mutex, so the threads sharing a map can request it concurrently.
+ * A copy starts empty.
+ */
+struct batch_row_index_cache {
+  using indices_type = std::pair<std::vector<int64_t>, std::vector<int64_t>>;
+
+  batch_row_index_cache() = default;
+  batch_row_index_cache(batch_row_index_cache const &) {}
+  batch_row_index_cache &operator=(batch_row_index_cache const &) {
+    reset();
+    return *this;
+  }
+
+  // Called by the mutating methods of the map, which require exclusive
+  // access to the map.
+  void reset() noexcept { valid.store(false, std::memory_order_relaxed); }
+
+  std::atomic<bool> valid{false};
+  std::mutex mutex;
+  indices_type indices;
+};
+
 } // namespace detail
 
 /*
@@ -563,6 +870,241 @@ public:
     return merged_map;
   }
 
+  /*
+   * @brief reorder the rows by the batch index and then along a space filling
+   * curve so that the rows of the nearby coordinates are close.
+   *
+   * The spatial coordinates are divided by the tensor stride and the curve
+   * uses at most 64 bits. The low bits of the coordinates with a larger range
+   * are dropped.
+   *
+   * @return the old row of each new row.
+   */
+  index_vector_type reorder(CoordinateOrdering::Type const ordering) {
+    size_type const N = size();
+    index_vector_type order(N);
+    std::iota(order.begin(), order.end(), 0);
+    if (ordering == CoordinateOrdering::INSERTION || N == 0)
+      return order;
+
+    uint32_t const ndim = m_coordinate_size - 1;
+    coordinate_type const *p_coordinate = base_type::const_coordinate_data();
+    // The origin map has the tensor stride 0
+    std::vector<uint64_t> tensor_stride(ndim);
+    for (uint32_t j = 0; j < ndim; ++j)
+      tensor_stride[j] = std::max<uint64_t>(base_type::m_tensor_stride[j], 1);
+    std::vector<coordinate_type> min_coordinate(
+        p_coordinate + 1, p_coordinate + m_coordinate_size);
+    std::vector<coordinate_type> max_coordinate(min_coordinate);
+    for (index_type i = 0; i < N; ++i) {
+      coordinate_type const *p_curr = p_coordinate + i * m_coordinate_size;
+      for (uint32_t j = 0; j < ndim; ++j) {
+        min_coordinate[j] = std::min(min_coordinate[j], p_curr[j + 1]);
+        max_coordinate[j] = std::max(max_coordinate[j], p_curr[j + 1]);
+      }
+    }
+    uint32_t bits = 0;
+    for (uint32_t j = 0; j < ndim; ++j) {
+      uint64_t const range =
+          uint64_t(max_coordinate[j] - min_coordinate[j]) / tensor_stride[j];
+      while (bits < 32 && (range >> bits) > 0)
+        ++bits;
+    }
+    uint32_t const shift = ndim * bits > 64 ? bits - 64 / ndim : 0;
+    bits -= shift;
+
+    // (batch index, code) of each row
+    std::vector<std::pair<coordinate_type, uint64_t>> keys(N);
+#pragma omp parallel
+    {
+      std::vector<uint64_t> x(ndim);
+#pragma omp for
+      for (int64_t i = 0; i < N; ++i) {
+        coordinate_type const *p_curr = p_coordinate + i * m_coordinate_size;
+        for (uint32_t j = 0; j < ndim; ++j)
+          x[j] = (uint64_t(p_curr[j + 1] - min_coordinate[j]) /
+                  tensor_stride[j]) >>
+                 shift;
+        keys[i] = std::make_pair(
+            p_curr[0], ordering == CoordinateOrdering::HILBERT
+                           ? detail::hilbert_code(x.data(), ndim, bits)
+                           : detail::morton_code(x.data(), ndim, bits));
+      }
+    }
+    std::sort(order.begin(), order.end(),
+              [&keys](index_type const lhs, index_type const rhs) {
+                return keys[lhs] < keys[rhs];
+              });
+
+    // Move the coordinates to the new rows and point the keys to them
+    auto coordinates =
+        base_type::allocate_ptr(base_type::m_capacity * m_coordinate_size);
+    index_vector_type new_rows(N);
+#pragma omp parallel for
+    for (int64_t i = 0; i < N; ++i) {
+      std::copy_n(p_coordinate + order[i] * m_coordinate_size,
+                  m_coordinate_size,
+                  coordinates.get() + i * m_coordinate_size);
+      new_rows[order[i]] = i;
+    }
+    for (auto it = m_map.begin(); it != m_map.end(); ++it) {
+      it->second = new_rows[it->second];
+      it->first.data(coordinates.get() + it->second * m_coordinate_size);
+    }
+    base_type::m_coordinates = coordinates;
+    m_batch_row_indices.reset();
+    return order;
+  }
+
+  /*****************************************************************************
+   * Incremental update
+   ****************************************************************************/
+  /*
+   * @brief insert the new coordinates after the current rows. The coordinate
+   * buffer grows geometrically.
+   *
+   * @return the row of each coordinate. The rows of the existing coordinates
+   * are unchanged.
+   */
+  std::vector<int64_t> append(coordinate_type const *coordinate_begin,
+                              coordinate_type const *coordinate_end) {
+    size_type const N = (coordinate_end - coordinate_begin) / m_coordinate_size;
+    if (size() + N > base_type::m_capacity)
+      grow(std::max<size_type>(size() + N, 2 * base_type::m_capacity));
+    m_map.reserve(size() + N);
+
+    std::vector<int64_t> rows;
+    rows.reserve(N);
+    index_type value = size();
+    for (coordinate_type const *key = coordinate_begin; key != coordinate_end;
+         key += m_coordinate_size) {
+      auto const result = insert(key_type(key), value);
+      rows.push_back(result.first->second);
+      value += result.second;
+    }
+    return rows;
+  }
+
+  /*
+   * @brief erase the coordinates. The rows after the new size are moved to
+   * the rows of the erased coordinates to keep the rows contiguous.
+   *
+   * @return the new row of each old row, or an empty vector if no coordinate
+   * is erased. The rows of the erased coordinates are
+   * std::numeric_limits<index_type>::max().
+   */
+  index_vector_type erase(coordinate_type const *coordinate_begin,
+                          coordinate_type const *coordinate_end) {
+    index_type const invalid_row = std::numeric_limits<index_type>::max();
+    size_type const num_rows = size();
+
+    index_vector_type erased_rows;
+    for (coordinate_type const *key = coordinate_begin; key != coordinate_end;
+         key += m_coordinate_size) {
+      auto const it = m_map.find(key_type(key));
+      if (it == m_map.end())
+        continue;
+      erased_rows.push_back(it->second);
+      m_map.erase(it);
+    }
+    if (erased_rows.empty())
+      return {};
+
+    index_vector_type row_remap(num_rows);
+    std::iota(row_remap.begin(), row_remap.end(), 0);
+    for (auto const row : erased_rows)
+      row_remap[row] = invalid_row;
+    size_type const new_num_rows = m_map.size();
+
+    // The number of live rows after new_num_rows equals the number of erased
+    // rows before it.
+    index_type hole = 0;
+    for (index_type row = new_num_rows; row < num_rows; ++row) {
+      if (row_remap[row] == invalid_row)
+        continue;
+      while (row_remap[hole] != invalid_row)
+        ++hole;
+      coordinate_type *p_hole =
+          &base_type::m_coordinates[hole * m_coordinate_size];
+      coordinate_type *p_row =
+          &base_type::m_coordinates[row * m_coordinate_size];
+      auto it = m_map.find(key_type(p_row));
+      std::copy_n(p_row, m_coordinate_size, p_hole);
+      // The hash of the key does not change with its address
+      it->first.data(p_hole);
+      it->second = hole;
+      row_remap[row] = hole++;
+    }
+    m_batch_row_indices.reset();
+    return row_remap;
+  }
+
+  /*
+   * @brief update a kernel map of this map to itself after erase and append.
+   *
+   * The pairs of the erased rows are removed and the moved rows are renamed
+   * in a pass over the pairs, which is skipped if row_remap is empty. Then
+   * the pairs of the rows from first_new_row are added by looking up the
+   * neighbors of the new rows only.
+   */
+  void update_kernel_map(cpu_kernel_map &kernel_map,
+                         cpu_kernel_region<coordinate_type> const &kernel,
+                         index_vector_type const &row_remap,
+                         index_type const first_new_row) const {
+    index_type const invalid_row = std::numeric_limits<index_type>::max();
+    auto &in_maps = kernel_map.first;
+    auto &out_maps = kernel_map.second;
+    index_type const kernel_volume = kernel.volume();
+    index_type const num_rows = size();
+    ASSERT(in_maps.size() == kernel_volume, "Invalid kernel map volume",
+           in_maps.size(), "!=", kernel_volume);
+    coordinate_type const *p_coordinate = base_type::const_coordinate_data();
+
+#pragma omp parallel for
+    for (index_type k = 0; k < kernel_volume; ++k) {
+      auto &in_map = in_maps[k];
+      auto &out_map = out_maps[k];
+      if (!row_remap.empty()) {
+        index_type n = 0;
+        for (index_type i = 0; i < in_map.size(); ++i) {
+          index_type const in_row = row_remap[in_map[i]];
+          index_type const out_row = row_remap[out_map[i]];
+          if (in_row != invalid_row && out_row != invalid_row) {
+            in_map[n] = in_row;
+            out_map[n] = out_row;
+            ++n;
+          }
+        }
+        in_map.resize(n);
+        out_map.resize(n);
+      }
+
+      // A new row is the output of its neighbors and the input of the rows
+      // that have it as a neighbor. A pair of two new rows is added once, as
+      // the output.
+      std::vector<coordinate_type> neighbor(m_coordinate_size),
+          source(m_coordinate_size);
+      for (index_type row = first_new_row; row < num_rows; ++row) {
+        coordinate_type const *p_curr = p_coordinate + row * m_coordinate_size;
+        kernel.coordinate_at(k, p_curr, neighbor.data());
+        auto const in_it = m_map.find(key_type(neighbor.data()));
+        if (in_it != m_map.end()) {
+          in_map.push_back(in_it->second);
+          out_map.push_back(row);
+        }
+
+        source[0] = p_curr[0];
+        for (size_type d = 1; d < m_coordinate_size; ++d)
+          source[d] = 2 * p_curr[d] - neighbor[d];
+        auto const out_it = m_map.find(key_type(source.data()));
+        if (out_it != m_map.end() && out_it->second < first_new_row) {
+          in_map.push_back(row);
+          out_map.push_back(out_it->second);
+        }
+      }
+    }
+  }
+
   /*****************************************************************************
    * Kernel map
    ****************************************************************************/
@@ -734,52 +1276,15 @@ public:
     size_type const out_size = origin_coordinate_map.size();
     LOG_DEBUG("Generate origin_map with in NNZ:", in_size,
               "out NNZ:", out_size);
-    ASSERT(in_size > out_size, "Invalid out_coordinate_map");
+    ASSERT(in_size >= out_size, "Invalid out_coordinate_map");
 
-    std::vector<std::pair<index_type, index_type>> in_out(in_size);
-
-    // compute the chunk size per thread.
-    // There's a trade-off between the thread initialization overhead and the
-    // job sizes. If some jobs finish earlier than others due to imbalance in
-    // hash distribution, these threads will be idle.
-    size_t const in_map_num_elements = m_map.capacity();
-    size_t N = 2 * omp_get_max_threads();
-    size_t const stride = (in_map_num_elements + N - 1) / N;
-    N = (in_map_num_elements + stride - 1) / stride;
-    LOG_DEBUG("kernel map with", N, "chunks.");
-
-    size_type num_used = 0;
-#pragma omp parallel for
-    for (index_type n = 0; n < N; ++n) {
-      index_type curr_index_begin;
-      std::vector<coordinate_type> dst(m_coordinate_size);
-      std::for_each(dst.begin(), dst.end(), [](auto &i) { i = 0; });
-
-      for (auto iter_in = m_map.begin(stride * n);
-           iter_in.num_steps() <
-           std::min(stride, in_map_num_elements - n * stride);
-           ++iter_in) {
-        dst[0] = iter_in->first[0];
-        const auto iter_origin =
-            origin_coordinate_map.find(coordinate<coordinate_type>(dst.data()));
-        ASSERT(iter_origin != origin_coordinate_map.m_map.cend(),
-               "Invalid origin_coordinate_map");
-        index_type origin_row_index = iter_origin->second;
-
-#pragma omp atomic capture
-        {
-          curr_index_begin = num_used;
-          num_used += 1;
-        }
-
-        in_out[curr_index_begin] =
-            std::make_pair(iter_in->second, origin_row_index);
-      }
-    }
+    // The rows of the coordinates are the mapped values of the hash map
+    auto const out_rows = detail::origin_rows<coordinate_type>(
+        base_type::const_coordinate_data(), in_size, m_coordinate_size,
+        origin_coordinate_map);
 
     // Decomposed kernel map
-    auto batch_indices = origin_coordinate_map.batch_indices();
-    return cpu_kernel_map(in_out, batch_indices);
+    return cpu_kernel_map(out_rows, out_size);
   }
 
   /*****************************************************************************
@@ -820,6 +1325,50 @@ public:
     }
   }
 
+  /*
+   * Given query points, return the (row_ptr, rows, distances) of the k nearest
+   * coordinates if k > 0 or of the coordinates within the radius otherwise.
+   * See detail::neighbor_search_kernel.
+   */
+  std::vector<at::Tensor> neighbors(at::Tensor const &query,
+                                    double const radius, uint32_t const k,
+                                    bool const is_l2) const {
+    ASSERT(query.dim() == 2, "Invalid query dimension");
+    ASSERT(query.size(1) == m_coordinate_size, "Invalid query size");
+    ASSERT(k > 0 || radius > 0, "Either k or radius must be positive");
+    for (auto const s : base_type::m_tensor_stride)
+      ASSERT(s > 0, "Invalid tensor stride", base_type::m_tensor_stride);
+
+    // Bounding box of the coordinates of each batch that bounds the search
+    size_type const ndim = m_coordinate_size - 1;
+    coordinate_type const *p_coordinate = base_type::const_coordinate_data();
+    std::unordered_map<coordinate_type, std::vector<coordinate_type>>
+        batch_bounds;
+    for (index_type i = 0; i < size(); ++i) {
+      coordinate_type const *p_curr = p_coordinate + i * m_coordinate_size;
+      auto const result = batch_bounds.emplace(p_curr[0], 2 * ndim);
+      auto &bounds = result.first->second;
+      for (size_type j = 0; j < ndim; ++j) {
+        coordinate_type const c = p_curr[j + 1];
+        bounds[j] = result.second ? c : std::min(bounds[j], c);
+        bounds[ndim + j] = result.second ? c : std::max(bounds[ndim + j], c);
+      }
+    }
+
+    switch (query.scalar_type()) {
+    case at::ScalarType::Double:
+      return detail::neighbor_search_kernel<coordinate_type, double, map_type>(
+          query.size(0), m_coordinate_size, query.template data_ptr<double>(),
+          m_map, base_type::m_tensor_stride, batch_bounds, radius, k, is_l2);
+    case at::ScalarType::Float:
+      return detail::neighbor_search_kernel<coordinate_type, float, map_type>(
+          query.size(0), m_coordinate_size, query.template data_ptr<float>(),
+          m_map, base_type::m_tensor_stride, batch_bounds, radius, k, is_l2);
+    default:
+      ASSERT(false, "Unsupported float type");
+    }
+  }
+
   template <typename coordinate_field_type>
   std::pair<at::Tensor, at::Tensor>
   field_map(coordinate_field_type const *p_tfield,
@@ -879,6 +1428,35 @@ public:
     return o.str();
   }
 
+  // Number of slots of the hash table.
+  inline size_type hash_capacity() const noexcept {
+    return m_map.mask() == 0 ? 0 : m_map.mask() + 1;
+  }
+
+  inline float load_factor() const noexcept {
+    return m_map.mask() == 0 ? 0 : m_map.load_factor();
+  }
+
+  // Bytes of the coordinate storage.
+  inline size_type coordinate_bytes() const noexcept {
+    return capacity() * m_coordinate_size * sizeof(coordinate_type);
+  }
+
+  // Bytes of the hash table and the batch row index cache.
+  size_type hash_bytes() const {
+    size_type bytes = 0;
+    {
+      std::lock_guard<std::mutex> lock(m_batch_row_indices.mutex);
+      bytes = (m_batch_row_indices.indices.first.capacity() +
+               m_batch_row_indices.indices.second.capacity()) *
+              sizeof(int64_t);
+    }
+    if (m_map.mask() > 0)
+      bytes += m_map.calcNumBytesTotal(
+          m_map.calcNumElementsWithBuffer(m_map.mask() + 1));
+    return bytes;
+  }
+
   using base_type::capacity;
   using base_type::coordinate_size;
   using base_type::get_tensor_stride;
@@ -888,6 +1466,13 @@ public:
     m_map.reserve(c);
   }
 
+  // Rehash so that at most occupancy percent of the buckets are used. The
+  // hash table holds at most 80% of its buckets before growing.
+  void rehash(size_type const occupancy) {
+    ASSERT(occupancy > 0 && occupancy <= 80, "Invalid occupancy", occupancy);
+    m_map.reserve(m_map.size() * 80 / occupancy);
+  }
+
   void copy_coordinates(coordinate_type *dst_coordinate) const {
     if (m_map.size() == 0)
       return;
@@ -911,6 +1496,28 @@ public:
     }
   }
 
+  /*
+   * @brief call fn(chunk_index, p_coordinate, row_index) for all coordinates.
+   * The map is split into at most num_chunks chunks that run in parallel.
+   */
+  template <typename Func>
+  void parallel_for_each(size_t const num_chunks, Func const &fn) const {
+    if (m_map.size() == 0)
+      return;
+    size_t const capacity = m_map.capacity();
+    const size_t stride = (capacity + num_chunks - 1) / num_chunks;
+    size_t const N = (capacity + stride - 1) / stride;
+
+#pragma omp parallel for
+    for (index_type n = 0; n < N; ++n) {
+      for (auto it = m_map.begin(stride * n);                        //
+           it.num_steps() < std::min(stride, capacity - n * stride); //
+           ++it) {
+        fn(n, it->first.data(), it->second);
+      }
+    }
+  }
+
   std::vector<coordinate_type> batch_indices() const {
     std::vector<coordinate_type> indices(size());
     for (auto it = m_map.begin(); it != m_map.end(); ++it) {
@@ -919,10 +1526,55 @@ public:
     return indices;
   }
 
+  /*
+   * @brief rows of each batch in ascending order.
+   *
+   * @return (row_ptr, rows) where rows[row_ptr[b]:row_ptr[b + 1]] are the rows
+   * of the batch index b for b in [0, max batch index]. The index is built
+   * with a counting sort on the batch indices on the first call and is reused
+   * until the next insertion. Concurrent calls build it once.
+   */
+  detail::batch_row_index_cache::indices_type const &
+  batch_row_indices() const {
+    if (m_batch_row_indices.valid.load(std::memory_order_acquire))
+      return m_batch_row_indices.indices;
+
+    std::lock_guard<std::mutex> lock(m_batch_row_indices.mutex);
+    if (m_batch_row_indices.valid.load(std::memory_order_relaxed))
+      return m_batch_row_indices.indices;
+
+    size_type const N = size();
+    coordinate_type const *p_coordinate = base_type::const_coordinate_data();
+
+    int64_t max_batch_index = -1;
+    for (size_type i = 0; i < N; ++i) {
+      coordinate_type const b = p_coordinate[i * m_coordinate_size];
+      ASSERT(b >= 0, "Invalid batch index:", b);
+      max_batch_index = std::max<int64_t>(max_batch_index, b);
+    }
+
+    auto &row_ptr = m_batch_row_indices.indices.first;
+    auto &rows = m_batch_row_indices.indices.second;
+    row_ptr.assign(max_batch_index + 2, 0);
+    for (size_type i = 0; i < N; ++i)
+      ++row_ptr[p_coordinate[i * m_coordinate_size] + 1];
+    std::partial_sum(row_ptr.begin(), row_ptr.end(), row_ptr.begin());
+
+    rows.resize(N);
+    std::vector<int64_t> offsets(row_ptr.begin(), row_ptr.end() - 1);
+    for (size_type i = 0; i < N; ++i)
+      rows[offsets[p_coordinate[i * m_coordinate_size]]++] = i;
+
+    LOG_DEBUG("Batch row indices for", max_batch_index + 1, "batches built");
+    m_batch_row_indices.valid.store(true, std::memory_order_release);
+    return m_batch_row_indices.indices;
+  }
+
   std::pair<iterator, bool> insert(key_type const &key,
                                    mapped_type const &val) {
     ASSERT(val < base_type::m_capacity, "Invalid mapped value: ", val,
            ", current capacity: ", base_type::m_capacity);
+    m_batch_row_indices.reset();
     coordinate_type *ptr = &base_type::m_coordinates[val * m_coordinate_size];
     std::copy_n(key.data(), m_coordinate_size, ptr);
     return m_map.insert(value_type(coordinate<coordinate_type>{ptr}, val));
@@ -935,8 +1587,22 @@ public:
   inline const_iterator cend() const { return m_map.cend(); }
 
 private:
+  // Move the coordinates to a larger buffer and point the keys to it.
+  void grow(size_type const capacity) {
+    auto coordinates = base_type::allocate_ptr(capacity * m_coordinate_size);
+    std::copy_n(base_type::m_coordinates.get(), size() * m_coordinate_size,
+                coordinates.get());
+    for (auto it = m_map.begin(); it != m_map.end(); ++it)
+      it->first.data(coordinates.get() + it->second * m_coordinate_size);
+    base_type::m_coordinates = coordinates;
+    base_type::m_capacity = capacity;
+  }
+
   using base_type::m_coordinate_size;
   map_type m_map;
+
+  // batch segment index cache. See batch_row_indices().
+  mutable detail::batch_row_index_cache m_batch_row_indices;
 };
 
 // Field map
@@ -1078,59 +1744,14 @@ public:
     size_type const out_size = origin_coordinate_map.size();
     LOG_DEBUG("Generate origin_map with in NNZ:", in_size,
               "out NNZ:", out_size);
-    ASSERT(in_size > out_size, "Invalid out_coordinate_map");
-
-    std::vector<std::pair<index_type, index_type>> in_out(in_size);
+    ASSERT(in_size >= out_size, "Invalid out_coordinate_map");
 
-    // compute the chunk size per thread.
-    // There's a trade-off between the thread initialization overhead and the
-    // job sizes. If some jobs finish earlier than others due to imbalance in
-    // hash distribution, these threads will be idle.
-    size_t const in_map_num_elements = size();
-    size_t N = 2 * omp_get_max_threads();
-    size_t const stride = (in_map_num_elements + N - 1) / N;
-    N = (in_map_num_elements + stride - 1) / stride;
-    LOG_DEBUG("kernel map with", N, "chunks", stride, "stride");
-    coordinate_field_type const *const p_tfield = const_coordinate_data();
-    size_type num_used = 0;
-#pragma omp parallel for
-    for (index_type n = 0; n < N; ++n) {
-      index_type curr_index_begin;
-      std::vector<coordinate_int_type> dst(m_coordinate_size);
-      std::for_each(dst.begin(), dst.end(), [](auto &i) { i = 0; });
-      // LOG_DEBUG(n, "th chunk contains",
-      //           std::min((n + 1) * stride, in_map_num_elements) - n * stride,
-      //           "elements");
-
-      for (size_t i = stride * n;
-           i < std::min((n + 1) * stride, in_map_num_elements); ++i) {
-        dst[0] = p_tfield[i * m_coordinate_size];
-        // LOG_DEBUG(i, "th row batch index", dst[0]);
-        const auto iter_origin = origin_coordinate_map.find(
-            coordinate<coordinate_int_type>(dst.data()));
-        ASSERT(iter_origin != origin_coordinate_map.cend(),
-               "Invalid origin_coordinate_map");
-        index_type origin_row_index = iter_origin->second;
-
-#pragma omp atomic capture
-        {
-          curr_index_begin = num_used;
-          num_used += 1;
-        }
-
-        in_out[curr_index_begin] = std::make_pair(i, origin_row_index);
-      }
-    }
+    auto const out_rows = detail::origin_rows<coordinate_int_type>(
+        const_coordinate_data(), in_size, m_coordinate_size,
+        origin_coordinate_map);
 
-    // #ifdef DEBUG
-    //     LOG_DEBUG("Kernel map");
-    //     for (auto iter : in_out) {
-    //       std::cout << iter.first << ":" << iter.second << "\n";
-    //     }
-    // #endif
     // Decomposed kernel map
-    auto batch_indices = origin_coordinate_map.batch_indices();
-    return cpu_kernel_map(in_out, batch_indices);
+    return cpu_kernel_map(out_rows, out_size);
   }
 
   inline size_type size() const noexcept { return m_size; }
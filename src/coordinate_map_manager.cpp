@@ -31,6 +31,7 @@
 #include "utils.hpp"
 
 #include <pybind11/pybind11.h>
+#include <numeric>
 #include <string>
 #include <unordered_map>
 
@@ -70,6 +71,20 @@ struct insert_and_map_functor<coordinate_type, coordinate_field_type,
         p_coordinate, p_coordinate + N * coordinate_size);
     LOG_DEBUG("mapping size:", map_inverse_map.first.size());
 
+    if (manager.coordinate_ordering() != CoordinateOrdering::INSERTION) {
+      auto const order = map.reorder(manager.coordinate_ordering());
+      auto &mapping = map_inverse_map.first;
+      auto &inverse_mapping = map_inverse_map.second;
+      std::vector<int64_t> old_mapping(mapping);
+      default_types::index_vector_type new_rows(order.size());
+      for (default_types::index_type i = 0; i < order.size(); ++i) {
+        mapping[i] = old_mapping[order[i]];
+        new_rows[order[i]] = i;
+      }
+      for (auto &row : inverse_mapping)
+        row = new_rows[row];
+    }
+
     // insert moves map
     THRUST_CHECK(manager.insert(map_key, map));
 
@@ -145,6 +160,7 @@ py::object CoordinateMapManager<coordinate_type, coordinate_field_type,
     insert_field(at::Tensor const &coordinates,
                  default_types::stride_type const tensor_stride,
                  std::string const string_id) {
+  auto const omp_scope = thread_scope();
 
   torch::TensorArg arg_coordinate(coordinates, "coordinates", 0);
   torch::CheckedFrom c = "initialize";
@@ -167,7 +183,7 @@ py::object CoordinateMapManager<coordinate_type, coordinate_field_type,
 
   // generate the map_key
   coordinate_map_key_type map_key = std::make_pair(tensor_stride, string_id);
-  if (m_field_coordinates.find(map_key) != m_field_coordinates.end()) {
+  if (find_field(map_key) != field_map_end()) {
     LOG_DEBUG("CoordinateMapKey collision detected:", map_key,
               "generating new string id.");
     map_key = get_random_string_id(tensor_stride, string_id);
@@ -201,6 +217,7 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
         CoordinateMapKey const *p_in_field_map_key,
         default_types::stride_type const sparse_tensor_stride,
         std::string const sparse_tensor_string_id) {
+  auto const omp_scope = thread_scope();
   auto const coordinate_size = p_in_field_map_key->get_coordinate_size();
   // Basic assertions
   ASSERT(coordinate_size - 1 == sparse_tensor_stride.size(),
@@ -209,8 +226,8 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
          ArrToString(sparse_tensor_stride));
 
   // Find coordinate field
-  auto const it = m_field_coordinates.find(p_in_field_map_key->get_key());
-  ASSERT(it != m_field_coordinates.end(), ERROR_MAP_NOT_FOUND);
+  auto const it = find_field(p_in_field_map_key->get_key());
+  ASSERT(it != field_map_end(), ERROR_MAP_NOT_FOUND);
   auto const &field_map = it->second;
 
   auto options = torch::TensorOptions().dtype(torch::kInt).requires_grad(false);
@@ -227,7 +244,7 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
   // generate the map_key
   coordinate_map_key_type map_key =
       std::make_pair(sparse_tensor_stride, sparse_tensor_string_id);
-  if (m_coordinate_maps.find(map_key) != m_coordinate_maps.end()) {
+  if (find(map_key) != map_end()) {
     LOG_DEBUG("CoordinateMapKey collision detected:", map_key,
               "generating new string id.");
     map_key =
@@ -244,21 +261,28 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
   field_map.quantize_coordinates(int_coordinates.data_ptr<coordinate_type>(),
                                  sparse_tensor_stride);
 
-  auto const map_inverse_map =
-      detail::insert_and_map_functor<coordinate_type, coordinate_field_type,
-                                     TemplatedAllocator, CoordinateMapType>()(
-          map_key, int_coordinates, *this);
+  auto const map_inverse_map = [&] {
+    profile_scope const scope("insert_and_map", "map");
+    return detail::insert_and_map_functor<
+        coordinate_type, coordinate_field_type, TemplatedAllocator,
+        CoordinateMapType>()(map_key, int_coordinates, *this);
+  }();
 
   auto const field_to_sparse_map_key =
       std::pair<coordinate_map_key_type, coordinate_map_key_type>{
           p_in_field_map_key->get_key(), map_key};
 
-  auto result = m_field_to_sparse_maps.insert(
-      std::pair<
-          const std::pair<coordinate_map_key_type, coordinate_map_key_type>,
-          const std::pair<at::Tensor, at::Tensor>>{field_to_sparse_map_key,
-                                                   map_inverse_map});
-  LOG_DEBUG("field to sparse tensor map insertion", result.second);
+  {
+    std::unique_lock<std::shared_timed_mutex> lock(m_mutex);
+    auto result = m_field_to_sparse_maps.insert(
+        std::pair<
+            const std::pair<coordinate_map_key_type, coordinate_map_key_type>,
+            const std::pair<at::Tensor, at::Tensor>>{field_to_sparse_map_key,
+                                                     map_inverse_map});
+    LOG_DEBUG("field to sparse tensor map insertion", result.second);
+    if (result.second)
+      created(&result.first->second);
+  }
 
   py::object py_key = py::cast(new CoordinateMapKey(coordinate_size, map_key));
 
@@ -280,9 +304,11 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
                             CoordinateMapKey const *p_sparse_key) const {
   auto key = std::pair<coordinate_map_key_type, coordinate_map_key_type>{
       p_field_key->get_key(), p_sparse_key->get_key()};
+  std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
   auto it = m_field_to_sparse_maps.find(key);
   ASSERT(it != m_field_to_sparse_maps.end(),
          "Field To Sparse Map doesn't exist");
+  touch(&it->second);
   return it->second;
 }
 
@@ -298,6 +324,7 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
                      CoordinateMapType>::
     field_to_sparse_map(CoordinateMapKey const *p_in_field_map_key,
                         CoordinateMapKey const *p_out_sparse_map_key) {
+  auto const omp_scope = thread_scope();
 
   auto const coordinate_size = p_in_field_map_key->get_coordinate_size();
   // Basic assertions
@@ -306,12 +333,11 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
          "!=", p_out_sparse_map_key->get_coordinate_size());
 
   // Find coordinate field
-  auto const it_field = m_field_coordinates.find(p_in_field_map_key->get_key());
-  ASSERT(it_field != m_field_coordinates.end(), ERROR_MAP_NOT_FOUND);
+  auto const it_field = find_field(p_in_field_map_key->get_key());
+  ASSERT(it_field != field_map_end(), ERROR_MAP_NOT_FOUND);
   auto const &field_map = it_field->second;
-  auto const it_sparse =
-      m_coordinate_maps.find(p_out_sparse_map_key->get_key());
-  ASSERT(it_sparse != m_coordinate_maps.end(), ERROR_MAP_NOT_FOUND);
+  auto const it_sparse = find(p_out_sparse_map_key->get_key());
+  ASSERT(it_sparse != map_end(), ERROR_MAP_NOT_FOUND);
   auto const &sparse_map = it_sparse->second;
 
   auto options = torch::TensorOptions().dtype(torch::kInt).requires_grad(false);
@@ -332,12 +358,17 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
       std::pair<coordinate_map_key_type, coordinate_map_key_type>{
           p_in_field_map_key->get_key(), p_out_sparse_map_key->get_key()};
 
-  auto result = m_field_to_sparse_maps.insert(
-      std::pair<
-          const std::pair<coordinate_map_key_type, coordinate_map_key_type>,
-          const std::pair<at::Tensor, at::Tensor>>{field_to_sparse_map_key,
-                                                   map_inverse_map});
-  LOG_DEBUG("field to sparse tensor map insertion", result.second);
+  {
+    std::unique_lock<std::shared_timed_mutex> lock(m_mutex);
+    auto result = m_field_to_sparse_maps.insert(
+        std::pair<
+            const std::pair<coordinate_map_key_type, coordinate_map_key_type>,
+            const std::pair<at::Tensor, at::Tensor>>{field_to_sparse_map_key,
+                                                     map_inverse_map});
+    LOG_DEBUG("field to sparse tensor map insertion", result.second);
+    if (result.second)
+      created(&result.first->second);
+  }
 
   return map_inverse_map;
 }
@@ -356,6 +387,7 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
     insert_and_map(at::Tensor const &coordinate,
                    default_types::stride_type const tensor_stride,
                    std::string const string_id) {
+  auto const omp_scope = thread_scope();
 
   torch::TensorArg arg_coordinate(coordinate, "coordinates", 0);
   torch::CheckedFrom c = "initialize";
@@ -377,7 +409,7 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
 
   // generate the map_key
   coordinate_map_key_type map_key = std::make_pair(tensor_stride, string_id);
-  if (m_coordinate_maps.find(map_key) != m_coordinate_maps.end()) {
+  if (find(map_key) != map_end()) {
     LOG_DEBUG("CoordinateMapKey collision detected:", map_key,
               "generating new string id.");
     map_key = get_random_string_id(tensor_stride, string_id);
@@ -386,6 +418,7 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
   LOG_DEBUG("initializing a map with tensor stride:", map_key.first,
             "string id:", map_key.second);
   // Create the concurrent coords map
+  profile_scope const scope("insert_and_map", "map");
   auto const map_inverse_map =
       detail::insert_and_map_functor<coordinate_type, coordinate_field_type,
                                      TemplatedAllocator, CoordinateMapType>()(
@@ -408,6 +441,7 @@ std::pair<coordinate_map_key_type, bool> CoordinateMapManager<
     CoordinateMapType>::stride(coordinate_map_key_type const &in_map_key,
                                stride_type const &kernel_stride,
                                std::string const string_id) {
+  auto const omp_scope = thread_scope();
   ASSERT(exists(in_map_key), ERROR_MAP_NOT_FOUND);
   // check if the key exists.
   LOG_DEBUG("In tensor stride:", in_map_key.first,
@@ -416,16 +450,25 @@ std::pair<coordinate_map_key_type, bool> CoordinateMapManager<
       detail::stride_tensor_stride(in_map_key.first, kernel_stride, false),
       string_id == "" ? in_map_key.second : string_id);
   LOG_DEBUG("Out stride map key:", out_map_key);
-  bool const exists_out_map = exists(out_map_key);
-  if (!exists_out_map) {
-    // operator[] required mapped_type(), which is not defined.
-    // ASSERTION already checked that in_map_key exists.
-    map_type const &in_map = m_coordinate_maps.find(in_map_key)->second;
-    map_type out_map = in_map.stride(kernel_stride);
-    insert(out_map_key, out_map);
+  bool generated = false;
+  if (!exists(out_map_key)) {
+    std::lock_guard<std::recursive_mutex> build_lock(m_build_mutex);
+    // Check again as another thread could have generated the map.
+    if (!exists(out_map_key)) {
+      profile_scope const scope("stride", "map");
+      // operator[] required mapped_type(), which is not defined.
+      // ASSERTION already checked that in_map_key exists.
+      map_type const &in_map = find(in_map_key)->second;
+      map_type out_map = in_map.stride(kernel_stride);
+      detail::reorder_functor<coordinate_type, TemplatedAllocator,
+                              CoordinateMapType>()(out_map,
+                                                   m_coordinate_ordering);
+      generated = insert(out_map_key, out_map);
+      derived(in_map_key, out_map_key);
+    }
   }
   // (key, new map generated flag)
-  return std::make_pair(out_map_key, !exists_out_map);
+  return std::make_pair(out_map_key, generated);
 }
 
 template <typename coordinate_type, typename coordinate_field_type,
@@ -439,6 +482,7 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
                   cpu_kernel_region<coordinate_type> &kernel,
                   stride_type const &out_tensor_stride,
                   bool const expand_coordinates) {
+  auto const omp_scope = thread_scope();
   ASSERT(exists(in_map_key), ERROR_MAP_NOT_FOUND);
   LOG_DEBUG("stride_region");
   // kernel.tensor_stride must be set to out tensor stride.
@@ -448,18 +492,28 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
 
   // check if the key exists.
   coordinate_map_key_type out_map_key(out_tensor_stride, "");
+  // Reuse the existing map without serializing on the build lock.
+  if (!expand_coordinates && exists(out_map_key))
+    return std::make_pair(out_map_key, false);
+
+  std::lock_guard<std::recursive_mutex> build_lock(m_build_mutex);
   bool const exists_out_map = exists(out_map_key);
   if (!exists_out_map || expand_coordinates) {
     LOG_DEBUG("Create a new stride region map for tensor_stride:",
               out_tensor_stride);
-    map_type const &in_map = m_coordinate_maps.find(in_map_key)->second;
+    profile_scope const scope("stride_region", "map");
+    map_type const &in_map = find(in_map_key)->second;
     map_type out_map = in_map.stride_region(kernel, out_tensor_stride);
+    detail::reorder_functor<coordinate_type, TemplatedAllocator,
+                            CoordinateMapType>()(out_map,
+                                                 m_coordinate_ordering);
     if (exists_out_map) {
       LOG_DEBUG("coordinate map exists for tensor_stride:", out_tensor_stride);
       out_map_key = get_random_string_id(out_tensor_stride, "");
       LOG_DEBUG("created a random key:", out_map_key);
     }
     insert(out_map_key, out_map);
+    derived(in_map_key, out_map_key);
   }
   // (key, new map generated flag)
   return std::make_pair(out_map_key, !exists_out_map || expand_coordinates);
@@ -472,16 +526,26 @@ template <typename coordinate_type, typename coordinate_field_type,
 std::pair<coordinate_map_key_type, bool>
 CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
                      CoordinateMapType>::origin() {
-  ASSERT(m_coordinate_maps.size() > 0, "No coordinate map found");
-  // check if the key exists.
-  map_type const &random_map = m_coordinate_maps.begin()->second;
-  stride_type origin_tensor_stride(random_map.coordinate_size() - 1);
-  std::for_each(origin_tensor_stride.begin(), origin_tensor_stride.end(),
-                [](auto &i) { i = 0; });
-  LOG_DEBUG("origin tensor stride:", origin_tensor_stride);
-
-  coordinate_map_key_type origin_map_key(origin_tensor_stride, "");
-  bool const exists_origin_map = exists(origin_map_key);
+  auto const omp_scope = thread_scope();
+  coordinate_map_key_type origin_map_key;
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+    ASSERT(m_coordinate_maps.size() > 0, "No coordinate map found");
+    map_type const &random_map = m_coordinate_maps.begin()->second;
+    stride_type origin_tensor_stride(random_map.coordinate_size() - 1);
+    std::for_each(origin_tensor_stride.begin(), origin_tensor_stride.end(),
+                  [](auto &i) { i = 0; });
+    LOG_DEBUG("origin tensor stride:", origin_tensor_stride);
+    origin_map_key = coordinate_map_key_type(origin_tensor_stride, "");
+  }
+  // check if the key exists before serializing on the build lock.
+  if (exists(origin_map_key))
+    return std::make_pair(origin_map_key, false);
+
+  std::lock_guard<std::recursive_mutex> build_lock(m_build_mutex);
+  std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+  bool const exists_origin_map =
+      m_coordinate_maps.find(origin_map_key) != m_coordinate_maps.end();
   if (!exists_origin_map) {
     LOG_DEBUG("origin coordinate map not found");
     map_type const *p_min_coordinate_map{nullptr};
@@ -492,6 +556,8 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
         p_min_coordinate_map = &(map_it->second);
       }
     }
+    // The build lock keeps the other threads from inserting the origin map.
+    lock.unlock();
 
     if (p_min_coordinate_map != nullptr) {
       map_type origin_map = p_min_coordinate_map->origin();
@@ -514,16 +580,26 @@ template <typename coordinate_type, typename coordinate_field_type,
 std::pair<coordinate_map_key_type, bool>
 CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
                      CoordinateMapType>::origin_field() {
-  ASSERT(m_field_coordinates.size() > 0, "No coordinate map found");
-  // check if the key exists.
-  field_map_type const &random_map = m_field_coordinates.begin()->second;
-  stride_type origin_tensor_stride(random_map.coordinate_size() - 1);
-  std::for_each(origin_tensor_stride.begin(), origin_tensor_stride.end(),
-                [](auto &i) { i = 0; });
-  LOG_DEBUG("origin tensor stride:", origin_tensor_stride);
+  auto const omp_scope = thread_scope();
+  coordinate_map_key_type origin_map_key;
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+    ASSERT(m_field_coordinates.size() > 0, "No coordinate map found");
+    field_map_type const &random_map = m_field_coordinates.begin()->second;
+    stride_type origin_tensor_stride(random_map.coordinate_size() - 1);
+    std::for_each(origin_tensor_stride.begin(), origin_tensor_stride.end(),
+                  [](auto &i) { i = 0; });
+    LOG_DEBUG("origin tensor stride:", origin_tensor_stride);
+    origin_map_key = coordinate_map_key_type(origin_tensor_stride, "");
+  }
+  // check if the key exists before serializing on the build lock.
+  if (exists(origin_map_key))
+    return std::make_pair(origin_map_key, false);
 
-  coordinate_map_key_type origin_map_key(origin_tensor_stride, "");
-  bool const exists_origin_map = exists(origin_map_key);
+  std::lock_guard<std::recursive_mutex> build_lock(m_build_mutex);
+  std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+  bool const exists_origin_map =
+      m_coordinate_maps.find(origin_map_key) != m_coordinate_maps.end();
 
   if (!exists_origin_map) {
     LOG_DEBUG("origin coordinate map not found");
@@ -535,6 +611,8 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
         p_min_coordinate_map = &(map_it->second);
       }
     }
+    // The build lock keeps the other threads from inserting the origin map.
+    lock.unlock();
 
     if (p_min_coordinate_map != nullptr) {
       map_type origin_map = p_min_coordinate_map->origin();
@@ -559,18 +637,20 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
                                                    &in_key,
                                                bool const *keep_begin,
                                                bool const *keep_end) {
-  auto const map_it = m_coordinate_maps.find(in_key);
-  ASSERT(map_it != m_coordinate_maps.end(), ERROR_MAP_NOT_FOUND);
+  auto const omp_scope = thread_scope();
+  auto const map_it = find(in_key);
+  ASSERT(map_it != map_end(), ERROR_MAP_NOT_FOUND);
 
   // create a coordinate_map_key
   coordinate_map_key_type map_key = std::make_pair(in_key.first, "pruned");
-  if (m_coordinate_maps.find(map_key) != m_coordinate_maps.end()) {
+  if (find(map_key) != map_end()) {
     map_key = get_random_string_id(map_key.first, map_key.second);
   }
 
   map_type pruned_map = map_it->second.prune(keep_begin, keep_end);
   LOG_DEBUG("pruned map with size:", pruned_map.size(), " inserted");
   insert(map_key, pruned_map);
+  derived(in_key, map_key);
 
   return map_key;
 }
@@ -604,6 +684,47 @@ struct stride_map_functor<coordinate_type, std::allocator, CoordinateMapCPU,
   }
 };
 
+template <> struct kernel_map_layout_functor<cpu_kernel_map> {
+
+  void operator()(cpu_kernel_map &kernel_map,
+                  MinkowskiAlgorithm::Mode const algorithm) {
+    auto &in_maps = kernel_map.first;
+    auto &out_maps = kernel_map.second;
+    switch (algorithm) {
+    case MinkowskiAlgorithm::SPEED_OPTIMIZED: {
+      // Sort the pairs of each kernel offset by the input row for sequential
+      // gathers. The pairs are in the hash table order otherwise.
+#pragma omp parallel for schedule(dynamic)
+      for (int64_t k = 0; k < in_maps.size(); ++k) {
+        auto &in_map = in_maps[k];
+        auto &out_map = out_maps[k];
+        std::vector<std::pair<default_types::index_type,
+                              default_types::index_type>>
+            pairs(in_map.size());
+        for (size_t i = 0; i < in_map.size(); ++i)
+          pairs[i] = std::make_pair(in_map[i], out_map[i]);
+        std::sort(pairs.begin(), pairs.end());
+        for (size_t i = 0; i < in_map.size(); ++i) {
+          in_map[i] = pairs[i].first;
+          out_map[i] = pairs[i].second;
+        }
+      }
+      break;
+    }
+    case MinkowskiAlgorithm::MEMORY_EFFICIENT: {
+      // The maps of each offset are allocated for all output rows.
+      for (size_t k = 0; k < in_maps.size(); ++k) {
+        in_maps[k].shrink_to_fit();
+        out_maps[k].shrink_to_fit();
+      }
+      break;
+    }
+    default:
+      break;
+    }
+  }
+};
+
 // a partial specialization functor for kernel map in/out swap
 template <> struct swap_in_out_map_functor<cpu_kernel_map> {
 
@@ -631,14 +752,14 @@ template <typename coordinate_type, typename coordinate_field_type,
           class CoordinateMapType>
 typename CoordinateMapManager<coordinate_type, coordinate_field_type,
                               TemplatedAllocator,
-                              CoordinateMapType>::kernel_map_type const &
+                              CoordinateMapType>::kernel_map_pointer_type
 CoordinateMapManager<
     coordinate_type, coordinate_field_type, TemplatedAllocator,
     CoordinateMapType>::kernel_map(CoordinateMapKey const *p_in_map_key,
                                    CoordinateMapKey const *p_out_map_key) {
   // when kernel has volume 1
-  auto const &map_it = m_coordinate_maps.find(p_in_map_key->get_key());
-  ASSERT(map_it != m_coordinate_maps.end(), ERROR_MAP_NOT_FOUND);
+  auto const &map_it = find(p_in_map_key->get_key());
+  ASSERT(map_it != map_end(), ERROR_MAP_NOT_FOUND);
   auto const coordinate_size = map_it->second.coordinate_size();
   auto const one_vec = detail::ones(coordinate_size - 1);
   auto const offset = torch::empty(
@@ -658,7 +779,7 @@ template <typename coordinate_type, typename coordinate_field_type,
           class CoordinateMapType>
 typename CoordinateMapManager<coordinate_type, coordinate_field_type,
                               TemplatedAllocator,
-                              CoordinateMapType>::kernel_map_type const &
+                              CoordinateMapType>::kernel_map_pointer_type
 CoordinateMapManager<
     coordinate_type, coordinate_field_type, TemplatedAllocator,
     CoordinateMapType>::kernel_map(CoordinateMapKey const *p_in_map_key,
@@ -669,6 +790,7 @@ CoordinateMapManager<
                                    RegionType::Type const region_type,
                                    at::Tensor const &offset, bool is_transpose,
                                    bool is_pool) {
+  auto const omp_scope = thread_scope();
   ASSERT(region_type != RegionType::CUSTOM, "Not implemented yet.");
   if (region_type == RegionType::CUSTOM)
     ASSERT(offset.is_cuda() ==
@@ -688,138 +810,169 @@ CoordinateMapManager<
                       kernel_size, kernel_stride, kernel_dilation, // kernels
                       region_type, is_transpose, is_pool);
 
-  const auto &kernel_map_iter = m_kernel_maps.find(kernel_map_key);
+  // The stride maps of poolings are cheap to regenerate and not cached in the
+  // CPU memory efficient mode.
+  bool const is_transient =
+      detail::is_cpu_coordinate_map<CoordinateMapType>::value &&
+      m_algorithm == MinkowskiAlgorithm::MEMORY_EFFICIENT && is_pool &&
+      kernel_stride == kernel_size;
+  auto &kernel_maps = is_transient ? m_transient_kernel_maps : m_kernel_maps;
+
   LOG_DEBUG("set kernel map key for kernel map:", p_in_map_key->get_key(), "->",
             p_out_map_key->get_key());
+  kernel_map_pointer_type p_kernel_map;
+  {
+    profile_scope const scope("kernel_map.lookup", "map");
+    p_kernel_map = find_kernel_map(kernel_maps, kernel_map_key);
+  }
+  if (p_kernel_map != nullptr) {
+    LOG_DEBUG("kernel map found");
+    return p_kernel_map;
+  }
 
-  if (kernel_map_iter == m_kernel_maps.end()) {
-    // create a kernel map if it exists
-    auto const in_map_it = m_coordinate_maps.find(p_in_map_key->get_key());
-    auto const out_map_it = m_coordinate_maps.find(p_out_map_key->get_key());
+  // Generate a missing kernel map once. The threads that miss the same kernel
+  // map wait for the generation and return the saved kernel map.
+  profile_scope const build_scope("kernel_map.build", "map");
+  std::lock_guard<std::recursive_mutex> build_lock(m_build_mutex);
+  p_kernel_map = find_kernel_map(kernel_maps, kernel_map_key);
+  if (p_kernel_map != nullptr)
+    return p_kernel_map;
+
+  // Keep only the last transient kernel map. The callers of the replaced
+  // kernel map keep it until they finish.
+  if (is_transient) {
+    std::unique_lock<std::shared_timed_mutex> lock(m_mutex);
+    for (auto const &kv : kernel_maps)
+      m_entry_times.erase(kv.second.get());
+    kernel_maps.clear();
+  }
 
-    ASSERT(in_map_it != m_coordinate_maps.end(), "in_map", ERROR_MAP_NOT_FOUND);
-    ASSERT(out_map_it != m_coordinate_maps.end(), "out_map",
-           ERROR_MAP_NOT_FOUND);
+  // create a kernel map if it exists
+  auto const in_map_it = find(p_in_map_key->get_key());
+  auto const out_map_it = find(p_out_map_key->get_key());
 
-    auto const &in_map = in_map_it->second;
-    auto const &out_map = out_map_it->second;
+  ASSERT(in_map_it != map_end(), "in_map", ERROR_MAP_NOT_FOUND);
+  ASSERT(out_map_it != map_end(), "out_map", ERROR_MAP_NOT_FOUND);
 
-    LOG_DEBUG("coordinate_size:", in_map.coordinate_size(),
-              "in tensor_stride:", in_map.get_tensor_stride(),
-              "out tensor_stride:", out_map.get_tensor_stride());
+  auto const &in_map = in_map_it->second;
+  auto const &out_map = out_map_it->second;
 
-    // +1 for batch index
-    ASSERT(kernel_dim + 1 == in_map.coordinate_size(), "kernel size mismatch");
-    ASSERT(kernel_dim + 1 == out_map.coordinate_size(), "kernel size mismatch");
+  LOG_DEBUG("coordinate_size:", in_map.coordinate_size(),
+            "in tensor_stride:", in_map.get_tensor_stride(),
+            "out tensor_stride:", out_map.get_tensor_stride());
 
-    // If either coordinate map is empty
-    if (in_map.size() == 0 || out_map.size() == 0) {
-      return detail::empty_map_functor<coordinate_type, TemplatedAllocator,
-                                       CoordinateMapType, kernel_map_type>()();
-    }
+  // +1 for batch index
+  ASSERT(kernel_dim + 1 == in_map.coordinate_size(), "kernel size mismatch");
+  ASSERT(kernel_dim + 1 == out_map.coordinate_size(), "kernel size mismatch");
 
-    if (!is_transpose) {
-      if (is_pool && (kernel_stride == kernel_size)) {
-        LOG_DEBUG("generating stride_map");
+  // If either coordinate map is empty
+  if (in_map.size() == 0 || out_map.size() == 0) {
+    return std::make_shared<kernel_map_type const>(
+        detail::empty_map_functor<coordinate_type, TemplatedAllocator,
+                                  CoordinateMapType, kernel_map_type>()());
+  }
+
+  kernel_map_type new_kernel_map;
+  if (!is_transpose) {
+    if (is_pool && (kernel_stride == kernel_size)) {
+      LOG_DEBUG("generating stride_map");
+      auto const stride_map =
+          detail::stride_map_functor<coordinate_type, TemplatedAllocator,
+                                     CoordinateMapType, kernel_map_type>()(
+              in_map, out_map, out_map.get_tensor_stride());
+
+      new_kernel_map = std::move(stride_map);
+
+    } else {
+      LOG_DEBUG("generating kernel map");
+
+      // Default kernel map
+      LOG_DEBUG(
+          "kernel region with kernel: ",
+          PtrToString(kernel_size.data(), in_map.coordinate_size() - 1));
+      LOG_DEBUG(
+          "kernel region with dilation: ",
+          PtrToString(kernel_dilation.data(), in_map.coordinate_size() - 1));
+
+      auto kernel_region = cpu_kernel_region<coordinate_type>(
+          region_type,                       //
+          in_map.coordinate_size(),          //
+          in_map.get_tensor_stride().data(), //
+          kernel_size.data(),                //
+          kernel_dilation.data(),            //
+          0, offset.data_ptr<coordinate_type>(), offset.size(0));
+
+      auto const kernel_map =
+          detail::kernel_map_functor<coordinate_type, TemplatedAllocator,
+                                     CoordinateMapType, kernel_map_type>()(
+              in_map, out_map, m_kernel_map_mode, kernel_region);
+
+      LOG_DEBUG("kernel_map done");
+      new_kernel_map = std::move(kernel_map);
+    }
+  } else { // is_transpose == true
+    // Check first if the out2in kernel map exists
+    //
+    // Create temporary key for the flipped in/out
+    kernel_map_key_type const swapped_kernel_map_key = std::make_tuple(
+        p_out_map_key->get_key(), p_in_map_key->get_key(), // maps
+        kernel_size, kernel_stride, kernel_dilation,       // kernels
+        region_type, false, is_pool);
+
+    // Check if the temporary key exists and return swapped in/out
+    auto const p_swapped_kernel_map =
+        find_kernel_map(m_kernel_maps, swapped_kernel_map_key);
+    if (p_swapped_kernel_map != nullptr) {
+      // copy the in out maps from the existing maps
+      LOG_DEBUG("found existing kernel_map_key for transposed kernel map");
+      new_kernel_map = detail::swap_in_out_map_functor<kernel_map_type>()(
+          *p_swapped_kernel_map);
+    } else { // create in out kernel if it doesn't exist
+      LOG_DEBUG("No existing kernel_map_key for transposed kernel map");
+      if (is_pool && kernel_stride == kernel_size) {
+        // e.g. out_map has tensor stride 2 in_map has tensor stride 4.
+        // Thus, create a stride map from 2 to 4, out to in.
         auto const stride_map =
             detail::stride_map_functor<coordinate_type, TemplatedAllocator,
                                        CoordinateMapType, kernel_map_type>()(
-                in_map, out_map, out_map.get_tensor_stride());
-
-        m_kernel_maps[kernel_map_key] = std::move(stride_map);
+                out_map, in_map, in_map.get_tensor_stride());
 
+        new_kernel_map =
+            detail::swap_in_out_map_functor<kernel_map_type>()(stride_map);
       } else {
-        LOG_DEBUG("generating kernel map");
-
         // Default kernel map
-        LOG_DEBUG(
-            "kernel region with kernel: ",
-            PtrToString(kernel_size.data(), in_map.coordinate_size() - 1));
-        LOG_DEBUG(
-            "kernel region with dilation: ",
-            PtrToString(kernel_dilation.data(), in_map.coordinate_size() - 1));
-
         auto kernel_region = cpu_kernel_region<coordinate_type>(
-            region_type,                       //
-            in_map.coordinate_size(),          //
-            in_map.get_tensor_stride().data(), //
-            kernel_size.data(),                //
-            kernel_dilation.data(),            //
-            0, offset.data_ptr<coordinate_type>(), offset.size(0));
-
+            region_type,                        //
+            out_map.coordinate_size(),          //
+            out_map.get_tensor_stride().data(), //
+            kernel_size.data(),                 //
+            kernel_dilation.data(),             //
+            0, offset.data_ptr<coordinate_type>(), offset.size(0),
+            true // is_transpose
+        );
+
+        // out to in kernel map
         auto const kernel_map =
             detail::kernel_map_functor<coordinate_type, TemplatedAllocator,
                                        CoordinateMapType, kernel_map_type>()(
-                in_map, out_map, m_kernel_map_mode, kernel_region);
+                out_map, in_map, m_kernel_map_mode, kernel_region);
 
         LOG_DEBUG("kernel_map done");
-        m_kernel_maps[kernel_map_key] = std::move(kernel_map);
-        LOG_DEBUG("kernel_map saved");
-      }
-    } else { // is_transpose == true
-      // Check first if the out2in kernel map exists
-      //
-      // Create temporary key for the flipped in/out
-      kernel_map_key_type const swapped_kernel_map_key = std::make_tuple(
-          p_out_map_key->get_key(), p_in_map_key->get_key(), // maps
-          kernel_size, kernel_stride, kernel_dilation,       // kernels
-          region_type, false, is_pool);
-
-      // Check if the temporary key exists and return swapped in/out
-      if (m_kernel_maps.find(swapped_kernel_map_key) != m_kernel_maps.end()) {
-        // copy the in out maps from the existing maps
-        LOG_DEBUG("found existing kernel_map_key for transposed kernel map");
-        m_kernel_maps[kernel_map_key] =
+        new_kernel_map =
             detail::swap_in_out_map_functor<kernel_map_type>()(
-                m_kernel_maps[swapped_kernel_map_key]);
-      } else { // create in out kernel if it doesn't exist
-        LOG_DEBUG("No existing kernel_map_key for transposed kernel map");
-        if (is_pool && kernel_stride == kernel_size) {
-          // e.g. out_map has tensor stride 2 in_map has tensor stride 4.
-          // Thus, create a stride map from 2 to 4, out to in.
-          auto const stride_map =
-              detail::stride_map_functor<coordinate_type, TemplatedAllocator,
-                                         CoordinateMapType, kernel_map_type>()(
-                  out_map, in_map, in_map.get_tensor_stride());
-
-          // TODO Replace the kernel_map values to shared pointers.
-          m_kernel_maps[kernel_map_key] =
-              detail::swap_in_out_map_functor<kernel_map_type>()(stride_map);
-        } else {
-          // Default kernel map
-          auto kernel_region = cpu_kernel_region<coordinate_type>(
-              region_type,                        //
-              out_map.coordinate_size(),          //
-              out_map.get_tensor_stride().data(), //
-              kernel_size.data(),                 //
-              kernel_dilation.data(),             //
-              0, offset.data_ptr<coordinate_type>(), offset.size(0),
-              true // is_transpose
-          );
-
-          // out to in kernel map
-          auto const kernel_map =
-              detail::kernel_map_functor<coordinate_type, TemplatedAllocator,
-                                         CoordinateMapType, kernel_map_type>()(
-                  out_map, in_map, m_kernel_map_mode, kernel_region);
-
-          LOG_DEBUG("kernel_map done");
-          m_kernel_maps[kernel_map_key] =
-              detail::swap_in_out_map_functor<kernel_map_type>()(
-                  std::move(kernel_map));
-          LOG_DEBUG("kernel_map saved");
+                std::move(kernel_map));
         }
-      }
     }
   }
-#ifdef DEBUG
-  else {
-    LOG_DEBUG("kernel map found");
-  }
-#endif
-
-  // TODO check if it copies or moves the internal data
-  return m_kernel_maps[kernel_map_key];
+  detail::kernel_map_layout_functor<kernel_map_type>()(new_kernel_map,
+                                                       m_algorithm);
+
+  auto p_new_kernel_map =
+      std::make_shared<kernel_map_type>(std::move(new_kernel_map));
+  std::unique_lock<std::shared_timed_mutex> lock(m_mutex);
+  kernel_maps[kernel_map_key] = p_new_kernel_map;
+  created(p_new_kernel_map.get());
+  return p_new_kernel_map;
 }
 
 namespace detail {
@@ -892,7 +1045,7 @@ template <typename coordinate_type, typename coordinate_field_type,
           class CoordinateMapType>
 typename CoordinateMapManager<coordinate_type, coordinate_field_type,
                               TemplatedAllocator,
-                              CoordinateMapType>::kernel_map_type const &
+                              CoordinateMapType>::kernel_map_pointer_type
 CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
                      CoordinateMapType>::origin_map(CoordinateMapKey const
                                                         *p_in_map_key) {
@@ -901,15 +1054,26 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
       origin_map_key(p_in_map_key->get_key());
   coordinate_map_key_type const origin_key = std::get<1>(kernel_map_key);
 
-  if (m_kernel_maps.find(kernel_map_key) == m_kernel_maps.end()) {
-    auto const key = origin().first;
-    auto const &origin_coordinate_map = m_coordinate_maps.find(key)->second;
-    auto origin_map = m_coordinate_maps.find(p_in_map_key->get_key())
-                          ->second.origin_map(origin_coordinate_map);
-    m_kernel_maps[kernel_map_key] = std::move(origin_map);
-  }
-
-  return m_kernel_maps[kernel_map_key];
+  auto p_origin_map = find_kernel_map(m_kernel_maps, kernel_map_key);
+  if (p_origin_map != nullptr)
+    return p_origin_map;
+
+  std::lock_guard<std::recursive_mutex> build_lock(m_build_mutex);
+  p_origin_map = find_kernel_map(m_kernel_maps, kernel_map_key);
+  if (p_origin_map != nullptr)
+    return p_origin_map;
+
+  auto const key = origin().first;
+  auto const &origin_coordinate_map = find(key)->second;
+  auto origin_map = find(p_in_map_key->get_key())
+                        ->second.origin_map(origin_coordinate_map);
+
+  auto p_new_origin_map =
+      std::make_shared<kernel_map_type>(std::move(origin_map));
+  std::unique_lock<std::shared_timed_mutex> lock(m_mutex);
+  m_kernel_maps[kernel_map_key] = p_new_origin_map;
+  created(p_new_origin_map.get());
+  return p_new_origin_map;
 }
 
 template <typename coordinate_type, typename coordinate_field_type,
@@ -918,7 +1082,7 @@ template <typename coordinate_type, typename coordinate_field_type,
           class CoordinateMapType>
 typename CoordinateMapManager<coordinate_type, coordinate_field_type,
                               TemplatedAllocator,
-                              CoordinateMapType>::kernel_map_type const &
+                              CoordinateMapType>::kernel_map_pointer_type
 CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
                      CoordinateMapType>::origin_field_map(CoordinateMapKey const
                                                               *p_in_map_key) {
@@ -927,15 +1091,26 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
       origin_map_key(p_in_map_key->get_key());
   coordinate_map_key_type const origin_key = std::get<1>(kernel_map_key);
 
-  if (m_field_kernel_maps.find(kernel_map_key) == m_field_kernel_maps.end()) {
-    auto const key = origin_field().first;
-    auto const &origin_coordinate_map = m_coordinate_maps.find(key)->second;
-    auto origin_map = m_field_coordinates.find(p_in_map_key->get_key())
-                          ->second.origin_map(origin_coordinate_map);
-    m_field_kernel_maps[kernel_map_key] = std::move(origin_map);
-  }
-
-  return m_field_kernel_maps[kernel_map_key];
+  auto p_origin_map = find_kernel_map(m_field_kernel_maps, kernel_map_key);
+  if (p_origin_map != nullptr)
+    return p_origin_map;
+
+  std::lock_guard<std::recursive_mutex> build_lock(m_build_mutex);
+  p_origin_map = find_kernel_map(m_field_kernel_maps, kernel_map_key);
+  if (p_origin_map != nullptr)
+    return p_origin_map;
+
+  auto const key = origin_field().first;
+  auto const &origin_coordinate_map = find(key)->second;
+  auto origin_map = find_field(p_in_map_key->get_key())
+                        ->second.origin_map(origin_coordinate_map);
+
+  auto p_new_origin_map =
+      std::make_shared<kernel_map_type>(std::move(origin_map));
+  std::unique_lock<std::shared_timed_mutex> lock(m_mutex);
+  m_field_kernel_maps[kernel_map_key] = p_new_origin_map;
+  created(p_new_origin_map.get());
+  return p_new_origin_map;
 }
 namespace detail {
 
@@ -972,6 +1147,76 @@ struct stride_map2tensor_functor<coordinate_type, std::allocator,
   }
 };
 
+template <typename coordinate_type>
+struct batch_row_indices_functor<coordinate_type, std::allocator,
+                                 CoordinateMapCPU> {
+
+  std::pair<at::Tensor, at::Tensor>
+  operator()(CoordinateMapCPU<coordinate_type, std::allocator> const
+                 &coordinate_map) {
+    auto const &batch_row_indices = coordinate_map.batch_row_indices();
+    auto const &row_ptr = batch_row_indices.first;
+    auto const &rows = batch_row_indices.second;
+
+    auto options =
+        torch::TensorOptions().dtype(torch::kLong).requires_grad(false);
+    at::Tensor th_row_ptr = torch::empty({(int64_t)row_ptr.size()}, options);
+    at::Tensor th_rows = torch::empty({(int64_t)rows.size()}, options);
+    std::copy(row_ptr.begin(), row_ptr.end(), th_row_ptr.data_ptr<int64_t>());
+    std::copy(rows.begin(), rows.end(), th_rows.data_ptr<int64_t>());
+    return std::make_pair(std::move(th_row_ptr), std::move(th_rows));
+  }
+};
+
+template <typename coordinate_type>
+struct neighbors_functor<coordinate_type, std::allocator, CoordinateMapCPU> {
+
+  std::vector<at::Tensor>
+  operator()(CoordinateMapCPU<coordinate_type, std::allocator> const &map,
+             at::Tensor const &query, double const radius, uint32_t const k,
+             bool const is_l2) {
+    return map.neighbors(query, radius, k, is_l2);
+  }
+};
+
+template <typename coordinate_type>
+struct update_map_functor<coordinate_type, std::allocator, CoordinateMapCPU> {
+
+  std::pair<default_types::index_vector_type, at::Tensor>
+  operator()(CoordinateMapCPU<coordinate_type, std::allocator> &map,
+             at::Tensor const &insert_coordinates,
+             at::Tensor const &erase_coordinates) {
+    coordinate_type const *p_erase =
+        erase_coordinates.data_ptr<coordinate_type>();
+    auto row_remap =
+        map.erase(p_erase, p_erase + erase_coordinates.numel());
+
+    coordinate_type const *p_insert =
+        insert_coordinates.data_ptr<coordinate_type>();
+    auto const rows =
+        map.append(p_insert, p_insert + insert_coordinates.numel());
+
+    at::Tensor th_rows = torch::empty(
+        {(int64_t)rows.size()},
+        torch::TensorOptions().requires_grad(false).dtype(torch::kInt64));
+    std::copy(rows.begin(), rows.end(), th_rows.data_ptr<int64_t>());
+    return std::make_pair(std::move(row_remap), std::move(th_rows));
+  }
+};
+
+template <typename coordinate_type>
+struct update_kernel_map_functor<coordinate_type, std::allocator,
+                                 CoordinateMapCPU, cpu_kernel_map> {
+
+  void operator()(CoordinateMapCPU<coordinate_type, std::allocator> const &map,
+                  cpu_kernel_map &kernel_map,
+                  cpu_kernel_region<coordinate_type> const &kernel,
+                  default_types::index_vector_type const &row_remap,
+                  default_types::index_type const first_new_row) {
+    map.update_kernel_map(kernel_map, kernel, row_remap, first_new_row);
+  }
+};
+
 } // namespace detail
 
 template <typename coordinate_type, typename coordinate_field_type,
@@ -988,10 +1233,8 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
   ASSERT(exists(p_in_map_key), ERROR_MAP_NOT_FOUND);
   ASSERT(exists(p_strided_map_key), ERROR_MAP_NOT_FOUND);
 
-  map_type const &in_map =
-      m_coordinate_maps.find(p_in_map_key->get_key())->second;
-  map_type const &strided_map =
-      m_coordinate_maps.find(p_strided_map_key->get_key())->second;
+  map_type const &in_map = find(p_in_map_key->get_key())->second;
+  map_type const &strided_map = find(p_strided_map_key->get_key())->second;
 
   // Get tensor strides and find kernel stride size
   // Check if the kernel map key exists
@@ -1015,22 +1258,32 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
       RegionType::HYPER_CUBE /* region_type */, 0 /* is_transpose */,
       true /* is_pool */);
 
-  if (m_kernel_maps.find(kernel_map_key) == m_kernel_maps.end()) {
-    LOG_DEBUG("Creating stride kernel map with kernel size:",
-              ArrToString(kernel_stride));
-    auto const stride_map =
-        detail::stride_map_functor<coordinate_type, TemplatedAllocator,
-                                   CoordinateMapType, kernel_map_type>()(
-            in_map, strided_map, strided_map.get_tensor_stride());
-
-    m_kernel_maps[kernel_map_key] = std::move(stride_map);
+  auto p_stride_map = find_kernel_map(m_kernel_maps, kernel_map_key);
+  if (p_stride_map == nullptr) {
+    std::lock_guard<std::recursive_mutex> build_lock(m_build_mutex);
+    p_stride_map = find_kernel_map(m_kernel_maps, kernel_map_key);
+    if (p_stride_map == nullptr) {
+      LOG_DEBUG("Creating stride kernel map with kernel size:",
+                ArrToString(kernel_stride));
+      auto stride_map =
+          detail::stride_map_functor<coordinate_type, TemplatedAllocator,
+                                     CoordinateMapType, kernel_map_type>()(
+              in_map, strided_map, strided_map.get_tensor_stride());
+
+      auto p_new_stride_map =
+          std::make_shared<kernel_map_type>(std::move(stride_map));
+      std::unique_lock<std::shared_timed_mutex> lock(m_mutex);
+      m_kernel_maps[kernel_map_key] = p_new_stride_map;
+      created(p_new_stride_map.get());
+      p_stride_map = std::move(p_new_stride_map);
+    }
   }
 
   // copy the kernel map to tensors
   return detail::stride_map2tensor_functor<coordinate_type, TemplatedAllocator,
                                            CoordinateMapType,
                                            kernel_map_type>()(
-      m_kernel_maps[kernel_map_key]);
+      *p_stride_map);
 }
 
 template <typename coordinate_type, typename coordinate_field_type,
@@ -1041,14 +1294,14 @@ std::pair<at::Tensor, std::vector<at::Tensor>>
 CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
                      CoordinateMapType>::origin_map_th(CoordinateMapKey const
                                                            *p_in_map_key) {
-  kernel_map_type const &kernel_map = origin_map(p_in_map_key);
+  auto const p_kernel_map = origin_map(p_in_map_key);
 
   coordinate_map_key_type const origin_key = origin().first;
-  map_type const &origin_map = m_coordinate_maps.find(origin_key)->second;
+  map_type const &origin_map = find(origin_key)->second;
 
   return detail::origin_map_functor<coordinate_type, TemplatedAllocator,
                                     CoordinateMapType, kernel_map_type>()(
-      origin_map, kernel_map);
+      origin_map, *p_kernel_map);
 }
 
 template <typename coordinate_type, typename coordinate_field_type,
@@ -1059,14 +1312,233 @@ std::pair<at::Tensor, std::vector<at::Tensor>>
 CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
                      CoordinateMapType>::
     origin_field_map_th(CoordinateMapKey const *p_in_map_key) {
-  kernel_map_type const &kernel_map = origin_field_map(p_in_map_key);
+  auto const p_kernel_map = origin_field_map(p_in_map_key);
 
   coordinate_map_key_type const origin_key = origin_field().first;
-  map_type const &origin_map = m_coordinate_maps.find(origin_key)->second;
+  map_type const &origin_map = find(origin_key)->second;
 
   return detail::origin_map_functor<coordinate_type, TemplatedAllocator,
                                     CoordinateMapType, kernel_map_type>()(
-      origin_map, kernel_map);
+      origin_map, *p_kernel_map);
+}
+
+template <typename coordinate_type, typename coordinate_field_type,
+          template <typename C> class TemplatedAllocator,
+          template <typename T, template <typename Q> class A>
+          class CoordinateMapType>
+std::pair<at::Tensor, at::Tensor>
+CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
+                     CoordinateMapType>::
+    batch_row_indices_th(CoordinateMapKey const *p_in_map_key) {
+  ASSERT(exists(p_in_map_key), ERROR_MAP_NOT_FOUND);
+  map_type const &in_map = find(p_in_map_key->get_key())->second;
+
+  return detail::batch_row_indices_functor<coordinate_type, TemplatedAllocator,
+                                           CoordinateMapType>()(in_map);
+}
+
+/*
+ * Erase and insert the coordinates of a map in place.
+ *
+ * The erased rows are filled with the last rows so that the rows stay
+ * contiguous and the inserted coordinates get the rows after them. The kernel
+ * maps of the map to itself with unit kernel strides are updated with the
+ * neighbors of the inserted coordinates only. The other kernel maps and the
+ * field to sparse maps of the map are dropped and regenerated on demand. The
+ * maps derived from the map, e.g. the strided maps, and the origin map are
+ * stale, so they are erased with their kernel maps and field to sparse maps.
+ * stride() regenerates them from the updated map under the same keys.
+ *
+ * An insertion takes O(inserted x kernel volume) lookups. An erasure adds a
+ * pass over the rows and the pairs of the updated kernel maps, O(N + pairs).
+ *
+ * The map and its kernel maps must not be used by other threads during the
+ * update, since the erased kernel maps are freed.
+ */
+template <typename coordinate_type, typename coordinate_field_type,
+          template <typename C> class TemplatedAllocator,
+          template <typename T, template <typename Q> class A>
+          class CoordinateMapType>
+std::pair<at::Tensor, at::Tensor>
+CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
+                     CoordinateMapType>::
+    update(CoordinateMapKey const *p_map_key,
+           at::Tensor const &insert_coordinates,
+           at::Tensor const &erase_coordinates) {
+  auto const omp_scope = thread_scope();
+  coordinate_map_key_check(p_map_key);
+  coordinate_map_key_type const &map_key = p_map_key->get_key();
+
+  std::lock_guard<std::recursive_mutex> build_lock(m_build_mutex);
+  std::unique_lock<std::shared_timed_mutex> lock(m_mutex);
+  auto map_it = m_coordinate_maps.find(map_key);
+  ASSERT(map_it != m_coordinate_maps.end(), ERROR_MAP_NOT_FOUND);
+  auto &map = map_it->second;
+  touch(&map);
+
+  for (auto const &coordinates : {insert_coordinates, erase_coordinates}) {
+    ASSERT(coordinates.scalar_type() == torch::kInt32,
+           "Coordinates must be an int type tensor.");
+    ASSERT(coordinates.is_contiguous(), "Coordinates must be contiguous.");
+    ASSERT(!coordinates.is_cuda(), "Coordinates must be a CPU tensor.");
+    ASSERT(coordinates.dim() == 2 &&
+               coordinates.size(1) == map.coordinate_size(),
+           "Coordinates must be a matrix with", map.coordinate_size(),
+           "columns.");
+  }
+
+  index_type const num_rows = map.size();
+  auto update_result =
+      detail::update_map_functor<coordinate_type, TemplatedAllocator,
+                                 CoordinateMapType>()(map, insert_coordinates,
+                                                      erase_coordinates);
+  // row_remap is empty if no coordinate is erased
+  auto const &row_remap = update_result.first;
+  index_type const first_new_row =
+      num_rows - std::count(row_remap.begin(), row_remap.end(),
+                            std::numeric_limits<index_type>::max());
+  LOG_DEBUG("updated map from", num_rows, "to", map.size(), "rows");
+
+  // The maps derived from the map, e.g. the strided maps, and the origin map
+  // are stale. Erase them and the maps derived from them so that they are
+  // regenerated from the updated map on demand.
+  std::set<coordinate_map_key_type> stale_keys;
+  std::vector<coordinate_map_key_type> stale_queue{map_key};
+  while (!stale_queue.empty()) {
+    auto const key = std::move(stale_queue.back());
+    stale_queue.pop_back();
+    auto const derived_it = m_derived_keys.find(key);
+    if (derived_it == m_derived_keys.end())
+      continue;
+    for (auto const &derived_key : derived_it->second)
+      if (derived_key != map_key && stale_keys.insert(derived_key).second)
+        stale_queue.push_back(derived_key);
+    m_derived_keys.erase(derived_it);
+  }
+  coordinate_map_key_type const origin_key(
+      stride_type(map.coordinate_size() - 1, 0), "");
+  if (origin_key != map_key)
+    stale_keys.insert(origin_key);
+  for (auto const &key : stale_keys) {
+    auto const stale_it = m_coordinate_maps.find(key);
+    if (stale_it == m_coordinate_maps.end())
+      continue;
+    LOG_DEBUG("erase stale map", key);
+    m_entry_times.erase(&stale_it->second);
+    m_coordinate_maps.erase(stale_it);
+    m_derived_keys.erase(key);
+  }
+  auto const is_affected = [&](coordinate_map_key_type const &key) {
+    return key == map_key || stale_keys.count(key) > 0;
+  };
+
+  for (auto it = m_kernel_maps.begin(); it != m_kernel_maps.end();) {
+    auto const &kernel_map_key = it->first;
+    bool const is_in = std::get<0>(kernel_map_key) == map_key;
+    bool const is_out = std::get<1>(kernel_map_key) == map_key;
+    if (!is_affected(std::get<0>(kernel_map_key)) &&
+        !is_affected(std::get<1>(kernel_map_key))) {
+      ++it;
+      continue;
+    }
+
+    auto const &kernel_size = std::get<2>(kernel_map_key);
+    auto const &kernel_stride = std::get<3>(kernel_map_key);
+    auto const &kernel_dilation = std::get<4>(kernel_map_key);
+    auto const region_type = std::get<5>(kernel_map_key);
+    bool const is_transpose = std::get<6>(kernel_map_key);
+    bool const is_pool = std::get<7>(kernel_map_key);
+    // A kernel map between the map and a stale map is erased
+    bool const is_updatable =
+        is_in && is_out && !is_transpose && region_type != RegionType::CUSTOM &&
+        !(is_pool && kernel_stride == kernel_size) &&
+        std::all_of(kernel_stride.begin(), kernel_stride.end(),
+                    [](auto const &s) { return s == 1; });
+    if (!is_updatable) {
+      m_entry_times.erase(it->second.get());
+      it = m_kernel_maps.erase(it);
+      continue;
+    }
+
+    // Update a copy of the kernel map in use by the other threads.
+    if (it->second.use_count() > 1) {
+      auto const times_it = m_entry_times.find(it->second.get());
+      auto p_copy = std::make_shared<kernel_map_type>(*it->second);
+      if (times_it != m_entry_times.end()) {
+        int64_t const created = times_it->second.created;
+        int64_t const last_used =
+            times_it->second.last_used.load(std::memory_order_relaxed);
+        m_entry_times.erase(times_it);
+        m_entry_times
+            .emplace(std::piecewise_construct,
+                     std::forward_as_tuple(p_copy.get()),
+                     std::forward_as_tuple(created))
+            .first->second.last_used.store(last_used,
+                                           std::memory_order_relaxed);
+      }
+      it->second = std::move(p_copy);
+    }
+
+    auto const kernel_region = cpu_kernel_region<coordinate_type>(
+        region_type, map.coordinate_size(), map.get_tensor_stride().data(),
+        kernel_size.data(), kernel_dilation.data());
+    detail::update_kernel_map_functor<coordinate_type, TemplatedAllocator,
+                                      CoordinateMapType, kernel_map_type>()(
+        map, *it->second, kernel_region, row_remap, first_new_row);
+    detail::kernel_map_layout_functor<kernel_map_type>()(*it->second,
+                                                         m_algorithm);
+    ++it;
+  }
+
+  for (auto it = m_transient_kernel_maps.begin();
+       it != m_transient_kernel_maps.end();) {
+    if (is_affected(std::get<0>(it->first)) ||
+        is_affected(std::get<1>(it->first))) {
+      m_entry_times.erase(it->second.get());
+      it = m_transient_kernel_maps.erase(it);
+    } else
+      ++it;
+  }
+
+  for (auto it = m_field_kernel_maps.begin(); it != m_field_kernel_maps.end();) {
+    if (is_affected(std::get<0>(it->first)) ||
+        is_affected(std::get<1>(it->first))) {
+      m_entry_times.erase(it->second.get());
+      it = m_field_kernel_maps.erase(it);
+    } else
+      ++it;
+  }
+
+  for (auto it = m_field_to_sparse_maps.begin();
+       it != m_field_to_sparse_maps.end();) {
+    if (is_affected(it->first.second)) {
+      m_entry_times.erase(&it->second);
+      it = m_field_to_sparse_maps.erase(it);
+    } else
+      ++it;
+  }
+
+  // (old row, new row) of the moved rows
+  std::vector<int64_t> moved_rows;
+  for (index_type row = 0; row < row_remap.size(); ++row) {
+    if (row_remap[row] != row &&
+        row_remap[row] != std::numeric_limits<index_type>::max()) {
+      moved_rows.push_back(row);
+      moved_rows.push_back(row_remap[row]);
+    }
+  }
+  int64_t const num_moved = moved_rows.size() / 2;
+  at::Tensor th_moved_rows = torch::empty(
+      {2, num_moved},
+      torch::TensorOptions().requires_grad(false).dtype(torch::kInt64));
+  int64_t *p_moved_rows = th_moved_rows.data_ptr<int64_t>();
+  for (int64_t i = 0; i < num_moved; ++i) {
+    p_moved_rows[i] = moved_rows[2 * i];
+    p_moved_rows[num_moved + i] = moved_rows[2 * i + 1];
+  }
+
+  return std::make_pair(std::move(update_result.second),
+                        std::move(th_moved_rows));
 }
 
 // Interpolation map
@@ -1079,11 +1551,35 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
                      CoordinateMapType>::
     interpolation_map_weight(at::Tensor const &tfield,
                              CoordinateMapKey const *p_in_map_key) {
+  auto const omp_scope = thread_scope();
   ASSERT(exists(p_in_map_key), ERROR_MAP_NOT_FOUND);
-  return m_coordinate_maps.find(p_in_map_key->get_key())
+  return find(p_in_map_key->get_key())
       ->second.interpolation_map_weight(tfield);
 }
 
+template <typename coordinate_type, typename coordinate_field_type,
+          template <typename C> class TemplatedAllocator,
+          template <typename T, template <typename Q> class A>
+          class CoordinateMapType>
+std::vector<at::Tensor>
+CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
+                     CoordinateMapType>::neighbors(at::Tensor const &query,
+                                                   CoordinateMapKey const
+                                                       *p_map_key,
+                                                   double const radius,
+                                                   uint32_t const k,
+                                                   bool const is_l2) {
+  auto const omp_scope = thread_scope();
+  ASSERT(exists(p_map_key), ERROR_MAP_NOT_FOUND);
+  ASSERT(query.is_contiguous(), "Query points must be contiguous.");
+  ASSERT(query.is_cuda() ==
+             !detail::is_cpu_coordinate_map<CoordinateMapType>::value,
+         "Invalid device for the query points");
+  return detail::neighbors_functor<coordinate_type, TemplatedAllocator,
+                                   CoordinateMapType>()(
+      find(p_map_key->get_key())->second, query, radius, k, is_l2);
+}
+
 /*********************************/
 /*
 template <typename MapType>
@@ -1249,6 +1745,7 @@ coordinate_map_key_type
 CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
                      CoordinateMapType>::
     merge(std::vector<coordinate_map_key_type> const &map_keys) {
+  auto const omp_scope = thread_scope();
   ASSERT(map_keys.size() > 1, "Got one or zero map. Merge at least 2 maps.");
   // Aggregate all coords maps
   std::vector<std::reference_wrapper<map_type>> maps;
@@ -1256,7 +1753,7 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
   stride_type merged_map_tensor_stride{map_keys[0].first};
   for (const auto &key : map_keys) {
     ASSERT(exists(key), ERROR_MAP_NOT_FOUND);
-    auto &map = m_coordinate_maps.find(key)->second;
+    auto &map = find(key)->second;
     maps.push_back(map);
     for (int k = 0; k < tensor_stride_size; ++k) {
       merged_map_tensor_stride[k] =
@@ -1267,9 +1764,11 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
   // Create a merged map with the smallest tensor stride
   coordinate_map_key_type merged_map_key =
       get_random_string_id(merged_map_tensor_stride, "merge");
-  map_type const &map = m_coordinate_maps.find(map_keys[0])->second;
+  map_type const &map = find(map_keys[0])->second;
   map_type merged_map = map.merge(maps);
   insert(merged_map_key, merged_map);
+  for (auto const &key : map_keys)
+    derived(key, merged_map_key);
   return merged_map_key;
 }
 
@@ -1283,12 +1782,12 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
     union_map(std::vector<coordinate_map_key_type> const &map_keys) {
   // Create a merged map
   auto const merged_key = merge(map_keys);
-  map_type const &merged_map = m_coordinate_maps.find(merged_key)->second;
+  map_type const &merged_map = find(merged_key)->second;
 
   std::vector<std::reference_wrapper<map_type>> maps;
   for (const auto &key : map_keys) {
     ASSERT(exists(key), ERROR_MAP_NOT_FOUND);
-    maps.push_back(std::ref(m_coordinate_maps.find(key)->second));
+    maps.push_back(std::ref(find(key)->second));
   }
 
   return std::make_pair(merged_key, merged_map.union_map(maps));
@@ -1326,8 +1825,8 @@ CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
                      CoordinateMapType>::get_coordinates(CoordinateMapKey const
                                                              *p_key) const {
   ASSERT(exists(p_key), ERROR_MAP_NOT_FOUND);
-  auto const it = m_coordinate_maps.find(p_key->get_key());
-  ASSERT(it != m_coordinate_maps.end(), ERROR_MAP_NOT_FOUND);
+  auto const it = find(p_key->get_key());
+  ASSERT(it != map_end(), ERROR_MAP_NOT_FOUND);
   auto const &map = it->second;
   auto const nrows = map.size();
   auto const ncols = map.coordinate_size();
@@ -1403,14 +1902,14 @@ std::unordered_map<int64_t, at::Tensor> CoordinateMapManager<
                                       at::Tensor const &offset,
                                       bool is_transpose, bool is_pool) {
 
-  auto const &curr_kernel_map =
+  auto const p_curr_kernel_map =
       kernel_map(p_in_map_key, p_out_map_key,                 // maps
                  kernel_size, kernel_stride, kernel_dilation, // kernels
                  region_type, offset, is_transpose, is_pool);
 
   return detail::kernel_map_to_tensors<coordinate_type, TemplatedAllocator,
                                        CoordinateMapType, kernel_map_type>()(
-      curr_kernel_map);
+      *p_curr_kernel_map);
 }
 
 template <typename coordinate_type, typename coordinate_field_type,
@@ -1420,8 +1919,8 @@ template <typename coordinate_type, typename coordinate_field_type,
 at::Tensor CoordinateMapManager<coordinate_type, coordinate_field_type,
                                 TemplatedAllocator, CoordinateMapType>::
     get_coordinate_field(CoordinateMapKey const *p_key) const {
-  auto const it = m_field_coordinates.find(p_key->get_key());
-  ASSERT(it != m_field_coordinates.end(), ERROR_MAP_NOT_FOUND);
+  auto const it = find_field(p_key->get_key());
+  ASSERT(it != field_map_end(), ERROR_MAP_NOT_FOUND);
   auto const &map = it->second;
   auto const nrows = map.size();
   auto const ncols = map.coordinate_size();
@@ -1448,6 +1947,393 @@ at::Tensor CoordinateMapManager<coordinate_type, coordinate_field_type,
   return coordinates;
 }
 
+/*******************************
+ * Serialization
+ *******************************/
+
+namespace detail {
+
+template <typename coordinate_type, typename coordinate_field_type>
+struct coordinate_map_manager_serializer<coordinate_type, coordinate_field_type,
+                                         std::allocator, CoordinateMapCPU> {
+  using manager_type = CoordinateMapManager<coordinate_type,
+                                            coordinate_field_type,
+                                            std::allocator, CoordinateMapCPU>;
+  using map_type = typename manager_type::map_type;
+  using field_map_type = typename manager_type::field_map_type;
+  using size_type = default_types::size_type;
+  using index_type = default_types::index_type;
+
+  template <typename kernel_map_collection_type>
+  void write_kernel_maps(binary_writer &writer,
+                         kernel_map_collection_type const &kernel_maps) {
+    for (auto const &kv : kernel_maps) {
+      writer.write_kernel_map_key(kv.first);
+      cpu_kernel_map const &kernel_map = *kv.second;
+      ASSERT(kernel_map.first.size() == kernel_map.second.size(),
+             "invalid kernel_map");
+      writer.write<uint64_t>(kernel_map.first.size());
+      for (size_t k = 0; k < kernel_map.first.size(); ++k) {
+        writer.write_vector(kernel_map.first[k]);
+        writer.write_vector(kernel_map.second[k]);
+      }
+    }
+  }
+
+  template <typename kernel_map_collection_type>
+  void read_kernel_maps(binary_reader &reader, uint64_t const num_kernel_maps,
+                        kernel_map_collection_type &kernel_maps) {
+    for (uint64_t i = 0; i < num_kernel_maps; ++i) {
+      auto kernel_map_key = reader.read_kernel_map_key();
+      uint64_t const kernel_volume = reader.read<uint64_t>();
+      // Each kernel offset has two array lengths
+      reader.check_count(kernel_volume, 2 * sizeof(uint64_t));
+      cpu_kernel_map kernel_map;
+      kernel_map.first.resize(kernel_volume);
+      kernel_map.second.resize(kernel_volume);
+      for (uint64_t k = 0; k < kernel_volume; ++k) {
+        kernel_map.first[k] = reader.read_vector<index_type>();
+        kernel_map.second[k] = reader.read_vector<index_type>();
+        ASSERT(kernel_map.first[k].size() == kernel_map.second[k].size(),
+               "invalid kernel_map");
+      }
+      kernel_maps[kernel_map_key] =
+          std::make_shared<cpu_kernel_map>(std::move(kernel_map));
+    }
+  }
+
+  void save(manager_type const &manager, std::string const &path) {
+    binary_writer writer(path);
+
+    serialization_header header;
+    std::copy_n(SERIALIZATION_MAGIC, sizeof(header.magic), header.magic);
+    header.version = SERIALIZATION_VERSION;
+    header.byte_order = SERIALIZATION_BYTE_ORDER;
+    header.coordinate_type_size = sizeof(coordinate_type);
+    header.coordinate_field_type_size = sizeof(coordinate_field_type);
+    header.index_type_size = sizeof(index_type);
+    header.algorithm = manager.m_algorithm;
+    header.num_coordinate_maps = manager.m_coordinate_maps.size();
+    header.num_field_maps = manager.m_field_coordinates.size();
+    header.num_kernel_maps = manager.m_kernel_maps.size();
+    header.num_field_kernel_maps = manager.m_field_kernel_maps.size();
+    header.num_field_to_sparse_maps = manager.m_field_to_sparse_maps.size();
+    writer.write(header);
+
+    // Coordinates are stored in the row order. The row index is the mapped
+    // value of the hash table.
+    for (auto const &kv : manager.m_coordinate_maps) {
+      map_type const &map = kv.second;
+      writer.write_key(kv.first);
+      writer.write_vector(map.get_tensor_stride());
+      writer.write<uint32_t>(map.coordinate_size());
+      writer.write_array(map.const_coordinate_data(),
+                         uint64_t(map.size()) * map.coordinate_size());
+    }
+
+    for (auto const &kv : manager.m_field_coordinates) {
+      field_map_type const &map = kv.second;
+      writer.write_key(kv.first);
+      writer.write_vector(map.get_tensor_stride());
+      writer.write<uint32_t>(map.coordinate_size());
+      writer.write_array(map.const_coordinate_data(),
+                         uint64_t(map.size()) * map.coordinate_size());
+    }
+
+    write_kernel_maps(writer, manager.m_kernel_maps);
+    write_kernel_maps(writer, manager.m_field_kernel_maps);
+
+    for (auto const &kv : manager.m_field_to_sparse_maps) {
+      writer.write_key(kv.first.first);
+      writer.write_key(kv.first.second);
+      for (at::Tensor const &map : {kv.second.first, kv.second.second}) {
+        at::Tensor const cmap = map.contiguous();
+        writer.write<int32_t>(static_cast<int32_t>(cmap.scalar_type()));
+        writer.write_array(static_cast<char const *>(cmap.data_ptr()),
+                           cmap.nbytes());
+      }
+    }
+
+    writer.close();
+  }
+
+  void load(manager_type &manager, std::string const &path) {
+    ASSERT(manager.m_coordinate_maps.empty() &&
+               manager.m_field_coordinates.empty(),
+           "Cannot load maps to a coordinate manager with existing maps.");
+    binary_reader reader(path);
+
+    auto const header = reader.read<serialization_header>();
+    ASSERT(std::equal(header.magic, header.magic + sizeof(header.magic),
+                      SERIALIZATION_MAGIC),
+           "Invalid coordinate manager file:", path);
+    ASSERT(header.version == SERIALIZATION_VERSION,
+           "Unsupported coordinate manager file version:", header.version,
+           "expected:", SERIALIZATION_VERSION);
+    ASSERT(header.byte_order == SERIALIZATION_BYTE_ORDER,
+           "Byte order mismatch in", path);
+    ASSERT(header.coordinate_type_size == sizeof(coordinate_type) &&
+               header.coordinate_field_type_size ==
+                   sizeof(coordinate_field_type) &&
+               header.index_type_size == sizeof(index_type),
+           "Coordinate type mismatch in", path);
+    WARNING(header.algorithm != manager.m_algorithm,
+            "The coordinate manager was saved with a different "
+            "MinkowskiAlgorithm.");
+
+    for (uint64_t i = 0; i < header.num_coordinate_maps; ++i) {
+      auto map_key = reader.read_key();
+      auto const tensor_stride = reader.read_vector<size_type>();
+      uint32_t const coordinate_size = reader.read<uint32_t>();
+      uint64_t const num_elements = reader.read_array_size<coordinate_type>();
+      ASSERT(coordinate_size > 0 && num_elements % coordinate_size == 0,
+             "Invalid coordinate map size in", path);
+      size_type const N = num_elements / coordinate_size;
+
+      std::vector<coordinate_type> coordinates(num_elements);
+      reader.read_array_data(coordinates.data(), num_elements);
+
+      // Rebuild the hash table. Inserting in the row order restores the
+      // original row indices, which keeps the saved kernel maps valid.
+      map_type map(N, coordinate_size, tensor_stride);
+      map.insert(coordinates.data(), coordinates.data() + num_elements);
+      ASSERT(map.size() == N, "Duplicate coordinates in", path);
+      manager.insert(std::move(map_key), map);
+    }
+
+    for (uint64_t i = 0; i < header.num_field_maps; ++i) {
+      auto map_key = reader.read_key();
+      auto const tensor_stride = reader.read_vector<size_type>();
+      uint32_t const coordinate_size = reader.read<uint32_t>();
+      uint64_t const num_elements =
+          reader.read_array_size<coordinate_field_type>();
+      ASSERT(coordinate_size > 0 && num_elements % coordinate_size == 0,
+             "Invalid coordinate field size in", path);
+      size_type const N = num_elements / coordinate_size;
+
+      // The field map owns a flat coordinate buffer. Read it in place.
+      field_map_type map(N, coordinate_size, tensor_stride);
+      reader.read_array_data(map.coordinate_data(), num_elements);
+      manager.insert_field_map(std::move(map_key), map);
+    }
+
+    std::unique_lock<std::shared_timed_mutex> lock(manager.m_mutex);
+    read_kernel_maps(reader, header.num_kernel_maps, manager.m_kernel_maps);
+    read_kernel_maps(reader, header.num_field_kernel_maps,
+                     manager.m_field_kernel_maps);
+
+    for (uint64_t i = 0; i < header.num_field_to_sparse_maps; ++i) {
+      auto field_key = reader.read_key();
+      auto sparse_key = reader.read_key();
+      std::array<at::Tensor, 2> maps;
+      for (auto &map : maps) {
+        auto const dtype = static_cast<at::ScalarType>(reader.read<int32_t>());
+        ASSERT(dtype == at::kInt || dtype == at::kLong,
+               "Invalid field to sparse map type in", path);
+        uint64_t const num_bytes = reader.read_array_size<char>();
+        ASSERT(num_bytes % at::elementSize(dtype) == 0,
+               "Invalid field to sparse map size in", path);
+        map = torch::empty(
+            {int64_t(num_bytes / at::elementSize(dtype))},
+            torch::TensorOptions().dtype(dtype).requires_grad(false));
+        reader.read_array_data(static_cast<char *>(map.data_ptr()), num_bytes);
+      }
+      manager.m_field_to_sparse_maps.insert(
+          std::pair<
+              const std::pair<coordinate_map_key_type, coordinate_map_key_type>,
+              const std::pair<at::Tensor, at::Tensor>>{
+              {field_key, sparse_key}, {maps[0], maps[1]}});
+    }
+
+    for (auto const &kv : manager.m_kernel_maps)
+      manager.created(kv.second.get());
+    for (auto const &kv : manager.m_field_kernel_maps)
+      manager.created(kv.second.get());
+    for (auto const &kv : manager.m_field_to_sparse_maps)
+      manager.created(&kv.second);
+  }
+};
+
+} // namespace detail
+
+template <typename coordinate_type, typename coordinate_field_type,
+          template <typename C> class TemplatedAllocator,
+          template <typename T, template <typename Q> class A>
+          class CoordinateMapType>
+void CoordinateMapManager<coordinate_type, coordinate_field_type,
+                          TemplatedAllocator,
+                          CoordinateMapType>::save(std::string const &path)
+    const {
+  LOG_DEBUG("Saving coordinate manager to", path);
+  std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+  detail::coordinate_map_manager_serializer<
+      coordinate_type, coordinate_field_type, TemplatedAllocator,
+      CoordinateMapType>()
+      .save(*this, path);
+}
+
+template <typename coordinate_type, typename coordinate_field_type,
+          template <typename C> class TemplatedAllocator,
+          template <typename T, template <typename Q> class A>
+          class CoordinateMapType>
+void CoordinateMapManager<coordinate_type, coordinate_field_type,
+                          TemplatedAllocator,
+                          CoordinateMapType>::load(std::string const &path) {
+  LOG_DEBUG("Loading coordinate manager from", path);
+  detail::coordinate_map_manager_serializer<
+      coordinate_type, coordinate_field_type, TemplatedAllocator,
+      CoordinateMapType>()
+      .load(*this, path);
+}
+
+/*
+ * Memory introspection
+ */
+template <typename coordinate_type, typename coordinate_field_type,
+          template <typename C> class TemplatedAllocator,
+          template <typename T, template <typename Q> class A>
+          class CoordinateMapType>
+py::dict CoordinateMapManager<coordinate_type, coordinate_field_type,
+                              TemplatedAllocator,
+                              CoordinateMapType>::memory_stats() const {
+  auto const py_key = [](coordinate_map_key_type const &key) {
+    return py::cast(new CoordinateMapKey(key.first.size() + 1, key));
+  };
+  auto const py_list = [](auto const &vec) {
+    py::list list;
+    for (auto const &v : vec)
+      list.append(v);
+    return list;
+  };
+  auto const set_times = [this](py::dict &entry, void const *p_entry) {
+    auto const it = m_entry_times.find(p_entry);
+    if (it == m_entry_times.end()) {
+      entry["created"] = py::none();
+      entry["last_used"] = py::none();
+    } else {
+      entry["created"] = it->second.created * 1e-9;
+      entry["last_used"] =
+          it->second.last_used.load(std::memory_order_relaxed) * 1e-9;
+    }
+  };
+  auto const kernel_map_entry = [&](kernel_map_key_type const &key,
+                                    kernel_map_type const &kernel_map) {
+    auto const memory =
+        detail::kernel_map_memory_functor<kernel_map_type>()(kernel_map);
+    py::dict entry;
+    entry["in_key"] = py_key(std::get<0>(key));
+    entry["out_key"] = py_key(std::get<1>(key));
+    entry["kernel_size"] = py_list(std::get<2>(key));
+    entry["kernel_stride"] = py_list(std::get<3>(key));
+    entry["kernel_dilation"] = py_list(std::get<4>(key));
+    entry["region_type"] = std::get<5>(key);
+    entry["is_transpose"] = std::get<6>(key);
+    entry["is_pool"] = std::get<7>(key);
+    entry["size"] = std::accumulate(memory.second.begin(), memory.second.end(),
+                                    int64_t(0));
+    entry["sizes"] = py_list(memory.second);
+    entry["bytes"] = memory.first;
+    set_times(entry, &kernel_map);
+    return entry;
+  };
+
+  std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+  py::list coordinate_maps;
+  for (auto const &kv : m_coordinate_maps) {
+    auto const memory =
+        detail::map_memory_functor<coordinate_type, TemplatedAllocator,
+                                   CoordinateMapType>()(kv.second);
+    py::dict entry;
+    entry["key"] = py_key(kv.first);
+    entry["size"] = kv.second.size();
+    entry["capacity"] = kv.second.capacity();
+    entry["hash_capacity"] = std::get<2>(memory);
+    entry["load_factor"] = std::get<3>(memory);
+    entry["coordinate_bytes"] = std::get<0>(memory);
+    entry["hash_bytes"] = std::get<1>(memory);
+    entry["bytes"] = std::get<0>(memory) + std::get<1>(memory);
+    set_times(entry, &kv.second);
+    coordinate_maps.append(entry);
+  }
+
+  py::list field_maps;
+  for (auto const &kv : m_field_coordinates) {
+    py::dict entry;
+    entry["key"] = py_key(kv.first);
+    entry["size"] = kv.second.size();
+    entry["capacity"] = kv.second.capacity();
+    entry["bytes"] = kv.second.capacity() * kv.second.coordinate_size() *
+                     sizeof(coordinate_field_type);
+    set_times(entry, &kv.second);
+    field_maps.append(entry);
+  }
+
+  py::list kernel_maps, field_kernel_maps, transient_kernel_maps;
+  for (auto const &kv : m_kernel_maps)
+    kernel_maps.append(kernel_map_entry(kv.first, *kv.second));
+  for (auto const &kv : m_field_kernel_maps)
+    field_kernel_maps.append(kernel_map_entry(kv.first, *kv.second));
+  for (auto const &kv : m_transient_kernel_maps)
+    transient_kernel_maps.append(kernel_map_entry(kv.first, *kv.second));
+
+  py::list field_to_sparse_maps;
+  for (auto const &kv : m_field_to_sparse_maps) {
+    py::dict entry;
+    entry["field_key"] = py_key(kv.first.first);
+    entry["sparse_key"] = py_key(kv.first.second);
+    entry["size"] = kv.second.first.numel();
+    entry["bytes"] = kv.second.first.nbytes() + kv.second.second.nbytes();
+    set_times(entry, &kv.second);
+    field_to_sparse_maps.append(entry);
+  }
+
+  py::dict stats;
+  stats["coordinate_maps"] = coordinate_maps;
+  stats["field_maps"] = field_maps;
+  stats["kernel_maps"] = kernel_maps;
+  stats["field_kernel_maps"] = field_kernel_maps;
+  stats["transient_kernel_maps"] = transient_kernel_maps;
+  stats["field_to_sparse_maps"] = field_to_sparse_maps;
+  return stats;
+}
+
+template <typename coordinate_type, typename coordinate_field_type,
+          template <typename C> class TemplatedAllocator,
+          template <typename T, template <typename Q> class A>
+          class CoordinateMapType>
+typename CoordinateMapManager<coordinate_type, coordinate_field_type,
+                              TemplatedAllocator, CoordinateMapType>::size_type
+CoordinateMapManager<coordinate_type, coordinate_field_type, TemplatedAllocator,
+                     CoordinateMapType>::
+    clear_kernel_maps(double const last_used_before) {
+  int64_t const threshold = last_used_before * 1e9;
+  size_type num_erased = 0;
+  auto const clear = [&](kernel_map_collection_type &kernel_maps,
+                         bool const clear_all) {
+    for (auto it = kernel_maps.begin(); it != kernel_maps.end();) {
+      auto const times_it = m_entry_times.find(it->second.get());
+      bool const has_times = times_it != m_entry_times.end();
+      if (clear_all || !has_times ||
+          times_it->second.last_used.load(std::memory_order_relaxed) <
+              threshold) {
+        if (has_times)
+          m_entry_times.erase(times_it);
+        it = kernel_maps.erase(it);
+        ++num_erased;
+      } else
+        ++it;
+    }
+  };
+
+  std::lock_guard<std::recursive_mutex> build_lock(m_build_mutex);
+  std::unique_lock<std::shared_timed_mutex> lock(m_mutex);
+  clear(m_kernel_maps, false);
+  clear(m_field_kernel_maps, false);
+  clear(m_transient_kernel_maps, true);
+  LOG_DEBUG("erased", num_erased, "kernel maps");
+  return num_erased;
+}
+
 template class CoordinateMapManager<default_types::dcoordinate_type,
                                     default_types::ccoordinate_type,
                                     std::allocator, CoordinateMapCPU>;
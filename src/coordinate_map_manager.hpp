@@ -31,6 +31,8 @@
 #include "coordinate_map_cpu.hpp"
 #include "coordinate_map_key.hpp"
 #include "errors.hpp"
+#include "profiler.hpp"
+#include "serialization.hpp"
 #include "types.hpp"
 #include "utils.hpp"
 
@@ -41,11 +43,18 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <iostream>
 #include <iterator>
+#include <memory>
+#include <mutex>
 #include <omp.h>
+#include <set>
+#include <shared_mutex>
 #include <string>
+#include <tuple>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
@@ -65,6 +74,97 @@ struct is_cpu_coordinate_map : std::false_type {};
 
 template <> struct is_cpu_coordinate_map<CoordinateMapCPU> : std::true_type {};
 
+// Rehash a coordinate map so that at most `occupancy` percent of the buckets
+// are used. The GPU hash tables are sized on construction.
+template <typename coordinate_type,
+          template <typename C> class TemplatedAllocator,
+          template <typename T, template <typename Q> class A>
+          class CoordinateMapType>
+struct hash_occupancy_functor {
+  void operator()(CoordinateMapType<coordinate_type, TemplatedAllocator> &map,
+                  size_t const occupancy) {}
+};
+
+template <typename coordinate_type,
+          template <typename C> class TemplatedAllocator>
+struct hash_occupancy_functor<coordinate_type, TemplatedAllocator,
+                              CoordinateMapCPU> {
+  void operator()(CoordinateMapCPU<coordinate_type, TemplatedAllocator> &map,
+                  size_t const occupancy) {
+    if (occupancy > 0)
+      map.rehash(occupancy);
+  }
+};
+
+// Memory usage of a coordinate map as (coordinate bytes, hash table bytes,
+// hash table slots, load factor). Not available for the GPU hash tables.
+template <typename coordinate_type,
+          template <typename C> class TemplatedAllocator,
+          template <typename T, template <typename Q> class A>
+          class CoordinateMapType>
+struct map_memory_functor {
+  std::tuple<size_t, size_t, size_t, float>
+  operator()(CoordinateMapType<coordinate_type, TemplatedAllocator> const &map) {
+    ASSERT(false, ERROR_NOT_IMPLEMENTED, "for a GPU coordinate manager.");
+    return std::make_tuple(0, 0, 0, 0.f);
+  }
+};
+
+template <typename coordinate_type,
+          template <typename C> class TemplatedAllocator>
+struct map_memory_functor<coordinate_type, TemplatedAllocator,
+                          CoordinateMapCPU> {
+  std::tuple<size_t, size_t, size_t, float> operator()(
+      CoordinateMapCPU<coordinate_type, TemplatedAllocator> const &map) {
+    return std::make_tuple(map.coordinate_bytes(), map.hash_bytes(),
+                           map.hash_capacity(), map.load_factor());
+  }
+};
+
+// Memory usage of a kernel map as (bytes, number of pairs of each kernel
+// offset).
+template <typename kernel_map_type> struct kernel_map_memory_functor {
+  std::pair<size_t, std::vector<int64_t>>
+  operator()(kernel_map_type const &kernel_map) {
+    ASSERT(false, ERROR_NOT_IMPLEMENTED, "for a GPU coordinate manager.");
+    return std::make_pair(0, std::vector<int64_t>());
+  }
+};
+
+template <> struct kernel_map_memory_functor<cpu_kernel_map> {
+  std::pair<size_t, std::vector<int64_t>>
+  operator()(cpu_kernel_map const &kernel_map) {
+    std::vector<int64_t> sizes;
+    for (auto const &in_map : kernel_map.first)
+      sizes.push_back(in_map.size());
+    return std::make_pair(kernel_map.bytes(), sizes);
+  }
+};
+
+// Reorder the rows of a coordinate map along a space filling curve and return
+// the old row of each new row. The GPU coordinate maps keep the hash order.
+template <typename coordinate_type,
+          template <typename C> class TemplatedAllocator,
+          template <typename T, template <typename Q> class A>
+          class CoordinateMapType>
+struct reorder_functor {
+  default_types::index_vector_type
+  operator()(CoordinateMapType<coordinate_type, TemplatedAllocator> &map,
+             CoordinateOrdering::Type const ordering) {
+    return default_types::index_vector_type();
+  }
+};
+
+template <typename coordinate_type,
+          template <typename C> class TemplatedAllocator>
+struct reorder_functor<coordinate_type, TemplatedAllocator, CoordinateMapCPU> {
+  default_types::index_vector_type
+  operator()(CoordinateMapCPU<coordinate_type, TemplatedAllocator> &map,
+             CoordinateOrdering::Type const ordering) {
+    return map.reorder(ordering);
+  }
+};
+
 template <typename T1, typename T2> void copy_types(const T1 &src, T2 &dst) {
   size_t curr_it = 0;
   for (const auto s : src)
@@ -78,6 +178,13 @@ default_types::stride_type _fill_vec(size_t const len) {
   return vec;
 }
 
+// a partial specialization functor for saving and loading a manager
+template <typename coordinate_type, typename coordinate_field_type,
+          template <typename C> class TemplatedAllocator,
+          template <typename T, template <typename Q> class A>
+          class CoordinateMapType>
+struct coordinate_map_manager_serializer;
+
 } // namespace detail
 
 template <typename coordinate_type, typename coordinate_field_type,
@@ -106,6 +213,9 @@ public:
                                          TemplatedAllocator, CoordinateMapType>;
   using map_collection_type = std::map<coordinate_map_key_type, map_type,
                                        coordinate_map_key_comparator>;
+  using field_map_collection_type =
+      std::map<coordinate_map_key_type, field_map_type,
+               coordinate_map_key_comparator>;
   using kernel_map_type =
 #ifndef CPU_ONLY
       typename std::conditional<
@@ -124,32 +234,43 @@ public:
 #else
       cpu_kernel_map_reference;
 #endif
+  // The callers share the ownership of the kernel maps with the cache so that
+  // erasing a kernel map from the cache does not free it while in use.
+  using kernel_map_pointer_type = std::shared_ptr<kernel_map_type const>;
+  using kernel_map_collection_type =
+      std::unordered_map<kernel_map_key_type, std::shared_ptr<kernel_map_type>,
+                         kernel_map_key_hasher<coordinate_map_key_hasher>>;
 
 public:
   // allocator backend will be ignored when coordinate map backend is CPU
   CoordinateMapManager(
       MinkowskiAlgorithm::Mode algo = MinkowskiAlgorithm::DEFAULT,
-      size_type num_threads = 0)
-      : m_algorithm(algo) {
-    if (num_threads > 0) {
-      // Doesn't seem to work. use `export OMP_NUM_THREADS=N;` in bash.
-      omp_set_dynamic(0);
-      omp_set_num_threads(num_threads);
-    }
+      size_type num_threads = 0,
+      CoordinateOrdering::Type ordering = CoordinateOrdering::INSERTION)
+      : m_algorithm(algo), m_num_threads(num_threads),
+        m_coordinate_ordering(ordering) {
+    // On CPU,
+    // - SPEED_OPTIMIZED rehashes the coordinate maps to 40% occupancy and
+    //   sorts the kernel maps by the input row.
+    // - MEMORY_EFFICIENT compacts the coordinate maps and the kernel maps and
+    //   regenerates the stride maps of poolings instead of caching them.
     switch (m_algorithm) {
     case MinkowskiAlgorithm::DEFAULT: {
       m_kernel_map_mode = CUDAKernelMapMode::SPEED_OPTIMIZED;
       m_gpu_default_occupancy = 25;
+      m_cpu_default_occupancy = 0;
       break;
     }
     case MinkowskiAlgorithm::MEMORY_EFFICIENT: {
       m_kernel_map_mode = CUDAKernelMapMode::MEMORY_EFFICIENT;
       m_gpu_default_occupancy = 50;
+      m_cpu_default_occupancy = 80;
       break;
     }
     case MinkowskiAlgorithm::SPEED_OPTIMIZED: {
       m_kernel_map_mode = CUDAKernelMapMode::SPEED_OPTIMIZED;
       m_gpu_default_occupancy = 25;
+      m_cpu_default_occupancy = 40;
       break;
     }
     }
@@ -254,37 +375,75 @@ public:
    ****************************************************************************/
   bool insert(coordinate_map_key_type map_key, map_type &map) {
     LOG_DEBUG("insert map with tensor_stride", map_key.first);
+    detail::hash_occupancy_functor<coordinate_type, TemplatedAllocator,
+                                   CoordinateMapType>()(
+        map, m_cpu_default_occupancy);
+    std::unique_lock<std::shared_timed_mutex> lock(m_mutex);
     auto result = m_coordinate_maps.insert(
         std::make_pair<coordinate_map_key_type, map_type>(std::move(map_key),
                                                           std::move(map)));
     LOG_DEBUG("map insertion", result.second);
+    if (result.second)
+      created(&result.first->second);
     return result.second;
   }
 
   bool insert_field_map(coordinate_map_key_type map_key, field_map_type &map) {
     LOG_DEBUG("insert map with tensor_stride", map_key.first);
+    std::unique_lock<std::shared_timed_mutex> lock(m_mutex);
     auto result = m_field_coordinates.insert(
         std::make_pair<coordinate_map_key_type, field_map_type>(
             std::move(map_key), std::move(map)));
     LOG_DEBUG("map insertion", result.second);
+    if (result.second)
+      created(&result.first->second);
     return result.second;
   }
 
+  // std::map does not invalidate the iterators on insertion. Thus, the
+  // returned iterators stay valid without the lock until the map is updated.
+  // See m_mutex.
   typename map_collection_type::iterator
   find(coordinate_map_key_type const &map_key) {
-    return m_coordinate_maps.find(map_key);
+    std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+    auto const it = m_coordinate_maps.find(map_key);
+    if (it != m_coordinate_maps.end())
+      touch(&it->second);
+    return it;
+  }
+
+  typename map_collection_type::const_iterator
+  find(coordinate_map_key_type const &map_key) const {
+    std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+    auto const it = m_coordinate_maps.find(map_key);
+    if (it != m_coordinate_maps.end())
+      touch(&it->second);
+    return it;
   }
 
   typename map_collection_type::const_iterator map_end() const {
     return m_coordinate_maps.cend();
   }
 
+  typename field_map_collection_type::const_iterator
+  find_field(coordinate_map_key_type const &map_key) const {
+    std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+    auto const it = m_field_coordinates.find(map_key);
+    if (it != m_field_coordinates.end())
+      touch(&it->second);
+    return it;
+  }
+
+  typename field_map_collection_type::const_iterator field_map_end() const {
+    return m_field_coordinates.cend();
+  }
+
   inline bool exists(coordinate_map_key_type const &key) const noexcept {
-    return m_coordinate_maps.find(key) != m_coordinate_maps.end();
+    return find(key) != map_end();
   }
 
   inline bool exists_field(coordinate_map_key_type const &key) const noexcept {
-    return m_field_coordinates.find(key) != m_field_coordinates.end();
+    return find_field(key) != field_map_end();
   }
 
   inline bool exists_field_to_sparse(
@@ -292,19 +451,25 @@ public:
       coordinate_map_key_type const &sparse_key) const noexcept {
     auto key = std::pair<coordinate_map_key_type, coordinate_map_key_type>{
         field_key, sparse_key};
+    std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
     return m_field_to_sparse_maps.find(key) != m_field_to_sparse_maps.end();
   }
 
   std::vector<py::object>
   field_to_sparse_keys(coordinate_map_key_type const &field_key) const {
-    std::vector<py::object> return_keys;
-    for (auto const &elem : m_field_to_sparse_maps) {
-      if (elem.first.first == field_key) {
-        auto const &tensor_key = elem.first.second;
-        return_keys.push_back(py::cast(
-            new CoordinateMapKey(tensor_key.first.size() + 1, tensor_key)));
+    std::vector<coordinate_map_key_type> tensor_keys;
+    {
+      std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+      for (auto const &elem : m_field_to_sparse_maps) {
+        if (elem.first.first == field_key)
+          tensor_keys.push_back(elem.first.second);
       }
     }
+    std::vector<py::object> return_keys;
+    for (auto const &tensor_key : tensor_keys) {
+      return_keys.push_back(py::cast(
+          new CoordinateMapKey(tensor_key.first.size() + 1, tensor_key)));
+    }
     return return_keys;
   }
 
@@ -329,12 +494,10 @@ public:
   }
 
   inline size_type size(coordinate_map_key_type const &key) const {
-    auto const it = m_coordinate_maps.find(key);
-    auto const field_it = m_field_coordinates.find(key);
-    ASSERT(it != m_coordinate_maps.end() ||
-               field_it != m_field_coordinates.end(),
-           ERROR_MAP_NOT_FOUND);
-    if (it != m_coordinate_maps.end())
+    auto const it = find(key);
+    auto const field_it = find_field(key);
+    ASSERT(it != map_end() || field_it != field_map_end(), ERROR_MAP_NOT_FOUND);
+    if (it != map_end())
       return it->second.size();
     else
       return field_it->second.size();
@@ -345,8 +508,8 @@ public:
   }
 
   inline size_type capacity(coordinate_map_key_type const &key) const {
-    auto it = m_coordinate_maps.find(key);
-    ASSERT(it != m_coordinate_maps.end(), ERROR_MAP_NOT_FOUND);
+    auto it = find(key);
+    ASSERT(it != map_end(), ERROR_MAP_NOT_FOUND);
     return it->second.capacity();
   }
 
@@ -360,15 +523,19 @@ public:
 
   std::vector<py::object>
   get_coordinate_map_keys(stride_type const tensor_stride) const {
-    std::vector<py::object> keys;
-    for (auto it = m_coordinate_maps.begin(); it != m_coordinate_maps.end();
-         ++it) {
-      coordinate_map_key_type const &key = it->first;
-      if (key.first == tensor_stride) {
-        keys.push_back(
-            py::cast(new CoordinateMapKey(key.first.size() + 1, key)));
+    std::vector<coordinate_map_key_type> map_keys;
+    {
+      std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+      for (auto it = m_coordinate_maps.begin(); it != m_coordinate_maps.end();
+           ++it) {
+        if (it->first.first == tensor_stride)
+          map_keys.push_back(it->first);
       }
     }
+    std::vector<py::object> keys;
+    for (auto const &key : map_keys) {
+      keys.push_back(py::cast(new CoordinateMapKey(key.first.size() + 1, key)));
+    }
     return keys;
   }
 
@@ -381,13 +548,14 @@ public:
   }
 
   std::string to_string(CoordinateMapKey const *p_key) const {
-    auto it = m_coordinate_maps.find(p_key->get_key());
-    ASSERT(it != m_coordinate_maps.end(), ERROR_MAP_NOT_FOUND);
+    auto it = find(p_key->get_key());
+    ASSERT(it != map_end(), ERROR_MAP_NOT_FOUND);
     return print_key(it->first) + " : " + it->second.to_string();
   }
 
   std::string to_string() const {
     Formatter o;
+    std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
     for (auto const &kv : m_coordinate_maps) {
       o << "\t" << print_key(kv.first) << ":\t" << kv.second.to_string()
         << "\n";
@@ -402,20 +570,64 @@ public:
 
     for (auto const &kv : m_kernel_maps) {
       o << "\t" << print_key(std::get<0>(kv.first)) << "->"
-        << print_key(std::get<1>(kv.first)) << ":\t" << kv.second << "\n";
+        << print_key(std::get<1>(kv.first)) << ":\t" << *kv.second << "\n";
     }
     return o.str();
   }
 
   MinkowskiAlgorithm::Mode algorithm() const { return m_algorithm; }
 
+  // Number of threads of the CPU kernels that use this manager. The budget
+  // never exceeds the PyTorch intra-op threads so that the kernels do not
+  // oversubscribe the cores PyTorch uses. 0 uses all PyTorch threads.
+  size_type num_threads() const {
+    size_type const torch_threads = at::get_num_threads();
+    return m_num_threads > 0 ? std::min(m_num_threads, torch_threads)
+                             : torch_threads;
+  }
+
+  // The OpenMP regions of the calling thread use num_threads() threads until
+  // the returned scope is destroyed.
+  omp_thread_scope thread_scope() const {
+    return omp_thread_scope(num_threads());
+  }
+
+  CoordinateOrdering::Type coordinate_ordering() const {
+    return m_coordinate_ordering;
+  }
+
+  /****************************************************************************
+   * Memory introspection
+   ****************************************************************************/
+
+  // Bytes, sizes, and the creation and the last use times in seconds since
+  // the epoch of the coordinate maps, the field maps, the kernel maps, and
+  // the field to sparse maps.
+  py::dict memory_stats() const;
+
+  // Erase the kernel maps last used before the time in seconds since the
+  // epoch and all transient kernel maps. Returns the number of erased kernel
+  // maps. The kernel maps in use by other threads are freed after their use.
+  size_type clear_kernel_maps(double const last_used_before);
+
+  /****************************************************************************
+   * Serialization
+   ****************************************************************************/
+
+  // Save coordinate maps, kernel maps, and field to sparse maps to a file.
+  void save(std::string const &path) const;
+
+  // Load the maps saved with `save`. The manager must not have any map.
+  void load(std::string const &path);
+
   /****************************************************************************
    * Kernel map related functions
    ****************************************************************************/
 
   // return kernel map. for cpu it is {in maps, out maps}.
   // For gpu it could be {in maps, out maps}, or {kernel index, in map, out map}
-  kernel_map_type const &
+  // The caller keeps the returned pointer while using the kernel map.
+  kernel_map_pointer_type
   kernel_map(CoordinateMapKey const *py_in_coords_key,  //
              CoordinateMapKey const *py_out_coords_key, //
              stride_type const &kernel_size,            //
@@ -425,11 +637,11 @@ public:
              at::Tensor const &offsets, bool is_transpose, bool is_pool);
 
   // for kernel size 0
-  kernel_map_type const &kernel_map(CoordinateMapKey const *py_in_coords_key,
-                                    CoordinateMapKey const *py_out_coords_key);
+  kernel_map_pointer_type kernel_map(CoordinateMapKey const *py_in_coords_key,
+                                     CoordinateMapKey const *py_out_coords_key);
 
-  kernel_map_type const &origin_map(CoordinateMapKey const *py_out_coords_key);
-  kernel_map_type const &
+  kernel_map_pointer_type origin_map(CoordinateMapKey const *py_out_coords_key);
+  kernel_map_pointer_type
   origin_field_map(CoordinateMapKey const *py_out_coords_key);
 
   // return kernel map. for cpu it is {in maps, out maps}.
@@ -448,6 +660,13 @@ public:
   interpolation_map_weight(at::Tensor const &tfield,
                            CoordinateMapKey const *py_in_coords_key);
 
+  // (row_ptr, rows, distances) of the k nearest coordinates or of the
+  // coordinates within the radius of each query point
+  std::vector<at::Tensor> neighbors(at::Tensor const &query,
+                                    CoordinateMapKey const *p_map_key,
+                                    double const radius, uint32_t const k,
+                                    bool const is_l2);
+
   std::pair<at::Tensor, std::vector<at::Tensor>>
   origin_map_th(CoordinateMapKey const *py_out_coords_key);
 
@@ -458,16 +677,31 @@ public:
   stride_map_th(CoordinateMapKey const *p_in_map_key,
                 CoordinateMapKey const *p_strided_map_key);
 
+  // (row_ptr, rows) where rows[row_ptr[b]:row_ptr[b + 1]] are the rows of
+  // the batch index b in ascending order.
+  std::pair<at::Tensor, at::Tensor>
+  batch_row_indices_th(CoordinateMapKey const *p_in_map_key);
+
+  // Erase and insert the coordinates of a map in place. Returns (rows of the
+  // inserted coordinates, [2, M] moved (old row, new row) pairs). The maps
+  // derived from the map and the origin map are erased. The map and the
+  // kernel maps from or to it must not be in use by other threads.
+  std::pair<at::Tensor, at::Tensor>
+  update(CoordinateMapKey const *p_map_key,
+         at::Tensor const &insert_coordinates,
+         at::Tensor const &erase_coordinates);
+
   size_t origin_map_size() {
-    ASSERT(m_coordinate_maps.size() > 0 or m_field_coordinates.size() > 0,
-           "No coordinate map found.");
-    if (m_coordinate_maps.size() > 0) {
-      auto const key = origin().first;
-      return m_coordinate_maps.find(key)->second.size();
-    } else {
-      auto const key = origin_field().first;
-      return m_coordinate_maps.find(key)->second.size();
+    bool has_coordinate_maps, has_field_maps;
+    {
+      std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+      has_coordinate_maps = m_coordinate_maps.size() > 0;
+      has_field_maps = m_field_coordinates.size() > 0;
     }
+    ASSERT(has_coordinate_maps or has_field_maps, "No coordinate map found.");
+    auto const key =
+        has_coordinate_maps ? origin().first : origin_field().first;
+    return find(key)->second.size();
   }
 
   coordinate_map_key_type get_random_string_id(stride_type const &tensor_stride,
@@ -475,7 +709,7 @@ public:
     coordinate_map_key_type key = std::make_pair(
         tensor_stride, string_id.size() > 0 ? string_id + '-' + random_string(5)
                                             : random_string(5));
-    while (m_coordinate_maps.find(key) != m_coordinate_maps.end()) {
+    while (exists(key)) {
       key =
           std::make_pair(tensor_stride, string_id.size() > 0
                                             ? string_id + '-' + random_string(5)
@@ -505,10 +739,55 @@ private:
     return str;
   }
 
+  // Returns nullptr if the kernel map is not cached. The returned kernel map
+  // stays valid after it is erased from the cache.
+  kernel_map_pointer_type
+  find_kernel_map(kernel_map_collection_type const &kernel_maps,
+                  kernel_map_key_type const &kernel_map_key) const {
+    std::shared_lock<std::shared_timed_mutex> lock(m_mutex);
+    auto const it = kernel_maps.find(kernel_map_key);
+    if (it == kernel_maps.end())
+      return nullptr;
+    touch(it->second.get());
+    return it->second;
+  }
+
+  static int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+  }
+
+  // Record the creation of a cached map. The caller holds m_mutex
+  // exclusively.
+  void created(void const *p_entry) {
+    m_entry_times.erase(p_entry);
+    m_entry_times.emplace(std::piecewise_construct,
+                          std::forward_as_tuple(p_entry),
+                          std::forward_as_tuple(now_ns()));
+  }
+
+  // Record that the coordinate map out_key is generated from in_key, so that
+  // update() erases it as stale when in_key is updated.
+  void derived(coordinate_map_key_type const &in_key,
+               coordinate_map_key_type const &out_key) {
+    std::unique_lock<std::shared_timed_mutex> lock(m_mutex);
+    auto &keys = m_derived_keys[in_key];
+    if (std::find(keys.begin(), keys.end(), out_key) == keys.end())
+      keys.push_back(out_key);
+  }
+
+  // Record the use of a cached map. The caller holds m_mutex.
+  void touch(void const *p_entry) const {
+    auto const it = m_entry_times.find(p_entry);
+    if (it != m_entry_times.end())
+      it->second.last_used.store(now_ns(), std::memory_order_relaxed);
+  }
+
   kernel_map_key_type
   origin_map_key(coordinate_map_key_type const &in_key) const {
-    map_type const &random_map = m_coordinate_maps.begin()->second;
-    stride_type zero_vec(random_map.coordinate_size() - 1);
+    // All maps of a manager have the same coordinate size
+    stride_type zero_vec(in_key.first.size());
     std::for_each(zero_vec.begin(), zero_vec.end(), [](auto &i) { i = 0; });
     coordinate_map_key_type origin_key = std::make_pair(zero_vec, "");
 
@@ -519,6 +798,9 @@ private:
 
 public:
   size_t m_gpu_default_occupancy;
+  // Maximum hash occupancy in percent of the CPU coordinate maps. 0 keeps the
+  // capacity reserved on construction.
+  size_t m_cpu_default_occupancy;
 #ifndef CPU_ONLY
   void *allocate(size_type n) { return m_allocator.allocate(n); }
 
@@ -527,25 +809,28 @@ public:
   }
 #endif
 private:
+  template <typename coordinate_t, typename coordinate_field_t,
+            template <typename C> class Allocator,
+            template <typename T, template <typename Q> class A>
+            class MapType>
+  friend struct detail::coordinate_map_manager_serializer;
+
   // NOTE: operator[] required mapped_type(), which is not defined.
   //
   // CoordinateMapManager owns the coordinate maps
-  std::map<coordinate_map_key_type, map_type, coordinate_map_key_comparator>
-      m_coordinate_maps;
+  map_collection_type m_coordinate_maps;
 
   // CoordinateMapManager managed coordinates
-  std::map<coordinate_map_key_type, field_map_type,
-           coordinate_map_key_comparator>
-      m_field_coordinates;
+  field_map_collection_type m_field_coordinates;
 
   // CoordinateMapManager owns the kernel maps
-  std::unordered_map<kernel_map_key_type, kernel_map_type,
-                     kernel_map_key_hasher<coordinate_map_key_hasher>>
-      m_kernel_maps;
+  kernel_map_collection_type m_kernel_maps;
+
+  kernel_map_collection_type m_field_kernel_maps;
 
-  std::unordered_map<kernel_map_key_type, kernel_map_type,
-                     kernel_map_key_hasher<coordinate_map_key_hasher>>
-      m_field_kernel_maps;
+  // The last uncached kernel map. The callers share the ownership, so it is
+  // replaced without waiting for the other threads that use it.
+  kernel_map_collection_type m_transient_kernel_maps;
 
   std::unordered_map<
       const std::pair<coordinate_map_key_type, coordinate_map_key_type>,
@@ -553,6 +838,36 @@ private:
       field_to_sparse_map_key_hasher<coordinate_map_key_hasher>>
       m_field_to_sparse_maps;
 
+  // The keys of the coordinate maps generated from each coordinate map, e.g.
+  // the strided maps.
+  std::unordered_map<coordinate_map_key_type,
+                     std::vector<coordinate_map_key_type>,
+                     coordinate_map_key_hasher>
+      m_derived_keys;
+
+  // Creation and last use times in nanoseconds of the cached maps keyed by
+  // the address of the map, which the node based collections keep stable.
+  struct entry_times {
+    explicit entry_times(int64_t const now) : created(now), last_used(now) {}
+    int64_t const created;
+    mutable std::atomic<int64_t> last_used;
+  };
+  std::unordered_map<void const *, entry_times> m_entry_times;
+
+  // Guards the insertions to and the lookups in the map collections above.
+  // The references to the coordinate maps returned to the callers are used
+  // without the lock, so they stay valid while the manager only inserts
+  // maps. update() modifies a coordinate map in place and erases the maps
+  // derived from it. The callers must not run it while other threads use the
+  // affected coordinate maps, e.g. call it between iterations. The kernel
+  // maps are shared with the callers and may be erased at any time.
+  mutable std::shared_timed_mutex m_mutex;
+
+  // Serializes the generation of missing maps so that concurrent callers
+  // generate a map once and share it. Recursive since origin_map generates
+  // the origin coordinate map.
+  std::recursive_mutex m_build_mutex;
+
 #ifndef CPU_ONLY
   TemplatedAllocator<char> m_allocator;
 #endif
@@ -562,6 +877,12 @@ private:
   // Algorithm index
   MinkowskiAlgorithm::Mode m_algorithm;
 
+  // Thread budget of the CPU kernels. 0 follows the PyTorch intra-op threads.
+  size_type m_num_threads;
+
+  // Row order of the new and the strided CPU coordinate maps
+  CoordinateOrdering::Type m_coordinate_ordering;
+
 }; // coordsmanager
 
 namespace detail {
@@ -632,6 +953,13 @@ struct empty_map_functor {
   kernel_map_type operator()();
 };
 
+// a partial specialization functor for the MinkowskiAlgorithm specific
+// layout of a new kernel map
+template <typename kernel_map_type> struct kernel_map_layout_functor {
+  void operator()(kernel_map_type &kernel_map,
+                  MinkowskiAlgorithm::Mode const algorithm) {}
+};
+
 // a partial specialization functor for kernel map in/out swap
 template <typename kernel_map_type> struct swap_in_out_map_functor {
 
@@ -674,6 +1002,87 @@ struct kernel_map_to_tensors {
   operator()(kernel_map_type const &kernel_map);
 };
 
+// a partial specialization functor for the batch row indices
+template <typename coordinate_type,
+          template <typename C> class TemplatedAllocator,
+          template <typename T, template <typename Q> class A>
+          class CoordinateMapType>
+struct batch_row_indices_functor {
+  std::pair<at::Tensor, at::Tensor>
+  operator()(CoordinateMapType<coordinate_type, TemplatedAllocator> const
+                 &coordinate_map) {
+    ASSERT(false, ERROR_NOT_IMPLEMENTED, "for a GPU coordinate manager.");
+    return std::make_pair(at::Tensor(), at::Tensor());
+  }
+};
+
+// a partial specialization functor for the neighbor search of query points
+template <typename coordinate_type,
+          template <typename C> class TemplatedAllocator,
+          template <typename T, template <typename Q> class A>
+          class CoordinateMapType>
+struct neighbors_functor {
+  std::vector<at::Tensor>
+  operator()(CoordinateMapType<coordinate_type, TemplatedAllocator> const &map,
+             at::Tensor const &query, double const radius, uint32_t const k,
+             bool const is_l2) {
+    ASSERT(false, ERROR_NOT_IMPLEMENTED, "for a GPU coordinate manager.");
+    return {};
+  }
+};
+
+// a partial specialization functor for the in place update of a map. Returns
+// (new row of each old row, rows of the inserted coordinates).
+template <typename coordinate_type,
+          template <typename C> class TemplatedAllocator,
+          template <typename T, template <typename Q> class A>
+          class CoordinateMapType>
+struct update_map_functor {
+  std::pair<default_types::index_vector_type, at::Tensor>
+  operator()(CoordinateMapType<coordinate_type, TemplatedAllocator> &map,
+             at::Tensor const &insert_coordinates,
+             at::Tensor const &erase_coordinates) {
+    ASSERT(false, ERROR_NOT_IMPLEMENTED, "for a GPU coordinate manager.");
+    return std::make_pair(default_types::index_vector_type(), at::Tensor());
+  }
+};
+
+// a partial specialization functor for the kernel map update of a map
+// updated with update_map_functor
+template <typename coordinate_type,
+          template <typename C> class TemplatedAllocator,
+          template <typename T, template <typename Q> class A>
+          class CoordinateMapType,
+          typename kernel_map_type>
+struct update_kernel_map_functor {
+  void
+  operator()(CoordinateMapType<coordinate_type, TemplatedAllocator> const &map,
+             kernel_map_type &kernel_map,
+             cpu_kernel_region<coordinate_type> const &kernel,
+             default_types::index_vector_type const &row_remap,
+             default_types::index_type const first_new_row) {
+    ASSERT(false, ERROR_NOT_IMPLEMENTED, "for a GPU coordinate manager.");
+  }
+};
+
+template <typename coordinate_type, typename coordinate_field_type,
+          template <typename C> class TemplatedAllocator,
+          template <typename T, template <typename Q> class A>
+          class CoordinateMapType>
+struct coordinate_map_manager_serializer {
+  using manager_type =
+      CoordinateMapManager<coordinate_type, coordinate_field_type,
+                           TemplatedAllocator, CoordinateMapType>;
+
+  void save(manager_type const &manager, std::string const &path) {
+    ASSERT(false, ERROR_NOT_IMPLEMENTED, "for a GPU coordinate manager.");
+  }
+
+  void load(manager_type &manager, std::string const &path) {
+    ASSERT(false, ERROR_NOT_IMPLEMENTED, "for a GPU coordinate manager.");
+  }
+};
+
 } // namespace detail
 
 // type defs
@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2020 NVIDIA Corporation.
+ * Copyright (c) 2018-2020 Chris Choy (chrischoy@ai.stanford.edu).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *
+ * Please cite "4D Spatio-Temporal ConvNets: Minkowski Convolutional Neural
+ * Networks", CVPR'19 (https://arxiv.org/abs/1904.08755) if you use any part
+ * of the code.
+ */
+#include "coordinate_map.hpp"
+#include "coordinate_map_cpu.hpp"
+#include "coordinate_map_key.hpp"
+#include "coordinate_map_manager.hpp"
+#include "errors.hpp"
+#include "types.hpp"
+#include "utils.hpp"
+
+#include <limits>
+#include <omp.h>
+#include <pybind11/pybind11.h>
+#include <torch/extension.h>
+
+namespace minkowski {
+
+namespace detail {
+
+/*
+ * Linear offsets of a [B, C, S_1, ..., S_D] or a channels last [B, S_1, ...,
+ * S_D, C] dense tensor.
+ */
+template <typename coordinate_type> struct dense_layout {
+  dense_layout(std::vector<int64_t> const &shape, // B, S_1, ..., S_D
+               std::vector<coordinate_type> const &min_coordinate,
+               default_types::stride_type const &tensor_stride,
+               bool const contract_stride, int64_t const nchannel,
+               bool const channels_last)
+      : m_dimension(min_coordinate.size()), m_shape(shape),
+        m_min_coordinate(min_coordinate), m_divisor(min_coordinate.size(), 1),
+        m_nchannel(nchannel), m_channels_last(channels_last) {
+    ASSERT(shape.size() == m_dimension + 1, "Invalid dense shape size.");
+    for (uint32_t j = 0; j < m_dimension; ++j) {
+      ASSERT(min_coordinate[j] % tensor_stride[j] == 0,
+             "The minimum coordinates must be divisible by the tensor stride.");
+      if (contract_stride)
+        m_divisor[j] = tensor_stride[j];
+    }
+    m_volume = std::accumulate(shape.begin() + 1, shape.end(), int64_t(1),
+                               std::multiplies<int64_t>());
+  }
+
+  std::vector<int64_t> tensor_shape() const {
+    std::vector<int64_t> out_shape(m_shape);
+    out_shape.insert(m_channels_last ? out_shape.end() : out_shape.begin() + 1,
+                     m_nchannel);
+    return out_shape;
+  }
+
+  // Offset of the first channel or -1 if the coordinate is out of bound.
+  int64_t offset(coordinate_type const *p_coordinate) const {
+    int64_t const b = p_coordinate[0];
+    if (b < 0 || b >= m_shape[0])
+      return -1;
+    int64_t linear = 0;
+    for (uint32_t j = 0; j < m_dimension; ++j) {
+      int64_t const diff = p_coordinate[j + 1] - m_min_coordinate[j];
+      if (diff < 0 || diff / m_divisor[j] >= m_shape[j + 1])
+        return -1;
+      linear = linear * m_shape[j + 1] + diff / m_divisor[j];
+    }
+    return m_channels_last ? (b * m_volume + linear) * m_nchannel
+                           : b * m_nchannel * m_volume + linear;
+  }
+
+  int64_t channel_stride() const { return m_channels_last ? 1 : m_volume; }
+
+  uint32_t m_dimension;
+  std::vector<int64_t> m_shape;
+  std::vector<coordinate_type> m_min_coordinate;
+  std::vector<int64_t> m_divisor;
+  int64_t m_nchannel, m_volume;
+  bool m_channels_last;
+};
+
+} // namespace detail
+
+/*
+ * Scatter the features to a dense tensor in a single parallel pass over the
+ * coordinate map.
+ *
+ * shape is [B, S_1, ..., S_D] and min_coordinate is D-dimensional. An empty
+ * shape is computed from the coordinates with an additional parallel pass.
+ * An empty min_coordinate indexes the absolute coordinates, which must be
+ * non-negative, as SparseTensor.dense does.
+ *
+ * returns {dense tensor, min_coordinate used as the offset}
+ */
+template <typename coordinate_type>
+std::pair<at::Tensor, at::Tensor>
+SparseToDenseCPU(at::Tensor const &in_feat,                           //
+                 std::vector<int64_t> shape,                          //
+                 std::vector<coordinate_type> min_coordinate,         //
+                 bool const contract_stride,                          //
+                 bool const channels_last,                            //
+                 CoordinateMapKey *p_in_map_key,                      //
+                 cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("SparseToDenseCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
+  ASSERT(in_feat.is_contiguous(), "in_feat must be contiguous");
+  ASSERT(!in_feat.is_cuda(), "in_feat must be on CPU");
+  ASSERT(in_feat.dim() == 2, "Invalid in_feat.dim():", in_feat.dim());
+
+  coordinate_map_key_type in_key = p_in_map_key->get_key();
+  auto const it = p_map_manager->find(in_key);
+  ASSERT(it != p_map_manager->map_end(), ERROR_MAP_NOT_FOUND);
+  auto const &in_map = it->second;
+  ASSERT(in_feat.size(0) == in_map.size(), "Invalid in_feat size",
+         in_feat.size(0), "!=", in_map.size());
+
+  uint32_t const D = in_map.coordinate_size() - 1;
+  default_types::stride_type const &tensor_stride = in_key.first;
+
+  // Bounds of the coordinates
+  if (shape.empty() || min_coordinate.empty()) {
+    size_t const num_chunks = omp_get_max_threads();
+    std::vector<coordinate_type> chunk_min(
+        num_chunks * (D + 1), std::numeric_limits<coordinate_type>::max()),
+        chunk_max(num_chunks * (D + 1),
+                  std::numeric_limits<coordinate_type>::min());
+    in_map.parallel_for_each(
+        num_chunks, [&](size_t n, coordinate_type const *p_coordinate,
+                        default_types::index_type) {
+          for (uint32_t j = 0; j <= D; ++j) {
+            auto &curr_min = chunk_min[n * (D + 1) + j];
+            auto &curr_max = chunk_max[n * (D + 1) + j];
+            curr_min = std::min(curr_min, p_coordinate[j]);
+            curr_max = std::max(curr_max, p_coordinate[j]);
+          }
+        });
+    std::vector<coordinate_type> lb(D + 1), ub(D + 1);
+    for (uint32_t j = 0; j <= D; ++j) {
+      lb[j] = chunk_min[j];
+      ub[j] = chunk_max[j];
+      for (size_t n = 1; n < num_chunks; ++n) {
+        lb[j] = std::min(lb[j], chunk_min[n * (D + 1) + j]);
+        ub[j] = std::max(ub[j], chunk_max[n * (D + 1) + j]);
+      }
+    }
+
+    if (min_coordinate.empty()) {
+      for (uint32_t j = 0; j < D; ++j)
+        ASSERT(lb[j + 1] >= 0, "Coordinate has a negative value:", lb[j + 1],
+               ". Please provide min_coordinate argument");
+      min_coordinate.assign(D, 0);
+    }
+    if (shape.empty()) {
+      shape.resize(D + 1);
+      shape[0] = ub[0] + 1;
+      for (uint32_t j = 0; j < D; ++j)
+        shape[j + 1] = (ub[j + 1] - min_coordinate[j]) /
+                           (contract_stride ? tensor_stride[j] : 1) +
+                       1;
+    }
+  }
+  ASSERT(min_coordinate.size() == D, "Invalid min_coordinate size.");
+
+  detail::dense_layout<coordinate_type> const layout(
+      shape, min_coordinate, tensor_stride, contract_stride, in_feat.size(1),
+      channels_last);
+  LOG_DEBUG("dense shape", layout.tensor_shape());
+
+  auto dense = torch::zeros(layout.tensor_shape(), in_feat.options());
+  int64_t const nchannel = in_feat.size(1);
+  int64_t const channel_stride = layout.channel_stride();
+
+  size_t const num_chunks = omp_get_max_threads();
+  std::vector<char> out_of_bound(num_chunks, false);
+
+  AT_DISPATCH_FLOATING_TYPES(
+      in_feat.scalar_type(), "sparse_to_dense_cpu", [&] {
+        scalar_t const *p_in_feat = in_feat.template data_ptr<scalar_t>();
+        scalar_t *p_dense = dense.template data_ptr<scalar_t>();
+        in_map.parallel_for_each(
+            num_chunks, [&](size_t n, coordinate_type const *p_coordinate,
+                            default_types::index_type row) {
+              int64_t const offset = layout.offset(p_coordinate);
+              if (offset < 0) {
+                out_of_bound[n] = true;
+                return;
+              }
+              scalar_t *p_out = p_dense + offset;
+              scalar_t const *p_in = p_in_feat + row * nchannel;
+              for (int64_t c = 0; c < nchannel; ++c)
+                p_out[c * channel_stride] = p_in[c];
+            });
+      });
+  ASSERT(std::none_of(out_of_bound.begin(), out_of_bound.end(),
+                      [](char i) { return i; }),
+         "Coordinates out of the dense tensor bound.");
+
+  auto min_coordinate_th = torch::empty(
+      {D}, torch::TensorOptions().dtype(torch::kInt32).requires_grad(false));
+  std::copy(min_coordinate.begin(), min_coordinate.end(),
+            min_coordinate_th.template data_ptr<int32_t>());
+  return std::make_pair(dense, min_coordinate_th);
+}
+
+/*
+ * Gather the features of the coordinates from a dense tensor. The inverse of
+ * SparseToDenseCPU.
+ */
+template <typename coordinate_type>
+at::Tensor
+DenseToSparseCPU(at::Tensor const &dense,                            //
+                 std::vector<coordinate_type> const &min_coordinate, //
+                 bool const contract_stride,                         //
+                 bool const channels_last,                           //
+                 CoordinateMapKey *p_in_map_key,                     //
+                 cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("DenseToSparseCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
+  ASSERT(dense.is_contiguous(), "dense must be contiguous");
+  ASSERT(!dense.is_cuda(), "dense must be on CPU");
+
+  coordinate_map_key_type in_key = p_in_map_key->get_key();
+  auto const it = p_map_manager->find(in_key);
+  ASSERT(it != p_map_manager->map_end(), ERROR_MAP_NOT_FOUND);
+  auto const &in_map = it->second;
+
+  uint32_t const D = in_map.coordinate_size() - 1;
+  ASSERT(dense.dim() == D + 2, "Invalid dense.dim():", dense.dim());
+  ASSERT(min_coordinate.size() == D, "Invalid min_coordinate size.");
+
+  std::vector<int64_t> shape(dense.sizes().begin(), dense.sizes().end());
+  int64_t const nchannel = channels_last ? shape.back() : shape[1];
+  shape.erase(channels_last ? shape.end() - 1 : shape.begin() + 1);
+
+  detail::dense_layout<coordinate_type> const layout(
+      shape, min_coordinate, in_key.first, contract_stride, nchannel,
+      channels_last);
+  int64_t const channel_stride = layout.channel_stride();
+
+  auto out_feat = torch::empty({int64_t(in_map.size()), nchannel},
+                               dense.options());
+  size_t const num_chunks = omp_get_max_threads();
+  std::vector<char> out_of_bound(num_chunks, false);
+
+  AT_DISPATCH_FLOATING_TYPES(dense.scalar_type(), "dense_to_sparse_cpu", [&] {
+    scalar_t const *p_dense = dense.template data_ptr<scalar_t>();
+    scalar_t *p_out_feat = out_feat.template data_ptr<scalar_t>();
+    in_map.parallel_for_each(
+        num_chunks, [&](size_t n, coordinate_type const *p_coordinate,
+                        default_types::index_type row) {
+          int64_t const offset = layout.offset(p_coordinate);
+          if (offset < 0) {
+            out_of_bound[n] = true;
+            return;
+          }
+          scalar_t const *p_in = p_dense + offset;
+          scalar_t *p_out = p_out_feat + row * nchannel;
+          for (int64_t c = 0; c < nchannel; ++c)
+            p_out[c] = p_in[c * channel_stride];
+        });
+  });
+  ASSERT(std::none_of(out_of_bound.begin(), out_of_bound.end(),
+                      [](char i) { return i; }),
+         "Coordinates out of the dense tensor bound.");
+  return out_feat;
+}
+
+template std::pair<at::Tensor, at::Tensor>
+SparseToDenseCPU<default_types::dcoordinate_type>(
+    at::Tensor const &in_feat,                                   //
+    std::vector<int64_t> shape,                                  //
+    std::vector<default_types::dcoordinate_type> min_coordinate, //
+    bool const contract_stride,                                  //
+    bool const channels_last,                                    //
+    CoordinateMapKey *p_in_map_key,                              //
+    cpu_manager_type<default_types::dcoordinate_type> *p_map_manager);
+
+template at::Tensor DenseToSparseCPU<default_types::dcoordinate_type>(
+    at::Tensor const &dense,                                            //
+    std::vector<default_types::dcoordinate_type> const &min_coordinate, //
+    bool const contract_stride,                                         //
+    bool const channels_last,                                           //
+    CoordinateMapKey *p_in_map_key,                                     //
+    cpu_manager_type<default_types::dcoordinate_type> *p_map_manager);
+} // end namespace minkowski
@@ -18,6 +18,8 @@ LICENSE file in the root directory of this source tree.
 #include "depthwise_convolution_kernel.cuh"
 #include "kernel_map.cuh"
 
+#include "depthwise_convolution_cpu.cpp"
+
 // #include <ATen/ATen.h>
 #include <ATen/cuda/CUDAUtils.h>
 #include <pybind11/pybind11.h>
@@ -68,7 +70,7 @@ at::Tensor DepthwiseConvolutionForwardGPU(
         p_out_map_key->set_key(out_key);
     }
 
-    auto const &in_out = p_map_manager->kernel_map(
+    auto const p_in_out = p_map_manager->kernel_map(
       p_in_map_key,    //
       p_out_map_key,   //
       kernel_size,     //
@@ -76,6 +78,7 @@ at::Tensor DepthwiseConvolutionForwardGPU(
       kernel_dilation, //
       region_type,     //
       offset, false /* is_transpose */, false /* is_pool */);
+    auto const &in_out = *p_in_out;
     
     auto const out_nrows = p_map_manager->size(p_out_map_key->get_key());
     at::Tensor out_feat =
@@ -155,13 +158,14 @@ std::pair<at::Tensor, at::Tensor> DepthwiseConvolutionBackwardGPU(
   coordinate_map_key_type out_key = p_out_map_key->get_key();
   ASSERT(p_map_manager->exists(out_key), ERROR_MAP_NOT_FOUND);
 
-  auto const &in_out = p_map_manager->kernel_map(p_in_map_key,    //
-                                                 p_out_map_key,   //
-                                                 kernel_size,     //
-                                                 kernel_stride,   //
-                                                 kernel_dilation, //
-                                                 region_type,     //
-                                                 offset, false, false);
+  auto const p_in_out = p_map_manager->kernel_map(p_in_map_key,    //
+                                                  p_out_map_key,   //
+                                                  kernel_size,     //
+                                                  kernel_stride,   //
+                                                  kernel_dilation, //
+                                                  region_type,     //
+                                                  offset, false, false);
+  auto const &in_out = *p_in_out;
 
   at::Tensor grad_in_feat =
       torch::zeros({in_feat.size(0), in_feat.size(1)}, in_feat.options());
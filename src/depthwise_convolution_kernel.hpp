@@ -0,0 +1,95 @@
+/*
+Copyright (c) Meta Platforms, Inc. and affiliates.
+
+All rights reserved.
+
+This source code is licensed under the license found in the
+LICENSE file in the root directory of this source tree.
+*/
+#ifndef CPU_DEPTHWISE_CONVOLUTION
+#define CPU_DEPTHWISE_CONVOLUTION
+
+#include "types.hpp"
+
+#include <algorithm>
+#include <omp.h>
+#include <vector>
+
+namespace minkowski {
+
+/**
+ * out[out_maps[k][i]] += in[in_maps[k][i]] * kernel[k] for each kernel offset
+ * k. The output rows of a kernel offset are unique, so the rows of each
+ * offset are processed in parallel without atomics.
+ */
+template <typename Dtype, typename Itype>
+void DepthwiseConvolutionForwardKernelCPU(Dtype const *p_in_feat,   //
+                                          Dtype *p_out_feat,        //
+                                          int const nchannel,       //
+                                          Dtype const *p_kernel,    //
+                                          cpu_in_maps const &in_maps, //
+                                          cpu_out_maps const &out_maps) {
+  int const kernel_volume = in_maps.size();
+#pragma omp parallel
+  {
+    for (int k = 0; k < kernel_volume; ++k) {
+      int64_t const n_active_in_volume = in_maps[k].size();
+      Dtype const *p_curr_kernel = p_kernel + k * nchannel;
+#pragma omp for
+      for (int64_t row = 0; row < n_active_in_volume; ++row) {
+        Dtype const *p_curr_in = p_in_feat + in_maps[k][row] * nchannel;
+        Dtype *p_curr_out = p_out_feat + out_maps[k][row] * nchannel;
+#pragma omp simd
+        for (int c = 0; c < nchannel; ++c)
+          p_curr_out[c] += p_curr_in[c] * p_curr_kernel[c];
+      }
+    }
+  }
+}
+
+/**
+ * grad_in[in_maps[k][i]] += grad_out[out_maps[k][i]] * kernel[k] and
+ * grad_kernel[k] += sum_i in[in_maps[k][i]] * grad_out[out_maps[k][i]].
+ * The kernel gradient is accumulated per thread and reduced at the end.
+ */
+template <typename Dtype, typename Itype>
+void DepthwiseConvolutionBackwardKernelCPU(Dtype const *p_in_feat,      //
+                                           Dtype *p_grad_in_feat,       //
+                                           int const nchannel,          //
+                                           Dtype const *p_grad_out_feat, //
+                                           Dtype const *p_kernel,       //
+                                           Dtype *p_grad_kernel,        //
+                                           cpu_in_maps const &in_maps,  //
+                                           cpu_out_maps const &out_maps) {
+  int const kernel_volume = in_maps.size();
+#pragma omp parallel
+  {
+    std::vector<Dtype> grad_kernel(kernel_volume * nchannel, 0);
+    for (int k = 0; k < kernel_volume; ++k) {
+      int64_t const n_active_in_volume = in_maps[k].size();
+      Dtype const *p_curr_kernel = p_kernel + k * nchannel;
+      Dtype *p_curr_grad_kernel = &grad_kernel[k * nchannel];
+#pragma omp for
+      for (int64_t row = 0; row < n_active_in_volume; ++row) {
+        auto const in_row = in_maps[k][row];
+        Dtype const *p_curr_in = p_in_feat + in_row * nchannel;
+        Dtype const *p_curr_grad_out =
+            p_grad_out_feat + out_maps[k][row] * nchannel;
+        Dtype *p_curr_grad_in = p_grad_in_feat + in_row * nchannel;
+#pragma omp simd
+        for (int c = 0; c < nchannel; ++c) {
+          p_curr_grad_in[c] += p_curr_grad_out[c] * p_curr_kernel[c];
+          p_curr_grad_kernel[c] += p_curr_in[c] * p_curr_grad_out[c];
+        }
+      }
+    }
+
+#pragma omp critical
+    for (int64_t i = 0; i < grad_kernel.size(); ++i)
+      p_grad_kernel[i] += grad_kernel[i];
+  }
+}
+
+} // end namespace minkowski
+
+#endif // CPU_DEPTHWISE_CONVOLUTION
@@ -32,14 +32,43 @@
 #include "types.hpp"
 #include "utils.hpp"
 
-#include "pooling_avg_kernel.hpp"
-#include "pooling_max_kernel.hpp"
+#include "global_pooling_kernel.hpp"
 
+#include <numeric>
 #include <pybind11/pybind11.h>
 #include <torch/extension.h>
 
 namespace minkowski {
 
+namespace detail {
+
+/*
+ * Input rows of each output row. A single batch skips the origin map.
+ * p_origin_map keeps the returned origin map rows alive.
+ */
+template <typename coordinate_type>
+cpu_in_maps const &
+global_pooling_batch_rows(int64_t const nrows, bool const is_field,
+                          CoordinateMapKey *p_in_map_key,
+                          cpu_manager_type<coordinate_type> *p_map_manager,
+                          cpu_in_maps &single_batch_rows,
+                          cpu_kernel_map_pointer &p_origin_map) {
+  if (p_map_manager->origin_map_size() == 1) {
+    single_batch_rows.resize(1);
+    single_batch_rows[0].resize(nrows);
+    std::iota(single_batch_rows[0].begin(), single_batch_rows[0].end(), 0);
+    return single_batch_rows;
+  }
+
+  if (is_field)
+    p_origin_map = p_map_manager->origin_field_map(p_in_map_key);
+  else
+    p_origin_map = p_map_manager->origin_map(p_in_map_key);
+  return p_origin_map->first;
+}
+
+} // namespace detail
+
 template <typename coordinate_type>
 std::tuple<at::Tensor, at::Tensor>
 GlobalPoolingForwardCPU(at::Tensor const &in_feat,
@@ -47,6 +76,8 @@ GlobalPoolingForwardCPU(at::Tensor const &in_feat,
                         CoordinateMapKey *p_in_map_key,       //
                         CoordinateMapKey *p_out_map_key,      //
                         cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("GlobalPoolingForwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
 
   ASSERT(in_feat.is_contiguous(), "in_feat must be contiguous");
   ASSERT(!in_feat.is_cuda(), "in_feat must be on CPU");
@@ -90,140 +121,50 @@ GlobalPoolingForwardCPU(at::Tensor const &in_feat,
       pooling_mode == PoolingMode::GLOBAL_AVG_POOLING_DEFAULT ||
       pooling_mode == PoolingMode::GLOBAL_AVG_POOLING_KERNEL ||
       pooling_mode == PoolingMode::GLOBAL_AVG_POOLING_PYTORCH_INDEX;
+  bool const use_max =
+      pooling_mode == PoolingMode::GLOBAL_MAX_POOLING_DEFAULT ||
+      pooling_mode == PoolingMode::GLOBAL_MAX_POOLING_KERNEL ||
+      pooling_mode == PoolingMode::GLOBAL_MAX_POOLING_PYTORCH_INDEX;
 
-  if (batch_size == 1) {
-    // Simple reduction
-    if (pooling_mode == PoolingMode::GLOBAL_MAX_POOLING_DEFAULT ||
-        pooling_mode == PoolingMode::GLOBAL_MAX_POOLING_KERNEL ||
-        pooling_mode == PoolingMode::GLOBAL_MAX_POOLING_PYTORCH_INDEX) {
-      auto pair = in_feat.max(0, true);
-      return {std::get<0>(pair), std::get<1>(pair).to(torch::kInt)};
-    } else {
-      auto out_feat = in_feat.sum(0, true);
-      auto num_nonzero = torch::zeros({batch_size}, in_feat.options());
-      if (use_avg)
-        out_feat /= in_feat.size(0);
-      num_nonzero[0] = in_feat.size(0);
-      return {out_feat, num_nonzero};
-    }
+  // All pooling modes use the segmented reduction over the origin map, which
+  // picks the parallelization from the number of batches and rows.
+  cpu_in_maps single_batch_rows;
+  cpu_kernel_map_pointer p_origin_map;
+  cpu_in_maps const &batch_rows = detail::global_pooling_batch_rows(
+      in_feat.size(0), is_field, p_in_map_key, p_map_manager,
+      single_batch_rows, p_origin_map);
+  ASSERT(batch_rows.size() == batch_size, "Invalid batch_size");
 
+  auto out_feat =
+      torch::empty({batch_size, in_feat.size(1)}, in_feat.options());
+  if (use_max) {
+    at::Tensor max_index = torch::empty({batch_size, in_feat.size(1)},
+                                        torch::TensorOptions()
+                                            .device(in_feat.device())
+                                            .dtype(torch::kInt)
+                                            .requires_grad(false));
+    AT_DISPATCH_FLOATING_TYPES_AND2(
+        at::ScalarType::BFloat16, at::ScalarType::Half, in_feat.scalar_type(),
+        "global_pooling_forward_cpu", [&] {
+          GlobalMaxPoolingForwardKernelCPU<scalar_t, int32_t>(
+              in_feat.template data_ptr<scalar_t>(),
+              out_feat.template data_ptr<scalar_t>(),
+              max_index.template data_ptr<int32_t>(), in_feat.size(1),
+              batch_rows);
+        });
+    return {out_feat, max_index};
   } else {
-    // batch_size > 1
-    // TODO Default to specific pooling mode conversion.
-    // Regular case
-    // if (pooling_mode == 0)
-    //   pooling_mode = in_feat.size(0) / batch_size > 100 ? 1 : 2;
-
-    // origin kernel map
-    if (pooling_mode == PoolingMode::GLOBAL_SUM_POOLING_KERNEL ||
-        pooling_mode == PoolingMode::GLOBAL_AVG_POOLING_KERNEL ||
-        pooling_mode == PoolingMode::GLOBAL_SUM_POOLING_PYTORCH_INDEX ||
-        pooling_mode == PoolingMode::GLOBAL_AVG_POOLING_PYTORCH_INDEX) {
-      auto out_feat =
-          torch::zeros({batch_size, in_feat.size(1)}, in_feat.options());
-      auto num_nonzero = torch::zeros({batch_size}, in_feat.options());
-
-      // If the policy is GlobalPoolingMode.INDEX_SELECT
-      switch (pooling_mode) {
-      case PoolingMode::GLOBAL_SUM_POOLING_PYTORCH_INDEX:
-      case PoolingMode::GLOBAL_AVG_POOLING_PYTORCH_INDEX: {
-        std::vector<at::Tensor> vec_maps;
-        at::Tensor batch_index;
-        LOG_DEBUG("get origin_map_th");
-        if (is_field) {
-          auto batch_map_pair =
-              p_map_manager->origin_field_map_th(p_in_map_key);
-          batch_index = batch_map_pair.first;
-          vec_maps = batch_map_pair.second;
-        } else {
-          auto batch_map_pair = p_map_manager->origin_map_th(p_in_map_key);
-          batch_index = batch_map_pair.first;
-          vec_maps = batch_map_pair.second;
-        }
-        ASSERT(batch_index.numel() == batch_size, "Invalid batch_size");
-        LOG_DEBUG("batch wise avg.", vec_maps.size());
-        for (int b = 0; b < batch_size; ++b) {
-          LOG_DEBUG("batch ", b, "size", vec_maps[b].numel());
-          if (use_avg)
-            out_feat[batch_index[b]] =
-                in_feat.index_select(0, vec_maps[b]).mean(0);
-          else
-            out_feat[batch_index[b]] =
-                in_feat.index_select(0, vec_maps[b]).sum(0);
-          num_nonzero[batch_index[b]] = vec_maps[b].numel();
-        }
-      } break;
-      case PoolingMode::GLOBAL_SUM_POOLING_KERNEL:
-      case PoolingMode::GLOBAL_AVG_POOLING_KERNEL: {
-        if (is_field) {
-          const auto &in_outs = p_map_manager->origin_field_map(p_in_map_key);
-          AT_DISPATCH_FLOATING_TYPES(
-              in_feat.scalar_type(), "global_pooling_forward_cpu", [&] {
-                NonzeroAvgPoolingForwardKernelCPU<scalar_t, int>(
-                    in_feat.template data_ptr<scalar_t>(),
-                    out_feat.template data_ptr<scalar_t>(),
-                    num_nonzero.template data_ptr<scalar_t>(), in_feat.size(1),
-                    in_outs.first, in_outs.second, batch_size, use_avg);
-              });
-        } else {
-          const auto &in_outs = p_map_manager->origin_map(p_in_map_key);
-          AT_DISPATCH_FLOATING_TYPES(
-              in_feat.scalar_type(), "global_pooling_forward_cpu", [&] {
-                NonzeroAvgPoolingForwardKernelCPU<scalar_t, int>(
-                    in_feat.template data_ptr<scalar_t>(),
-                    out_feat.template data_ptr<scalar_t>(),
-                    num_nonzero.template data_ptr<scalar_t>(), in_feat.size(1),
-                    in_outs.first, in_outs.second, batch_size, use_avg);
-              });
-        }
-      } break;
-      default:
-        ASSERT(false, "Invalid pooling mode");
-      }
-      return {out_feat, num_nonzero};
-    } else {
-      // Max pool
-      auto out_feat =
-          torch::zeros({batch_size, in_feat.size(1)}, in_feat.options());
-      at::Tensor max_index = torch::empty({batch_size, in_feat.size(1)},
-                                          torch::TensorOptions()
-                                              .device(in_feat.device())
-                                              .dtype(torch::kInt)
-                                              .requires_grad(false));
-
-      switch (pooling_mode) {
-      case PoolingMode::GLOBAL_MAX_POOLING_KERNEL:
-        // TODO
-      case PoolingMode::GLOBAL_MAX_POOLING_PYTORCH_INDEX: {
-        if (is_field) {
-          const auto &in_outs = p_map_manager->origin_field_map(p_in_map_key);
-          AT_DISPATCH_FLOATING_TYPES(
-              in_feat.scalar_type(), "global_pooling_forward_cpu", [&] {
-                MaxPoolingForwardKernelCPU<scalar_t, int32_t,
-                                           default_types::index_type>(
-                    in_feat.template data_ptr<scalar_t>(),
-                    out_feat.template data_ptr<scalar_t>(),
-                    max_index.template data_ptr<int32_t>(), in_feat.size(1),
-                    in_outs.first, in_outs.second, batch_size);
-              });
-        } else {
-          const auto &in_outs = p_map_manager->origin_map(p_in_map_key);
-          AT_DISPATCH_FLOATING_TYPES(
-              in_feat.scalar_type(), "global_pooling_forward_cpu", [&] {
-                MaxPoolingForwardKernelCPU<scalar_t, int32_t,
-                                           default_types::index_type>(
-                    in_feat.template data_ptr<scalar_t>(),
-                    out_feat.template data_ptr<scalar_t>(),
-                    max_index.template data_ptr<int32_t>(), in_feat.size(1),
-                    in_outs.first, in_outs.second, batch_size);
-              });
-        }
-      } break;
-      default:
-        ASSERT(false, "Invalid pooling mode");
-      }
-      return {out_feat, max_index};
-    }
+    auto num_nonzero = torch::empty({batch_size}, in_feat.options());
+    AT_DISPATCH_FLOATING_TYPES_AND2(
+        at::ScalarType::BFloat16, at::ScalarType::Half, in_feat.scalar_type(),
+        "global_pooling_forward_cpu", [&] {
+          GlobalSumPoolingForwardKernelCPU<scalar_t>(
+              in_feat.template data_ptr<scalar_t>(),
+              out_feat.template data_ptr<scalar_t>(),
+              num_nonzero.template data_ptr<scalar_t>(), in_feat.size(1),
+              batch_rows, use_avg);
+        });
+    return {out_feat, num_nonzero};
   }
 }
 
@@ -235,6 +176,8 @@ GlobalPoolingBackwardCPU(at::Tensor const &in_feat, at::Tensor &grad_out_feat,
                          CoordinateMapKey *p_in_map_key,       //
                          CoordinateMapKey *p_out_map_key,      //
                          cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("GlobalPoolingBackwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
 
   ASSERT(!grad_out_feat.is_cuda(), "grad_out_feat must be on CPU");
   ASSERT(grad_out_feat.dim() == 2,
@@ -276,63 +219,38 @@ GlobalPoolingBackwardCPU(at::Tensor const &in_feat, at::Tensor &grad_out_feat,
       pooling_mode == PoolingMode::GLOBAL_AVG_POOLING_KERNEL ||
       pooling_mode == PoolingMode::GLOBAL_AVG_POOLING_PYTORCH_INDEX;
 
-  auto grad_in_feat = torch::empty_like(in_feat);
-  // TODO Default to specific pooling mode conversion.
-  // Regular case
-  // if (pooling_mode == 0)
-  //   pooling_mode = in_feat.size(0) / batch_size > 100 ? 1 : 2;
-
-  if (pooling_mode == PoolingMode::GLOBAL_SUM_POOLING_DEFAULT ||
-      pooling_mode == PoolingMode::GLOBAL_AVG_POOLING_DEFAULT ||
-      pooling_mode == PoolingMode::GLOBAL_SUM_POOLING_KERNEL ||
-      pooling_mode == PoolingMode::GLOBAL_AVG_POOLING_KERNEL ||
-      pooling_mode == PoolingMode::GLOBAL_SUM_POOLING_PYTORCH_INDEX ||
-      pooling_mode == PoolingMode::GLOBAL_AVG_POOLING_PYTORCH_INDEX) {
-
-    LOG_DEBUG("GLOBAL_POOLING");
-    if (batch_size == 1) {
-      if (use_avg) {
-        LOG_DEBUG("Copying grad_out_feat. size:", in_feat.size(0));
-        grad_in_feat.copy_(grad_out_feat / in_feat.size(0));
-      } else
-        grad_in_feat.copy_(grad_out_feat);
-    } else {
-      if (is_field) {
-        const auto &in_outs = p_map_manager->origin_field_map(p_in_map_key);
-        grad_in_feat.zero_();
-        AT_DISPATCH_FLOATING_TYPES(
-            in_feat.scalar_type(), "global_pooling_backward_cpu", [&] {
-              NonzeroAvgPoolingBackwardKernelCPU<scalar_t, int>(
-                  grad_in_feat.template data_ptr<scalar_t>(), in_feat.size(0),
-                  grad_out_feat.template data_ptr<scalar_t>(),
-                  num_nonzero.template data_ptr<scalar_t>(), in_feat.size(1),
-                  in_outs.first, in_outs.second, use_avg);
-            });
-
-      } else {
-        const auto &in_outs = p_map_manager->origin_map(p_in_map_key);
-        grad_in_feat.zero_();
-        AT_DISPATCH_FLOATING_TYPES(
-            in_feat.scalar_type(), "global_pooling_backward_cpu", [&] {
-              NonzeroAvgPoolingBackwardKernelCPU<scalar_t, int>(
-                  grad_in_feat.template data_ptr<scalar_t>(), in_feat.size(0),
-                  grad_out_feat.template data_ptr<scalar_t>(),
-                  num_nonzero.template data_ptr<scalar_t>(), in_feat.size(1),
-                  in_outs.first, in_outs.second, use_avg);
-            });
-      }
-    }
-  } else {
-    grad_in_feat.zero_();
-    AT_DISPATCH_FLOATING_TYPES(
-        in_feat.scalar_type(), "global_pooling_backward_cpu", [&] {
-          MaxPoolingBackwardKernelCPU<scalar_t, int32_t>(
-              grad_in_feat.template data_ptr<scalar_t>(), in_feat.size(0),
+  if (pooling_mode == PoolingMode::GLOBAL_MAX_POOLING_DEFAULT ||
+      pooling_mode == PoolingMode::GLOBAL_MAX_POOLING_KERNEL ||
+      pooling_mode == PoolingMode::GLOBAL_MAX_POOLING_PYTORCH_INDEX) {
+    auto grad_in_feat = torch::zeros_like(in_feat);
+    AT_DISPATCH_FLOATING_TYPES_AND2(
+        at::ScalarType::BFloat16, at::ScalarType::Half, in_feat.scalar_type(),
+        "global_pooling_backward_cpu", [&] {
+          GlobalMaxPoolingBackwardKernelCPU<scalar_t, int32_t>(
+              grad_in_feat.template data_ptr<scalar_t>(),
               grad_out_feat.template data_ptr<scalar_t>(),
-              grad_out_feat.size(0), num_nonzero.template data_ptr<int32_t>(),
-              in_feat.size(1));
+              num_nonzero.template data_ptr<int32_t>(), in_feat.size(1),
+              batch_size);
         });
+    return grad_in_feat;
   }
+
+  cpu_in_maps single_batch_rows;
+  cpu_kernel_map_pointer p_origin_map;
+  cpu_in_maps const &batch_rows = detail::global_pooling_batch_rows(
+      in_feat.size(0), is_field, p_in_map_key, p_map_manager,
+      single_batch_rows, p_origin_map);
+  ASSERT(batch_rows.size() == batch_size, "Invalid batch_size");
+
+  auto grad_in_feat = torch::empty_like(in_feat);
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      at::ScalarType::BFloat16, at::ScalarType::Half, in_feat.scalar_type(),
+      "global_pooling_backward_cpu", [&] {
+        GlobalSumPoolingBackwardKernelCPU<scalar_t>(
+            grad_in_feat.template data_ptr<scalar_t>(),
+            grad_out_feat.template data_ptr<scalar_t>(), in_feat.size(1),
+            batch_rows, use_avg);
+      });
   return grad_in_feat;
 }
 
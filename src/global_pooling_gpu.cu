@@ -149,7 +149,8 @@ std::tuple<at::Tensor, at::Tensor> GlobalPoolingForwardGPU(
         TemplatedAllocator<char> byte_allocator;
 
         if (is_field) {
-          const auto &in_outs = p_map_manager->origin_field_map(p_in_map_key);
+          auto const p_in_outs = p_map_manager->origin_field_map(p_in_map_key);
+          const auto &in_outs = *p_in_outs;
           AT_DISPATCH_FLOATING_TYPES(
               in_feat.scalar_type(), "global_pooling_forward_gpu", [&] {
                 NonzeroAvgPoolingForwardKernelGPU<scalar_t,
@@ -161,7 +162,8 @@ std::tuple<at::Tensor, at::Tensor> GlobalPoolingForwardGPU(
                     in_outs, use_avg, byte_allocator, handle, stream);
               });
         } else {
-          const auto &in_outs = p_map_manager->origin_map(p_in_map_key);
+          auto const p_in_outs = p_map_manager->origin_map(p_in_map_key);
+          const auto &in_outs = *p_in_outs;
           AT_DISPATCH_FLOATING_TYPES(
               in_feat.scalar_type(), "global_pooling_forward_gpu", [&] {
                 NonzeroAvgPoolingForwardKernelGPU<scalar_t,
@@ -193,7 +195,8 @@ std::tuple<at::Tensor, at::Tensor> GlobalPoolingForwardGPU(
         cudaStream_t stream = at::cuda::getCurrentCUDAStream().stream();
         TemplatedAllocator<char> byte_allocator;
         if (is_field) {
-          const auto &in_outs = p_map_manager->origin_field_map(p_in_map_key);
+          auto const p_in_outs = p_map_manager->origin_field_map(p_in_map_key);
+          const auto &in_outs = *p_in_outs;
           AT_DISPATCH_FLOATING_TYPES(
               in_feat.scalar_type(), "global_pooling_forward_gpu", [&] {
                 MaxPoolingForwardKernelGPU<scalar_t, default_types::index_type,
@@ -204,7 +207,8 @@ std::tuple<at::Tensor, at::Tensor> GlobalPoolingForwardGPU(
                     byte_allocator, stream);
               });
         } else {
-          const auto &in_outs = p_map_manager->origin_map(p_in_map_key);
+          auto const p_in_outs = p_map_manager->origin_map(p_in_map_key);
+          const auto &in_outs = *p_in_outs;
           AT_DISPATCH_FLOATING_TYPES(
               in_feat.scalar_type(), "global_pooling_forward_gpu", [&] {
                 MaxPoolingForwardKernelGPU<scalar_t, default_types::index_type,
@@ -298,7 +302,8 @@ at::Tensor GlobalPoolingBackwardGPU(
         grad_in_feat.copy_(grad_out_feat);
     } else {
       if (is_field) {
-        const auto &in_outs = p_map_manager->origin_field_map(p_in_map_key);
+        auto const p_in_outs = p_map_manager->origin_field_map(p_in_map_key);
+        const auto &in_outs = *p_in_outs;
         grad_in_feat.zero_();
         AT_DISPATCH_FLOATING_TYPES(
             in_feat.scalar_type(), "global_pooling_backward_gpu", [&] {
@@ -312,7 +317,8 @@ at::Tensor GlobalPoolingBackwardGPU(
                   in_outs, use_avg, stream);
             });
       } else {
-        const auto &in_outs = p_map_manager->origin_map(p_in_map_key);
+        auto const p_in_outs = p_map_manager->origin_map(p_in_map_key);
+        const auto &in_outs = *p_in_outs;
         grad_in_feat.zero_();
         AT_DISPATCH_FLOATING_TYPES(
             in_feat.scalar_type(), "global_pooling_backward_gpu", [&] {
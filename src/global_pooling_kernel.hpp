@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2020 NVIDIA CORPORATION.
+ * Copyright (c) 2018-2020 Chris Choy (chrischoy@ai.stanford.edu)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Please cite "4D Spatio-Temporal ConvNets: Minkowski Convolutional Neural
+ * Networks", CVPR'19 (https://arxiv.org/abs/1904.08755) if you use any part
+ * of the code.
+ */
+#ifndef CPU_GLOBAL_POOLING
+#define CPU_GLOBAL_POOLING
+
+#include "kernel_map.hpp"
+#include "math_functions.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <omp.h>
+#include <tuple>
+#include <vector>
+
+namespace minkowski {
+
+namespace detail {
+
+// Minimum number of rows of a batch reduced by a single task.
+constexpr uint32_t GLOBAL_POOLING_CHUNK_SIZE = 1024;
+
+// (batch index, row begin, row end) of the rows in batch_rows[batch index].
+using global_pooling_task = std::tuple<uint32_t, uint32_t, uint32_t>;
+
+/*
+ * Each batch is reduced by a single task if there are enough batches to keep
+ * all threads busy. Otherwise, the rows of each batch are split into chunks
+ * that are reduced in parallel and merged.
+ */
+inline std::vector<global_pooling_task>
+global_pooling_tasks(cpu_in_maps const &batch_rows) {
+  size_t const num_tasks = 2 * omp_get_max_threads();
+  size_t nrows = 0;
+  for (auto const &rows : batch_rows)
+    nrows += rows.size();
+
+  size_t chunk_size = std::numeric_limits<uint32_t>::max();
+  if (batch_rows.size() < num_tasks)
+    chunk_size = std::max<size_t>(GLOBAL_POOLING_CHUNK_SIZE,
+                                  (nrows + num_tasks - 1) / num_tasks);
+
+  std::vector<global_pooling_task> tasks;
+  for (uint32_t b = 0; b < batch_rows.size(); ++b) {
+    size_t const curr_nrows = batch_rows[b].size();
+    for (size_t begin = 0; begin < curr_nrows; begin += chunk_size)
+      tasks.emplace_back(b, begin, std::min(begin + chunk_size, curr_nrows));
+  }
+  return tasks;
+}
+
+} // namespace detail
+
+/**
+ * Sum or average the features of the rows of each batch. p_num_nonzero has
+ * the number of rows of each batch. The sums are accumulated in
+ * accumulate_type<Dtype>.
+ */
+template <typename Dtype>
+void GlobalSumPoolingForwardKernelCPU(Dtype const *p_in_feat,        //
+                                      Dtype *p_out_feat,             //
+                                      Dtype *p_num_nonzero,          //
+                                      uint32_t const nchannel,       //
+                                      cpu_in_maps const &batch_rows, //
+                                      bool const use_avg) {
+  auto const tasks = detail::global_pooling_tasks(batch_rows);
+  uint32_t const batch_size = batch_rows.size();
+
+  using Acc = typename accumulate_type<Dtype>::type;
+  std::vector<Acc> task_sum(tasks.size() * nchannel, 0);
+#pragma omp parallel for schedule(dynamic)
+  for (int64_t t = 0; t < tasks.size(); ++t) {
+    uint32_t b, begin, end;
+    std::tie(b, begin, end) = tasks[t];
+    Acc *p_sum = &task_sum[t * nchannel];
+    for (uint32_t i = begin; i < end; ++i) {
+      Dtype const *p_curr_in = p_in_feat + batch_rows[b][i] * nchannel;
+#pragma omp simd
+      for (uint32_t c = 0; c < nchannel; ++c)
+        p_sum[c] += Acc(p_curr_in[c]);
+    }
+  }
+
+  std::vector<Acc> sum(batch_size * nchannel, 0);
+  for (uint32_t t = 0; t < tasks.size(); ++t) {
+    Acc *p_curr_sum = &sum[std::get<0>(tasks[t]) * nchannel];
+    for (uint32_t c = 0; c < nchannel; ++c)
+      p_curr_sum[c] += task_sum[t * nchannel + c];
+  }
+
+  for (uint32_t b = 0; b < batch_size; ++b) {
+    p_num_nonzero[b] = batch_rows[b].size();
+    Acc const scale = (use_avg && batch_rows[b].size() > 0)
+                          ? Acc(1) / batch_rows[b].size()
+                          : Acc(1);
+    for (uint32_t c = 0; c < nchannel; ++c)
+      p_out_feat[b * nchannel + c] = sum[b * nchannel + c] * scale;
+  }
+}
+
+/**
+ * Max of the features of the rows of each batch. p_max_index is the index of
+ * the max element in p_in_feat, row * nchannel + channel, or -1 for an empty
+ * batch.
+ */
+template <typename Dtype, typename MaskItype>
+void GlobalMaxPoolingForwardKernelCPU(Dtype const *p_in_feat,        //
+                                      Dtype *p_out_feat,             //
+                                      MaskItype *p_max_index,        //
+                                      uint32_t const nchannel,       //
+                                      cpu_in_maps const &batch_rows) {
+  auto const tasks = detail::global_pooling_tasks(batch_rows);
+  uint32_t const batch_size = batch_rows.size();
+
+  std::vector<Dtype> task_max(tasks.size() * nchannel,
+                              -std::numeric_limits<Dtype>::max());
+  std::vector<MaskItype> task_index(tasks.size() * nchannel, -1);
+#pragma omp parallel for schedule(dynamic)
+  for (int64_t t = 0; t < tasks.size(); ++t) {
+    uint32_t b, begin, end;
+    std::tie(b, begin, end) = tasks[t];
+    Dtype *p_max = &task_max[t * nchannel];
+    MaskItype *p_index = &task_index[t * nchannel];
+    for (uint32_t i = begin; i < end; ++i) {
+      MaskItype const in_offset = batch_rows[b][i] * nchannel;
+      Dtype const *p_curr_in = p_in_feat + in_offset;
+      for (uint32_t c = 0; c < nchannel; ++c) {
+        if (p_index[c] < 0 || p_max[c] < p_curr_in[c]) {
+          p_max[c] = p_curr_in[c];
+          p_index[c] = in_offset + c;
+        }
+      }
+    }
+  }
+
+  std::fill(p_out_feat, p_out_feat + batch_size * nchannel, 0);
+  std::fill(p_max_index, p_max_index + batch_size * nchannel, -1);
+  // The tasks of a batch are in the row order. Keep the first max on ties.
+  for (uint32_t t = 0; t < tasks.size(); ++t) {
+    uint32_t const b = std::get<0>(tasks[t]);
+    for (uint32_t c = 0; c < nchannel; ++c) {
+      MaskItype &index = p_max_index[b * nchannel + c];
+      Dtype &out = p_out_feat[b * nchannel + c];
+      if (index < 0 || out < task_max[t * nchannel + c]) {
+        out = task_max[t * nchannel + c];
+        index = task_index[t * nchannel + c];
+      }
+    }
+  }
+}
+
+/**
+ * Broadcast the gradient of each batch to the rows of the batch. All rows of
+ * p_grad_in_feat must be in batch_rows.
+ */
+template <typename Dtype>
+void GlobalSumPoolingBackwardKernelCPU(Dtype *p_grad_in_feat,          //
+                                       Dtype const *p_grad_out_feat,   //
+                                       uint32_t const nchannel,        //
+                                       cpu_in_maps const &batch_rows,  //
+                                       bool const use_avg) {
+  using Acc = typename accumulate_type<Dtype>::type;
+  auto const tasks = detail::global_pooling_tasks(batch_rows);
+
+#pragma omp parallel for schedule(dynamic)
+  for (int64_t t = 0; t < tasks.size(); ++t) {
+    uint32_t b, begin, end;
+    std::tie(b, begin, end) = tasks[t];
+    Dtype const *p_curr_grad_out = p_grad_out_feat + b * nchannel;
+    Acc const scale = use_avg ? Acc(1) / batch_rows[b].size() : Acc(1);
+    for (uint32_t i = begin; i < end; ++i) {
+      Dtype *p_curr_grad_in = p_grad_in_feat + batch_rows[b][i] * nchannel;
+#pragma omp simd
+      for (uint32_t c = 0; c < nchannel; ++c)
+        p_curr_grad_in[c] = scale * Acc(p_curr_grad_out[c]);
+    }
+  }
+}
+
+/**
+ * Scatter the gradient of each batch to the max element. p_grad_in_feat must
+ * be initialized to 0. The max elements of different batches and channels are
+ * distinct.
+ */
+template <typename Dtype, typename MaskItype>
+void GlobalMaxPoolingBackwardKernelCPU(Dtype *p_grad_in_feat,         //
+                                       Dtype const *p_grad_out_feat,  //
+                                       MaskItype const *p_max_index,  //
+                                       uint32_t const nchannel,       //
+                                       uint32_t const batch_size) {
+#pragma omp parallel for
+  for (int64_t i = 0; i < int64_t(batch_size) * nchannel; ++i) {
+    if (p_max_index[i] >= 0)
+      p_grad_in_feat[p_max_index[i]] = p_grad_out_feat[i];
+  }
+}
+
+} // namespace minkowski
+
+#endif // CPU_GLOBAL_POOLING
@@ -35,6 +35,7 @@
 
 #include <pybind11/pybind11.h>
 #include <torch/extension.h>
+#include <type_traits>
 
 namespace minkowski {
 
@@ -44,6 +45,8 @@ InterpolationForwardCPU(at::Tensor const &in_feat,      //
                         at::Tensor const &tfield,       //
                         CoordinateMapKey *p_in_map_key, //
                         cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("InterpolationForwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
 
   ASSERT(in_feat.is_contiguous(), "in_feat must be contiguous");
   ASSERT(!in_feat.is_cuda(), "in_feat must be CPU");
@@ -53,31 +56,37 @@ InterpolationForwardCPU(at::Tensor const &in_feat,      //
   ASSERT(!tfield.is_cuda(), "tfield must be CPU");
   ASSERT(tfield.dim() == 2, "tfield.dim():", tfield.dim());
 
-  ASSERT(tfield.dtype() == in_feat.dtype(),
-         "tfield and in_feat must have the same dtype");
-
   coordinate_map_key_type in_key = p_in_map_key->get_key();
   ASSERT(p_map_manager->exists(in_key), ERROR_MAP_NOT_FOUND);
 
   ASSERT(in_feat.size(0) == p_map_manager->size(in_key), "Invalid in_feat size",
          in_feat.size(0), "!=", p_map_manager->size(in_key));
 
-  auto map_weight =
-      p_map_manager->interpolation_map_weight(tfield, p_in_map_key);
+  // The map weights are computed in float or double regardless of the
+  // feature type
+  auto map_weight = p_map_manager->interpolation_map_weight(
+      tfield.scalar_type() == at::kDouble ? tfield : tfield.to(at::kFloat),
+      p_in_map_key);
 
   LOG_DEBUG("out_feat with size", tfield.size(0), in_feat.size(1));
   auto out_feat =
-      torch::zeros({tfield.size(0), in_feat.size(1)}, tfield.options());
+      torch::zeros({tfield.size(0), in_feat.size(1)}, in_feat.options());
 
-  AT_DISPATCH_FLOATING_TYPES(
-      in_feat.scalar_type(), "interpolation_forward_cpu", [&] {
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      at::ScalarType::BFloat16, at::ScalarType::Half, in_feat.scalar_type(),
+      "interpolation_forward_cpu", [&] {
         LOG_DEBUG("InterpolationForwardKernelCPU");
-        InterpolationForwardKernelCPU<scalar_t, scalar_t, int>(
+        // Reduced precision features are interpolated with float weights
+        using weight_t = typename accumulate_type<scalar_t>::type;
+        at::Tensor const weight = map_weight[2].to(
+            std::is_same<weight_t, double>::value ? at::kDouble : at::kFloat);
+        InterpolationForwardKernelCPU<scalar_t, weight_t, int>(
             in_feat.template data_ptr<scalar_t>(),
-            out_feat.template data_ptr<scalar_t>(), in_feat.size(1),
+            out_feat.template data_ptr<scalar_t>(), tfield.size(0),
+            in_feat.size(1),
             map_weight[0].template data_ptr<int>(),      // in
             map_weight[1].template data_ptr<int>(),      // out
-            map_weight[2].template data_ptr<scalar_t>(), // weight
+            weight.template data_ptr<weight_t>(),        // weight
             map_weight[0].numel());
       });
 
@@ -94,6 +103,8 @@ InterpolationBackwardCPU(at::Tensor &grad_out_feat,      //
                          at::Tensor const &weight,       //
                          CoordinateMapKey *p_in_map_key, //
                          cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("InterpolationBackwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
 
   if (!grad_out_feat.is_contiguous())
     grad_out_feat = grad_out_feat.contiguous();
@@ -110,15 +121,19 @@ InterpolationBackwardCPU(at::Tensor &grad_out_feat,      //
   auto grad_in_feat =
       torch::zeros({in_nrows, nchannel}, grad_out_feat.options());
 
-  AT_DISPATCH_FLOATING_TYPES(
-      grad_out_feat.scalar_type(), "interpolation_backward_cpu", [&] {
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      at::ScalarType::BFloat16, at::ScalarType::Half, grad_out_feat.scalar_type(),
+      "interpolation_backward_cpu", [&] {
         LOG_DEBUG("InterpolationBackwardKernelCPU");
-        InterpolationBackwardKernelCPU<scalar_t, scalar_t, int>(
+        using weight_t = typename accumulate_type<scalar_t>::type;
+        at::Tensor const curr_weight = weight.to(
+            std::is_same<weight_t, double>::value ? at::kDouble : at::kFloat);
+        InterpolationBackwardKernelCPU<scalar_t, weight_t, int>(
             grad_in_feat.template data_ptr<scalar_t>(), in_nrows, nchannel,
             grad_out_feat.template data_ptr<scalar_t>(),
             in_map.template data_ptr<int>(),      // in
             out_map.template data_ptr<int>(),     // out
-            weight.template data_ptr<scalar_t>(), // weight
+            curr_weight.template data_ptr<weight_t>(), // weight
             in_map.numel());
       });
 
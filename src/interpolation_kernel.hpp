@@ -27,39 +27,102 @@
 
 #include "math_functions.hpp"
 
+#include <algorithm>
 #include <limits>
+#include <numeric>
+#include <vector>
 
 namespace minkowski {
 
+namespace detail {
+
+/*
+ * Group the (in, out, weight) triples by rows[i] with a counting sort. Returns
+ * the row pointers of the rows and the permutation of the triples. The
+ * permutation is empty if rows are already sorted.
+ */
+template <typename Itype>
+std::pair<std::vector<int64_t>, std::vector<uint32_t>>
+segment_by_row(Itype const *const rows, uint32_t const nrows,
+               uint32_t const nnz) {
+  std::vector<int64_t> row_ptr(nrows + 1, 0);
+  bool sorted = true;
+  for (uint32_t i = 0; i < nnz; ++i) {
+    row_ptr[rows[i] + 1] += 1;
+    sorted &= (i == 0) || (rows[i - 1] <= rows[i]);
+  }
+  std::partial_sum(row_ptr.begin(), row_ptr.end(), row_ptr.begin());
+
+  std::vector<uint32_t> perm;
+  if (!sorted) {
+    perm.resize(nnz);
+    std::vector<int64_t> curr(row_ptr.begin(), row_ptr.end() - 1);
+    for (uint32_t i = 0; i < nnz; ++i)
+      perm[curr[rows[i]]++] = i;
+  }
+  return std::make_pair(std::move(row_ptr), std::move(perm));
+}
+
+/*
+ * p_dst[segment row] = sum_i weights[i] * p_src[src_rows[i]] for all triples i
+ * of each segment. Each thread owns a set of destination rows, so no atomics
+ * are required. Each row is accumulated in accumulate_type<Dtype>.
+ */
+template <typename Dtype, typename Wtype, typename Itype>
+void segmented_weighted_sum(Dtype const *const p_src, Dtype *p_dst,
+                            uint32_t const nchannel,
+                            Itype const *const src_rows,
+                            Wtype const *const weights,
+                            std::vector<int64_t> const &row_ptr,
+                            std::vector<uint32_t> const &perm) {
+  using Acc = typename accumulate_type<Dtype>::type;
+  int64_t const nrows = row_ptr.size() - 1;
+  bool const use_perm = perm.size() > 0;
+#pragma omp parallel
+  {
+    std::vector<Acc> acc(nchannel);
+#pragma omp for schedule(static)
+    for (int64_t row = 0; row < nrows; ++row) {
+      Dtype *p_curr_dst = p_dst + row * nchannel;
+      std::copy_n(p_curr_dst, nchannel, acc.begin());
+      for (int64_t k = row_ptr[row]; k < row_ptr[row + 1]; ++k) {
+        uint32_t const i = use_perm ? perm[k] : k;
+        Dtype const *p_curr_src = p_src + src_rows[i] * nchannel;
+        Acc const weight = weights[i];
+#pragma omp simd
+        for (uint32_t c = 0; c < nchannel; ++c)
+          acc[c] += weight * Acc(p_curr_src[c]);
+      }
+      std::copy(acc.begin(), acc.end(), p_curr_dst);
+    }
+  }
+}
+
+} // namespace detail
+
 /**
- * CPU pooling function. The p_out_feat must be initialized and set to 0.
- * p_num_nonzero is set to 0 inside this function.
- *
- * TODO consistent memset
+ * CPU interpolation function. The p_out_feat must be initialized and set to
+ * 0. The triples are segmented by the output rows and each output row is
+ * accumulated by a single thread.
  */
 template <typename Dtype, typename Wtype, typename Itype>
 void InterpolationForwardKernelCPU(Dtype const *const p_in_feat,
                                    Dtype *p_out_feat,           //
+                                   uint32_t const out_nrows,    //
                                    uint32_t const nchannel,     //
                                    Itype const *const in_maps,  //
                                    Itype const *const out_maps, //
                                    Wtype const *const weights,  //
                                    uint32_t const nnz) {
-  const Dtype *p_curr_in;
-  Dtype *p_curr_out;
-
-  // Set all values to - Dtype min
-  // std::fill(p_out_feat, p_out_feat + nnz * nchannel, 0);
-
-  // Iterate through each spatial kernel out of filter_volume spatial kernels
-  for (uint32_t i = 0; i < nnz; ++i) {
-    // Define current pointers
-    p_curr_in = p_in_feat + in_maps[i] * nchannel;
-    p_curr_out = p_out_feat + out_maps[i] * nchannel;
-    cpu_axpy<Dtype>(nchannel, (Dtype)weights[i], p_curr_in, p_curr_out);
-  }
+  auto const segments = detail::segment_by_row(out_maps, out_nrows, nnz);
+  detail::segmented_weighted_sum(p_in_feat, p_out_feat, nchannel, in_maps,
+                                 weights, segments.first, segments.second);
 }
 
+/**
+ * The p_grad_in_feat must be initialized and set to 0. The triples are
+ * segmented by the input rows.
+ */
 template <typename Dtype, typename Wtype, typename Itype>
 void InterpolationBackwardKernelCPU(Dtype *p_grad_in_feat,
                                     uint32_t const in_nrows,
@@ -69,25 +132,16 @@ void InterpolationBackwardKernelCPU(Dtype *p_grad_in_feat,
                                     Itype const *const out_maps,
                                     Wtype const *const weights,
                                     uint32_t const nnz) {
-  Dtype *p_curr_grad_in;
-  Dtype const *p_curr_grad_out;
-
-  // cleanup gradients
-  // std::fill(p_grad_in_feat, p_grad_in_feat + in_nrows * nchannel, 0);
-
-  for (uint32_t i = 0; i < nnz; ++i) {
-    // Define current pointers
-    p_curr_grad_in = p_grad_in_feat + in_maps[i] * nchannel;
-    p_curr_grad_out = p_grad_out_feat + out_maps[i] * nchannel;
-
-    cpu_axpy<Dtype>(nchannel, (Dtype)weights[i], p_curr_grad_out,
-                    p_curr_grad_in);
-  }
+  auto const segments = detail::segment_by_row(in_maps, in_nrows, nnz);
+  detail::segmented_weighted_sum(p_grad_out_feat, p_grad_in_feat, nchannel,
+                                 out_maps, weights, segments.first,
+                                 segments.second);
 }
 
 template void
 InterpolationForwardKernelCPU<float, float, int>(float const *const p_in_feat,
                                                  float *p_out_feat,          //
+                                                 uint32_t const out_nrows,   //
                                                  uint32_t const nchannel,    //
                                                  int const *const in_maps,   //
                                                  int const *const out_maps,  //
@@ -97,6 +151,7 @@ InterpolationForwardKernelCPU<float, float, int>(float const *const p_in_feat,
 template void
 InterpolationForwardKernelCPU<double, float, int>(double const *const p_in_feat,
                                                   double *p_out_feat,         //
+                                                  uint32_t const out_nrows,   //
                                                   uint32_t const nchannel,    //
                                                   int const *const in_maps,   //
                                                   int const *const out_maps,  //
@@ -28,6 +28,9 @@
 
 #include "types.hpp"
 
+#include <algorithm>
+#include <memory>
+#include <omp.h>
 #include <ostream>
 #include <tuple>
 #include <vector>
@@ -52,41 +55,62 @@ struct cpu_kernel_map : std::pair<cpu_in_maps, cpu_out_maps> {
   cpu_kernel_map(std::pair<cpu_in_maps, cpu_out_maps> const &other)
       : std::pair<cpu_in_maps, cpu_out_maps>(other) {}
 
-  // origin map initialization.
-  cpu_kernel_map(std::vector<index_pair> &in_out,
-                 std::vector<default_types::dcoordinate_type> const
-                     &unique_batch_indicies) {
-    auto comp = [](std::pair<index_type, index_type> const &l,
-                   std::pair<index_type, index_type> const &r) {
-      return l.second < r.second;
-    };
-    std::sort(in_out.begin(), in_out.end(), comp);
-
-    auto const kernel_volume = unique_batch_indicies.size();
-    this->first.resize(kernel_volume);
-    this->second.resize(kernel_volume);
-
-    for (index_type k = 0; k < unique_batch_indicies.size(); ++k) {
-      auto const lb = std::lower_bound(in_out.begin(), in_out.end(),
-                                       index_pair{0, k}, comp);
-      auto const ub = std::upper_bound(in_out.begin(), in_out.end(),
-                                       index_pair{0, k}, comp);
-      auto const curr_size = ub - lb;
-      default_types::index_type start_index = lb - in_out.begin();
-      LOG_DEBUG("batch row_index:", k, "curr_size:", curr_size,
-                "start_index:", start_index);
-      // resize
-      auto &in_map = this->first[k];
-      auto &out_map = this->second[k];
-      in_map.resize(curr_size);
-      out_map.resize(curr_size);
-      // copy
-      for (uint32_t i = 0; i < curr_size; ++i) {
-        auto const &curr_pair = in_out[i + start_index];
-        in_map[i] = curr_pair.first;
-        out_map[i] = curr_pair.second;
+  // origin map initialization. out_rows[i] is the origin row of the input row
+  // i. A parallel counting sort groups the input rows of each origin row in
+  // the ascending order.
+  cpu_kernel_map(std::vector<index_type> const &out_rows,
+                 index_type const out_size) {
+    int64_t const in_size = out_rows.size();
+    this->first.resize(out_size);
+    this->second.resize(out_size);
+
+    int64_t const num_chunks = std::max<int64_t>(
+        1, std::min<int64_t>(omp_get_max_threads(), in_size / 1024));
+    int64_t const stride = (in_size + num_chunks - 1) / num_chunks;
+
+    // number of rows of each origin row per chunk
+    std::vector<index_type> offsets(num_chunks * out_size, 0);
+#pragma omp parallel for
+    for (int64_t n = 0; n < num_chunks; ++n) {
+      index_type *p_count = &offsets[n * out_size];
+      for (int64_t i = n * stride; i < std::min(in_size, (n + 1) * stride);
+           ++i)
+        ++p_count[out_rows[i]];
+    }
+
+    // exclusive prefix sum over the chunks of each origin row
+    for (index_type k = 0; k < out_size; ++k) {
+      index_type curr_size = 0;
+      for (int64_t n = 0; n < num_chunks; ++n) {
+        index_type const count = offsets[n * out_size + k];
+        offsets[n * out_size + k] = curr_size;
+        curr_size += count;
       }
+      LOG_DEBUG("batch row_index:", k, "curr_size:", curr_size);
+      this->first[k].resize(curr_size);
+      this->second[k].assign(curr_size, k);
     }
+
+#pragma omp parallel for
+    for (int64_t n = 0; n < num_chunks; ++n) {
+      index_type *p_offset = &offsets[n * out_size];
+      for (int64_t i = n * stride; i < std::min(in_size, (n + 1) * stride);
+           ++i) {
+        index_type const k = out_rows[i];
+        this->first[k][p_offset[k]++] = i;
+      }
+    }
+  }
+
+  // Bytes of the in and out maps.
+  size_t bytes() const noexcept {
+    size_t bytes = (this->first.capacity() + this->second.capacity()) *
+                   sizeof(cpu_in_map);
+    for (auto const &map : this->first)
+      bytes += map.capacity() * sizeof(index_type);
+    for (auto const &map : this->second)
+      bytes += map.capacity() * sizeof(index_type);
+    return bytes;
   }
 
   friend std::ostream &operator<<(std::ostream &out,
@@ -102,6 +126,54 @@ struct cpu_kernel_map : std::pair<cpu_in_maps, cpu_out_maps> {
 };
 
 using cpu_kernel_map_reference = std::pair<cpu_in_maps &, cpu_out_maps &>;
+using cpu_kernel_map_pointer = std::shared_ptr<cpu_kernel_map const>;
+
+// The pairs of a kernel map grouped by the tiles of tile_nrows consecutive
+// rows of maps, the in maps or the out maps. The pairs of the tile t and the
+// kernel offset k are the indices pairs[begin(t, k)] to pairs[end(t, k) - 1]
+// of maps[k]. A thread that owns a tile accumulates its rows without a
+// buffer for all rows.
+struct cpu_kernel_map_tiles {
+  using index_type = default_types::index_type;
+
+  cpu_kernel_map_tiles(std::vector<cpu_out_map> const &maps,
+                       int64_t const nrows, int64_t const tile_nrows = 512)
+      : tile_nrows(tile_nrows),
+        num_tiles((nrows + tile_nrows - 1) / tile_nrows),
+        kernel_volume(maps.size()), ptr(num_tiles * kernel_volume + 1, 0) {
+    // Each kernel offset counts and fills its own slots of the tiles.
+#pragma omp parallel for
+    for (int64_t k = 0; k < kernel_volume; ++k)
+      for (auto const row : maps[k])
+        ++ptr[(row / tile_nrows) * kernel_volume + k + 1];
+
+    for (int64_t i = 0; i + 1 < ptr.size(); ++i)
+      ptr[i + 1] += ptr[i];
+    pairs.resize(ptr.back());
+
+#pragma omp parallel for
+    for (int64_t k = 0; k < kernel_volume; ++k) {
+      std::vector<int64_t> offsets(num_tiles);
+      for (int64_t t = 0; t < num_tiles; ++t)
+        offsets[t] = ptr[t * kernel_volume + k];
+      for (int64_t i = 0; i < maps[k].size(); ++i)
+        pairs[offsets[maps[k][i] / tile_nrows]++] = i;
+    }
+  }
+
+  int64_t begin(int64_t const t, int64_t const k) const {
+    return ptr[t * kernel_volume + k];
+  }
+  int64_t end(int64_t const t, int64_t const k) const {
+    return ptr[t * kernel_volume + k + 1];
+  }
+
+  int64_t const tile_nrows;
+  int64_t const num_tiles;
+  int64_t const kernel_volume;
+  std::vector<int64_t> ptr;
+  std::vector<index_type> pairs;
+};
 
 } // namespace minkowski
 
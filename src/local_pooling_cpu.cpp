@@ -52,6 +52,8 @@ LocalPoolingForwardCPU(at::Tensor const &in_feat,
                        CoordinateMapKey *p_in_map_key,                    //
                        CoordinateMapKey *p_out_map_key,                   //
                        cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("LocalPoolingForwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
 
   ASSERT(in_feat.is_contiguous(), "in_feat must be contiguous");
   ASSERT(!in_feat.is_cuda(), "in_feat must be CPU");
@@ -70,7 +72,7 @@ LocalPoolingForwardCPU(at::Tensor const &in_feat,
     p_out_map_key->set_key(out_key);
   }
 
-  cpu_kernel_map const &in_out = p_map_manager->kernel_map(
+  auto const p_in_out = p_map_manager->kernel_map(
       p_in_map_key,    //
       p_out_map_key,   //
       kernel_size,     //
@@ -78,6 +80,7 @@ LocalPoolingForwardCPU(at::Tensor const &in_feat,
       kernel_dilation, //
       region_type,     //
       offset, false /* is_transpose */, true /* is_pool */);
+  cpu_kernel_map const &in_out = *p_in_out;
 
   auto const out_nrows = p_map_manager->size(p_out_map_key->get_key());
   at::Tensor out_feat =
@@ -90,8 +93,9 @@ LocalPoolingForwardCPU(at::Tensor const &in_feat,
     max_index.resize_({out_nrows, in_feat.size(1)});
     max_index.zero_();
 
-    AT_DISPATCH_FLOATING_TYPES(
-        in_feat.scalar_type(), "local_pooling_forward_cpu", [&] {
+    AT_DISPATCH_FLOATING_TYPES_AND2(
+        at::ScalarType::BFloat16, at::ScalarType::Half, in_feat.scalar_type(),
+        "local_pooling_forward_cpu", [&] {
           MaxPoolingForwardKernelCPU<scalar_t, int32_t,
                                      default_types::index_type>(
               in_feat.template data_ptr<scalar_t>(),
@@ -107,8 +111,9 @@ LocalPoolingForwardCPU(at::Tensor const &in_feat,
       num_nonzero.resize_({out_nrows});
       num_nonzero.zero_();
     }
-    AT_DISPATCH_FLOATING_TYPES(
-        in_feat.scalar_type(), "local_pooling_forward_cpu", [&] {
+    AT_DISPATCH_FLOATING_TYPES_AND2(
+        at::ScalarType::BFloat16, at::ScalarType::Half, in_feat.scalar_type(),
+        "local_pooling_forward_cpu", [&] {
           NonzeroAvgPoolingForwardKernelCPU<scalar_t, coordinate_type>(
               in_feat.template data_ptr<scalar_t>(),
               out_feat.template data_ptr<scalar_t>(),
@@ -133,6 +138,8 @@ LocalPoolingBackwardCPU(at::Tensor const &in_feat,                         //
                         CoordinateMapKey *p_in_map_key,                    //
                         CoordinateMapKey *p_out_map_key,                   //
                         cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("LocalPoolingBackwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
   ASSERT(in_feat.is_contiguous(), "in_feat must be contiguous");
   ASSERT(grad_out_feat.is_contiguous(), "grad_out_feata must be contiguous");
 
@@ -149,7 +156,7 @@ LocalPoolingBackwardCPU(at::Tensor const &in_feat,                         //
   coordinate_map_key_type out_key = p_out_map_key->get_key();
   ASSERT(p_map_manager->exists(out_key), ERROR_MAP_NOT_FOUND);
 
-  cpu_kernel_map const &in_out = p_map_manager->kernel_map(
+  auto const p_in_out = p_map_manager->kernel_map(
       p_in_map_key,    //
       p_out_map_key,   //
       kernel_size,     //
@@ -157,13 +164,15 @@ LocalPoolingBackwardCPU(at::Tensor const &in_feat,                         //
       kernel_dilation, //
       region_type,     //
       offset, false /* is_transpose */, true /* is_pool */);
+  cpu_kernel_map const &in_out = *p_in_out;
 
   at::Tensor grad_in_feat =
       torch::zeros({in_feat.size(0), in_feat.size(1)}, in_feat.options());
 
   if (pooling_mode == PoolingMode::LOCAL_MAX_POOLING) {
-    AT_DISPATCH_FLOATING_TYPES(
-        in_feat.scalar_type(), "local_pooling_backward_cpu", [&] {
+    AT_DISPATCH_FLOATING_TYPES_AND2(
+        at::ScalarType::BFloat16, at::ScalarType::Half, in_feat.scalar_type(),
+        "local_pooling_backward_cpu", [&] {
           MaxPoolingBackwardKernelCPU<scalar_t, int32_t>(
               grad_in_feat.template data_ptr<scalar_t>(), in_feat.size(0),
               grad_out_feat.template data_ptr<scalar_t>(),
@@ -171,8 +180,9 @@ LocalPoolingBackwardCPU(at::Tensor const &in_feat,                         //
               in_feat.size(1));
         });
   } else {
-    AT_DISPATCH_FLOATING_TYPES(
-        in_feat.scalar_type(), "local_pooling_backward_cpu", [&] {
+    AT_DISPATCH_FLOATING_TYPES_AND2(
+        at::ScalarType::BFloat16, at::ScalarType::Half, in_feat.scalar_type(),
+        "local_pooling_backward_cpu", [&] {
           NonzeroAvgPoolingBackwardKernelCPU<scalar_t,
                                              default_types::index_type>(
               grad_in_feat.template data_ptr<scalar_t>(), in_feat.size(0),
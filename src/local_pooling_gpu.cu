@@ -74,7 +74,7 @@ std::pair<at::Tensor, at::Tensor> LocalPoolingForwardGPU(
     p_out_map_key->set_key(out_key);
   }
 
-  auto const &in_out = p_map_manager->kernel_map(
+  auto const p_in_out = p_map_manager->kernel_map(
       p_in_map_key,    //
       p_out_map_key,   //
       kernel_size,     //
@@ -82,6 +82,7 @@ std::pair<at::Tensor, at::Tensor> LocalPoolingForwardGPU(
       kernel_dilation, //
       region_type,     //
       offset, false /* is_transpose */, true /* is_pool */);
+  auto const &in_out = *p_in_out;
 
   auto const out_nrows = p_map_manager->size(p_out_map_key->get_key());
   at::Tensor out_feat =
@@ -167,7 +168,7 @@ at::Tensor LocalPoolingBackwardGPU(
   coordinate_map_key_type out_key = p_out_map_key->get_key();
   ASSERT(p_map_manager->exists(out_key), ERROR_MAP_NOT_FOUND);
 
-  auto const &in_out = p_map_manager->kernel_map(
+  auto const p_in_out = p_map_manager->kernel_map(
       p_in_map_key,    //
       p_out_map_key,   //
       kernel_size,     //
@@ -175,6 +176,7 @@ at::Tensor LocalPoolingBackwardGPU(
       kernel_dilation, //
       region_type,     //
       offset, false /* is_transpose */, true /* is_pool */);
+  auto const &in_out = *p_in_out;
 
   at::Tensor grad_in_feat =
       torch::zeros({in_feat.size(0), in_feat.size(1)}, in_feat.options());
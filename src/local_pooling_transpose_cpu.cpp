@@ -52,6 +52,8 @@ std::pair<at::Tensor, at::Tensor> LocalPoolingTransposeForwardCPU(
     CoordinateMapKey *p_in_map_key,                    //
     CoordinateMapKey *p_out_map_key,                   //
     cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("LocalPoolingTransposeForwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
 
   ASSERT(in_feat.is_contiguous(), "in_feat must be contiguous");
   ASSERT(!in_feat.is_cuda(), "in_feat must be CPU");
@@ -87,7 +89,7 @@ std::pair<at::Tensor, at::Tensor> LocalPoolingTransposeForwardCPU(
     p_out_map_key->set_key(out_key);
   }
 
-  cpu_kernel_map const &in_out = p_map_manager->kernel_map(
+  auto const p_in_out = p_map_manager->kernel_map(
       p_in_map_key,    //
       p_out_map_key,   //
       kernel_size,     //
@@ -95,6 +97,7 @@ std::pair<at::Tensor, at::Tensor> LocalPoolingTransposeForwardCPU(
       kernel_dilation, //
       region_type,     //
       offset, true /* is_transpose */, true /* is_pool */);
+  cpu_kernel_map const &in_out = *p_in_out;
 
   auto const out_nrows = p_map_manager->size(p_out_map_key->get_key());
   at::Tensor out_feat =
@@ -103,8 +106,9 @@ std::pair<at::Tensor, at::Tensor> LocalPoolingTransposeForwardCPU(
 
   at::Tensor num_nonzero =
       torch::empty({0}, in_feat.options().requires_grad(false));
-  AT_DISPATCH_FLOATING_TYPES(
-      in_feat.scalar_type(), "local_pooling_forward_cpu", [&] {
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      at::ScalarType::BFloat16, at::ScalarType::Half, in_feat.scalar_type(),
+      "local_pooling_forward_cpu", [&] {
         NonzeroAvgPoolingForwardKernelCPU<scalar_t, coordinate_type>(
             in_feat.template data_ptr<scalar_t>(),
             out_feat.template data_ptr<scalar_t>(),
@@ -128,6 +132,8 @@ at::Tensor LocalPoolingTransposeBackwardCPU(
     CoordinateMapKey *p_in_map_key,                    //
     CoordinateMapKey *p_out_map_key,                   //
     cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("LocalPoolingTransposeBackwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
   ASSERT(in_feat.is_contiguous(), "in_feat must be contiguous");
   ASSERT(grad_out_feat.is_contiguous(), "grad_out_feata must be contiguous");
 
@@ -144,7 +150,7 @@ at::Tensor LocalPoolingTransposeBackwardCPU(
   coordinate_map_key_type out_key = p_out_map_key->get_key();
   ASSERT(p_map_manager->exists(out_key), ERROR_MAP_NOT_FOUND);
 
-  cpu_kernel_map const &in_out = p_map_manager->kernel_map(
+  auto const p_in_out = p_map_manager->kernel_map(
       p_in_map_key,    //
       p_out_map_key,   //
       kernel_size,     //
@@ -152,12 +158,14 @@ at::Tensor LocalPoolingTransposeBackwardCPU(
       kernel_dilation, //
       region_type,     //
       offset, true /* is_transpose */, true /* is_pool */);
+  cpu_kernel_map const &in_out = *p_in_out;
 
   at::Tensor grad_in_feat =
       torch::zeros({in_feat.size(0), in_feat.size(1)}, in_feat.options());
 
-  AT_DISPATCH_FLOATING_TYPES(
-      in_feat.scalar_type(), "local_pooling_backward_cpu", [&] {
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      at::ScalarType::BFloat16, at::ScalarType::Half, in_feat.scalar_type(),
+      "local_pooling_backward_cpu", [&] {
         NonzeroAvgPoolingBackwardKernelCPU<scalar_t, default_types::index_type>(
             grad_in_feat.template data_ptr<scalar_t>(), in_feat.size(0),
             grad_out_feat.template data_ptr<scalar_t>(),
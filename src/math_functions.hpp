@@ -29,14 +29,40 @@
 
 #include "mkl_alternate.hpp"
 
+#include <c10/util/BFloat16.h>
+#include <c10/util/Half.h>
+#include <type_traits>
+
 namespace minkowski {
 
+/**
+ * Type of the CPU accumulators for features of type Dtype. bfloat16 and half
+ * features are stored in half width and accumulated in float.
+ */
+template <typename Dtype> struct accumulate_type { using type = Dtype; };
+template <> struct accumulate_type<c10::BFloat16> { using type = float; };
+template <> struct accumulate_type<c10::Half> { using type = float; };
+
+template <typename Dtype>
+using is_reduced_precision = std::integral_constant<
+    bool, !std::is_same<Dtype, typename accumulate_type<Dtype>::type>::value>;
+
 template <typename Dtype>
 void cpu_gemm(const CBLAS_ORDER Layout, const CBLAS_TRANSPOSE TransA,
               const CBLAS_TRANSPOSE TransB, const int M, const int N,
               const int K, const Dtype alpha, const Dtype *A, const Dtype *B,
               const Dtype beta, Dtype *C);
 
+/**
+ * C := alpha * op(A) * op(B) + beta * C with reduced precision A and B and a
+ * float C.
+ */
+template <typename Dtype>
+void cpu_gemm_acc(const CBLAS_ORDER Layout, const CBLAS_TRANSPOSE TransA,
+                  const CBLAS_TRANSPOSE TransB, const int M, const int N,
+                  const int K, const float alpha, const Dtype *A,
+                  const Dtype *B, const float beta, float *C);
+
 template <typename Dtype>
 void cpu_add(const int N, const Dtype *a, const Dtype *b, Dtype *y);
 
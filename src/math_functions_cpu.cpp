@@ -24,6 +24,9 @@
  */
 #include "math_functions.hpp"
 
+#include <algorithm>
+#include <vector>
+
 namespace minkowski {
 
 template <>
@@ -64,6 +67,66 @@ void cpu_gemm<double>(const CBLAS_ORDER Layout, const CBLAS_TRANSPOSE TransA,
               ldc);
 }
 
+namespace detail {
+
+/*
+ * Portable reduced precision GEMM. Converts A and B to float and uses the
+ * float GEMM.
+ */
+template <typename Dtype>
+void cpu_gemm_acc_float(const CBLAS_ORDER Layout,
+                        const CBLAS_TRANSPOSE TransA,
+                        const CBLAS_TRANSPOSE TransB, const int M, const int N,
+                        const int K, const float alpha, const Dtype *A,
+                        const Dtype *B, const float beta, float *C) {
+  std::vector<float> a(int64_t(M) * K), b(int64_t(K) * N);
+  std::copy(A, A + a.size(), a.begin());
+  std::copy(B, B + b.size(), b.begin());
+  cpu_gemm<float>(Layout, TransA, TransB, M, N, K, alpha, a.data(), b.data(),
+                  beta, C);
+}
+
+} // namespace detail
+
+template <>
+void cpu_gemm_acc<c10::BFloat16>(
+    const CBLAS_ORDER Layout, const CBLAS_TRANSPOSE TransA,
+    const CBLAS_TRANSPOSE TransB, const int M, const int N, const int K,
+    const float alpha, const c10::BFloat16 *A, const c10::BFloat16 *B,
+    const float beta, float *C) {
+#if defined(USE_MKL) && INTEL_MKL_VERSION >= 20200000
+  // Uses the AVX-512 BF16 and AMX instructions when available.
+  int lda, ldb, ldc;
+  if (Layout == CblasRowMajor) {
+    lda = (TransA == CblasNoTrans) ? K : M;
+    ldb = (TransB == CblasNoTrans) ? N : K;
+    ldc = N;
+  } else {
+    lda = (TransA == CblasNoTrans) ? M : K;
+    ldb = (TransB == CblasNoTrans) ? K : N;
+    ldc = M;
+  }
+  cblas_gemm_bf16bf16f32(Layout, TransA, TransB, M, N, K, alpha,
+                         reinterpret_cast<const MKL_BF16 *>(A), lda,
+                         reinterpret_cast<const MKL_BF16 *>(B), ldb, beta, C,
+                         ldc);
+#else
+  detail::cpu_gemm_acc_float(Layout, TransA, TransB, M, N, K, alpha, A, B,
+                             beta, C);
+#endif
+}
+
+template <>
+void cpu_gemm_acc<c10::Half>(const CBLAS_ORDER Layout,
+                             const CBLAS_TRANSPOSE TransA,
+                             const CBLAS_TRANSPOSE TransB, const int M,
+                             const int N, const int K, const float alpha,
+                             const c10::Half *A, const c10::Half *B,
+                             const float beta, float *C) {
+  detail::cpu_gemm_acc_float(Layout, TransA, TransB, M, N, K, alpha, A, B,
+                             beta, C);
+}
+
 template <>
 void cpu_add<float>(const int n, const float *a, const float *b, float *y) {
   vsAdd(n, a, b, y);
@@ -74,6 +137,20 @@ void cpu_add<double>(const int n, const double *a, const double *b, double *y) {
   vdAdd(n, a, b, y);
 }
 
+template <>
+void cpu_add<c10::BFloat16>(const int n, const c10::BFloat16 *a,
+                            const c10::BFloat16 *b, c10::BFloat16 *y) {
+  for (int i = 0; i < n; ++i)
+    y[i] = float(a[i]) + float(b[i]);
+}
+
+template <>
+void cpu_add<c10::Half>(const int n, const c10::Half *a, const c10::Half *b,
+                        c10::Half *y) {
+  for (int i = 0; i < n; ++i)
+    y[i] = float(a[i]) + float(b[i]);
+}
+
 template <>
 void cpu_mul<float>(const int n, const float *a, const float *b, float *y) {
   vsMul(n, a, b, y);
@@ -84,6 +161,20 @@ void cpu_mul<double>(const int n, const double *a, const double *b, double *y) {
   vdMul(n, a, b, y);
 }
 
+template <>
+void cpu_mul<c10::BFloat16>(const int n, const c10::BFloat16 *a,
+                            const c10::BFloat16 *b, c10::BFloat16 *y) {
+  for (int i = 0; i < n; ++i)
+    y[i] = float(a[i]) * float(b[i]);
+}
+
+template <>
+void cpu_mul<c10::Half>(const int n, const c10::Half *a, const c10::Half *b,
+                        c10::Half *y) {
+  for (int i = 0; i < n; ++i)
+    y[i] = float(a[i]) * float(b[i]);
+}
+
 template <>
 void cpu_div<float>(const int n, const float *a, const float *b, float *y) {
   vsDiv(n, a, b, y);
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2020 NVIDIA Corporation.
+ * Copyright (c) 2018-2020 Chris Choy (chrischoy@ai.stanford.edu).
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *
+ * Please cite "4D Spatio-Temporal ConvNets: Minkowski Convolutional Neural
+ * Networks", CVPR'19 (https://arxiv.org/abs/1904.08755) if you use any part
+ * of the code.
+ */
+#include "coordinate_map.hpp"
+#include "coordinate_map_cpu.hpp"
+#include "coordinate_map_key.hpp"
+#include "coordinate_map_manager.hpp"
+#include "errors.hpp"
+#include "types.hpp"
+#include "utils.hpp"
+
+#include "normalization_kernel.hpp"
+
+#include <pybind11/pybind11.h>
+#include <torch/extension.h>
+
+namespace minkowski {
+
+namespace detail {
+
+/*
+ * Rows of each batch. A single batch skips the origin map.
+ */
+template <typename coordinate_type>
+cpu_in_maps instance_norm_batch_rows(
+    at::Tensor const &in_feat, CoordinateMapKey *p_in_map_key,
+    cpu_manager_type<coordinate_type> *p_map_manager) {
+  coordinate_map_key_type in_key = p_in_map_key->get_key();
+  ASSERT(p_map_manager->exists(in_key) || p_map_manager->exists_field(in_key),
+         ERROR_MAP_NOT_FOUND);
+  ASSERT(in_feat.size(0) == p_map_manager->size(in_key), "Invalid in_feat size",
+         in_feat.size(0), "!=", p_map_manager->size(in_key));
+
+  if (p_map_manager->origin_map_size() == 1) {
+    cpu_in_maps batch_rows(1);
+    batch_rows[0].resize(in_feat.size(0));
+    std::iota(batch_rows[0].begin(), batch_rows[0].end(), 0);
+    return batch_rows;
+  }
+
+  if (p_map_manager->exists_field(in_key))
+    return p_map_manager->origin_field_map(p_in_map_key)->first;
+
+  // The batch segment index of the coordinate map skips the origin map
+  auto const &batch_row_indices =
+      p_map_manager->find(in_key)->second.batch_row_indices();
+  auto const &row_ptr = batch_row_indices.first;
+  auto const &rows = batch_row_indices.second;
+  cpu_in_maps batch_rows(row_ptr.size() - 1);
+  for (uint32_t b = 0; b < batch_rows.size(); ++b)
+    batch_rows[b].assign(rows.begin() + row_ptr[b],
+                         rows.begin() + row_ptr[b + 1]);
+  return batch_rows;
+}
+
+} // namespace detail
+
+/*
+ * Returns the normalized features and the inverse standard deviation of each
+ * batch.
+ */
+template <typename coordinate_type>
+std::pair<at::Tensor, at::Tensor>
+InstanceNormForwardCPU(at::Tensor const &in_feat,      //
+                       double const eps,               //
+                       CoordinateMapKey *p_in_map_key, //
+                       cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("InstanceNormForwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
+  ASSERT(in_feat.is_contiguous(), "in_feat must be contiguous");
+  ASSERT(!in_feat.is_cuda(), "in_feat must be on CPU");
+  ASSERT(in_feat.dim() == 2, "Invalid in_feat.dim():", in_feat.dim());
+
+  cpu_in_maps const batch_rows = detail::instance_norm_batch_rows(
+      in_feat, p_in_map_key, p_map_manager);
+  int64_t const batch_size = batch_rows.size();
+  LOG_DEBUG("Instance norm with batch size", batch_size);
+
+  auto out_feat = torch::empty_like(in_feat);
+  auto inv_std = torch::empty({batch_size, in_feat.size(1)}, in_feat.options());
+
+  AT_DISPATCH_FLOATING_TYPES(
+      in_feat.scalar_type(), "instance_norm_forward_cpu", [&] {
+        InstanceNormForwardKernelCPU<scalar_t>(
+            in_feat.template data_ptr<scalar_t>(),
+            out_feat.template data_ptr<scalar_t>(),
+            inv_std.template data_ptr<scalar_t>(), in_feat.size(1), batch_rows,
+            eps);
+      });
+
+  return std::make_pair(out_feat, inv_std);
+}
+
+template <typename coordinate_type>
+at::Tensor
+InstanceNormBackwardCPU(at::Tensor &grad_out_feat,      //
+                        at::Tensor const &out_feat,     //
+                        at::Tensor const &inv_std,      //
+                        CoordinateMapKey *p_in_map_key, //
+                        cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("InstanceNormBackwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
+  if (!grad_out_feat.is_contiguous())
+    grad_out_feat = grad_out_feat.contiguous();
+  ASSERT(!grad_out_feat.is_cuda(), "grad_out_feat must be on CPU");
+  ASSERT(out_feat.is_contiguous(), "out_feat must be contiguous");
+  ASSERT(grad_out_feat.sizes() == out_feat.sizes(), "Invalid grad_out_feat size");
+
+  cpu_in_maps const batch_rows = detail::instance_norm_batch_rows(
+      out_feat, p_in_map_key, p_map_manager);
+  ASSERT(inv_std.size(0) == batch_rows.size(), "Invalid inv_std size",
+         inv_std.size(0), "!=", batch_rows.size());
+
+  auto grad_in_feat = torch::empty_like(grad_out_feat);
+
+  AT_DISPATCH_FLOATING_TYPES(
+      grad_out_feat.scalar_type(), "instance_norm_backward_cpu", [&] {
+        InstanceNormBackwardKernelCPU<scalar_t>(
+            grad_out_feat.template data_ptr<scalar_t>(),
+            out_feat.template data_ptr<scalar_t>(),
+            inv_std.template data_ptr<scalar_t>(),
+            grad_in_feat.template data_ptr<scalar_t>(), out_feat.size(1),
+            batch_rows);
+      });
+  return grad_in_feat;
+}
+
+template std::pair<at::Tensor, at::Tensor>
+InstanceNormForwardCPU<default_types::dcoordinate_type>(
+    at::Tensor const &in_feat,      //
+    double const eps,               //
+    CoordinateMapKey *p_in_map_key, //
+    cpu_manager_type<default_types::dcoordinate_type> *p_map_manager);
+
+template at::Tensor InstanceNormBackwardCPU<default_types::dcoordinate_type>(
+    at::Tensor &grad_out_feat,      //
+    at::Tensor const &out_feat,     //
+    at::Tensor const &inv_std,      //
+    CoordinateMapKey *p_in_map_key, //
+    cpu_manager_type<default_types::dcoordinate_type> *p_map_manager);
+} // end namespace minkowski
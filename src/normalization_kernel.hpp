@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2020 NVIDIA CORPORATION.
+ * Copyright (c) 2018-2020 Chris Choy (chrischoy@ai.stanford.edu)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Please cite "4D Spatio-Temporal ConvNets: Minkowski Convolutional Neural
+ * Networks", CVPR'19 (https://arxiv.org/abs/1904.08755) if you use any part
+ * of the code.
+ */
+#ifndef CPU_NORMALIZATION
+#define CPU_NORMALIZATION
+
+#include "kernel_map.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <vector>
+
+namespace minkowski {
+
+namespace detail {
+
+// Number of rows of a batch processed by a single task.
+constexpr uint32_t INSTANCE_NORM_CHUNK_SIZE = 1024;
+
+// (batch index, row begin, row end) of the rows in batch_rows[batch index].
+using instance_norm_task = std::tuple<uint32_t, uint32_t, uint32_t>;
+
+inline std::vector<instance_norm_task>
+instance_norm_tasks(cpu_in_maps const &batch_rows) {
+  std::vector<instance_norm_task> tasks;
+  for (uint32_t b = 0; b < batch_rows.size(); ++b) {
+    uint32_t const nrows = batch_rows[b].size();
+    for (uint32_t begin = 0; begin < nrows; begin += INSTANCE_NORM_CHUNK_SIZE)
+      tasks.emplace_back(
+          b, begin, std::min(begin + INSTANCE_NORM_CHUNK_SIZE, nrows));
+  }
+  return tasks;
+}
+
+} // namespace detail
+
+/**
+ * Normalize the features of each batch with the batch mean and variance.
+ *
+ * The first pass computes the mean and the sum of squared deviations of each
+ * chunk with the Welford update and merges the chunks of each batch. The
+ * second pass writes the normalized features. p_inv_std has the size of
+ * batch_rows.size() * nchannel.
+ */
+template <typename Dtype>
+void InstanceNormForwardKernelCPU(Dtype const *p_in_feat,       //
+                                  Dtype *p_out_feat,            //
+                                  Dtype *p_inv_std,             //
+                                  uint32_t const nchannel,      //
+                                  cpu_in_maps const &batch_rows, //
+                                  Dtype const eps) {
+  auto const tasks = detail::instance_norm_tasks(batch_rows);
+  uint32_t const batch_size = batch_rows.size();
+
+  std::vector<Dtype> task_mean(tasks.size() * nchannel, 0),
+      task_m2(tasks.size() * nchannel, 0);
+
+#pragma omp parallel for schedule(dynamic)
+  for (int64_t t = 0; t < tasks.size(); ++t) {
+    uint32_t b, begin, end;
+    std::tie(b, begin, end) = tasks[t];
+    Dtype *p_mean = &task_mean[t * nchannel];
+    Dtype *p_m2 = &task_m2[t * nchannel];
+    for (uint32_t i = begin; i < end; ++i) {
+      Dtype const *p_curr_in = p_in_feat + batch_rows[b][i] * nchannel;
+      Dtype const inv_count = Dtype(1) / (i - begin + 1);
+#pragma omp simd
+      for (uint32_t c = 0; c < nchannel; ++c) {
+        Dtype const delta = p_curr_in[c] - p_mean[c];
+        p_mean[c] += delta * inv_count;
+        p_m2[c] += delta * (p_curr_in[c] - p_mean[c]);
+      }
+    }
+  }
+
+  // Merge the chunk statistics of each batch
+  std::vector<Dtype> mean(batch_size * nchannel, 0),
+      m2(batch_size * nchannel, 0);
+  std::vector<uint32_t> count(batch_size, 0);
+  for (uint32_t t = 0; t < tasks.size(); ++t) {
+    uint32_t b, begin, end;
+    std::tie(b, begin, end) = tasks[t];
+    Dtype const n_a = count[b], n_b = end - begin, n = n_a + n_b;
+    Dtype *p_mean = &mean[b * nchannel];
+    Dtype *p_m2 = &m2[b * nchannel];
+    for (uint32_t c = 0; c < nchannel; ++c) {
+      Dtype const delta = task_mean[t * nchannel + c] - p_mean[c];
+      p_mean[c] += delta * n_b / n;
+      p_m2[c] += task_m2[t * nchannel + c] + delta * delta * n_a * n_b / n;
+    }
+    count[b] += end - begin;
+  }
+
+  for (uint32_t b = 0; b < batch_size; ++b) {
+    for (uint32_t c = 0; c < nchannel; ++c) {
+      Dtype const var =
+          count[b] > 0 ? m2[b * nchannel + c] / count[b] : Dtype(0);
+      p_inv_std[b * nchannel + c] = 1 / std::sqrt(var + eps);
+    }
+  }
+
+#pragma omp parallel for schedule(dynamic)
+  for (int64_t t = 0; t < tasks.size(); ++t) {
+    uint32_t b, begin, end;
+    std::tie(b, begin, end) = tasks[t];
+    Dtype const *p_mean = &mean[b * nchannel];
+    Dtype const *p_curr_inv_std = p_inv_std + b * nchannel;
+    for (uint32_t i = begin; i < end; ++i) {
+      auto const row = batch_rows[b][i];
+      Dtype const *p_curr_in = p_in_feat + row * nchannel;
+      Dtype *p_curr_out = p_out_feat + row * nchannel;
+#pragma omp simd
+      for (uint32_t c = 0; c < nchannel; ++c)
+        p_curr_out[c] = (p_curr_in[c] - p_mean[c]) * p_curr_inv_std[c];
+    }
+  }
+}
+
+/**
+ * grad_in = inv_std * (grad_out - mean(grad_out) - out * mean(grad_out *
+ * out)) where the means are taken over the rows of each batch.
+ */
+template <typename Dtype>
+void InstanceNormBackwardKernelCPU(Dtype const *p_grad_out_feat, //
+                                   Dtype const *p_out_feat,      //
+                                   Dtype const *p_inv_std,       //
+                                   Dtype *p_grad_in_feat,        //
+                                   uint32_t const nchannel,      //
+                                   cpu_in_maps const &batch_rows) {
+  auto const tasks = detail::instance_norm_tasks(batch_rows);
+  uint32_t const batch_size = batch_rows.size();
+
+  std::vector<Dtype> task_sum_grad(tasks.size() * nchannel, 0),
+      task_sum_grad_out(tasks.size() * nchannel, 0);
+
+#pragma omp parallel for schedule(dynamic)
+  for (int64_t t = 0; t < tasks.size(); ++t) {
+    uint32_t b, begin, end;
+    std::tie(b, begin, end) = tasks[t];
+    Dtype *p_sum_grad = &task_sum_grad[t * nchannel];
+    Dtype *p_sum_grad_out = &task_sum_grad_out[t * nchannel];
+    for (uint32_t i = begin; i < end; ++i) {
+      auto const row = batch_rows[b][i];
+      Dtype const *p_curr_grad = p_grad_out_feat + row * nchannel;
+      Dtype const *p_curr_out = p_out_feat + row * nchannel;
+#pragma omp simd
+      for (uint32_t c = 0; c < nchannel; ++c) {
+        p_sum_grad[c] += p_curr_grad[c];
+        p_sum_grad_out[c] += p_curr_grad[c] * p_curr_out[c];
+      }
+    }
+  }
+
+  std::vector<Dtype> mean_grad(batch_size * nchannel, 0),
+      mean_grad_out(batch_size * nchannel, 0);
+  for (uint32_t t = 0; t < tasks.size(); ++t) {
+    uint32_t const b = std::get<0>(tasks[t]);
+    for (uint32_t c = 0; c < nchannel; ++c) {
+      mean_grad[b * nchannel + c] += task_sum_grad[t * nchannel + c];
+      mean_grad_out[b * nchannel + c] += task_sum_grad_out[t * nchannel + c];
+    }
+  }
+  for (uint32_t b = 0; b < batch_size; ++b) {
+    if (batch_rows[b].size() == 0)
+      continue;
+    Dtype const inv_count = Dtype(1) / batch_rows[b].size();
+    for (uint32_t c = 0; c < nchannel; ++c) {
+      mean_grad[b * nchannel + c] *= inv_count;
+      mean_grad_out[b * nchannel + c] *= inv_count;
+    }
+  }
+
+#pragma omp parallel for schedule(dynamic)
+  for (int64_t t = 0; t < tasks.size(); ++t) {
+    uint32_t b, begin, end;
+    std::tie(b, begin, end) = tasks[t];
+    Dtype const *p_mean_grad = &mean_grad[b * nchannel];
+    Dtype const *p_mean_grad_out = &mean_grad_out[b * nchannel];
+    Dtype const *p_curr_inv_std = p_inv_std + b * nchannel;
+    for (uint32_t i = begin; i < end; ++i) {
+      auto const row = batch_rows[b][i];
+      Dtype const *p_curr_grad = p_grad_out_feat + row * nchannel;
+      Dtype const *p_curr_out = p_out_feat + row * nchannel;
+      Dtype *p_curr_grad_in = p_grad_in_feat + row * nchannel;
+#pragma omp simd
+      for (uint32_t c = 0; c < nchannel; ++c)
+        p_curr_grad_in[c] = p_curr_inv_std[c] *
+                            (p_curr_grad[c] - p_mean_grad[c] -
+                             p_curr_out[c] * p_mean_grad_out[c]);
+    }
+  }
+}
+
+} // namespace minkowski
+
+#endif // CPU_NORMALIZATION
@@ -25,9 +25,13 @@
 #ifndef CPU_POOLING_AVG
 #define CPU_POOLING_AVG
 
+#include "kernel_map.hpp"
 #include "math_functions.hpp"
 
+#include <algorithm>
 #include <limits>
+#include <type_traits>
+#include <vector>
 
 namespace minkowski {
 
@@ -38,7 +42,8 @@ namespace minkowski {
  * TODO consistent memset
  */
 template <typename Dtype, typename Itype>
-void NonzeroAvgPoolingForwardKernelCPU(Dtype const *p_in_feat,
+typename std::enable_if<!is_reduced_precision<Dtype>::value>::type
+NonzeroAvgPoolingForwardKernelCPU(Dtype const *p_in_feat,
                                        Dtype *p_out_feat, //
                                        Dtype *p_num_nonzero,
                                        int const nchannel,           //
@@ -101,7 +106,8 @@ void NonzeroAvgPoolingForwardKernelCPU(Dtype const *p_in_feat,
 }
 
 template <typename Dtype, typename Itype>
-void NonzeroAvgPoolingBackwardKernelCPU(Dtype *p_grad_in_feat,
+typename std::enable_if<!is_reduced_precision<Dtype>::value>::type
+NonzeroAvgPoolingBackwardKernelCPU(Dtype *p_grad_in_feat,
                                         int const in_nrows,
                                         Dtype const *p_grad_out_feat,
                                         Dtype const *p_num_nonzero,
@@ -149,6 +155,106 @@ void NonzeroAvgPoolingBackwardKernelCPU(Dtype *p_grad_in_feat,
   }
 }
 
+/**
+ * Reduced precision pooling. Each thread accumulates the features of a tile
+ * of output rows in float and rounds them to Dtype once.
+ */
+template <typename Dtype, typename Itype>
+typename std::enable_if<is_reduced_precision<Dtype>::value>::type
+NonzeroAvgPoolingForwardKernelCPU(Dtype const *p_in_feat,
+                                  Dtype *p_out_feat, //
+                                  Dtype *p_num_nonzero,
+                                  int const nchannel,           //
+                                  cpu_in_maps const &in_maps,   //
+                                  cpu_out_maps const &out_maps, //
+                                  int const out_nrows, const bool use_avg) {
+  using Acc = typename accumulate_type<Dtype>::type;
+  cpu_kernel_map_tiles const tiles(out_maps, out_nrows);
+
+#pragma omp parallel
+  {
+    std::vector<Acc> tile_acc(tiles.tile_nrows * nchannel);
+    std::vector<int> num_nonzero(tiles.tile_nrows);
+#pragma omp for schedule(dynamic)
+    for (int64_t t = 0; t < tiles.num_tiles; ++t) {
+      int64_t const row_begin = t * tiles.tile_nrows;
+      int64_t const nrows =
+          std::min<int64_t>(tiles.tile_nrows, out_nrows - row_begin);
+      std::fill_n(tile_acc.begin(), nrows * nchannel, 0);
+      std::fill_n(num_nonzero.begin(), nrows, 0);
+
+      for (int k = 0; k < in_maps.size(); k++) {
+        for (int64_t i = tiles.begin(t, k); i < tiles.end(t, k); i++) {
+          auto const pair = tiles.pairs[i];
+          auto const out_row = out_maps[k][pair] - row_begin;
+          Dtype const *p_curr_in = p_in_feat + in_maps[k][pair] * nchannel;
+          Acc *p_curr_out = &tile_acc[out_row * nchannel];
+          num_nonzero[out_row]++;
+          for (int j = 0; j < nchannel; j++)
+            p_curr_out[j] += Acc(p_curr_in[j]);
+        }
+      }
+
+      for (int64_t row = 0; row < nrows; row++) {
+        Acc const scale = (use_avg && num_nonzero[row] > 0)
+                              ? Acc(1) / num_nonzero[row]
+                              : Acc(1);
+        Dtype *p_curr_out = p_out_feat + (row_begin + row) * nchannel;
+        for (int j = 0; j < nchannel; j++)
+          p_curr_out[j] = tile_acc[row * nchannel + j] * scale;
+        if (use_avg)
+          p_num_nonzero[row_begin + row] = num_nonzero[row];
+      }
+    }
+  }
+}
+
+template <typename Dtype, typename Itype>
+typename std::enable_if<is_reduced_precision<Dtype>::value>::type
+NonzeroAvgPoolingBackwardKernelCPU(Dtype *p_grad_in_feat,
+                                   int const in_nrows,
+                                   Dtype const *p_grad_out_feat,
+                                   Dtype const *p_num_nonzero,
+                                   int const nchannel,           //
+                                   cpu_in_maps const &in_maps,   //
+                                   cpu_out_maps const &out_maps, //
+                                   bool const use_avg) {
+  using Acc = typename accumulate_type<Dtype>::type;
+  cpu_kernel_map_tiles const tiles(in_maps, in_nrows);
+
+#pragma omp parallel
+  {
+    std::vector<Acc> tile_acc(tiles.tile_nrows * nchannel);
+#pragma omp for schedule(dynamic)
+    for (int64_t t = 0; t < tiles.num_tiles; ++t) {
+      int64_t const row_begin = t * tiles.tile_nrows;
+      int64_t const nrows =
+          std::min<int64_t>(tiles.tile_nrows, in_nrows - row_begin);
+      std::fill_n(tile_acc.begin(), nrows * nchannel, 0);
+
+      for (int k = 0; k < in_maps.size(); k++) {
+        for (int64_t i = tiles.begin(t, k); i < tiles.end(t, k); i++) {
+          auto const pair = tiles.pairs[i];
+          Acc *p_curr_grad_in =
+              &tile_acc[(in_maps[k][pair] - row_begin) * nchannel];
+          Dtype const *p_curr_grad_out =
+              p_grad_out_feat + out_maps[k][pair] * nchannel;
+          Acc scale = 1;
+          if (use_avg) {
+            Acc const curr_num_nonzero = p_num_nonzero[out_maps[k][pair]];
+            scale = curr_num_nonzero > 0 ? 1 / curr_num_nonzero : 0;
+          }
+          for (int j = 0; j < nchannel; j++)
+            p_curr_grad_in[j] += Acc(p_curr_grad_out[j]) * scale;
+        }
+      }
+
+      std::copy_n(tile_acc.begin(), nrows * nchannel,
+                  p_grad_in_feat + row_begin * nchannel);
+    }
+  }
+}
+
 template void NonzeroAvgPoolingForwardKernelCPU<float, int>(
     float const *p_in_feat, float *p_out_feat, float *p_num_nonzero,
     int const nchannel,
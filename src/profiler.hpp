@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2020 NVIDIA CORPORATION.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Please cite "4D Spatio-Temporal ConvNets: Minkowski Convolutional Neural
+ * Networks", CVPR'19 (https://arxiv.org/abs/1904.08755) if you use any part
+ * of the code.
+ */
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace minkowski {
+
+/*
+ * Process-wide recorder of the timed phases of the ops. Recording is off by
+ * default and a disabled profile_scope costs a single relaxed atomic load.
+ * The events are exported to python as the complete events of the Chrome
+ * trace format.
+ */
+class profiler {
+public:
+  struct event {
+    std::string name;
+    std::string category;
+    int thread;
+    int64_t start_ns;
+    int64_t duration_ns;
+  };
+
+  static profiler &instance() {
+    static profiler s_profiler;
+    return s_profiler;
+  }
+
+  static bool enabled() {
+    return instance().m_enabled.load(std::memory_order_relaxed);
+  }
+
+  // Nanoseconds on the steady clock shared with the python layer events.
+  static int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  // Events beyond the capacity are counted as dropped.
+  void enable(int64_t capacity) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = capacity;
+    m_enabled.store(true, std::memory_order_relaxed);
+  }
+
+  void disable() { m_enabled.store(false, std::memory_order_relaxed); }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_events.clear();
+    m_dropped = 0;
+  }
+
+  void record(std::string name, std::string category, int64_t start_ns,
+              int64_t end_ns) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_capacity >= 0 && int64_t(m_events.size()) >= m_capacity) {
+      ++m_dropped;
+      return;
+    }
+    // Small consecutive ids for the trace viewer rows
+    auto const thread_it = m_threads.emplace(std::this_thread::get_id(),
+                                             int(m_threads.size()));
+    m_events.push_back(event{std::move(name), std::move(category),
+                             thread_it.first->second, start_ns,
+                             end_ns - start_ns});
+  }
+
+  std::vector<event> events() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_events;
+  }
+
+  int64_t dropped() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dropped;
+  }
+
+private:
+  profiler() = default;
+
+  std::atomic<bool> m_enabled{false};
+  mutable std::mutex m_mutex;
+  int64_t m_capacity{-1};
+  int64_t m_dropped{0};
+  std::vector<event> m_events;
+  std::unordered_map<std::thread::id, int> m_threads;
+};
+
+/*
+ * Records the lifetime of the scope as an event when the profiler is enabled.
+ * The name and the category must outlive the scope, e.g. string literals.
+ *
+ * Categories: "op" for the exported functions, "map" for the coordinate and
+ * kernel map lookup and generation, and "phase" for the "alloc", "gather",
+ * "gemm", and "scatter" steps of the feature computation.
+ */
+class profile_scope {
+public:
+  profile_scope(char const *name, char const *category)
+      : m_name(name), m_category(category),
+        m_start_ns(profiler::enabled() ? profiler::now() : -1) {}
+  profile_scope(profile_scope const &) = delete;
+  profile_scope &operator=(profile_scope const &) = delete;
+  ~profile_scope() { stop(); }
+
+  // Records the event before the end of the scope.
+  void stop() {
+    if (m_start_ns >= 0)
+      profiler::instance().record(m_name, m_category, m_start_ns,
+                                  profiler::now());
+    m_start_ns = -1;
+  }
+
+private:
+  char const *m_name;
+  char const *m_category;
+  int64_t m_start_ns;
+};
+
+} // end namespace minkowski
+
+#endif // PROFILER_HPP
@@ -46,6 +46,8 @@ PruningForwardCPU(at::Tensor const &in_feat, // CPU feat
                   CoordinateMapKey *p_in_map_key,  //
                   CoordinateMapKey *p_out_map_key, //
                   cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("PruningForwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
   ASSERT(in_feat.is_contiguous(), "in_feat must be contiguous");
   ASSERT(keep.is_contiguous(), "keep must be contiguous");
 
@@ -76,7 +78,8 @@ PruningForwardCPU(at::Tensor const &in_feat, // CPU feat
     p_out_map_key->set_key(out_key);
   }
 
-  const auto &in_out = p_map_manager->kernel_map(p_in_map_key, p_out_map_key);
+  auto const p_in_out = p_map_manager->kernel_map(p_in_map_key, p_out_map_key);
+  const auto &in_out = *p_in_out;
   LOG_DEBUG("Generated kernel map");
 
   // Get the total number of coords
@@ -108,6 +111,8 @@ PruningBackwardCPU(at::Tensor &grad_out_feat,       // CPU out feat
                    CoordinateMapKey *p_in_map_key,  //
                    CoordinateMapKey *p_out_map_key, //
                    cpu_manager_type<coordinate_type> *p_map_manager) {
+  profile_scope const scope("PruningBackwardCPU", "op");
+  auto const omp_scope = p_map_manager->thread_scope();
   if (!grad_out_feat.is_contiguous())
     grad_out_feat = grad_out_feat.contiguous();
 
@@ -123,7 +128,8 @@ PruningBackwardCPU(at::Tensor &grad_out_feat,       // CPU out feat
   ASSERT(grad_out_feat.size(0) == N_out, "Invalid grad_out_feat size",
          grad_out_feat.size(0), "!=", N_out);
 
-  const auto &in_out = p_map_manager->kernel_map(p_in_map_key, p_out_map_key);
+  auto const p_in_out = p_map_manager->kernel_map(p_in_map_key, p_out_map_key);
+  const auto &in_out = *p_in_out;
   const int nchannel = grad_out_feat.size(1);
   at::Tensor grad_in_feat =
       torch::zeros({N_in, nchannel}, grad_out_feat.options());
@@ -121,7 +121,8 @@ at::Tensor PruningForwardGPU(
     p_out_map_key->set_key(out_key);
   }
 
-  const auto &in_out = p_map_manager->kernel_map(p_in_map_key, p_out_map_key);
+  auto const p_in_out = p_map_manager->kernel_map(p_in_map_key, p_out_map_key);
+  const auto &in_out = *p_in_out;
 
   // Get the total number of coords
   const int64_t tot_n = p_map_manager->size(p_out_map_key->get_key());
@@ -167,7 +168,8 @@ at::Tensor PruningBackwardGPU(
   ASSERT(grad_out_feat.size(0) == N_out, "Invalid grad_out_feat size",
          grad_out_feat.size(0), "!=", N_out);
 
-  const auto &in_out = p_map_manager->kernel_map(p_in_map_key, p_out_map_key);
+  auto const p_in_out = p_map_manager->kernel_map(p_in_map_key, p_out_map_key);
+  const auto &in_out = *p_in_out;
   const int nchannel = grad_out_feat.size(1);
   at::Tensor grad_in_feat =
       torch::zeros({N_in, nchannel}, grad_out_feat.options());
@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2020 NVIDIA CORPORATION.
+ * Copyright (c) 2018-2020 Chris Choy (chrischoy@ai.stanford.edu)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * Please cite "4D Spatio-Temporal ConvNets: Minkowski Convolutional Neural
+ * Networks", CVPR'19 (https://arxiv.org/abs/1904.08755) if you use any part
+ * of the code.
+ */
+#ifndef SERIALIZATION_HPP
+#define SERIALIZATION_HPP
+
+#include "types.hpp"
+#include "utils.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace minkowski {
+
+namespace detail {
+
+/*
+ * Binary layout of a serialized CoordinateMapManager.
+ *
+ * The loader reads the arrays into the manager with a copy since the hash
+ * tables of the coordinate maps are rebuilt anyway. Every length read from a
+ * file is checked against the remaining file size before allocation.
+ *
+ * All scalars are stored in the native byte order, which is verified on load
+ * with SERIALIZATION_BYTE_ORDER. Every array is prefixed with its uint64
+ * length and starts at an offset aligned to SERIALIZATION_ALIGNMENT so that
+ * the index and coordinate arrays can be memory-mapped (e.g. numpy.memmap)
+ * without a copy.
+ *
+ * header | coordinate maps | field maps | kernel maps | field kernel maps |
+ * field to sparse maps
+ */
+constexpr char const SERIALIZATION_MAGIC[8] = {'M', 'I', 'N', 'K',
+                                               'M', 'A', 'P', '\0'};
+constexpr uint32_t SERIALIZATION_VERSION = 1;
+constexpr uint32_t SERIALIZATION_BYTE_ORDER = 0x01020304;
+constexpr uint64_t SERIALIZATION_ALIGNMENT = 64;
+
+struct serialization_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t coordinate_type_size;
+  uint32_t coordinate_field_type_size;
+  uint32_t index_type_size;
+  uint32_t algorithm;
+  uint64_t num_coordinate_maps;
+  uint64_t num_field_maps;
+  uint64_t num_kernel_maps;
+  uint64_t num_field_kernel_maps;
+  uint64_t num_field_to_sparse_maps;
+};
+
+class binary_writer {
+public:
+  binary_writer(std::string const &path)
+      : m_path(path), m_stream(path, std::ios::binary | std::ios::trunc),
+        m_offset(0) {
+    ASSERT(m_stream.is_open(), "Failed to open", path, "for writing.");
+  }
+
+  template <typename T> void write(T const &value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only trivially copyable types can be written.");
+    write_bytes(&value, sizeof(T));
+  }
+
+  void write_string(std::string const &str) {
+    write<uint64_t>(str.size());
+    write_bytes(str.data(), str.size());
+  }
+
+  template <typename T> void write_array(T const *p_data, uint64_t size) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only trivially copyable types can be written.");
+    write<uint64_t>(size);
+    align();
+    write_bytes(p_data, size * sizeof(T));
+  }
+
+  template <typename T> void write_vector(std::vector<T> const &vec) {
+    write_array(vec.data(), vec.size());
+  }
+
+  void write_key(coordinate_map_key_type const &key) {
+    write_vector(key.first);
+    write_string(key.second);
+  }
+
+  void write_kernel_map_key(kernel_map_key_type const &key) {
+    write_key(std::get<0>(key));
+    write_key(std::get<1>(key));
+    write_vector(std::get<2>(key));
+    write_vector(std::get<3>(key));
+    write_vector(std::get<4>(key));
+    write<uint32_t>(std::get<5>(key));
+    write<uint8_t>(std::get<6>(key));
+    write<uint8_t>(std::get<7>(key));
+  }
+
+  void close() {
+    m_stream.close();
+    ASSERT(!m_stream.fail(), "Failed to write", m_path);
+  }
+
+private:
+  void align() {
+    static char const zeros[SERIALIZATION_ALIGNMENT] = {0};
+    uint64_t const remainder = m_offset % SERIALIZATION_ALIGNMENT;
+    if (remainder > 0)
+      write_bytes(zeros, SERIALIZATION_ALIGNMENT - remainder);
+  }
+
+  void write_bytes(void const *p_data, uint64_t num_bytes) {
+    if (num_bytes == 0)
+      return;
+    m_stream.write(reinterpret_cast<char const *>(p_data), num_bytes);
+    ASSERT(m_stream.good(), "Failed to write", m_path);
+    m_offset += num_bytes;
+  }
+
+  std::string m_path;
+  std::ofstream m_stream;
+  uint64_t m_offset;
+};
+
+class binary_reader {
+public:
+  binary_reader(std::string const &path)
+      : m_path(path), m_stream(path, std::ios::binary), m_offset(0) {
+    ASSERT(m_stream.is_open(), "Failed to open", path, "for reading.");
+    m_stream.seekg(0, std::ios::end);
+    m_size = m_stream.tellg();
+    m_stream.seekg(0, std::ios::beg);
+    ASSERT(m_stream.good(), "Failed to read the size of", path);
+  }
+
+  template <typename T> T read() {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only trivially copyable types can be read.");
+    T value;
+    read_bytes(&value, sizeof(T));
+    return value;
+  }
+
+  std::string read_string() {
+    uint64_t const size = read<uint64_t>();
+    check_size(size, 1, m_offset);
+    std::string str(size, '\0');
+    read_bytes(&str[0], size);
+    return str;
+  }
+
+  // Returns the array length of T elements. Call read_array_data with a
+  // buffer of that size.
+  template <typename T> uint64_t read_array_size() {
+    uint64_t const size = read<uint64_t>();
+    check_size(size, sizeof(T), aligned(m_offset));
+    return size;
+  }
+
+  // Asserts that count records of at least record_size bytes fit in the file
+  // after the current offset.
+  void check_count(uint64_t const count, uint64_t const record_size) const {
+    check_size(count, record_size, m_offset);
+  }
+
+  template <typename T> void read_array_data(T *p_data, uint64_t size) {
+    align();
+    read_bytes(p_data, size * sizeof(T));
+  }
+
+  template <typename T> std::vector<T> read_vector() {
+    std::vector<T> vec(read_array_size<T>());
+    read_array_data(vec.data(), vec.size());
+    return vec;
+  }
+
+  coordinate_map_key_type read_key() {
+    auto tensor_stride = read_vector<default_types::size_type>();
+    auto string_id = read_string();
+    return std::make_pair(std::move(tensor_stride), std::move(string_id));
+  }
+
+  kernel_map_key_type read_kernel_map_key() {
+    auto in_key = read_key();
+    auto out_key = read_key();
+    auto kernel_size = read_vector<default_types::size_type>();
+    auto kernel_stride = read_vector<default_types::size_type>();
+    auto kernel_dilation = read_vector<default_types::size_type>();
+    auto const region_type = static_cast<RegionType::Type>(read<uint32_t>());
+    bool const is_transpose = read<uint8_t>();
+    bool const is_pool = read<uint8_t>();
+    return std::make_tuple(in_key, out_key, kernel_size, kernel_stride,
+                           kernel_dilation, region_type, is_transpose, is_pool);
+  }
+
+private:
+  static uint64_t aligned(uint64_t const offset) {
+    uint64_t const remainder = offset % SERIALIZATION_ALIGNMENT;
+    return remainder > 0 ? offset + SERIALIZATION_ALIGNMENT - remainder
+                         : offset;
+  }
+
+  void check_size(uint64_t const count, uint64_t const record_size,
+                  uint64_t const begin) const {
+    uint64_t const remaining = begin <= m_size ? m_size - begin : 0;
+    ASSERT(count <= remaining / record_size, "Invalid size", count, "at",
+           m_offset, "in", m_path, "of", m_size, "bytes.");
+  }
+
+  void align() {
+    char buffer[SERIALIZATION_ALIGNMENT];
+    uint64_t const remainder = m_offset % SERIALIZATION_ALIGNMENT;
+    if (remainder > 0)
+      read_bytes(buffer, SERIALIZATION_ALIGNMENT - remainder);
+  }
+
+  void read_bytes(void *p_data, uint64_t num_bytes) {
+    if (num_bytes == 0)
+      return;
+    m_stream.read(reinterpret_cast<char *>(p_data), num_bytes);
+    ASSERT(m_stream.good(), "Unexpected end of file while reading", m_path);
+    m_offset += num_bytes;
+  }
+
+  std::string m_path;
+  std::ifstream m_stream;
+  uint64_t m_offset;
+  uint64_t m_size;
+};
+
+} // namespace detail
+
+} // namespace minkowski
+
+#endif // SERIALIZATION_HPP
@@ -133,6 +133,10 @@ namespace CoordinateMapBackend {
 enum Type { CPU = 0, CUDA = 1 };
 }
 
+namespace CoordinateOrdering {
+enum Type { INSERTION = 0, MORTON = 1, HILBERT = 2 };
+}
+
 namespace RegionType {
 enum Type { HYPER_CUBE, HYPER_CROSS, CUSTOM };
 }
@@ -169,6 +173,15 @@ enum Type {
 };
 }
 
+namespace ActivationType {
+enum Type {
+  IDENTITY,
+  RELU,
+  LEAKY_RELU,
+  GELU,
+};
+}
+
 /* Key for KernelMap
  *
  * A tuple of (CoordinateMapKey (input),
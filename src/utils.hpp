@@ -27,6 +27,7 @@
 #include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <omp.h>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -256,6 +257,34 @@ public:
   index_type const m_from, m_to;
 };
 
+/*
+ * Limits the OpenMP parallel regions started by the calling thread to
+ * num_threads threads until the scope ends. The number of threads is a
+ * per-thread OpenMP setting, so the scope does not change the threads of
+ * other callers such as the PyTorch intra-op pool.
+ */
+class omp_thread_scope {
+public:
+  explicit omp_thread_scope(int num_threads)
+      : m_active(num_threads > 0), m_prev_num_threads(omp_get_max_threads()) {
+    if (m_active)
+      omp_set_num_threads(num_threads);
+  }
+  omp_thread_scope(omp_thread_scope const &) = delete;
+  omp_thread_scope(omp_thread_scope &&other)
+      : m_active(other.m_active), m_prev_num_threads(other.m_prev_num_threads) {
+    other.m_active = false;
+  }
+  ~omp_thread_scope() {
+    if (m_active)
+      omp_set_num_threads(m_prev_num_threads);
+  }
+
+private:
+  bool m_active;
+  int m_prev_num_threads;
+};
+
 } // end namespace minkowski
 
 #endif // UTILS
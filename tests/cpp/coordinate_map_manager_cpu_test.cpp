@@ -123,9 +123,10 @@ coordinate_map_manager_kernel_map(py::object manager,
 
   auto offset = torch::empty({0}, torch::TensorOptions().dtype(torch::kInt32));
 
-  cpu_kernel_map const &kernel_map = p_manager->kernel_map(
+  auto const p_kernel_map = p_manager->kernel_map(
       p_in_map_key, p_out_map_key, kernel_size, kernel_stride, kernel_dilation,
       RegionType::HYPER_CUBE, offset, false, false);
+  cpu_kernel_map const &kernel_map = *p_kernel_map;
   LOG_DEBUG("kernel_map generated");
 
   return std::make_pair(detail::to_torch<index_type>(kernel_map.first),
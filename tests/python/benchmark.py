@@ -0,0 +1,387 @@
+# Copyright (c) 2020 NVIDIA CORPORATION.
+# Copyright (c) 2018-2020 Chris Choy (chrischoy@ai.stanford.edu).
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+# of the Software, and to permit persons to whom the Software is furnished to do
+# so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# Please cite "4D Spatio-Temporal ConvNets: Minkowski Convolutional Neural
+# Networks", CVPR'19 (https://arxiv.org/abs/1904.08755) if you use any part
+# of the code.
+r"""Offline CPU benchmarks of the coordinate map and kernel primitives.
+
+The benchmarks run on synthetic point clouds sampled on sphere surfaces, so
+the occupancy resembles scanned scenes, and need no download. The results are
+written as JSON to compare the releases.
+
+Example::
+
+   python -m tests.python.benchmark --sizes 10000 100000 --threads 1 8 --output results.json
+   python -m tests.python.benchmark --benchmarks kernel_map conv_forward
+
+"""
+import argparse
+import json
+import os
+import platform
+import sys
+import time
+
+import numpy as np
+import torch
+import MinkowskiEngine as ME
+import MinkowskiEngineBackend._C as MEB
+
+parser = argparse.ArgumentParser()
+parser.add_argument("--sizes", type=int, nargs="+", default=[10000, 100000])
+parser.add_argument("--dimensions", type=int, nargs="+", default=[3])
+parser.add_argument(
+    "--threads", type=int, nargs="+", default=[1, torch.get_num_threads()]
+)
+parser.add_argument("--batch_size", type=int, default=2)
+parser.add_argument("--channels", type=int, default=32)
+parser.add_argument("--repeat", type=int, default=5)
+parser.add_argument("--warmup", type=int, default=1)
+parser.add_argument("--seed", type=int, default=0)
+parser.add_argument("--benchmarks", type=str, nargs="+", default=None)
+parser.add_argument("--output", type=str, default=None)
+
+
+def synthetic_coordinates(num_points, dimension, batch_size, seed):
+    r"""Returns the batched integer coordinates of points sampled on a sphere
+    surface per batch. The radius keeps about one point per voxel."""
+    generator = torch.Generator().manual_seed(seed)
+    radius = (num_points / batch_size) ** (1 / max(dimension - 1, 1))
+    coordinates = []
+    for b in range(batch_size):
+        points = torch.randn(num_points // batch_size, dimension, generator=generator)
+        points = points / points.norm(dim=1, keepdim=True) * radius
+        coordinates.append(torch.floor(points).int())
+    return ME.utils.batched_coordinates(coordinates)
+
+
+class Context:
+    def __init__(self, coordinates, dimension, channels, num_threads):
+        self.coordinates = coordinates
+        self.dimension = dimension
+        self.channels = channels
+        self.num_threads = num_threads
+        self.features = torch.rand(len(coordinates), channels)
+
+    def manager(self):
+        return ME.CoordinateManager(
+            D=self.dimension,
+            num_threads=self.num_threads,
+            coordinate_map_type=ME.CoordinateMapType.CPU,
+        )
+
+    def map_key(self):
+        manager = self.manager()
+        key, _ = manager.insert_and_map(self.coordinates)
+        return manager, key
+
+    def sparse_tensor(self, requires_grad=False):
+        input = ME.SparseTensor(
+            self.features,
+            self.coordinates,
+            coordinate_manager=self.manager(),
+        )
+        input.F.requires_grad_(requires_grad)
+        return input
+
+
+# Each benchmark returns (setup, run). setup() runs before each repetition
+# and its result is passed to run(), which is timed.
+def insert_and_map(ctx):
+    return ctx.manager, lambda manager: manager.insert_and_map(ctx.coordinates)
+
+
+def quantize_th(ctx):
+    return lambda: None, lambda _: MEB.quantize_th(ctx.coordinates)
+
+
+def stride(ctx):
+    return ctx.map_key, lambda state: state[0].stride(state[1], 2)
+
+
+def kernel_map(ctx):
+    return ctx.map_key, lambda state: state[0].kernel_map(
+        state[1], state[1], kernel_size=3
+    )
+
+
+def strided_kernel_map(ctx):
+    def setup():
+        manager, key = ctx.map_key()
+        return manager, key, manager.stride(key, 2)
+
+    return setup, lambda state: state[0].kernel_map(
+        state[1], state[2], stride=2, kernel_size=2
+    )
+
+
+def origin_map(ctx):
+    return ctx.map_key, lambda state: state[0].origin_map(state[1])
+
+
+def _module(ctx, module, requires_grad=False):
+    module.eval()
+
+    # The kernel maps are generated in the first call
+    def setup():
+        input = ctx.sparse_tensor(requires_grad)
+        with torch.no_grad():
+            module(input)
+        return input
+
+    return setup, module
+
+
+def _forward(ctx, module):
+    setup, module = _module(ctx, module)
+
+    def run(input):
+        with torch.no_grad():
+            return module(input)
+
+    return setup, run
+
+
+def _backward(ctx, module):
+    setup_input, module = _module(ctx, module, requires_grad=True)
+
+    def setup():
+        output = module(setup_input())
+        return output.F, torch.ones_like(output.F)
+
+    return setup, lambda state: state[0].backward(state[1])
+
+
+def conv_forward(ctx):
+    return _forward(
+        ctx,
+        ME.MinkowskiConvolution(
+            ctx.channels, ctx.channels, kernel_size=3, dimension=ctx.dimension
+        ),
+    )
+
+
+def conv_backward(ctx):
+    return _backward(
+        ctx,
+        ME.MinkowskiConvolution(
+            ctx.channels, ctx.channels, kernel_size=3, dimension=ctx.dimension
+        ),
+    )
+
+
+def strided_conv_forward(ctx):
+    return _forward(
+        ctx,
+        ME.MinkowskiConvolution(
+            ctx.channels, ctx.channels, kernel_size=2, stride=2, dimension=ctx.dimension
+        ),
+    )
+
+
+def generative_conv_transpose_forward(ctx):
+    r"""The transposed convolution generates the output coordinates with
+    stride_region in every call."""
+    down = ME.MinkowskiConvolution(
+        ctx.channels, ctx.channels, kernel_size=2, stride=2, dimension=ctx.dimension
+    )
+    up = ME.MinkowskiGenerativeConvolutionTranspose(
+        ctx.channels, ctx.channels, kernel_size=2, stride=2, dimension=ctx.dimension
+    )
+
+    def setup():
+        with torch.no_grad():
+            return down(ctx.sparse_tensor())
+
+    def run(input):
+        with torch.no_grad():
+            return up(input)
+
+    return setup, run
+
+
+def max_pooling_forward(ctx):
+    return _forward(
+        ctx, ME.MinkowskiMaxPooling(kernel_size=2, stride=2, dimension=ctx.dimension)
+    )
+
+
+def max_pooling_backward(ctx):
+    return _backward(
+        ctx, ME.MinkowskiMaxPooling(kernel_size=2, stride=2, dimension=ctx.dimension)
+    )
+
+
+def avg_pooling_forward(ctx):
+    return _forward(
+        ctx, ME.MinkowskiAvgPooling(kernel_size=3, stride=1, dimension=ctx.dimension)
+    )
+
+
+def sum_pooling_forward(ctx):
+    return _forward(
+        ctx, ME.MinkowskiSumPooling(kernel_size=2, stride=2, dimension=ctx.dimension)
+    )
+
+
+def pooling_transpose_forward(ctx):
+    pool = ME.MinkowskiSumPooling(kernel_size=2, stride=2, dimension=ctx.dimension)
+    unpool = ME.MinkowskiPoolingTranspose(
+        kernel_size=2, stride=2, dimension=ctx.dimension
+    )
+
+    def setup():
+        with torch.no_grad():
+            input = pool(ctx.sparse_tensor())
+            unpool(input)
+        return input
+
+    def run(input):
+        with torch.no_grad():
+            return unpool(input)
+
+    return setup, run
+
+
+def global_avg_pooling_forward(ctx):
+    return _forward(ctx, ME.MinkowskiGlobalAvgPooling())
+
+
+def global_max_pooling_forward(ctx):
+    return _forward(ctx, ME.MinkowskiGlobalMaxPooling())
+
+
+def interpolation_forward(ctx):
+    interpolation = ME.MinkowskiInterpolation()
+    tfield = ctx.coordinates.float()
+    tfield[:, 1:] += torch.rand(len(tfield), ctx.dimension)
+
+    def run(input):
+        with torch.no_grad():
+            return interpolation(input, tfield)
+
+    return ctx.sparse_tensor, run
+
+
+BENCHMARKS = [
+    insert_and_map,
+    quantize_th,
+    stride,
+    kernel_map,
+    strided_kernel_map,
+    origin_map,
+    conv_forward,
+    conv_backward,
+    strided_conv_forward,
+    generative_conv_transpose_forward,
+    max_pooling_forward,
+    max_pooling_backward,
+    avg_pooling_forward,
+    sum_pooling_forward,
+    pooling_transpose_forward,
+    global_avg_pooling_forward,
+    global_max_pooling_forward,
+    interpolation_forward,
+]
+
+
+def measure(setup, run, repeat, warmup):
+    times = []
+    for i in range(warmup + repeat):
+        state = setup()
+        start = time.perf_counter()
+        run(state)
+        elapsed = time.perf_counter() - start
+        if i >= warmup:
+            times.append(elapsed)
+    return times
+
+
+def run_benchmarks(config):
+    benchmarks = BENCHMARKS
+    if config.benchmarks is not None:
+        names = [benchmark.__name__ for benchmark in BENCHMARKS]
+        for name in config.benchmarks:
+            assert name in names, f"Invalid benchmark {name}. Choose from {names}"
+        benchmarks = [b for b in BENCHMARKS if b.__name__ in config.benchmarks]
+
+    default_threads = torch.get_num_threads()
+    results = []
+    try:
+        for dimension in config.dimensions:
+            for size in config.sizes:
+                coordinates = synthetic_coordinates(
+                    size, dimension, config.batch_size, config.seed
+                )
+                num_voxels = len(torch.unique(coordinates, dim=0))
+                for num_threads in config.threads:
+                    torch.set_num_threads(num_threads)
+                    ctx = Context(coordinates, dimension, config.channels, num_threads)
+                    for benchmark in benchmarks:
+                        torch.manual_seed(config.seed)
+                        times = measure(
+                            *benchmark(ctx), config.repeat, config.warmup
+                        )
+                        result = dict(
+                            benchmark=benchmark.__name__,
+                            dimension=dimension,
+                            num_points=len(coordinates),
+                            num_voxels=num_voxels,
+                            num_threads=num_threads,
+                            channels=config.channels,
+                            min_ms=1000 * min(times),
+                            median_ms=1000 * float(np.median(times)),
+                            mean_ms=1000 * float(np.mean(times)),
+                        )
+                        print(
+                            "{benchmark}\t{dimension}\t{num_voxels}\t{num_threads}\t{min_ms:.3f}\t{median_ms:.3f}".format(
+                                **result
+                            ),
+                            file=sys.stderr,
+                        )
+                        results.append(result)
+    finally:
+        torch.set_num_threads(default_threads)
+    return results
+
+
+if __name__ == "__main__":
+    config = parser.parse_args()
+    print(
+        "benchmark\tdimension\tnum_voxels\tnum_threads\tmin_ms\tmedian_ms",
+        file=sys.stderr,
+    )
+    results = run_benchmarks(config)
+    report = dict(
+        version=ME.__version__,
+        torch_version=torch.__version__,
+        platform=platform.platform(),
+        processor=platform.processor(),
+        cpu_count=os.cpu_count(),
+        config=vars(config),
+        results=results,
+    )
+    if config.output is None:
+        json.dump(report, sys.stdout, indent=2)
+    else:
+        with open(config.output, "w") as f:
+            json.dump(report, f, indent=2)
@@ -22,6 +22,7 @@
 # Please cite "4D Spatio-Temporal ConvNets: Minkowski Convolutional Neural
 # Networks", CVPR'19 (https://arxiv.org/abs/1904.08755) if you use any part
 # of the code.
+import copy
 import torch
 import unittest
 import time
@@ -34,10 +35,19 @@ from MinkowskiEngine import (
     MinkowskiAlgorithm,
     MinkowskiConvolution,
     MinkowskiConvolutionFunction,
+    MinkowskiConvolutionBiasActivationFunction,
+    MinkowskiFusedConvolution,
+    MinkowskiMultiTensorConvolutionFunction,
+    ActivationType,
     MinkowskiConvolutionTranspose,
     MinkowskiConvolutionTransposeFunction,
     MinkowskiGenerativeConvolutionTranspose,
     MinkowskiChannelwiseConvolution,
+    MinkowskiDepthwiseConvolution,
+    MinkowskiQuantize,
+    MinkowskiQuantizedConvolution,
+    calibrate_convolutions,
+    quantize_convolutions,
     KernelGenerator,
 )
 
@@ -89,6 +99,38 @@ class TestConvolution(unittest.TestCase):
         output = conv(input)
         print(output)
 
+    def test_algorithm(self):
+        print(f"{self.__class__.__name__}: test_algorithm")
+        in_channels, out_channels, D = 2, 3, 2
+        coords, feats, labels = data_loader(in_channels)
+        feats = feats.double()
+        conv = MinkowskiConvolution(
+            in_channels, out_channels, kernel_size=3, stride=2, dimension=D
+        ).double()
+
+        outputs = []
+        for algorithm in (
+            MinkowskiAlgorithm.DEFAULT,
+            MinkowskiAlgorithm.MEMORY_EFFICIENT,
+            MinkowskiAlgorithm.SPEED_OPTIMIZED,
+        ):
+            input = SparseTensor(
+                feats.clone().requires_grad_(),
+                coordinates=coords,
+                minkowski_algorithm=algorithm,
+            )
+            output = conv(input)
+            output.F.sum().backward()
+            outputs.append((output, input.F.grad))
+
+        # The row order of the strided coordinates depends on the hash table
+        output, grad = outputs[0]
+        for other_output, other_grad in outputs[1:]:
+            self.assertEqual(len(output), len(other_output))
+            other_F = other_output.features_at_coordinates(output.C.double())
+            self.assertTrue(torch.allclose(output.F, other_F))
+            self.assertTrue(torch.allclose(grad, other_grad))
+
     def test_kernel_map(self):
         print(f"{self.__class__.__name__}: test_gpu")
         if not torch.cuda.is_available():
@@ -244,6 +286,204 @@ class TestConvolution(unittest.TestCase):
         output = conv(input)
         print(output)
 
+    def test_reduced_precision(self):
+        print(f"{self.__class__.__name__}: test_reduced_precision")
+        in_channels, out_channels, D = 3, 4, 2
+        coords, feats, labels = data_loader(in_channels)
+        feats = feats / feats.numel()
+        conv = MinkowskiConvolution(
+            in_channels, out_channels, kernel_size=3, stride=2, bias=True, dimension=D
+        )
+        input = SparseTensor(feats.requires_grad_(), coordinates=coords)
+        output = conv(input)
+        output.F.sum().backward()
+
+        for dtype in (torch.bfloat16, torch.float16):
+            conv_half = copy.deepcopy(conv).to(dtype)
+            feats_half = feats.detach().to(dtype).requires_grad_()
+            input_half = SparseTensor(
+                feats_half,
+                coordinate_map_key=input.coordinate_map_key,
+                coordinate_manager=input.coordinate_manager,
+            )
+            output_half = conv_half(input_half)
+            self.assertEqual(output_half.F.dtype, dtype)
+            self.assertTrue(
+                torch.allclose(output_half.F.float(), output.F, rtol=1e-2, atol=1e-2)
+            )
+            output_half.F.sum().backward()
+            self.assertTrue(
+                torch.allclose(
+                    conv_half.kernel.grad.float(),
+                    conv.kernel.grad,
+                    rtol=1e-2,
+                    atol=1e-2,
+                )
+            )
+            self.assertTrue(
+                torch.allclose(feats_half.grad.float(), feats.grad, rtol=1e-2, atol=1e-2)
+            )
+
+    def test_forward_multi(self):
+        print(f"{self.__class__.__name__}: test_forward_multi")
+        in_channels, out_channels, D = 3, 4, 2
+        coords, feats, labels = data_loader(in_channels)
+        feats = feats.double()
+        conv = MinkowskiConvolution(
+            in_channels, out_channels, kernel_size=3, stride=2, bias=True, dimension=D
+        ).double()
+
+        # Each input has its own coordinate manager
+        inputs = [
+            SparseTensor(feats.clone().requires_grad_(), coordinates=coords),
+            SparseTensor(
+                (2 * feats[: len(coords) // 2]).requires_grad_(),
+                coordinates=coords[: len(coords) // 2],
+            ),
+        ]
+        outputs = conv.forward_multi(inputs)
+        self.assertEqual(len(outputs), len(inputs))
+        sum(output.F.sum() for output in outputs).backward()
+        grad_kernel = conv.kernel.grad.clone()
+
+        conv.kernel.grad.zero_()
+        for input, output in zip(inputs, outputs):
+            input_single = SparseTensor(
+                input.F.detach().requires_grad_(),
+                coordinate_map_key=input.coordinate_map_key,
+                coordinate_manager=input.coordinate_manager,
+            )
+            output_single = conv(input_single)
+            self.assertTrue(torch.equal(output.C, output_single.C))
+            self.assertTrue(torch.allclose(output.F, output_single.F))
+            output_single.F.sum().backward()
+            self.assertTrue(torch.allclose(input.F.grad, input_single.F.grad))
+        self.assertTrue(torch.allclose(conv.kernel.grad, grad_kernel))
+
+        fn = MinkowskiMultiTensorConvolutionFunction()
+        for input in inputs:
+            input.F.grad = None
+        self.assertTrue(
+            gradcheck(
+                fn.apply,
+                (
+                    conv.kernel,
+                    conv.kernel_generator,
+                    conv.convolution_mode,
+                    [input.coordinate_map_key for input in inputs],
+                    [output.coordinate_map_key for output in outputs],
+                    [input.coordinate_manager for input in inputs],
+                    *[input.F for input in inputs],
+                ),
+            )
+        )
+
+
+class TestFusedConvolution(unittest.TestCase):
+    def test(self):
+        print(f"{self.__class__.__name__}: test")
+        in_channels, out_channels, D = 2, 3, 2
+        coords, feats, labels = data_loader(in_channels)
+        feats = feats.double()
+        feats.requires_grad_()
+        input = SparseTensor(feats, coordinates=coords)
+        activations = {
+            ActivationType.IDENTITY: lambda x: x,
+            ActivationType.RELU: torch.nn.functional.relu,
+            ActivationType.LEAKY_RELU: lambda x: torch.nn.functional.leaky_relu(
+                x, 0.1
+            ),
+            ActivationType.GELU: torch.nn.functional.gelu,
+        }
+        for activation, fn in activations.items():
+            conv = MinkowskiFusedConvolution(
+                in_channels,
+                out_channels,
+                kernel_size=3,
+                stride=2,
+                activation=activation,
+                negative_slope=0.1,
+                dimension=D,
+            ).double()
+            output = conv(input)
+            ref_conv = MinkowskiConvolution(
+                in_channels, out_channels, kernel_size=3, stride=2, dimension=D
+            ).double()
+            ref_conv.kernel.data[:] = conv.kernel.data
+            ref_output = ref_conv(input)
+            self.assertTrue(
+                torch.allclose(output.F, fn(ref_output.F + conv.bias))
+            )
+
+            self.assertTrue(
+                gradcheck(
+                    MinkowskiConvolutionBiasActivationFunction(),
+                    (
+                        input.F,
+                        conv.kernel,
+                        conv.bias,
+                        activation,
+                        0.1,
+                        conv.kernel_generator,
+                        conv.convolution_mode,
+                        input.coordinate_map_key,
+                        output.coordinate_map_key,
+                        input.coordinate_manager,
+                    ),
+                )
+            )
+
+
+class TestQuantizedConvolution(unittest.TestCase):
+    def test(self):
+        print(f"{self.__class__.__name__}: test")
+        in_channels, out_channels, D = 3, 8, 2
+        coords, feats, labels = data_loader(in_channels)
+        input = SparseTensor(feats, coordinates=coords)
+        conv = MinkowskiConvolution(
+            in_channels, out_channels, kernel_size=3, stride=2, bias=True, dimension=D
+        ).eval()
+        with torch.no_grad():
+            output = conv(input)
+
+        ranges = calibrate_convolutions(conv, [input])
+        self.assertEqual(ranges[""], feats.abs().max().item())
+        input_scale = ranges[""] / 127
+        qconv = MinkowskiQuantizedConvolution.from_float(conv, input_scale)
+        self.assertEqual(qconv.kernel.dtype, torch.int8)
+
+        # Float input is quantized on the fly
+        qoutput = qconv(input)
+        self.assertEqual(qoutput.F.dtype, torch.float32)
+        self.assertTrue(torch.equal(qoutput.C, output.C))
+        tol = 0.05 * output.F.abs().max().item()
+        self.assertTrue(torch.allclose(qoutput.F, output.F, atol=tol))
+
+        # int8 input
+        qinput = MinkowskiQuantize(input_scale)(input)
+        self.assertEqual(qinput.F.dtype, torch.int8)
+        self.assertTrue(torch.equal(qconv(qinput).F, qoutput.F))
+
+    def test_quantize_convolutions(self):
+        print(f"{self.__class__.__name__}: test_quantize_convolutions")
+        in_channels, D = 3, 2
+        coords, feats, labels = data_loader(in_channels)
+        input = SparseTensor(feats, coordinates=coords)
+        model = torch.nn.Sequential(
+            MinkowskiConvolution(in_channels, 8, kernel_size=3, dimension=D),
+            MinkowskiConvolution(8, 4, kernel_size=1, dimension=D),
+        ).eval()
+        with torch.no_grad():
+            output = model(input)
+
+        model = quantize_convolutions(model, calibrate_convolutions(model, [input]))
+        self.assertIsInstance(model[0], MinkowskiQuantizedConvolution)
+        # 1x1 convolutions stay float
+        self.assertIsInstance(model[1], MinkowskiConvolution)
+        qoutput = model(input)
+        tol = 0.05 * output.F.abs().max().item()
+        self.assertTrue(torch.allclose(qoutput.F, output.F, atol=tol))
+
 
 class TestConvolutionMode(unittest.TestCase):
     def test_gpu(self):
@@ -592,6 +832,51 @@ class TestChannelwiseConvolution(unittest.TestCase):
         self.assertEqual(output.coordinate_map_key.get_tensor_stride(), [2, 2])
 
 
+class TestDepthwiseConvolution(unittest.TestCase):
+    def test(self):
+        print(f"{self.__class__.__name__}: test")
+        in_channels, D = 3, 2
+        coords, feats, labels = data_loader(in_channels)
+        feats = feats.double()
+        feats.requires_grad_()
+        input = SparseTensor(feats, coordinates=coords)
+        conv = MinkowskiDepthwiseConvolution(
+            in_channels, kernel_size=3, stride=2, bias=True, dimension=D
+        ).double()
+        output = conv(input)
+
+        # Compare with the dense convolution with the diagonal kernels
+        dense_conv = MinkowskiConvolution(
+            in_channels,
+            in_channels,
+            kernel_size=3,
+            stride=2,
+            bias=True,
+            dimension=D,
+        ).double()
+        with torch.no_grad():
+            dense_conv.kernel.copy_(torch.diag_embed(conv.kernel))
+            dense_conv.bias.copy_(conv.bias)
+        dense_output = dense_conv(input)
+        self.assertTrue(torch.allclose(output.F, dense_output.F))
+
+        fn = conv.conv
+        self.assertTrue(
+            gradcheck(
+                fn.apply,
+                (
+                    input.F,
+                    conv.kernel,
+                    conv.kernel_generator,
+                    conv.convolution_mode,
+                    input.coordinate_map_key,
+                    output.coordinate_map_key,
+                    input.coordinate_manager,
+                ),
+            )
+        )
+
+
 class TestPCD(unittest.TestCase):
     def test_forward(self):
         coords, colors, pcd = load_file("1.ply")
@@ -21,6 +21,11 @@
 # Please cite "4D Spatio-Temporal ConvNets: Minkowski Convolutional Neural
 # Networks", CVPR'19 (https://arxiv.org/abs/1904.08755) if you use any part
 # of the code.
+import os
+import sys
+import tempfile
+import threading
+import time
 import unittest
 
 import torch
@@ -77,6 +82,65 @@ class CoordinateManagerTestCase(unittest.TestCase):
         # print("Reduction mapping: ", cm.get_row_indices_per_batch(stride_key))
         # print(cm)
 
+    def test_save_load(self):
+        coordinates = torch.IntTensor(
+            [[0, 1], [0, 1], [0, 2], [0, 2], [1, 0], [1, 0], [1, 1]]
+        )
+
+        manager = ME.CoordinateManager(
+            D=1, coordinate_map_type=ME.CoordinateMapType.CPU
+        )
+        key, (unique_map, inverse_map) = manager.insert_and_map(coordinates, [1])
+        stride_key = manager.stride(key, [2])
+        kernel_map = manager.kernel_map(key, stride_key, 2, 3)
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            path = os.path.join(tmpdir, "manager.mkmap")
+            manager.save(path)
+
+            loaded_manager = ME.CoordinateManager(
+                D=1, coordinate_map_type=ME.CoordinateMapType.CPU
+            )
+            loaded_manager.load(path)
+
+            # Loading to a non-empty manager is not allowed
+            with self.assertRaises(RuntimeError):
+                manager.load(path)
+
+            with open(path, "rb") as f:
+                data = f.read()
+            # A truncated file or a corrupt array length fails before the
+            # allocation. The first array length follows the 72 byte header.
+            corrupt_path = os.path.join(tmpdir, "corrupt.mkmap")
+            for corrupt in (
+                data[: len(data) // 2],
+                data[:72] + (1 << 62).to_bytes(8, sys.byteorder) + data[80:],
+            ):
+                with open(corrupt_path, "wb") as f:
+                    f.write(corrupt)
+                with self.assertRaises(RuntimeError):
+                    ME.CoordinateManager(
+                        D=1, coordinate_map_type=ME.CoordinateMapType.CPU
+                    ).load(corrupt_path)
+
+        self.assertTrue(
+            torch.all(
+                manager.get_coordinates(key) == loaded_manager.get_coordinates(key)
+            )
+        )
+        self.assertTrue(
+            torch.all(
+                manager.get_coordinates(stride_key)
+                == loaded_manager.get_coordinates(stride_key)
+            )
+        )
+
+        # The cached kernel map must be identical
+        loaded_kernel_map = loaded_manager.kernel_map(key, stride_key, 2, 3)
+        self.assertEqual(kernel_map.keys(), loaded_kernel_map.keys())
+        for k, in_out in kernel_map.items():
+            self.assertTrue(torch.all(in_out == loaded_kernel_map[k]))
+
     def test_stride(self):
 
         coordinates = torch.IntTensor(
@@ -256,3 +320,289 @@ class CoordinateManagerTestCase(unittest.TestCase):
         coordinates = torch.IntTensor([[0, 0], [0, 0], [0, 1], [0, 2]])
         unique_map, inverse_map = ME.utils.unique_coordinate_map(coordinates)
         self.assertTrue(len(unique_map) == 3)
+
+    def test_num_threads(self):
+        coordinates = torch.IntTensor([[0, 0], [0, 1], [0, 2], [1, 0]])
+        torch_threads = torch.get_num_threads()
+
+        manager = ME.CoordinateManager(
+            D=1, coordinate_map_type=ME.CoordinateMapType.CPU
+        )
+        self.assertEqual(manager.num_threads, torch_threads)
+
+        manager = ME.CoordinateManager(
+            D=1, num_threads=1, coordinate_map_type=ME.CoordinateMapType.CPU
+        )
+        self.assertEqual(manager.num_threads, 1)
+        key, _ = manager.insert_and_map(coordinates, [1])
+        manager.stride(key, [2])
+        # The budget of a manager does not change the PyTorch threads
+        self.assertEqual(torch.get_num_threads(), torch_threads)
+
+        manager = ME.CoordinateManager(
+            D=1,
+            num_threads=torch_threads + 1,
+            coordinate_map_type=ME.CoordinateMapType.CPU,
+        )
+        self.assertEqual(manager.num_threads, torch_threads)
+
+    def test_concurrent_kernel_map(self):
+        coordinates = torch.randint(0, 16, (256, 3)).int()
+        coordinates[:, 0] = torch.randint(0, 2, (256,))
+        features = torch.rand(len(coordinates), 4)
+        conv = ME.MinkowskiConvolution(4, 8, kernel_size=3, stride=2, dimension=2)
+        conv.eval()
+
+        # Threads share the manager of the input and generate the missing
+        # strided map and kernel map concurrently.
+        def run(outputs, index):
+            with torch.no_grad():
+                outputs[index] = conv(input)
+
+        input = ME.SparseTensor(features, coordinates)
+        outputs = [None] * 4
+        threads = [
+            threading.Thread(target=run, args=(outputs, i))
+            for i in range(len(outputs))
+        ]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+
+        with torch.no_grad():
+            reference = conv(input)
+        for output in outputs:
+            self.assertTrue(output.coordinate_map_key == reference.coordinate_map_key)
+            self.assertTrue(torch.allclose(output.F, reference.F))
+
+    def test_update(self):
+        coordinates = torch.randint(0, 8, (128, 3)).int()
+        coordinates[:, 0] = torch.randint(0, 2, (128,))
+        coordinates = torch.unique(coordinates, dim=0)
+        features = torch.rand(len(coordinates), 4)
+        conv = ME.MinkowskiConvolution(4, 2, kernel_size=3, dimension=2)
+        conv.eval()
+
+        manager = ME.CoordinateManager(
+            D=2, coordinate_map_type=ME.CoordinateMapType.CPU
+        )
+        input = ME.SparseTensor(features, coordinates, coordinate_manager=manager)
+        key = input.coordinate_map_key
+        # Cache the kernel map of the input
+        with torch.no_grad():
+            conv(input)
+
+        # Erase some coordinates and insert the neighbors of the others
+        erase_coordinates = coordinates[:16]
+        insert_coordinates = torch.IntTensor([[0, 8, 7], [1, 7, 8], [0, 8, 8]])
+        insert_features = torch.rand(len(insert_coordinates), 4)
+        insert_rows, moved_rows = manager.update(
+            key, insert_coordinates, erase_coordinates
+        )
+        updated_features = manager.update_features(
+            key, input.F, insert_features, insert_rows, moved_rows
+        )
+        updated = ME.SparseTensor(
+            updated_features, coordinate_map_key=key, coordinate_manager=manager
+        )
+
+        reference_coordinates = torch.cat((coordinates[16:], insert_coordinates))
+        reference = ME.SparseTensor(
+            torch.cat((features[16:], insert_features)), reference_coordinates
+        )
+        self.assertEqual(len(updated.F), len(reference.F))
+        with torch.no_grad():
+            output = conv(updated)
+            reference_output = conv(reference)
+        query = reference_coordinates.float()
+        self.assertTrue(
+            torch.allclose(
+                output.features_at_coordinates(query),
+                reference_output.features_at_coordinates(query),
+                atol=1e-6,
+            )
+        )
+
+        # Insertion only moves no rows
+        new_coordinates = torch.IntTensor([[1, 9, 9], [0, 9, 8]])
+        new_features = torch.rand(len(new_coordinates), 4)
+        insert_rows, moved_rows = manager.update(key, new_coordinates)
+        self.assertEqual(moved_rows.shape, (2, 0))
+        num_rows = len(updated_features)
+        self.assertEqual(insert_rows.tolist(), [num_rows, num_rows + 1])
+        updated = ME.SparseTensor(
+            manager.update_features(
+                key, updated_features, new_features, insert_rows, moved_rows
+            ),
+            coordinate_map_key=key,
+            coordinate_manager=manager,
+        )
+        reference_coordinates = torch.cat((reference_coordinates, new_coordinates))
+        reference = ME.SparseTensor(
+            torch.cat((features[16:], insert_features, new_features)),
+            reference_coordinates,
+        )
+        with torch.no_grad():
+            output = conv(updated)
+            reference_output = conv(reference)
+        query = reference_coordinates.float()
+        self.assertTrue(
+            torch.allclose(
+                output.features_at_coordinates(query),
+                reference_output.features_at_coordinates(query),
+                atol=1e-6,
+            )
+        )
+
+    def test_update_derived_maps(self):
+        coordinates = torch.IntTensor([[0, 0, 0], [0, 1, 1]])
+        manager = ME.CoordinateManager(
+            D=2, coordinate_map_type=ME.CoordinateMapType.CPU
+        )
+        key, _ = manager.insert_and_map(coordinates)
+        stride_key = manager.stride(key, 2)
+        manager.kernel_map(key, stride_key, 2, 2)
+        self.assertEqual(manager.get_coordinates(stride_key).tolist(), [[0, 0, 0]])
+
+        # The strided map is regenerated from the updated map
+        manager.update(key, torch.IntTensor([[0, 4, 4]]), coordinates[:1])
+        self.assertEqual(manager.memory_stats()["kernel_maps"], [])
+        stride_key = manager.stride(key, 2)
+        self.assertEqual(
+            sorted(manager.get_coordinates(stride_key).tolist()),
+            [[0, 0, 0], [0, 4, 4]],
+        )
+
+    def test_coordinate_ordering(self):
+        coordinates = torch.randint(0, 32, (512, 4)).int()
+        coordinates[:, 0] = torch.randint(0, 2, (512,))
+        features = torch.rand(len(coordinates), 4)
+        conv = ME.MinkowskiConvolution(4, 2, kernel_size=3, stride=2, dimension=3)
+        conv.eval()
+
+        def convolve(ordering):
+            manager = ME.CoordinateManager(
+                D=3,
+                coordinate_map_type=ME.CoordinateMapType.CPU,
+                coordinate_ordering=ordering,
+            )
+            self.assertEqual(manager.coordinate_ordering, ordering)
+            input = ME.SparseTensor(features, coordinates, coordinate_manager=manager)
+            with torch.no_grad():
+                return manager, conv(input)
+
+        _, reference = convolve(ME.CoordinateOrdering.INSERTION)
+        for ordering in [ME.CoordinateOrdering.MORTON, ME.CoordinateOrdering.HILBERT]:
+            manager, output = convolve(ordering)
+            key, (unique_map, inverse_map) = manager.insert_and_map(coordinates)
+            unique_coordinates = manager.get_coordinates(key)
+            self.assertTrue(torch.all(coordinates[unique_map] == unique_coordinates))
+            self.assertTrue(
+                torch.all(coordinates == coordinates[unique_map][inverse_map])
+            )
+            # The batches are contiguous
+            batch_indices = unique_coordinates[:, 0]
+            self.assertTrue(torch.all(batch_indices[1:] >= batch_indices[:-1]))
+
+            query = output.C.float()
+            self.assertTrue(
+                torch.allclose(
+                    output.F,
+                    reference.features_at_coordinates(query),
+                    atol=1e-6,
+                )
+            )
+
+    def test_neighbors(self):
+        coordinates = torch.randint(0, 10, (64, 3)).int()
+        coordinates[:, 0] = torch.randint(0, 2, (64,))
+        manager = ME.CoordinateManager(
+            D=2, coordinate_map_type=ME.CoordinateMapType.CPU
+        )
+        key, _ = manager.insert_and_map(coordinates)
+        voxels = manager.get_coordinates(key).float()
+        query = torch.rand(16, 3) * 10
+        query[:, 0] = torch.randint(0, 2, (16,)).float()
+
+        def brute_force_distances(i, p):
+            batch_voxels = voxels[voxels[:, 0] == query[i, 0]]
+            return (batch_voxels[:, 1:] - query[i, 1:]).norm(p=p, dim=1).sort()[0]
+
+        row_ptr, rows, distances = manager.neighbors(key, query, k=4)
+        for i in range(len(query)):
+            reference = brute_force_distances(i, 2)[:4]
+            curr_rows = rows[row_ptr[i] : row_ptr[i + 1]]
+            curr_distances = distances[row_ptr[i] : row_ptr[i + 1]]
+            self.assertTrue(torch.allclose(curr_distances, reference))
+            self.assertTrue(
+                torch.allclose(
+                    (voxels[curr_rows, 1:] - query[i, 1:]).norm(dim=1), reference
+                )
+            )
+
+        row_ptr, rows, distances = manager.neighbors(
+            key, query, radius=2.5, p=float("inf")
+        )
+        for i in range(len(query)):
+            reference = brute_force_distances(i, float("inf"))
+            reference = reference[reference <= 2.5]
+            curr_distances = distances[row_ptr[i] : row_ptr[i + 1]]
+            self.assertTrue(torch.allclose(curr_distances, reference))
+
+        # A batch with fewer than k coordinates and a batch without any
+        coordinates = torch.IntTensor([[0, 0, 0], [0, 5, 5], [1, 100, -100]])
+        key, _ = manager.insert_and_map(coordinates, string_id="sparse")
+        query = torch.Tensor([[0, 1, 1], [1, 0, 0], [2, 0, 0]])
+        row_ptr, rows, distances = manager.neighbors(key, query, k=4)
+        self.assertEqual(row_ptr.tolist(), [0, 2, 3, 3])
+        self.assertEqual(rows.tolist(), [0, 1, 2])
+
+    def test_memory_stats(self):
+        coordinates = torch.IntTensor(
+            [[0, 1], [0, 1], [0, 2], [0, 2], [1, 0], [1, 0], [1, 1]]
+        )
+        manager = ME.CoordinateManager(
+            D=1, coordinate_map_type=ME.CoordinateMapType.CPU
+        )
+        key, _ = manager.insert_and_map(coordinates, [1])
+        stride_key = manager.stride(key, [2])
+        kernel_map = manager.kernel_map(key, stride_key, 2, 2)
+
+        stats = manager.memory_stats()
+        self.assertEqual(len(stats["coordinate_maps"]), 2)
+        for entry in stats["coordinate_maps"]:
+            self.assertGreaterEqual(entry["hash_capacity"], entry["size"])
+            self.assertGreater(entry["load_factor"], 0)
+            self.assertLessEqual(entry["load_factor"], 1)
+            self.assertEqual(
+                entry["bytes"], entry["coordinate_bytes"] + entry["hash_bytes"]
+            )
+            self.assertLessEqual(entry["created"], entry["last_used"])
+        self.assertEqual(
+            sorted(entry["size"] for entry in stats["coordinate_maps"]), [3, 4]
+        )
+
+        self.assertEqual(len(stats["kernel_maps"]), 1)
+        entry = stats["kernel_maps"][0]
+        self.assertEqual(entry["size"], sum(entry["sizes"]))
+        self.assertEqual(
+            entry["size"], sum(len(in_map) for in_map, _ in kernel_map.values())
+        )
+        self.assertGreater(stats["total_bytes"]["kernel_maps"], 0)
+
+        # A cached lookup updates the last use time
+        time.sleep(0.01)
+        manager.kernel_map(key, stride_key, 2, 2)
+        last_used = manager.memory_stats()["kernel_maps"][0]["last_used"]
+        self.assertGreater(last_used, entry["last_used"])
+
+        self.assertEqual(manager.clear_kernel_maps(idle_seconds=3600), 0)
+        self.assertEqual(manager.clear_kernel_maps(), 1)
+        stats = manager.memory_stats()
+        self.assertEqual(len(stats["kernel_maps"]), 0)
+        self.assertEqual(len(stats["coordinate_maps"]), 2)
+
+        # Regenerated on the next use
+        manager.kernel_map(key, stride_key, 2, 2)
+        self.assertEqual(len(manager.memory_stats()["kernel_maps"]), 1)
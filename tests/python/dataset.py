@@ -0,0 +1,105 @@
+# Copyright (c) Chris Choy (chrischoy@ai.stanford.edu).
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+# of the Software, and to permit persons to whom the Software is furnished to do
+# so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# Please cite "4D Spatio-Temporal ConvNets: Minkowski Convolutional Neural
+# Networks", CVPR'19 (https://arxiv.org/abs/1904.08755) if you use any part
+# of the code.
+import os
+import tempfile
+import unittest
+
+import numpy as np
+import torch
+
+from MinkowskiEngine.utils import (
+    sparse_quantize,
+    sparse_collate,
+    SparseDataset,
+    SparseDatasetWriter,
+)
+
+
+class TestSparseDataset(unittest.TestCase):
+    def _samples(self, num_samples=4):
+        samples = []
+        for i in range(num_samples):
+            N = 1000 + 100 * i
+            coords = np.random.rand(N, 3) * 10
+            feats = np.random.rand(N, 4).astype(np.float32)
+            labels = np.floor(np.random.rand(N) * 3).astype(np.int32)
+            samples.append((coords, feats, labels))
+        return samples
+
+    def test(self):
+        samples = self._samples()
+        with tempfile.TemporaryDirectory() as tmpdir:
+            path = os.path.join(tmpdir, "dataset")
+            with SparseDatasetWriter(path, quantization_size=0.5) as writer:
+                for coords, feats, labels in samples:
+                    writer.append(coords, feats, labels)
+
+            dataset = SparseDataset(path)
+            self.assertEqual(len(dataset), len(samples))
+            self.assertTrue(dataset.has_labels)
+
+            quantized = []
+            for i, (coords, feats, labels) in enumerate(samples):
+                qcoords, qfeats, qlabels = sparse_quantize(
+                    coords, feats, labels, quantization_size=0.5
+                )
+                dcoords, dfeats, dlabels = dataset[i]
+                self.assertTrue(torch.all(torch.as_tensor(qcoords).int() == dcoords))
+                self.assertTrue(torch.all(torch.as_tensor(qfeats) == dfeats))
+                self.assertTrue(torch.all(torch.as_tensor(qlabels) == dlabels))
+                quantized.append((dcoords, dfeats, dlabels))
+
+            # Batched output must match sparse_collate
+            indices = [2, 0, 3]
+            bcoords, bfeats, blabels = dataset.collate(indices)
+            ccoords, cfeats, clabels = sparse_collate(
+                [quantized[i][0] for i in indices],
+                [quantized[i][1] for i in indices],
+                [quantized[i][2] for i in indices],
+            )
+            self.assertTrue(torch.all(bcoords == ccoords))
+            self.assertTrue(torch.all(bfeats == cfeats))
+            self.assertTrue(torch.all(blabels == clabels))
+
+            # Modifying the returned tensors must not modify the dataset
+            dcoords, _, _ = dataset[0]
+            dcoords.zero_()
+            self.assertTrue(torch.all(SparseDataset(path)[0][0] == quantized[0][0]))
+
+    def test_maps(self):
+        samples = self._samples(2)
+        with tempfile.TemporaryDirectory() as tmpdir:
+            path = os.path.join(tmpdir, "dataset")
+            with SparseDatasetWriter(path, save_maps=True) as writer:
+                for coords, feats, _ in samples:
+                    writer.append(coords, feats)
+
+            dataset = SparseDataset(path)
+            self.assertFalse(dataset.has_labels)
+            for i, (coords, feats, _) in enumerate(samples):
+                unique_map, inverse_map = dataset.maps(i)
+                dcoords, dfeats = dataset[i]
+                discrete_coords = torch.from_numpy(np.floor(coords)).int()
+                self.assertTrue(torch.all(discrete_coords[unique_map] == dcoords))
+                self.assertTrue(torch.all(dcoords[inverse_map] == discrete_coords))
@@ -104,6 +104,47 @@ class TestDense(unittest.TestCase):
 
         self.assertEqual(dense_data.shape, x.shape)
 
+    def test_channels_last(self):
+        coords = torch.IntTensor([[0, 0, 0], [0, 2, 4], [1, 2, 2], [1, 6, 0]])
+        feats = torch.rand(4, 3).double()
+        feats.requires_grad_()
+        input = SparseTensor(feats, coords, tensor_stride=2)
+        dense, min_coord, _ = input.dense()
+        dense_last, min_coord_last, _ = input.dense(channels_last=True)
+        self.assertEqual(dense.shape, torch.Size([2, 3, 4, 3]))
+        self.assertTrue(torch.equal(dense.permute(0, 2, 3, 1), dense_last))
+        self.assertTrue(torch.equal(min_coord, min_coord_last))
+        self.assertTrue(torch.equal(dense[1, :, 3, 0], feats[3].detach()))
+
+        weight = torch.rand(dense_last.shape).double()
+        (dense_last * weight).sum().backward()
+        self.assertTrue(torch.equal(feats.grad[1], weight[0, 1, 2].double()))
+
+    def test_nonzero_min_coordinate(self):
+        coords = torch.IntTensor([[0, 2, 4], [0, 4, 6], [1, 6, 2], [1, 2, 2]])
+        feats = torch.arange(8).view(4, 2).double()
+        input = SparseTensor(feats, coords, tensor_stride=2)
+        dense, min_coord, _ = input.dense()
+
+        # The half features take the python fallback
+        half_input = SparseTensor(
+            feats.half(),
+            coordinate_map_key=input.coordinate_map_key,
+            coordinate_manager=input.coordinate_manager,
+        )
+        half_dense, half_min_coord, _ = half_input.dense()
+        self.assertTrue(torch.equal(dense, half_dense.double()))
+        self.assertTrue(torch.equal(min_coord, half_min_coord))
+        self.assertEqual(min_coord.tolist(), [[2, 2]])
+
+        # The absolute coordinates are indexed
+        self.assertEqual(dense.shape, torch.Size([2, 2, 4, 4]))
+        self.assertTrue(torch.equal(dense[0, :, 1, 2], feats[0]))
+        self.assertTrue(torch.equal(dense[1, :, 3, 1], feats[2]))
+
+        shape_dense, _, _ = input.dense(shape=dense.shape)
+        self.assertTrue(torch.equal(dense, shape_dense))
+
 
 class TestDenseToSparse(unittest.TestCase):
     def test(self):
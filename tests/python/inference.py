@@ -0,0 +1,113 @@
+# Copyright (c) 2020 NVIDIA CORPORATION.
+# Copyright (c) 2018-2020 Chris Choy (chrischoy@ai.stanford.edu).
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+# of the Software, and to permit persons to whom the Software is furnished to do
+# so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# Please cite "4D Spatio-Temporal ConvNets: Minkowski Convolutional Neural
+# Networks", CVPR'19 (https://arxiv.org/abs/1904.08755) if you use any part
+# of the code.
+import torch
+import torch.nn as nn
+import unittest
+
+import MinkowskiEngine as ME
+from MinkowskiEngine import SparseTensor
+from MinkowskiEngine.utils import optimize_for_inference, verify_inference_model
+
+from tests.python.common import data_loader
+
+
+def _randomize_batch_norm(model):
+    for module in model.modules():
+        if isinstance(module, ME.MinkowskiBatchNorm):
+            bn = module.bn
+            bn.running_mean.uniform_(-1, 1)
+            bn.running_var.uniform_(0.5, 2)
+            bn.weight.data.uniform_(0.5, 2)
+            bn.bias.data.uniform_(-1, 1)
+
+
+class Block(nn.Module):
+    def __init__(self, channels, D):
+        nn.Module.__init__(self)
+        self.conv = nn.Sequential(
+            ME.MinkowskiConvolution(channels, channels, kernel_size=3, dimension=D),
+            ME.MinkowskiBatchNorm(channels),
+            ME.MinkowskiReLU(),
+        )
+        self.linear = ME.MinkowskiLinear(channels, channels)
+
+    def forward(self, x):
+        return self.linear(self.conv(x) + x)
+
+
+class TestInference(unittest.TestCase):
+    def test(self):
+        in_channels, D = 3, 2
+        coords, feats, labels = data_loader(in_channels)
+        input = SparseTensor(feats.double() / feats.numel(), coords)
+
+        model = nn.Sequential(
+            ME.MinkowskiConvolution(in_channels, 8, kernel_size=3, dimension=D),
+            ME.MinkowskiBatchNorm(8),
+            ME.MinkowskiLeakyReLU(0.1),
+            ME.MinkowskiConvolution(8, 8, kernel_size=2, stride=2, dimension=D),
+            ME.MinkowskiBatchNorm(8),
+            ME.MinkowskiLinear(8, 6),
+            ME.MinkowskiDropout(),
+            ME.MinkowskiGELU(),
+            ME.MinkowskiBatchNorm(6),
+            ME.MinkowskiLinear(6, 4),
+            Block(4, D),
+            ME.MinkowskiConvolutionTranspose(
+                4, 4, kernel_size=2, stride=2, bias=True, dimension=D
+            ),
+            ME.MinkowskiBatchNorm(4),
+        ).double()
+        _randomize_batch_norm(model)
+
+        optimized = optimize_for_inference(model, verify_input=input, atol=1e-8)
+        print(optimized)
+        self.assertTrue(model.training)
+        modules = list(optimized.modules())
+        self.assertEqual(
+            len([m for m in modules if isinstance(m, ME.MinkowskiBatchNorm)]), 0
+        )
+        self.assertEqual(
+            len([m for m in modules if isinstance(m, ME.MinkowskiFusedConvolution)]),
+            3,
+        )
+        # conv, bn, leaky relu / conv, bn, linear, dropout, gelu / bn, linear /
+        # block / transposed conv, bn
+        self.assertEqual(len(optimized), 5)
+        self.assertEqual(optimized[1].out_channels, 6)
+
+    def test_verify(self):
+        in_channels, D = 3, 2
+        coords, feats, labels = data_loader(in_channels)
+        input = SparseTensor(feats.double(), coords)
+        model = nn.Sequential(
+            ME.MinkowskiConvolution(in_channels, 4, kernel_size=3, dimension=D),
+            ME.MinkowskiBatchNorm(4),
+        ).double()
+        _randomize_batch_norm(model)
+        optimized = optimize_for_inference(model)
+        optimized[0].bias.data += 1
+        with self.assertRaises(AssertionError):
+            verify_inference_model(model, optimized, input)
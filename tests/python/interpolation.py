@@ -84,6 +84,40 @@ class TestInterpolation(unittest.TestCase):
             output, _ = interp(input, tfield)
             output.sum().backward()
 
+    def test_reduced_precision(self):
+        in_channels, D = 2, 2
+        coords, feats, labels = data_loader(in_channels, batch_size=2)
+        tfield = torch.Tensor(
+            [
+                [0, 0.1, 2.7],
+                [0, 0.3, 2],
+                [1, 1.5, 2.5],
+            ]
+        )
+        feats.requires_grad_()
+        input = SparseTensor(feats, coordinates=coords)
+        interp = MinkowskiInterpolation()
+        output = interp(input, tfield)
+        output.sum().backward()
+
+        for dtype in (torch.bfloat16, torch.float16):
+            # The coordinates stay in float
+            feats_half = feats.detach().to(dtype).requires_grad_()
+            input_half = SparseTensor(
+                feats_half,
+                coordinate_map_key=input.coordinate_map_key,
+                coordinate_manager=input.coordinate_manager,
+            )
+            output_half = interp(input_half, tfield)
+            self.assertEqual(output_half.dtype, dtype)
+            self.assertTrue(
+                torch.allclose(output_half.float(), output, rtol=1e-2, atol=1e-2)
+            )
+            output_half.sum().backward()
+            self.assertTrue(
+                torch.allclose(feats_half.grad.float(), feats.grad, rtol=1e-2, atol=1e-2)
+            )
+
     def test_gpu(self):
         in_channels, D = 2, 2
         coords, feats, labels = data_loader(in_channels, batch_size=2)
@@ -172,3 +206,23 @@ class TestInterpolation(unittest.TestCase):
         output = interp(input, tfield)
         print(input)
         print(output)
+
+    def test_map_weight(self):
+        # dense 2D grid with stride 3 so that every field point has 4 corners
+        coords = torch.IntTensor(
+            [[0, 3 * i, 3 * j] for i in range(4) for j in range(4)]
+        )
+        feats = torch.rand(len(coords), 1).double()
+        input = SparseTensor(feats, coordinates=coords, tensor_stride=3)
+        tfield = torch.cat(
+            [torch.zeros(1000, 1), torch.rand(1000, 2) * 9], 1
+        ).double()
+        in_map, out_map, weights = input.coordinate_manager.interpolation_map_weight(
+            input.coordinate_map_key, tfield
+        )
+        self.assertEqual(len(in_map), 4 * len(tfield))
+        # sorted by the field index
+        self.assertTrue(torch.all(out_map[1:] >= out_map[:-1]))
+        weight_sum = torch.zeros(len(tfield)).double()
+        weight_sum.index_add_(0, out_map.long(), weights)
+        self.assertTrue(torch.allclose(weight_sum, torch.ones(len(tfield)).double()))
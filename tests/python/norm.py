@@ -54,6 +54,28 @@ class TestNormalization(unittest.TestCase):
             )
         )
 
+    def test_inst_norm_batch(self):
+        in_channels = 3
+        coords, feats, labels = data_loader(in_channels, batch_size=3)
+        feats = feats.double() * 10 + 5
+        input = SparseTensor(feats, coords)
+        norm = MinkowskiInstanceNorm(num_features=in_channels).double()
+        out = norm(input)
+
+        for b in range(3):
+            mask = out.C[:, 0] == b
+            out_feat = out.F[mask]
+            self.assertTrue(
+                torch.allclose(out_feat.mean(0), torch.zeros(in_channels).double())
+            )
+            self.assertTrue(
+                torch.allclose(
+                    out_feat.var(0, unbiased=False),
+                    torch.ones(in_channels).double(),
+                    atol=1e-6,
+                )
+            )
+
     def test_inst_norm_gpu(self):
         in_channels = 2
         coords, feats, labels = data_loader(in_channels)
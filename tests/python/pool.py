@@ -40,6 +40,7 @@ from MinkowskiEngine import (
     MinkowskiGlobalSumPooling,
     MinkowskiGlobalAvgPooling,
     MinkowskiGlobalMaxPooling,
+    PoolingMode,
 )
 
 from utils.gradcheck import gradcheck
@@ -529,6 +530,24 @@ class TestGlobalMaxPooling(unittest.TestCase):
             )
         )
 
+    def test_modes(self):
+        in_channels, D = 3, 2
+        coords, feats, labels = data_loader(in_channels, batch_size=4)
+        feats = feats.double()
+        input = SparseTensor(feats, coords)
+        reductions = {
+            "SUM": lambda x: x.sum(0),
+            "AVG": lambda x: x.mean(0),
+            "MAX": lambda x: x.max(0)[0],
+        }
+        for name, reduction in reductions.items():
+            for policy in ["DEFAULT", "KERNEL", "PYTORCH_INDEX"]:
+                mode = getattr(PoolingMode, f"GLOBAL_{name}_POOLING_{policy}")
+                output = MinkowskiGlobalPooling(mode)(input)
+                for out_feat, b in zip(output.F, output.C[:, 0]):
+                    in_feat = input.F[input.C[:, 0] == b]
+                    self.assertTrue(torch.allclose(out_feat, reduction(in_feat)))
+
     def test_field(self):
         in_channels, D = 2, 2
         coords, feats, labels = data_loader(in_channels)
@@ -0,0 +1,111 @@
+# Copyright (c) 2020 NVIDIA CORPORATION.
+# Copyright (c) 2018-2020 Chris Choy (chrischoy@ai.stanford.edu).
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+# of the Software, and to permit persons to whom the Software is furnished to do
+# so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# Please cite "4D Spatio-Temporal ConvNets: Minkowski Convolutional Neural
+# Networks", CVPR'19 (https://arxiv.org/abs/1904.08755) if you use any part
+# of the code.
+import json
+import os
+import tempfile
+import unittest
+
+import torch
+import torch.nn as nn
+
+import MinkowskiEngine as ME
+from MinkowskiEngine import SparseTensor
+from MinkowskiEngine.utils import (
+    profile,
+    record,
+    enable_profiling,
+    disable_profiling,
+    clear_profile,
+    profile_events,
+)
+
+from tests.python.common import data_loader
+
+
+class TestProfiler(unittest.TestCase):
+    def test_disabled(self):
+        clear_profile()
+        coords, feats, labels = data_loader(2)
+        conv = ME.MinkowskiConvolution(2, 3, kernel_size=3, dimension=2)
+        conv(SparseTensor(feats, coordinates=coords))
+        self.assertEqual(len(profile_events()), 0)
+
+    def test_capacity(self):
+        clear_profile()
+        enable_profiling(capacity=2)
+        for i in range(3):
+            with record(f"step{i}"):
+                pass
+        disable_profiling()
+        self.assertEqual([e["name"] for e in profile_events()], ["step0", "step1"])
+        clear_profile()
+
+    def test(self):
+        coords, feats, labels = data_loader(4)
+        feats = feats.double()
+        feats.requires_grad_()
+        model = nn.Sequential(
+            ME.MinkowskiConvolution(4, 8, kernel_size=3, stride=2, dimension=2),
+            ME.MinkowskiReLU(),
+            ME.MinkowskiConvolution(8, 8, kernel_size=3, dimension=2),
+            ME.MinkowskiGlobalAvgPooling(),
+        ).double()
+
+        with profile(model) as prof:
+            output = model(SparseTensor(feats, coordinates=coords))
+            output.F.sum().backward()
+
+        names = set(e["name"] for e in prof.events)
+        for name in [
+            "ConvolutionForwardCPU",
+            "ConvolutionBackwardCPU",
+            "GlobalPoolingForwardCPU",
+            "kernel_map.build",
+            "gather",
+            "gemm",
+            "scatter",
+            "0 (MinkowskiConvolution)",
+        ]:
+            self.assertTrue(name in names, name)
+
+        summary = prof.summary()
+        conv = summary["ConvolutionForwardCPU"]
+        self.assertEqual(conv["calls"], 2)
+        self.assertLessEqual(conv["self_ms"], conv["total_ms"])
+        self.assertGreater(conv["phases_ms"]["gemm"], 0)
+        self.assertLessEqual(sum(conv["phases_ms"].values()), conv["total_ms"])
+        # The kernel map of the first layer is built in its forward
+        self.assertGreater(
+            summary["0 (MinkowskiConvolution)"]["phases_ms"]["kernel_map.build"], 0
+        )
+        print(prof.table())
+
+        with tempfile.TemporaryDirectory() as d:
+            path = os.path.join(d, "trace.json")
+            prof.export_chrome_trace(path)
+            with open(path) as f:
+                trace = json.load(f)
+        self.assertEqual(len(trace["traceEvents"]), len(prof.events))
+        self.assertTrue(all(e["ph"] == "X" for e in trace["traceEvents"]))
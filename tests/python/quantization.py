@@ -25,7 +25,7 @@ import torch
 import unittest
 import numpy as np
 
-from MinkowskiEngine.utils import sparse_quantize
+from MinkowskiEngine.utils import sparse_quantize, sparse_collate
 import MinkowskiEngineBackend._C as MEB
 
 
@@ -120,6 +120,69 @@ class TestQuantization(unittest.TestCase):
         res = sparse_quantize(coords.numpy(), feats.numpy(), quantization_size=0.1)
         print(res[0].shape, res[1].shape)
 
+    def test_native_collate(self):
+        coords = [torch.rand(100, 3) * 10, (torch.rand(50, 3) * 10).numpy()]
+        feats = [torch.rand(100, 4), torch.rand(50, 4)]
+        labels = [torch.randint(0, 5, (100,)), torch.randint(0, 5, (50,))]
+        bcoords, bfeats, blabels = MEB.sparse_collate_cpu(
+            [torch.as_tensor(c) for c in coords], feats, labels, False, -100
+        )
+        self.assertEqual(bcoords.dtype, torch.int32)
+        self.assertEqual(bcoords.shape, (150, 4))
+        self.assertTrue(torch.all(bcoords[:100, 0] == 0))
+        self.assertTrue(torch.all(bcoords[100:, 0] == 1))
+        self.assertTrue(torch.equal(bcoords[:100, 1:], coords[0].floor().int()))
+        self.assertTrue(torch.equal(bfeats, torch.cat(feats)))
+        self.assertTrue(torch.equal(blabels, torch.cat(labels)))
+
+        # Python fallback for float coordinates
+        fcoords, ffeats, flabels = sparse_collate(
+            coords, feats, labels, dtype=torch.float32
+        )
+        self.assertTrue(torch.equal(bcoords.float(), fcoords))
+
+    def test_collate_without_labels(self):
+        coords = [torch.IntTensor([[0, 0], [0, 1]]), torch.IntTensor([[1, 1]])]
+        feats = [torch.rand(2, 3), torch.rand(1, 3)]
+        outputs = sparse_collate(coords, feats)
+        self.assertEqual(len(outputs), 2)
+        bcoords, bfeats = outputs
+        self.assertEqual(bcoords.tolist(), [[0, 0, 0], [0, 0, 1], [1, 1, 1]])
+        self.assertTrue(torch.equal(bfeats, torch.cat(feats)))
+
+    def test_collate_empty_features(self):
+        coords = [torch.IntTensor([[0, 0], [0, 1]]), torch.zeros(0, 2).int()]
+        feats = [torch.rand(2, 3), torch.rand(0, 3)]
+        labels = [torch.IntTensor([1, 2]), torch.zeros(0).int()]
+        bcoords, bfeats = sparse_collate(coords, feats)
+        self.assertEqual(bcoords.shape, (2, 3))
+        self.assertTrue(torch.equal(bfeats, feats[0]))
+
+        bcoords, bfeats, blabels = sparse_collate(
+            coords[::-1], feats[::-1], labels[::-1], quantize=True
+        )
+        self.assertEqual(bcoords[:, 0].tolist(), [1, 1])
+        self.assertEqual(bfeats.shape, (2, 3))
+        self.assertEqual(blabels.tolist(), [1, 2])
+
+    def test_collate_quantize(self):
+        coords = [
+            np.array([[0, 0], [0, 0], [0, 0], [0, 1]], dtype=np.int32),
+            np.array([[1, 1], [1, 1]], dtype=np.int32),
+        ]
+        feats = [np.arange(4).reshape(4, 1), np.arange(2).reshape(2, 1)]
+        labels = [
+            np.array([0, 1, 2, 3], dtype=np.int32),
+            np.array([4, 4], dtype=np.int32),
+        ]
+        bcoords, bfeats, blabels = sparse_collate(
+            coords, feats, labels, quantize=True, ignore_label=255
+        )
+        self.assertEqual(len(bcoords), 3)
+        self.assertEqual(len(bfeats), 3)
+        self.assertEqual(blabels.tolist(), [255, 3, 4])
+        self.assertEqual(bcoords[:, 0].tolist(), [0, 0, 1])
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -262,6 +262,27 @@ class SparseTensorTestCase(unittest.TestCase):
                 self.assertEqual(len(decomposed_coords), batch_size)
                 self.assertEqual(len(decomposed_feats), batch_size)
 
+    def test_batch_row_indices(self):
+        print(f"{self.__class__.__name__}: test_batch_row_indices")
+        coords = torch.IntTensor(
+            [[2, 0, 0], [0, 1, 1], [2, 1, 0], [0, 0, 1], [3, 5, 5]]
+        )
+        feats = torch.rand(len(coords), 2)
+        sinput = SparseTensor(feats, coords)
+        batch_rows = sinput._batchwise_row_indices
+        self.assertEqual(len(batch_rows), 4)
+        for b, rows in enumerate(batch_rows):
+            self.assertTrue(torch.all(sinput.C[rows, 0] == b))
+            self.assertTrue(torch.all(rows[1:] > rows[:-1]))
+        self.assertEqual(len(batch_rows[1]), 0)
+        self.assertEqual(sum(len(rows) for rows in batch_rows), len(coords))
+        self.assertTrue(
+            all(
+                torch.equal(a, b)
+                for a, b in zip(batch_rows, sinput._sorted_batchwise_row_indices)
+            )
+        )
+
     def test_decomposition_gpu(self):
         print(f"{self.__class__.__name__}: test_decomposition_gpu")
         if not torch.cuda.is_available():